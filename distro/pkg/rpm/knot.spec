@@ -38,6 +38,7 @@ BuildRequires:	pkgconfig(libedit)
 # Optional dependencies
 BuildRequires:	pkgconfig(libcap-ng)
 BuildRequires:	pkgconfig(libidn2)
+BuildRequires:	pkgconfig(liblz4)
 BuildRequires:	pkgconfig(libmnl)
 BuildRequires:	pkgconfig(libnghttp2)
 BuildRequires:	pkgconfig(libsystemd)
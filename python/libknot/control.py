@@ -47,6 +47,7 @@ class KnotCtlData(object):
 
     def __init__(self) -> None:
         self.data = self.DataArray()
+        self.bin_idx = None
 
     def __str__(self) -> str:
         """Returns data unit in text form."""
@@ -69,11 +70,25 @@ class KnotCtlData(object):
             value = str()
         return value if isinstance(value, str) else value.decode()
 
-    def __setitem__(self, index: KnotCtlDataIdx, value: str) -> None:
-        """Data unit item setter."""
+    def __setitem__(self, index: KnotCtlDataIdx, value) -> None:
+        """Data unit item setter. At most one item can be binary (bytes)."""
 
+        if isinstance(value, (bytes, bytearray)):
+            self.data[index] = ctypes.c_char_p(bytes(value))
+            self.bin_idx = index
+            self.bin_len = len(value)
+            return
+
+        if index == self.bin_idx:
+            self.bin_idx = None
         self.data[index] = ctypes.c_char_p(value.encode()) if value else ctypes.c_char_p()
 
+    def get_bytes(self, index: KnotCtlDataIdx, length: int) -> bytes:
+        """Binary data unit item getter."""
+
+        ptr = ctypes.cast(self.data, ctypes.POINTER(ctypes.c_void_p))[index]
+        return ctypes.string_at(ptr, length) if ptr else bytes()
+
 
 class KnotCtlError(Exception):
     """Libknot server control error."""
@@ -96,7 +111,11 @@ class KnotCtl(object):
     CONNECT = None
     CLOSE = None
     SEND = None
+    SEND_BIN = None
     RECEIVE = None
+    DATA_LEN = None
+
+    WIRE_MAX_SIZE = 65535
 
     def __init__(self) -> None:
         """Initializes a control interface instance."""
@@ -124,10 +143,19 @@ class KnotCtl(object):
             KnotCtl.SEND.restype = ctypes.c_int
             KnotCtl.SEND.argtypes = [ctypes.c_void_p, ctypes.c_uint, ctypes.c_void_p]
 
+            KnotCtl.SEND_BIN = libknot.Knot.LIBKNOT.knot_ctl_send_bin
+            KnotCtl.SEND_BIN.restype = ctypes.c_int
+            KnotCtl.SEND_BIN.argtypes = [ctypes.c_void_p, ctypes.c_uint, ctypes.c_void_p,
+                                         ctypes.c_uint, ctypes.c_size_t]
+
             KnotCtl.RECEIVE = libknot.Knot.LIBKNOT.knot_ctl_receive
             KnotCtl.RECEIVE.restype = ctypes.c_int
             KnotCtl.RECEIVE.argtypes = [ctypes.c_void_p, ctypes.c_void_p, ctypes.c_void_p]
 
+            KnotCtl.DATA_LEN = libknot.Knot.LIBKNOT.knot_ctl_data_len
+            KnotCtl.DATA_LEN.restype = ctypes.c_size_t
+            KnotCtl.DATA_LEN.argtypes = [ctypes.c_void_p, ctypes.c_uint]
+
         self.obj = KnotCtl.ALLOC()
 
     def __del__(self) -> None:
@@ -156,8 +184,12 @@ class KnotCtl(object):
     def send(self, data_type: KnotCtlType, data: KnotCtlData = None) -> None:
         """Sends a data unit to the connected control socket."""
 
-        ret = KnotCtl.SEND(self.obj, data_type,
-                           data.data if data else ctypes.c_char_p())
+        if data and data.bin_idx is not None:
+            ret = KnotCtl.SEND_BIN(self.obj, data_type, data.data,
+                                   data.bin_idx, data.bin_len)
+        else:
+            ret = KnotCtl.SEND(self.obj, data_type,
+                               data.data if data else ctypes.c_char_p())
         if ret != 0:
             err = libknot.Knot.STRERROR(ret)
             raise KnotCtlError(err if isinstance(err, str) else err.decode())
@@ -195,6 +227,83 @@ class KnotCtl(object):
         self.send(KnotCtlType.DATA, query)
         self.send(KnotCtlType.BLOCK)
 
+    @staticmethod
+    def _wire_frames(wire: bytes):
+        """Splits uncompressed wire format records into data unit sized frames."""
+
+        start = pos = 0
+        while pos < len(wire):
+            rr_start = pos
+            while wire[pos] != 0:
+                pos += wire[pos] + 1
+            pos += 1 + 8 # Owner end, type, class, and TTL.
+            pos += 2 + int.from_bytes(wire[pos:pos + 2], "big")
+
+            if pos - start > KnotCtl.WIRE_MAX_SIZE:
+                yield wire[start:rr_start]
+                start = rr_start
+                if pos - start > KnotCtl.WIRE_MAX_SIZE:
+                    raise KnotCtlError("too long record")
+
+        if start < len(wire):
+            yield wire[start:]
+
+    def send_wire_block(self, cmd: str, zone: str, wire: bytes = None,
+                        flags: str = None) -> None:
+        """Sends a bulk zone query block with records in wire format.
+           The records (zone-set, zone-unset) must not use name compression.
+           Records not fitting into one data unit are sent as several
+           commands, the answers of which except the last one are received
+           and checked here."""
+
+        flags = (flags if flags else "") + "W"
+        frames = list(self._wire_frames(wire)) if wire else [None]
+
+        for i, frame in enumerate(frames):
+            query = KnotCtlData()
+            query[KnotCtlDataIdx.COMMAND] = cmd
+            query[KnotCtlDataIdx.ZONE] = zone
+            query[KnotCtlDataIdx.FLAGS] = flags
+            if frame:
+                query[KnotCtlDataIdx.DATA] = frame
+
+            self.send(KnotCtlType.DATA, query)
+            self.send(KnotCtlType.BLOCK)
+
+            # Each frame is a separate command with its own answer.
+            if i < len(frames) - 1:
+                self.receive_block()
+
+    def receive_wire(self) -> list:
+        """Receives a bulk zone answer and returns it as a list of
+           (zone, flags, wire) tuples, where wire contains uncompressed
+           records in wire format."""
+
+        out = list()
+        err_reply = None
+
+        while True:
+            reply = KnotCtlData()
+            reply_type = self.receive(reply)
+
+            # Stop if not data type.
+            if reply_type not in [KnotCtlType.DATA, KnotCtlType.EXTRA]:
+                break
+
+            # Check for an error.
+            if reply[KnotCtlDataIdx.ERROR]:
+                err_reply = reply
+                continue
+
+            length = KnotCtl.DATA_LEN(self.obj, KnotCtlDataIdx.DATA)
+            out.append((reply[KnotCtlDataIdx.ZONE], reply[KnotCtlDataIdx.FLAGS],
+                        reply.get_bytes(KnotCtlDataIdx.DATA, length)))
+
+        if err_reply:
+            raise KnotCtlError(err_reply[KnotCtlDataIdx.ERROR], err_reply)
+
+        return out
+
     def _receive_conf(self, out, reply):
 
         section = reply[KnotCtlDataIdx.SECTION]
@@ -1015,6 +1015,44 @@ int trie_apply(trie_t *tbl, int (*f)(trie_val_t *, void *), void *d)
 	return apply_nodes(&tbl->root, f, d);
 }
 
+size_t trie_split(trie_t *tbl, trie_part_t *parts, size_t max)
+{
+	assert(tbl && parts && max > 0);
+	if (!tbl->weight)
+		return 0;
+
+	size_t count = 1;
+	parts[0].root = &tbl->root;
+
+	bool expanded = true;
+	while (expanded) {
+		expanded = false;
+		for (size_t i = 0; i < count; ) {
+			node_t *t = parts[i].root;
+			if (!isbranch(t) || count - 1 + branch_weight(t) > max) {
+				i++;
+				continue;
+			}
+			// replace the branch with its twigs, they are expanded in the next round
+			uint n = branch_weight(t);
+			memmove(parts + i + n, parts + i + 1, (count - i - 1) * sizeof(*parts));
+			for (uint j = 0; j < n; ++j)
+				parts[i + j].root = twig(t, j);
+			count += n - 1;
+			i += n;
+			expanded = true;
+		}
+	}
+
+	return count;
+}
+
+int trie_part_apply(trie_part_t part, int (*f)(trie_val_t *, void *), void *d)
+{
+	assert(part.root && f);
+	return apply_nodes(part.root, f, d);
+}
+
 /* These are all thin wrappers around static Tns* functions. */
 trie_it_t* trie_it_begin(trie_t *tbl)
 {
@@ -42,6 +42,11 @@ typedef struct trie trie_t;
 /*! \brief Opaque type for holding a QP-trie iterator. */
 typedef struct trie_it trie_it_t;
 
+/*! \brief Disjoint part of a QP-trie, see trie_split(). */
+typedef struct {
+	void *root;
+} trie_part_t;
+
 /*! \brief Callback for cloning trie values. */
 typedef trie_val_t (*trie_dup_cb)(const trie_val_t val, knot_mm_t *mm);
 
@@ -107,6 +112,28 @@ int trie_get_leq(trie_t *tbl, const trie_key_t *key, uint32_t len, trie_val_t **
  */
 int trie_apply(trie_t *tbl, int (*f)(trie_val_t *, void *), void *d);
 
+/*!
+ * \brief Split the trie into disjoint parts for parallel processing.
+ *
+ * Branches are expanded from the top while the parts fit into the array.
+ * The parts are ordered and together they contain all the values.
+ * The parts are valid until the key-set of the trie is modified.
+ *
+ * \param tbl    Trie to be split.
+ * \param parts  Output array of parts.
+ * \param max    Size of the output array (at least 1).
+ *
+ * \return Number of parts stored.
+ */
+size_t trie_split(trie_t *tbl, trie_part_t *parts, size_t max);
+
+/*!
+ * \brief Apply a function to every trie_val_t of a trie part, in order.
+ *
+ * \return KNOT_EOK if success or KNOT_E* if error.
+ */
+int trie_part_apply(trie_part_t part, int (*f)(trie_val_t *, void *), void *d);
+
 /*!
  * \brief Remove an item, returning KNOT_EOK if succeeded or KNOT_ENOENT if not found.
  *
@@ -73,6 +73,73 @@ static bool same_group(zone_t *old_z, zone_t *new_z)
 	}
 }
 
+static void generate_rem(struct knot_zonedb *db_new, zone_t *zone)
+{
+	knot_dname_t *cg = zone->catalog_gen;
+	if (cg == NULL || knot_zonedb_find(db_new, zone->name) != NULL) {
+		return;
+	}
+
+	zone_t *catz = knot_zonedb_find(db_new, cg);
+	if (catz == NULL || catz->contents == NULL) {
+		return;
+	}
+
+	assert(catz->cat_members != NULL); // if this failed to allocate, catz wasn't added to zonedb
+	knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
+	if (owner == NULL) {
+		catz->cat_members->error = KNOT_ENOENT;
+		return;
+	}
+	int ret = catalog_update_add(catz->cat_members, zone->name, owner,
+	                             cg, CAT_UPD_REM, NULL, 0, NULL);
+	free(owner);
+	if (ret != KNOT_EOK) {
+		catz->cat_members->error = ret;
+	} else {
+		zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
+	}
+}
+
+static void generate_add(struct knot_zonedb *db_new, zone_t *zone, zone_t *old)
+{
+	knot_dname_t *cg = zone->catalog_gen;
+	if (cg == NULL) {
+		return;
+	}
+
+	zone_t *catz = knot_zonedb_find(db_new, cg);
+	knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
+	size_t cgroup_size = zone->catalog_group == NULL ? 0 : strlen(zone->catalog_group);
+	if (catz == NULL) {
+		log_zone_warning(zone->name, "member zone belongs to non-existing catalog zone");
+	} else if (catz->contents == NULL || old == NULL) {
+		assert(catz->cat_members != NULL);
+		if (owner == NULL) {
+			catz->cat_members->error = KNOT_ENOENT;
+			return;
+		}
+		int ret = catalog_update_add(catz->cat_members, zone->name, owner,
+		                             cg, CAT_UPD_ADD, zone->catalog_group,
+		                             cgroup_size, NULL);
+		if (ret != KNOT_EOK) {
+			catz->cat_members->error = ret;
+		} else {
+			zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
+		}
+	} else if (!same_group(zone, old)) {
+		int ret = catalog_update_add(catz->cat_members, zone->name, owner,
+		                             cg, CAT_UPD_PROP, zone->catalog_group,
+		                             cgroup_size, NULL);
+		if (ret != KNOT_EOK) {
+			catz->cat_members->error = ret;
+		} else {
+			zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
+		}
+	}
+	free(owner);
+}
+
 void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old)
 {
 	// general comment: catz->contents!=NULL means incremental update of catalog
@@ -80,28 +147,7 @@ void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old)
 	if (db_old != NULL) {
 		knot_zonedb_iter_t *it = knot_zonedb_iter_begin(db_old);
 		while (!knot_zonedb_iter_finished(it)) {
-			zone_t *zone = knot_zonedb_iter_val(it);
-			knot_dname_t *cg = zone->catalog_gen;
-			if (cg != NULL && knot_zonedb_find(db_new, zone->name) == NULL) {
-				zone_t *catz = knot_zonedb_find(db_new, cg);
-				if (catz != NULL && catz->contents != NULL) {
-					assert(catz->cat_members != NULL); // if this failed to allocate, catz wasn't added to zonedb
-					knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
-					if (owner == NULL) {
-						catz->cat_members->error = KNOT_ENOENT;
-						knot_zonedb_iter_next(it);
-						continue;
-					}
-					int ret = catalog_update_add(catz->cat_members, zone->name, owner,
-					                             cg, CAT_UPD_REM, NULL, 0, NULL);
-					free(owner);
-					if (ret != KNOT_EOK) {
-						catz->cat_members->error = ret;
-					} else {
-						zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
-					}
-				}
-			}
+			generate_rem(db_new, knot_zonedb_iter_val(it));
 			knot_zonedb_iter_next(it);
 		}
 		knot_zonedb_iter_free(it);
@@ -110,48 +156,22 @@ void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old)
 	knot_zonedb_iter_t *it = knot_zonedb_iter_begin(db_new);
 	while (!knot_zonedb_iter_finished(it)) {
 		zone_t *zone = knot_zonedb_iter_val(it);
-		knot_dname_t *cg = zone->catalog_gen;
-		if (cg == NULL) {
-			knot_zonedb_iter_next(it);
-			continue;
-		}
-		zone_t *catz = knot_zonedb_find(db_new, cg);
-		zone_t *old = knot_zonedb_find(db_old, zone->name);
-		knot_dname_t *owner = catalog_member_owner(zone->name, cg, zone->timers.catalog_member);
-		size_t cgroup_size = zone->catalog_group == NULL ? 0 : strlen(zone->catalog_group);
-		if (catz == NULL) {
-			log_zone_warning(zone->name, "member zone belongs to non-existing catalog zone");
-		} else if (catz->contents == NULL || old == NULL) {
-			assert(catz->cat_members != NULL);
-			if (owner == NULL) {
-				catz->cat_members->error = KNOT_ENOENT;
-				knot_zonedb_iter_next(it);
-				continue;
-			}
-			int ret = catalog_update_add(catz->cat_members, zone->name, owner,
-			                             cg, CAT_UPD_ADD, zone->catalog_group,
-			                             cgroup_size, NULL);
-			if (ret != KNOT_EOK) {
-				catz->cat_members->error = ret;
-			} else {
-				zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
-			}
-		} else if (!same_group(zone, old)) {
-			int ret = catalog_update_add(catz->cat_members, zone->name, owner,
-			                             cg, CAT_UPD_PROP, zone->catalog_group,
-			                             cgroup_size, NULL);
-			if (ret != KNOT_EOK) {
-				catz->cat_members->error = ret;
-			} else {
-				zone_events_schedule_now(catz, ZONE_EVENT_LOAD);
-			}
-		}
-		free(owner);
+		generate_add(db_new, zone, knot_zonedb_find(db_old, zone->name));
 		knot_zonedb_iter_next(it);
 	}
 	knot_zonedb_iter_free(it);
 }
 
+void catalogs_generate_zone(struct knot_zonedb *db_new, struct zone *old_zone,
+                            struct zone *new_zone)
+{
+	if (new_zone != NULL) {
+		generate_add(db_new, new_zone, old_zone);
+	} else if (old_zone != NULL) {
+		generate_rem(db_new, old_zone);
+	}
+}
+
 static void set_rdata(knot_rrset_t *rrset, uint8_t *data, uint16_t len)
 {
 	knot_rdata_init(rrset->rrs.rdata, len, data);
@@ -29,6 +29,18 @@ struct knot_zonedb;
  */
 void catalogs_generate(struct knot_zonedb *db_new, struct knot_zonedb *db_old);
 
+struct zone;
+
+/*!
+ * \brief Create catalog upd for one zone added, removed, or re-created in zonedb.
+ *
+ * \param db_new     New zonedb.
+ * \param old_zone   Zone in the old zonedb (NULL if added).
+ * \param new_zone   Zone in the new zonedb (NULL if removed).
+ */
+void catalogs_generate_zone(struct knot_zonedb *db_new, struct zone *old_zone,
+                            struct zone *new_zone);
+
 struct zone_contents;
 
 /*!
@@ -207,6 +207,24 @@ void log_levels_add(log_target_t target, log_source_t src, int levels)
 	}
 }
 
+bool log_enabled(int priority, log_source_t src)
+{
+	if (!log_isopen() || src == LOG_SOURCE_ANY) {
+		return false;
+	}
+
+	bool enabled = false;
+
+	rcu_read_lock();
+	log_t *log = s_log;
+	for (int i = LOG_TARGET_SYSLOG; i < log->target_count && !enabled; ++i) {
+		enabled = (*src_levels(log, i, src) & LOG_MASK(priority));
+	}
+	rcu_read_unlock();
+
+	return enabled;
+}
+
 static void emit_log_msg(int level, log_source_t src, const char *zone,
                          size_t zone_len, const char *msg, const char *param)
 {
@@ -292,7 +310,7 @@ static int log_msg_add(char **write, size_t *capacity, const char *fmt, ...)
 static void log_msg_text(int level, log_source_t src, const char *zone,
                          const char *fmt, va_list args, const char *param)
 {
-	if (!log_isopen() || src == LOG_SOURCE_ANY) {
+	if (!log_enabled(level, src)) {
 		return;
 	}
 
@@ -349,6 +367,10 @@ void log_fmt(int priority, log_source_t src, const char *fmt, ...)
 void log_fmt_zone(int priority, log_source_t src, const knot_dname_t *zone,
                   const char *param, const char *fmt, ...)
 {
+	if (!log_enabled(priority, src)) {
+		return;
+	}
+
 	knot_dname_txt_storage_t buff;
 	char *zone_str = knot_dname_to_str(buff, zone, sizeof(buff));
 	if (zone_str == NULL) {
@@ -94,6 +94,18 @@ void log_levels_set(log_target_t target, log_source_t src, int levels);
  */
 void log_levels_add(log_target_t target, log_source_t src, int levels);
 
+/*!
+ * \brief Check if a message of given priority and source would be logged.
+ *
+ * Useful to skip preparation of expensive message arguments.
+ *
+ * \param priority  Message priority.
+ * \param src       Message source (LOG_SOURCE_SERVER...LOG_SOURCE_ZONE).
+ *
+ * \return True if some logging target accepts the message.
+ */
+bool log_enabled(int priority, log_source_t src);
+
 /*!
  * \brief Log message into server category.
  *
@@ -51,8 +51,18 @@ uint64_t server_zone_count(server_t *server)
 	return knot_zonedb_size(server->zone_db);
 }
 
+uint64_t server_query_allocations(server_t *server)
+{
+	uint64_t res = 0;
+	for (unsigned i = 0; i < server->thread_cache_count; i++) {
+		res += ATOMIC_GET(server->query_allocs[i]);
+	}
+	return res;
+}
+
 const stats_item_t server_stats[] = {
 	{ "zone-count", server_zone_count },
+	{ "query-allocations", server_query_allocations },
 	{ 0 }
 };
 
@@ -23,6 +23,7 @@
 #include "knot/conf/tools.h"
 #include "knot/common/log.h"
 #include "knot/nameserver/query_module.h"
+#include "knot/updates/acl.h"
 #include "libknot/libknot.h"
 #include "libknot/yparser/ypformat.h"
 #include "libknot/yparser/yptrafo.h"
@@ -85,6 +86,10 @@ int conf_refresh_txn(
 		return KNOT_EINVAL;
 	}
 
+	// Drop compiled data referencing the previous transaction.
+	acl_compiled_free(conf->acl);
+	conf->acl = NULL;
+
 	// Close previously opened transaction.
 	conf->api->txn_abort(&conf->read_txn);
 
@@ -461,6 +466,7 @@ void conf_free(
 		return;
 	}
 
+	acl_compiled_free(conf->acl);
 	yp_schema_free(conf->schema);
 	free(conf->filename);
 	free(conf->hostname);
@@ -82,6 +82,7 @@ knot_dynarray_declare(mod, module_t *, DYNARRAY_VISIBILITY_NORMAL, 16)
 knot_dynarray_declare(old_schema, yp_item_t *, DYNARRAY_VISIBILITY_NORMAL, 16)
 
 struct knot_catalog;
+struct acl_compiled;
 
 /*! Configuration context. */
 typedef struct {
@@ -154,6 +155,8 @@ typedef struct {
 	struct query_plan *query_plan;
 	/*! Zone catalog database. */
 	struct catalog *catalog;
+	/*! Compiled ACL rules (built on first use). */
+	struct acl_compiled *acl;
 } conf_t;
 
 /*!
@@ -160,6 +160,13 @@ static const knot_lookup_t log_severities[] = {
 static const knot_lookup_t journal_modes[] = {
 	{ JOURNAL_MODE_ROBUST, "robust" },
 	{ JOURNAL_MODE_ASYNC,  "asynchronous" },
+	{ JOURNAL_MODE_GROUP,  "grouped" },
+	{ 0, NULL }
+};
+
+static const knot_lookup_t journal_compressions[] = {
+	{ JOURNAL_COMPRESS_NONE, "none" },
+	{ JOURNAL_COMPRESS_LZ4,  "lz4" },
 	{ 0, NULL }
 };
 
@@ -188,6 +195,8 @@ static const yp_item_t desc_server[] = {
 	{ C_UDP_WORKERS,          YP_TINT,  YP_VINT = { 1, CONF_MAX_UDP_WORKERS, YP_NIL } },
 	{ C_TCP_WORKERS,          YP_TINT,  YP_VINT = { 1, CONF_MAX_TCP_WORKERS, YP_NIL } },
 	{ C_BG_WORKERS,           YP_TINT,  YP_VINT = { 1, CONF_MAX_BG_WORKERS, YP_NIL } },
+	{ C_BG_REFRESH_LIMIT,     YP_TINT,  YP_VINT = { 0, CONF_MAX_BG_WORKERS, 0 } },
+	{ C_BG_MAINT_LIMIT,       YP_TINT,  YP_VINT = { 0, CONF_MAX_BG_WORKERS, YP_NIL } },
 	{ C_ASYNC_START,          YP_TBOOL, YP_VNONE },
 	{ C_TCP_IDLE_TIMEOUT,     YP_TINT,  YP_VINT = { 1, INT32_MAX, 10, YP_STIME } },
 	{ C_TCP_IO_TIMEOUT,       YP_TINT,  YP_VINT = { 0, INT32_MAX, 500 } },
@@ -207,6 +216,13 @@ static const yp_item_t desc_server[] = {
 	                                                1232, YP_SSIZE } },
 	{ C_ECS,                  YP_TBOOL, YP_VNONE },
 	{ C_ANS_ROTATION,         YP_TBOOL, YP_VNONE },
+	{ C_IXFR_CACHE_SIZE,      YP_TINT,  YP_VINT = { 0, SSIZE_MAX, MEGA(16), YP_SSIZE } },
+	{ C_NSEC3_CACHE_SIZE,     YP_TINT,  YP_VINT = { 0, 1048576, 1024 } },
+	{ C_RESP_CACHE_SIZE,      YP_TINT,  YP_VINT = { 0, SSIZE_MAX, 0, YP_SSIZE } },
+	{ C_SOA_QUERY_LIMIT,      YP_TINT,  YP_VINT = { 0, 1024, 16 } },
+	{ C_NOTIFY_QUERY_LIMIT,   YP_TINT,  YP_VINT = { 0, 1024, 16 } },
+	{ C_RMT_POOL_LIMIT,       YP_TINT,  YP_VINT = { 0, INT32_MAX, 0 } },
+	{ C_RMT_POOL_TIMEOUT,     YP_TINT,  YP_VINT = { 1, INT32_MAX, 5, YP_STIME } },
 	{ C_LISTEN,               YP_TADDR, YP_VADDR = { 53 }, YP_FMULTI, { check_listen } },
 	{ C_COMMENT,              YP_TSTR,  YP_VNONE },
 	// Legacy items.
@@ -240,6 +256,7 @@ static const yp_item_t desc_xdp[] = {
 static const yp_item_t desc_control[] = {
 	{ C_LISTEN,  YP_TSTR, YP_VSTR = { "knot.sock" } },
 	{ C_TIMEOUT, YP_TINT, YP_VINT = { 0, INT32_MAX / 1000, 5, YP_STIME } },
+	{ C_WORKERS, YP_TINT, YP_VINT = { 1, 255, 4 } },
 	{ C_COMMENT, YP_TSTR, YP_VNONE },
 	{ NULL }
 };
@@ -266,6 +283,9 @@ static const yp_item_t desc_database[] = {
 	{ C_STORAGE,             YP_TSTR,  YP_VSTR = { STORAGE_DIR } },
 	{ C_JOURNAL_DB,          YP_TSTR,  YP_VSTR = { "journal" } },
 	{ C_JOURNAL_DB_MODE,     YP_TOPT,  YP_VOPT = { journal_modes, JOURNAL_MODE_ROBUST } },
+	{ C_JOURNAL_DB_GRP_WIN,  YP_TINT,  YP_VINT = { 0, 1000, 0 } },
+	{ C_JOURNAL_DB_COMPRESS, YP_TOPT,  YP_VOPT = { journal_compressions, JOURNAL_COMPRESS_NONE },
+	                                   YP_FNONE, { check_journal_compression } },
 	{ C_JOURNAL_DB_MAX_SIZE, YP_TINT,  YP_VINT = { MEGA(1), VIRT_MEM_LIMIT(TERA(100)),
 	                                               VIRT_MEM_LIMIT(GIGA(20)), YP_SSIZE } },
 	{ C_KASP_DB,             YP_TSTR,  YP_VSTR = { "keys" } },
@@ -29,6 +29,8 @@
 #define C_APPEND		"\x06""append"
 #define C_ASYNC_START		"\x0B""async-start"
 #define C_BACKEND		"\x07""backend"
+#define C_BG_MAINT_LIMIT	"\x1C""background-maintenance-limit"
+#define C_BG_REFRESH_LIMIT	"\x18""background-refresh-limit"
 #define C_BG_WORKERS		"\x12""background-workers"
 #define C_BLOCK_NOTIFY_XFR	"\x1B""block-notify-after-transfer"
 #define C_CATALOG_DB		"\x0A""catalog-db"
@@ -58,8 +60,11 @@
 #define C_ID			"\x02""id"
 #define C_IDENT			"\x08""identity"
 #define C_INCL			"\x07""include"
+#define C_IXFR_CACHE_SIZE	"\x0F""ixfr-cache-size"
 #define C_JOURNAL_CONTENT	"\x0F""journal-content"
 #define C_JOURNAL_DB		"\x0A""journal-db"
+#define C_JOURNAL_DB_COMPRESS	"\x16""journal-db-compression"
+#define C_JOURNAL_DB_GRP_WIN	"\x17""journal-db-group-window"
 #define C_JOURNAL_DB_MAX_SIZE	"\x13""journal-db-max-size"
 #define C_JOURNAL_DB_MODE	"\x0F""journal-db-mode"
 #define C_JOURNAL_MAX_DEPTH	"\x11""journal-max-depth"
@@ -80,7 +85,9 @@
 #define C_MODULE		"\x06""module"
 #define C_NO_EDNS		"\x07""no-edns"
 #define C_NOTIFY		"\x06""notify"
+#define C_NOTIFY_QUERY_LIMIT	"\x12""notify-query-limit"
 #define C_NSEC3			"\x05""nsec3"
+#define C_NSEC3_CACHE_SIZE	"\x10""nsec3-cache-size"
 #define C_NSEC3_ITER		"\x10""nsec3-iterations"
 #define C_NSEC3_OPT_OUT		"\x0D""nsec3-opt-out"
 #define C_NSEC3_SALT_LEN	"\x11""nsec3-salt-length"
@@ -94,7 +101,10 @@
 #define C_REFRESH_MAX_INTERVAL	"\x14""refresh-max-interval"
 #define C_REFRESH_MIN_INTERVAL	"\x14""refresh-min-interval"
 #define C_REPRO_SIGNING		"\x14""reproducible-signing"
+#define C_RESP_CACHE_SIZE	"\x13""response-cache-size"
 #define C_RMT			"\x06""remote"
+#define C_RMT_POOL_LIMIT	"\x11""remote-pool-limit"
+#define C_RMT_POOL_TIMEOUT	"\x13""remote-pool-timeout"
 #define C_ROUTE_CHECK		"\x0B""route-check"
 #define C_RRSIG_LIFETIME	"\x0E""rrsig-lifetime"
 #define C_RRSIG_PREREFRESH	"\x11""rrsig-pre-refresh"
@@ -108,6 +118,7 @@
 #define C_SIGNING_THREADS	"\x0F""signing-threads"
 #define C_SINGLE_TYPE_SIGNING	"\x13""single-type-signing"
 #define C_SOCKET_AFFINITY	"\x0F""socket-affinity"
+#define C_SOA_QUERY_LIMIT	"\x0F""soa-query-limit"
 #define C_SRV			"\x06""server"
 #define C_STATS			"\x0A""statistics"
 #define C_STORAGE		"\x07""storage"
@@ -140,6 +151,7 @@
 #define C_USER			"\x04""user"
 #define C_VERSION		"\x07""version"
 #define C_VIA			"\x03""via"
+#define C_WORKERS		"\x07""workers"
 #define C_XDP			"\x03""xdp"
 #define C_ZONE			"\x04""zone"
 #define C_ZONEFILE_LOAD		"\x0D""zonefile-load"
@@ -212,6 +224,12 @@ enum {
 enum {
 	JOURNAL_MODE_ROBUST = 0, // Robust journal DB disk synchronization.
 	JOURNAL_MODE_ASYNC  = 1, // Asynchronous journal DB disk synchronization.
+	JOURNAL_MODE_GROUP  = 2, // Robust synchronization shared by concurrent writes.
+};
+
+enum {
+	JOURNAL_COMPRESS_NONE = 0, // Journal chunks stored uncompressed.
+	JOURNAL_COMPRESS_LZ4  = 1, // Journal chunks compressed with LZ4.
 };
 
 enum {
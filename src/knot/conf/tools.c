@@ -256,6 +256,18 @@ int check_xdp_listen_old(
 	return KNOT_EOK;
 }
 
+int check_journal_compression(
+	knotd_conf_check_args_t *args)
+{
+#ifndef HAVE_LZ4
+	if (yp_opt(args->data) == JOURNAL_COMPRESS_LZ4) {
+		args->err_str = "LZ4 compression is not available";
+		return KNOT_ENOTSUP;
+	}
+#endif
+	return KNOT_EOK;
+}
+
 int check_xdp_listen(
 	knotd_conf_check_args_t *args)
 {
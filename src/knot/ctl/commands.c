@@ -55,9 +55,14 @@
 	} \
 }
 
+/*! Maximum size of wire format records in one control data item. */
+#define WIRE_MAX_SIZE	UINT16_MAX
+
 typedef struct {
 	ctl_args_t *args;
 	int type_filter; // -1: no specific type, [0, 2^16]: specific type.
+	bool wire;       // Records in wire format, many per data unit.
+	size_t wire_len; // Pending wire format records in rdata.
 	knot_dump_style_t style;
 	knot_ctl_data_t data;
 	knot_dname_txt_storage_t zone;
@@ -67,14 +72,24 @@ typedef struct {
 	char rdata[2 * 65536];
 } send_ctx_t;
 
-static struct {
+/*! Command buffers, allocated on the first use within a command. */
+struct ctl_buffers {
 	send_ctx_t send_ctx;
 	zs_scanner_t scanner;
 	char txt_rr[sizeof(((send_ctx_t *)0)->owner) +
 	            sizeof(((send_ctx_t *)0)->ttl) +
 	            sizeof(((send_ctx_t *)0)->type) +
 	            sizeof(((send_ctx_t *)0)->rdata)];
-} ctl_globals;
+};
+
+static struct ctl_buffers *get_buffers(ctl_args_t *args)
+{
+	if (args->buffers == NULL) {
+		args->buffers = malloc(sizeof(*args->buffers));
+	}
+
+	return args->buffers;
+}
 
 /*!
  * Evaluates a filter pair and checks for conflicting filters.
@@ -154,6 +169,11 @@ static void send_error(ctl_args_t *args, const char *msg)
 
 	data[KNOT_CTL_IDX_ERROR] = msg;
 
+	// Don't echo binary data.
+	if (ctl_has_flag(data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_WIRE)) {
+		data[KNOT_CTL_IDX_DATA] = NULL;
+	}
+
 	int ret = knot_ctl_send(args->ctl, KNOT_CTL_TYPE_DATA, &data);
 	if (ret != KNOT_EOK) {
 		log_ctl_debug("control, failed to send error (%s)", knot_strerror(ret));
@@ -756,11 +776,14 @@ static int init_send_ctx(send_ctx_t *ctx, const knot_dname_t *zone_name,
 	ctx->style.human_tmstamp = true;
 
 	// Set the output data buffers.
+	ctx->wire = ctl_has_flag(args->data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_WIRE);
 	ctx->data[KNOT_CTL_IDX_ZONE]  = ctx->zone;
-	ctx->data[KNOT_CTL_IDX_OWNER] = ctx->owner;
-	ctx->data[KNOT_CTL_IDX_TTL]   = ctx->ttl;
-	ctx->data[KNOT_CTL_IDX_TYPE]  = ctx->type;
 	ctx->data[KNOT_CTL_IDX_DATA]  = ctx->rdata;
+	if (!ctx->wire) {
+		ctx->data[KNOT_CTL_IDX_OWNER] = ctx->owner;
+		ctx->data[KNOT_CTL_IDX_TTL]   = ctx->ttl;
+		ctx->data[KNOT_CTL_IDX_TYPE]  = ctx->type;
+	}
 
 	// Set the ZONE.
 	if (knot_dname_to_str(ctx->zone, zone_name, sizeof(ctx->zone)) == NULL) {
@@ -781,8 +804,61 @@ static int init_send_ctx(send_ctx_t *ctx, const knot_dname_t *zone_name,
 	return KNOT_EOK;
 }
 
+static int send_wire(send_ctx_t *ctx)
+{
+	if (!ctx->wire || ctx->wire_len == 0) {
+		return KNOT_EOK;
+	}
+
+	int ret = knot_ctl_send_bin(ctx->args->ctl, KNOT_CTL_TYPE_DATA, &ctx->data,
+	                            KNOT_CTL_IDX_DATA, ctx->wire_len);
+	ctx->wire_len = 0;
+
+	return ret;
+}
+
+static int send_rrset_wire(knot_rrset_t *rrset, send_ctx_t *ctx)
+{
+	uint8_t *wire = (uint8_t *)ctx->rdata;
+	int ret = knot_rrset_to_wire(rrset, wire + ctx->wire_len,
+	                             WIRE_MAX_SIZE - ctx->wire_len, NULL);
+	if (ret == KNOT_ESPACE && ctx->wire_len > 0) {
+		ret = send_wire(ctx);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+		ret = knot_rrset_to_wire(rrset, wire, WIRE_MAX_SIZE, NULL);
+	}
+
+	// Split a too large rrset into single records.
+	if (ret == KNOT_ESPACE && rrset->rrs.count > 1) {
+		knot_rrset_t rr = *rrset;
+		rr.rrs.count = 1;
+		rr.rrs.rdata = rrset->rrs.rdata;
+		for (uint16_t i = 0; i < rrset->rrs.count; i++) {
+			rr.rrs.size = knot_rdata_size(rr.rrs.rdata->len);
+			ret = send_rrset_wire(&rr, ctx);
+			if (ret != KNOT_EOK) {
+				return ret;
+			}
+			rr.rrs.rdata = knot_rdataset_next(rr.rrs.rdata);
+		}
+		return KNOT_EOK;
+	} else if (ret < 0) {
+		return ret;
+	}
+
+	ctx->wire_len += ret;
+
+	return KNOT_EOK;
+}
+
 static int send_rrset(knot_rrset_t *rrset, send_ctx_t *ctx)
 {
+	if (ctx->wire) {
+		return send_rrset_wire(rrset, ctx);
+	}
+
 	if (rrset->type != KNOT_RRTYPE_RRSIG) {
 		int ret = snprintf(ctx->ttl, sizeof(ctx->ttl), "%u", rrset->ttl);
 		if (ret <= 0 || ret >= sizeof(ctx->ttl)) {
@@ -821,7 +897,8 @@ static int send_rrset(knot_rrset_t *rrset, send_ctx_t *ctx)
 static int send_node(zone_node_t *node, void *ctx_void)
 {
 	send_ctx_t *ctx = ctx_void;
-	if (knot_dname_to_str(ctx->owner, node->owner, sizeof(ctx->owner)) == NULL) {
+	if (!ctx->wire &&
+	    knot_dname_to_str(ctx->owner, node->owner, sizeof(ctx->owner)) == NULL) {
 		return KNOT_EINVAL;
 	}
 
@@ -886,7 +963,12 @@ static int get_owner(uint8_t *out, size_t out_len, knot_dname_t *origin,
 
 static int zone_read(zone_t *zone, ctl_args_t *args)
 {
-	send_ctx_t *ctx = &ctl_globals.send_ctx;
+	struct ctl_buffers *buffers = get_buffers(args);
+	if (buffers == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	send_ctx_t *ctx = &buffers->send_ctx;
 	int ret = init_send_ctx(ctx, zone->name, args);
 	if (ret != KNOT_EOK) {
 		return ret;
@@ -913,6 +995,10 @@ static int zone_read(zone_t *zone, ctl_args_t *args)
 		}
 	}
 
+	if (ret == KNOT_EOK) {
+		ret = send_wire(ctx);
+	}
+
 	return ret;
 }
 
@@ -923,7 +1009,12 @@ static int zone_flag_txn_get(zone_t *zone, ctl_args_t *args, const char *flag)
 		return KNOT_TXN_ENOTEXISTS;
 	}
 
-	send_ctx_t *ctx = &ctl_globals.send_ctx;
+	struct ctl_buffers *buffers = get_buffers(args);
+	if (buffers == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	send_ctx_t *ctx = &buffers->send_ctx;
 	int ret = init_send_ctx(ctx, zone->name, args);
 	if (ret != KNOT_EOK) {
 		return ret;
@@ -957,6 +1048,10 @@ static int zone_flag_txn_get(zone_t *zone, ctl_args_t *args, const char *flag)
 		zone_tree_it_free(&it);
 	}
 
+	if (ret == KNOT_EOK) {
+		ret = send_wire(ctx);
+	}
+
 	return ret;
 }
 
@@ -1010,7 +1105,8 @@ static int send_changeset_part(changeset_t *ch, send_ctx_t *ctx, bool from)
 	}
 	changeset_iter_clear(&it);
 
-	return KNOT_EOK;
+	// Records of one changeset part share the flag.
+	return send_wire(ctx);
 }
 
 static int send_changeset(changeset_t *ch, send_ctx_t *ctx)
@@ -1037,7 +1133,12 @@ static int zone_txn_diff(zone_t *zone, ctl_args_t *args)
 		return zone_flag_txn_get(zone, args, CTL_FLAG_ADD);
 	}
 
-	send_ctx_t *ctx = &ctl_globals.send_ctx;
+	struct ctl_buffers *buffers = get_buffers(args);
+	if (buffers == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	send_ctx_t *ctx = &buffers->send_ctx;
 	int ret = init_send_ctx(ctx, zone->name, args);
 	if (ret != KNOT_EOK) {
 		return ret;
@@ -1084,9 +1185,14 @@ static int create_rrset(knot_rrset_t **rrset, zone_t *zone, ctl_args_t *args,
 	const char *data  = args->data[KNOT_CTL_IDX_DATA];
 	const char *ttl   = need_ttl ? args->data[KNOT_CTL_IDX_TTL] : NULL;
 
+	struct ctl_buffers *buffers = get_buffers(args);
+	if (buffers == NULL) {
+		return KNOT_ENOMEM;
+	}
+
 	// Prepare a buffer for a reconstructed record.
-	const size_t buff_len = sizeof(ctl_globals.txt_rr);
-	char *buff = ctl_globals.txt_rr;
+	const size_t buff_len = sizeof(buffers->txt_rr);
+	char *buff = buffers->txt_rr;
 
 	uint32_t default_ttl = 0;
 	if (ttl == NULL) {
@@ -1108,7 +1214,7 @@ static int create_rrset(knot_rrset_t **rrset, zone_t *zone, ctl_args_t *args,
 	size_t rdata_len = ret;
 
 	// Parse the record.
-	zs_scanner_t *scanner = &ctl_globals.scanner;
+	zs_scanner_t *scanner = &buffers->scanner;
 	if (zs_init(scanner, origin, KNOT_CLASS_IN, default_ttl) != 0 ||
 	    zs_set_input_string(scanner, buff, rdata_len) != 0 ||
 	    zs_parse_record(scanner) != 0 ||
@@ -1134,6 +1240,41 @@ parser_failed:
 	return ret;
 }
 
+static int zone_txn_wire(zone_t *zone, ctl_args_t *args, bool add)
+{
+	const uint8_t *wire = (const uint8_t *)args->data[KNOT_CTL_IDX_DATA];
+	size_t wire_len = knot_ctl_data_len(args->ctl, KNOT_CTL_IDX_DATA);
+	if (wire == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	size_t pos = 0;
+	while (pos < wire_len) {
+		knot_rrset_t rr;
+		int ret = knot_rrset_rr_from_wire(wire, &pos, wire_len, &rr, NULL, false);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+		knot_dname_to_lower(rr.owner);
+
+		if (rr.rclass != KNOT_CLASS_IN) {
+			ret = KNOT_ENOTSUP;
+		} else if (knot_dname_in_bailiwick(rr.owner, zone->name) < 0) {
+			ret = KNOT_EOUTOFZONE;
+		} else if (add) {
+			ret = zone_update_add(zone->control_update, &rr);
+		} else {
+			ret = zone_update_remove(zone->control_update, &rr);
+		}
+		knot_rrset_clear(&rr, NULL);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
 static int zone_txn_set(zone_t *zone, ctl_args_t *args)
 {
 	if (zone->control_update == NULL) {
@@ -1141,6 +1282,10 @@ static int zone_txn_set(zone_t *zone, ctl_args_t *args)
 		return KNOT_TXN_ENOTEXISTS;
 	}
 
+	if (ctl_has_flag(args->data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_WIRE)) {
+		return zone_txn_wire(zone, args, true);
+	}
+
 	if (args->data[KNOT_CTL_IDX_OWNER] == NULL ||
 	    args->data[KNOT_CTL_IDX_TYPE]  == NULL) {
 		return KNOT_EINVAL;
@@ -1165,6 +1310,10 @@ static int zone_txn_unset(zone_t *zone, ctl_args_t *args)
 		return KNOT_TXN_ENOTEXISTS;
 	}
 
+	if (ctl_has_flag(args->data[KNOT_CTL_IDX_FLAGS], CTL_FLAG_WIRE)) {
+		return zone_txn_wire(zone, args, false);
+	}
+
 	if (args->data[KNOT_CTL_IDX_OWNER] == NULL) {
 		return KNOT_EINVAL;
 	}
@@ -1979,54 +2128,61 @@ static int ctl_conf_modify(ctl_args_t *args, ctl_cmd_t cmd)
 	return ret;
 }
 
+/*! Locking of the control commands with respect to other sessions. */
+typedef enum {
+	CTL_LOCK_EXCL,   // Modifies zones or server state, runs alone.
+	CTL_LOCK_SHARED, // Reads state or schedules zone events, runs in parallel.
+} ctl_lock_t;
+
 typedef struct {
 	const char *name;
 	int (*fcn)(ctl_args_t *, ctl_cmd_t);
+	ctl_lock_t lock;
 } desc_t;
 
 static const desc_t cmd_table[] = {
 	[CTL_NONE]            = { "" },
 
-	[CTL_STATUS]          = { "status",          ctl_server },
-	[CTL_STOP]            = { "stop",            ctl_server },
-	[CTL_RELOAD]          = { "reload",          ctl_server },
-	[CTL_STATS]           = { "stats",           ctl_stats },
-
-	[CTL_ZONE_STATUS]     = { "zone-status",        ctl_zone },
-	[CTL_ZONE_RELOAD]     = { "zone-reload",        ctl_zone },
-	[CTL_ZONE_REFRESH]    = { "zone-refresh",       ctl_zone },
-	[CTL_ZONE_RETRANSFER] = { "zone-retransfer",    ctl_zone },
-	[CTL_ZONE_NOTIFY]     = { "zone-notify",        ctl_zone },
-	[CTL_ZONE_FLUSH]      = { "zone-flush",         ctl_zone },
-	[CTL_ZONE_BACKUP]     = { "zone-backup",        ctl_zone },
-	[CTL_ZONE_RESTORE]    = { "zone-restore",       ctl_zone },
-	[CTL_ZONE_SIGN]       = { "zone-sign",          ctl_zone },
-	[CTL_ZONE_KEYS_LOAD]  = { "zone-keys-load",     ctl_zone },
-	[CTL_ZONE_KEY_ROLL]   = { "zone-key-rollover",  ctl_zone },
-	[CTL_ZONE_KSK_SBM]    = { "zone-ksk-submitted", ctl_zone },
-	[CTL_ZONE_FREEZE]     = { "zone-freeze",        ctl_zone },
-	[CTL_ZONE_THAW]       = { "zone-thaw",          ctl_zone },
-
-	[CTL_ZONE_READ]       = { "zone-read",       ctl_zone },
-	[CTL_ZONE_BEGIN]      = { "zone-begin",      ctl_zone },
-	[CTL_ZONE_COMMIT]     = { "zone-commit",     ctl_zone },
-	[CTL_ZONE_ABORT]      = { "zone-abort",      ctl_zone },
-	[CTL_ZONE_DIFF]       = { "zone-diff",       ctl_zone },
-	[CTL_ZONE_GET]        = { "zone-get",        ctl_zone },
-	[CTL_ZONE_SET]        = { "zone-set",        ctl_zone },
-	[CTL_ZONE_UNSET]      = { "zone-unset",      ctl_zone },
-	[CTL_ZONE_PURGE]      = { "zone-purge",      ctl_zone },
-	[CTL_ZONE_STATS]      = { "zone-stats",	     ctl_zone },
-
-	[CTL_CONF_LIST]       = { "conf-list",       ctl_conf_read },
-	[CTL_CONF_READ]       = { "conf-read",       ctl_conf_read },
-	[CTL_CONF_BEGIN]      = { "conf-begin",      ctl_conf_txn },
-	[CTL_CONF_COMMIT]     = { "conf-commit",     ctl_conf_txn },
-	[CTL_CONF_ABORT]      = { "conf-abort",      ctl_conf_txn },
-	[CTL_CONF_DIFF]       = { "conf-diff",       ctl_conf_read },
-	[CTL_CONF_GET]        = { "conf-get",        ctl_conf_read },
-	[CTL_CONF_SET]        = { "conf-set",        ctl_conf_modify },
-	[CTL_CONF_UNSET]      = { "conf-unset",      ctl_conf_modify },
+	[CTL_STATUS]          = { "status",              ctl_server,      CTL_LOCK_SHARED },
+	[CTL_STOP]            = { "stop",                ctl_server,      CTL_LOCK_EXCL },
+	[CTL_RELOAD]          = { "reload",              ctl_server,      CTL_LOCK_EXCL },
+	[CTL_STATS]           = { "stats",               ctl_stats,       CTL_LOCK_SHARED },
+
+	[CTL_ZONE_STATUS]     = { "zone-status",         ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_RELOAD]     = { "zone-reload",         ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_REFRESH]    = { "zone-refresh",        ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_RETRANSFER] = { "zone-retransfer",     ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_NOTIFY]     = { "zone-notify",         ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_FLUSH]      = { "zone-flush",          ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_BACKUP]     = { "zone-backup",         ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_RESTORE]    = { "zone-restore",        ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_SIGN]       = { "zone-sign",           ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_KEYS_LOAD]  = { "zone-keys-load",      ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_KEY_ROLL]   = { "zone-key-rollover",   ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_KSK_SBM]    = { "zone-ksk-submitted",  ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_FREEZE]     = { "zone-freeze",         ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_THAW]       = { "zone-thaw",           ctl_zone,        CTL_LOCK_SHARED },
+
+	[CTL_ZONE_READ]       = { "zone-read",           ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_BEGIN]      = { "zone-begin",          ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_COMMIT]     = { "zone-commit",         ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_ABORT]      = { "zone-abort",          ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_DIFF]       = { "zone-diff",           ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_GET]        = { "zone-get",            ctl_zone,        CTL_LOCK_SHARED },
+	[CTL_ZONE_SET]        = { "zone-set",            ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_UNSET]      = { "zone-unset",          ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_PURGE]      = { "zone-purge",          ctl_zone,        CTL_LOCK_EXCL },
+	[CTL_ZONE_STATS]      = { "zone-stats",          ctl_zone,        CTL_LOCK_SHARED },
+
+	[CTL_CONF_LIST]       = { "conf-list",           ctl_conf_read,   CTL_LOCK_EXCL },
+	[CTL_CONF_READ]       = { "conf-read",           ctl_conf_read,   CTL_LOCK_EXCL },
+	[CTL_CONF_BEGIN]      = { "conf-begin",          ctl_conf_txn,    CTL_LOCK_EXCL },
+	[CTL_CONF_COMMIT]     = { "conf-commit",         ctl_conf_txn,    CTL_LOCK_EXCL },
+	[CTL_CONF_ABORT]      = { "conf-abort",          ctl_conf_txn,    CTL_LOCK_EXCL },
+	[CTL_CONF_DIFF]       = { "conf-diff",           ctl_conf_read,   CTL_LOCK_EXCL },
+	[CTL_CONF_GET]        = { "conf-get",            ctl_conf_read,   CTL_LOCK_EXCL },
+	[CTL_CONF_SET]        = { "conf-set",            ctl_conf_modify, CTL_LOCK_EXCL },
+	[CTL_CONF_UNSET]      = { "conf-unset",          ctl_conf_modify, CTL_LOCK_EXCL },
 };
 
 #define MAX_CTL_CODE (sizeof(cmd_table) / sizeof(desc_t) - 1)
@@ -2061,7 +2217,21 @@ int ctl_exec(ctl_cmd_t cmd, ctl_args_t *args)
 		return KNOT_EINVAL;
 	}
 
-	return cmd_table[cmd].fcn(args, cmd);
+	pthread_rwlock_t *lock = &args->server->ctl_lock;
+	if (cmd_table[cmd].lock == CTL_LOCK_SHARED) {
+		pthread_rwlock_rdlock(lock);
+	} else {
+		pthread_rwlock_wrlock(lock);
+	}
+
+	int ret = cmd_table[cmd].fcn(args, cmd);
+
+	pthread_rwlock_unlock(lock);
+
+	free(args->buffers);
+	args->buffers = NULL;
+
+	return ret;
 }
 
 bool ctl_has_flag(const char *flags, const char *flag)
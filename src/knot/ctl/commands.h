@@ -23,6 +23,7 @@
 #define CTL_FLAG_BLOCKING	"B"
 #define CTL_FLAG_ADD		"+"
 #define CTL_FLAG_REM		"-"
+#define CTL_FLAG_WIRE		"W"
 
 #define CTL_FILTER_FLUSH_OUTDIR		'd'
 
@@ -97,12 +98,15 @@ typedef enum {
 	CTL_CONF_UNSET,
 } ctl_cmd_t;
 
+struct ctl_buffers;
+
 /*! Control command parameters. */
 typedef struct {
 	knot_ctl_t *ctl;
 	knot_ctl_type_t type;
 	knot_ctl_data_t data;
 	server_t *server;
+	struct ctl_buffers *buffers; // Command buffers, allocated on demand.
 	bool suppress;	// Suppress error reporting in the "all zones" ctl commands.
 } ctl_args_t;
 
@@ -127,6 +131,10 @@ ctl_cmd_t ctl_str_to_cmd(const char *cmd_str);
 /*!
  * Executes a control command.
  *
+ * Commands which only read the server state or schedule zone events hold
+ * the server control lock shared, so they can run in parallel from more
+ * control sessions. Other commands hold it exclusively.
+ *
  * \param[in] cmd   Control command.
  * \param[in] args  Command arguments.
  *
@@ -88,6 +88,30 @@ bool ufreeze_applies(zone_event_type_t type)
 	}
 }
 
+/*!
+ * \brief Get worker priority class of the event.
+ */
+static worker_prio_t event_prio(zone_events_t *events, zone_event_type_t type)
+{
+	if (events->forced[type] || events->blocking[type] != NULL) {
+		return WORKER_PRIO_CONTROL;
+	}
+
+	switch (type) {
+	case ZONE_EVENT_UPDATE:
+	case ZONE_EVENT_UFREEZE:
+	case ZONE_EVENT_UTHAW:
+		return WORKER_PRIO_UPDATE;
+	case ZONE_EVENT_FLUSH:
+	case ZONE_EVENT_BACKUP:
+	case ZONE_EVENT_DNSSEC:
+	case ZONE_EVENT_NSEC3RESALT:
+		return WORKER_PRIO_MAINTENANCE;
+	default:
+		return WORKER_PRIO_REFRESH;
+	}
+}
+
 /*! \brief Return remaining time to planned event (seconds). */
 static time_t time_until(time_t planned)
 {
@@ -228,6 +252,9 @@ static void event_wrap(worker_task_t *task)
 	int ret = conf_clone(&conf);
 	rcu_read_unlock();
 	if (ret == KNOT_EOK) {
+		/* Pick up the result of asynchronous NOTIFY. */
+		zone_notified_apply(zone);
+
 		/* Execute the event callback. */
 		ret = info->callback(conf, zone);
 		conf_free(conf);
@@ -268,6 +295,10 @@ static void event_dispatch(event_t *event)
 
 	pthread_mutex_lock(&events->mx);
 	if (!events->running && !events->frozen) {
+		zone_event_type_t type = get_next_event(events);
+		if (valid_event(type)) {
+			events->task.prio = event_prio(events, type);
+		}
 		events->running = true;
 		worker_pool_assign(events->pool, &events->task);
 	}
@@ -425,6 +456,7 @@ void zone_events_enqueue(zone_t *zone, zone_event_type_t type)
 		events->running = true;
 		events->type = type;
 		event_set_time(events, type, ZONE_EVENT_IMMEDIATE);
+		events->task.prio = event_prio(events, type);
 		worker_pool_assign(events->pool, &events->task);
 		pthread_mutex_unlock(&events->mx);
 		return;
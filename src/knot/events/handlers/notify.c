@@ -15,12 +15,16 @@
  */
 
 #include <assert.h>
+#include <stdlib.h>
 
 #include "knot/common/log.h"
 #include "knot/conf/conf.h"
+#include "knot/query/notify-send.h"
 #include "knot/query/query.h"
 #include "knot/query/requestor.h"
+#include "knot/server/server.h"
 #include "knot/zone/zone.h"
+#include "libknot/codes.h"
 #include "libknot/errcode.h"
 
 /*!
@@ -127,6 +131,60 @@ static int send_notify(conf_t *conf, zone_t *zone, const knot_rrset_t *soa,
 	return ret;
 }
 
+static void notify_done(void *ctx, int ret, const struct sockaddr_storage *remote,
+                        uint32_t serial, uint16_t rcode)
+{
+	zone_t *zone = ctx;
+
+	if (ret == KNOT_EOK) {
+		NOTIFY_OUT_LOG(LOG_INFO, zone->name, remote, "serial %u", serial);
+		zone_notified_post(zone, serial);
+	} else if (ret == KNOT_EDENIED) {
+		const knot_lookup_t *item = knot_lookup_by_id(knot_rcode_names, rcode);
+		NOTIFY_OUT_LOG(LOG_WARNING, zone->name, remote,
+		               "server responded with error '%s'",
+		               (item != NULL) ? item->name : "");
+	} else {
+		NOTIFY_OUT_LOG(LOG_WARNING, zone->name, remote,
+		               "failed (%s)", knot_strerror(ret));
+	}
+}
+
+/*! \brief Try to hand the NOTIFY to one remote over to the asynchronous engine. */
+static bool notify_submit(conf_t *conf, zone_t *zone, const knot_rrset_t *soa,
+                          conf_val_t *remote)
+{
+	if (zone->server == NULL) {
+		return false;
+	}
+
+	conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, remote);
+	size_t count = conf_val_count(&addr);
+	udp_target_t *targets = NULL;
+	if (count == 0 || (targets = calloc(count, sizeof(*targets))) == NULL) {
+		return false;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		udp_target_t *target = &targets[i];
+		target->remote = conf_remote(conf, remote, i);
+		query_edns_data_init(&target->edns, conf, zone->name,
+		                     target->remote.addr.ss_family);
+		int family = target->remote.addr.ss_family;
+		if ((family != AF_INET && family != AF_INET6) ||
+		    target->remote.via.ss_family != AF_UNSPEC) {
+			free(targets);
+			return false;
+		}
+	}
+
+	int ret = notify_send_submit(&zone->server->notify_send, zone->name, soa,
+	                             targets, count, notify_done, zone);
+	free(targets);
+
+	return ret == KNOT_EOK;
+}
+
 int event_notify(conf_t *conf, zone_t *zone)
 {
 	assert(zone);
@@ -144,6 +202,12 @@ int event_notify(conf_t *conf, zone_t *zone)
 	// send NOTIFY to each remote, use working address
 	conf_val_t notify = conf_zone_get(conf, C_NOTIFY, zone->name);
 	while (notify.code == KNOT_EOK) {
+		// the result is logged by the asynchronous engine
+		if (notify_submit(conf, zone, &soa, &notify)) {
+			conf_val_next(&notify);
+			continue;
+		}
+
 		conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, &notify);
 		size_t addr_count = conf_val_count(&addr);
 
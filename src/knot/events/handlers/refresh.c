@@ -17,7 +17,9 @@
 #include <assert.h>
 #include <stdint.h>
 
+#include "contrib/macros.h"
 #include "contrib/mempattern.h"
+#include "contrib/sockaddr.h"
 #include "libdnssec/random.h"
 #include "knot/common/log.h"
 #include "knot/conf/conf.h"
@@ -28,6 +30,8 @@
 #include "knot/query/layer.h"
 #include "knot/query/query.h"
 #include "knot/query/requestor.h"
+#include "knot/query/soa-check.h"
+#include "knot/server/server.h"
 #include "knot/updates/changesets.h"
 #include "knot/zone/adjust.h"
 #include "knot/zone/digest.h"
@@ -105,6 +109,7 @@ struct refresh_data {
 	struct query_edns_data edns;      //!< EDNS data to be used in queries.
 	zone_master_fallback_t *fallback; //!< Flags allowing zone_master_try() fallbacks.
 	bool fallback_axfr;               //!< Flag allowing fallback to AXFR,
+	bool skip_soa_query;              //!< Remote serial already known to be newer.
 
 	// internal state, initialize with zeroes:
 
@@ -210,8 +215,8 @@ static void axfr_slave_sign_serial(zone_contents_t *new_contents, zone_t *zone,
 {
 	// Update slave's serial to ensure it's growing and consistent with
 	// its serial policy.
-	conf_val_t val = conf_zone_get(conf, C_SERIAL_POLICY, zone->name);
-	unsigned serial_policy = conf_opt(&val);
+	zone_settings_t local;
+	unsigned serial_policy = zone_get_settings(conf, zone, &local)->serial_policy;
 
 	*master_serial = zone_contents_serial(new_contents);
 
@@ -233,8 +238,9 @@ static int axfr_finalize(struct refresh_data *data)
 {
 	zone_contents_t *new_zone = data->axfr.zone;
 
-	conf_val_t val = conf_zone_get(data->conf, C_DNSSEC_SIGNING, data->zone->name);
-	bool dnssec_enable = conf_bool(&val);
+	zone_settings_t local;
+	const zone_settings_t *settings = zone_get_settings(data->conf, data->zone, &local);
+	bool dnssec_enable = settings->dnssec_signing;
 	uint32_t old_serial = zone_contents_serial(data->zone->contents), master_serial = 0;
 	bool bootstrap = (data->zone->contents == NULL);
 
@@ -260,8 +266,7 @@ static int axfr_finalize(struct refresh_data *data)
 		return ret;
 	}
 
-	val = conf_zone_get(data->conf, C_ZONEMD_GENERATE, data->zone->name);
-	unsigned digest_alg = conf_opt(&val);
+	unsigned digest_alg = settings->zonemd_generate;
 
 	if (dnssec_enable) {
 		zone_sign_reschedule_t resch = { 0 };
@@ -465,8 +470,8 @@ static int ixfr_slave_sign_serial(list_t *changesets, zone_t *zone,
 		return KNOT_ERROR;
 	}
 
-	conf_val_t val = conf_zone_get(conf, C_SERIAL_POLICY, zone->name);
-	unsigned serial_policy = conf_opt(&val);
+	zone_settings_t local;
+	unsigned serial_policy = zone_get_settings(conf, zone, &local)->serial_policy;
 
 	int ret = zone_get_master_serial(zone, master_serial);
 	if (ret != KNOT_EOK) {
@@ -486,8 +491,9 @@ static int ixfr_slave_sign_serial(list_t *changesets, zone_t *zone,
 
 static int ixfr_finalize(struct refresh_data *data)
 {
-	conf_val_t val = conf_zone_get(data->conf, C_DNSSEC_SIGNING, data->zone->name);
-	bool dnssec_enable = conf_bool(&val);
+	zone_settings_t local;
+	const zone_settings_t *settings = zone_get_settings(data->conf, data->zone, &local);
+	bool dnssec_enable = settings->dnssec_signing;
 	uint32_t master_serial = 0, old_serial = zone_contents_serial(data->zone->contents);
 
 	if (dnssec_enable) {
@@ -534,8 +540,7 @@ static int ixfr_finalize(struct refresh_data *data)
 		return ret;
 	}
 
-	val = conf_zone_get(data->conf, C_ZONEMD_GENERATE, data->zone->name);
-	unsigned digest_alg = conf_opt(&val);
+	unsigned digest_alg = settings->zonemd_generate;
 
 	if (dnssec_enable) {
 		zone_sign_reschedule_t resch = { 0 };
@@ -1064,7 +1069,11 @@ static int refresh_begin(knot_layer_t *layer, void *_data)
 	layer->data = _data;
 	struct refresh_data *data = _data;
 
-	if (data->soa) {
+	if (data->soa && data->skip_soa_query) {
+		data->state = STATE_TRANSFER;
+		data->xfr_type = XFR_TYPE_IXFR;
+		data->initial_soa_copy = NULL;
+	} else if (data->soa) {
 		data->state = STATE_SOA_QUERY;
 		data->xfr_type = XFR_TYPE_IXFR;
 		data->initial_soa_copy = NULL;
@@ -1129,15 +1138,16 @@ static const knot_layer_api_t REFRESH_API = {
 	.finish = refresh_finish,
 };
 
-static size_t max_zone_size(conf_t *conf, const knot_dname_t *zone)
+static size_t max_zone_size(conf_t *conf, const zone_t *zone)
 {
-	conf_val_t val = conf_zone_get(conf, C_ZONE_MAX_SIZE, zone);
-	return conf_int(&val);
+	zone_settings_t local;
+	return zone_get_settings(conf, zone, &local)->max_zone_size;
 }
 
 typedef struct {
 	bool force_axfr;
 	bool send_notify;
+	bool skip_soa_query;
 } try_refresh_ctx_t;
 
 static int try_refresh(conf_t *conf, zone_t *zone, const conf_remote_t *master,
@@ -1162,12 +1172,16 @@ static int try_refresh(conf_t *conf, zone_t *zone, const conf_remote_t *master,
 		.conf = conf,
 		.remote = (struct sockaddr *)&master->addr,
 		.soa = zone->contents && !trctx->force_axfr ? &soa : NULL,
-		.max_zone_size = max_zone_size(conf, zone->name),
+		.max_zone_size = max_zone_size(conf, zone),
 		.use_edns = !master->no_edns,
 		.fallback = fallback,
 		.fallback_axfr = false, // will be set upon IXFR consume
+		.skip_soa_query = trctx->skip_soa_query,
 	};
 
+	// Only the preferred master is known to have a newer serial.
+	trctx->skip_soa_query = false;
+
 	query_edns_data_init(&data.edns, conf, zone->name, master->addr.ss_family);
 
 	knot_requestor_t requestor;
@@ -1217,16 +1231,167 @@ static int try_refresh(conf_t *conf, zone_t *zone, const conf_remote_t *master,
 	return ret;
 }
 
-static int64_t min_refresh_interval(conf_t *conf, const knot_dname_t *zone)
+static int64_t min_refresh_interval(conf_t *conf, const zone_t *zone)
+{
+	zone_settings_t local;
+	return zone_get_settings(conf, zone, &local)->refresh_min_interval;
+}
+
+static int64_t max_refresh_interval(conf_t *conf, const zone_t *zone)
+{
+	zone_settings_t local;
+	return zone_get_settings(conf, zone, &local)->refresh_max_interval;
+}
+
+static void soa_check_done(void *ctx, int ret, const struct sockaddr_storage *remote,
+                           uint32_t serial)
 {
-	conf_val_t val = conf_zone_get(conf, C_REFRESH_MIN_INTERVAL, zone);
-	return conf_int(&val);
+	zone_t *zone = ctx;
+
+	pthread_mutex_lock(&zone->preferred_lock);
+	zone->soa_check.state = ZONE_SOA_CHECK_DONE;
+	zone->soa_check.ret = ret;
+	zone->soa_check.serial = serial;
+	zone->soa_check.remote = *remote;
+	pthread_mutex_unlock(&zone->preferred_lock);
+
+	zone_events_schedule_now(zone, ZONE_EVENT_REFRESH);
 }
 
-static int64_t max_refresh_interval(conf_t *conf, const knot_dname_t *zone)
+/*!
+ * \brief List the masters in the order of zone_master_try().
+ *
+ * \return Number of targets, 0 if some master requires a blocking query.
+ */
+static size_t soa_check_targets(conf_t *conf, zone_t *zone,
+                                udp_target_t **targets)
 {
-	conf_val_t val = conf_zone_get(conf, C_REFRESH_MAX_INTERVAL, zone);
-	return conf_int(&val);
+	size_t count = 0;
+	conf_val_t masters = conf_zone_get(conf, C_MASTER, zone->name);
+	while (masters.code == KNOT_EOK) {
+		conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, &masters);
+		count += conf_val_count(&addr);
+		conf_val_next(&masters);
+	}
+	if (count == 0 || (*targets = calloc(count, sizeof(**targets))) == NULL) {
+		return 0;
+	}
+
+	size_t idx = 0;
+	masters = conf_zone_get(conf, C_MASTER, zone->name);
+	while (masters.code == KNOT_EOK) {
+		conf_val_t addr = conf_id_get(conf, C_RMT, C_ADDR, &masters);
+		size_t addr_count = conf_val_count(&addr);
+		for (size_t i = 0; i < addr_count; i++, idx++) {
+			udp_target_t *target = &(*targets)[idx];
+			target->remote = conf_remote(conf, &masters, i);
+			query_edns_data_init(&target->edns, conf, zone->name,
+			                     target->remote.addr.ss_family);
+			int family = target->remote.addr.ss_family;
+			if ((family != AF_INET && family != AF_INET6) ||
+			    target->remote.via.ss_family != AF_UNSPEC) {
+				free(*targets);
+				*targets = NULL;
+				return 0;
+			}
+		}
+		conf_val_next(&masters);
+	}
+
+	// Move the preferred master to the front.
+	pthread_mutex_lock(&zone->preferred_lock);
+	for (size_t i = 0; zone->preferred_master != NULL && i < count; i++) {
+		if (sockaddr_net_match(&(*targets)[i].remote.addr, zone->preferred_master, -1)) {
+			udp_target_t preferred = (*targets)[i];
+			memmove(&(*targets)[1], &(*targets)[0], i * sizeof(**targets));
+			(*targets)[0] = preferred;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&zone->preferred_lock);
+
+	return count;
+}
+
+/*! \brief Try to hand the SOA query over to the asynchronous engine. */
+static bool soa_check_submit_zone(conf_t *conf, zone_t *zone)
+{
+	const knot_rdataset_t *soa = zone_soa(zone);
+	if (zone->server == NULL || soa == NULL ||
+	    zone_get_flag(zone, ZONE_FORCE_AXFR, false)) {
+		return false;
+	}
+
+	udp_target_t *targets = NULL;
+	size_t count = soa_check_targets(conf, zone, &targets);
+	if (count == 0) {
+		return false;
+	}
+
+	pthread_mutex_lock(&zone->preferred_lock);
+	zone->soa_check.state = ZONE_SOA_CHECK_PENDING;
+	pthread_mutex_unlock(&zone->preferred_lock);
+
+	int ret = soa_check_submit(&zone->server->soa_check, zone->name, targets,
+	                           count, soa_check_done, zone);
+	free(targets);
+	if (ret != KNOT_EOK) {
+		pthread_mutex_lock(&zone->preferred_lock);
+		zone->soa_check.state = ZONE_SOA_CHECK_NONE;
+		pthread_mutex_unlock(&zone->preferred_lock);
+		return false;
+	}
+
+	// Safety net in case the result never arrives.
+	time_t retry = MAX(knot_soa_retry(soa->rdata), min_refresh_interval(conf, zone));
+	zone->timers.next_refresh = time(NULL) + retry;
+	replan_from_timers(conf, zone);
+
+	return true;
+}
+
+/*!
+ * \brief Evaluate the result of the asynchronous SOA query.
+ *
+ * \return KNOT_EOK if up-to-date, KNOT_EAGAIN if a blocking refresh is needed,
+ *         or an error.
+ */
+static int soa_check_result(conf_t *conf, zone_t *zone, int ret, uint32_t remote_serial,
+                            const struct sockaddr_storage *remote,
+                            try_refresh_ctx_t *trctx)
+{
+	const struct sockaddr *addr = (const struct sockaddr *)remote;
+
+	if (ret == KNOT_ENOTSUP) {
+		return KNOT_EAGAIN; // Truncated answer, retry over TCP.
+	} else if (ret != KNOT_EOK) {
+		REFRESH_LOG(LOG_WARNING, zone->name, addr, "failed (%s)", knot_strerror(ret));
+		return KNOT_ENOMASTER;
+	}
+
+	uint32_t local_serial;
+	ret = slave_zone_serial(zone, conf, &local_serial);
+	if (ret != KNOT_EOK) {
+		xfr_log_read_ms(zone->name, ret);
+		return ret;
+	}
+	bool current = serial_is_current(local_serial, remote_serial);
+	bool master_uptodate = serial_is_current(remote_serial, local_serial);
+
+	REFRESH_LOG(LOG_INFO, zone->name, addr,
+	            "remote serial %u, %s", remote_serial,
+	            current ? (master_uptodate ? "zone is up-to-date" :
+	            "master is outdated") : "zone is outdated");
+
+	if (current) {
+		// Outdated master, let the other masters be queried.
+		return master_uptodate ? KNOT_EOK : KNOT_EAGAIN;
+	}
+
+	zone_set_preferred_master(zone, remote);
+	trctx->skip_soa_query = true;
+
+	return KNOT_EAGAIN;
 }
 
 int event_refresh(conf_t *conf, zone_t *zone)
@@ -1237,6 +1402,27 @@ int event_refresh(conf_t *conf, zone_t *zone)
 		return KNOT_ENOTSUP;
 	}
 
+	pthread_mutex_lock(&zone->preferred_lock);
+	zone_soa_check_state_t check = zone->soa_check.state;
+	int check_ret = zone->soa_check.ret;
+	uint32_t check_serial = zone->soa_check.serial;
+	struct sockaddr_storage check_remote = zone->soa_check.remote;
+	bool check_again = false;
+	if (check == ZONE_SOA_CHECK_PENDING) {
+		// The result may predate the change this refresh is for.
+		zone->soa_check.again = true;
+	} else if (check == ZONE_SOA_CHECK_DONE) {
+		zone->soa_check.state = ZONE_SOA_CHECK_NONE;
+		check_again = zone->soa_check.again;
+		zone->soa_check.again = false;
+	}
+	pthread_mutex_unlock(&zone->preferred_lock);
+
+	if (check == ZONE_SOA_CHECK_PENDING ||
+	    (check == ZONE_SOA_CHECK_NONE && soa_check_submit_zone(conf, zone))) {
+		return KNOT_EOK;
+	}
+
 	try_refresh_ctx_t trctx = { 0 };
 
 	// TODO: Flag on zone is ugly. Event specific parameters would be nice.
@@ -1245,7 +1431,15 @@ int event_refresh(conf_t *conf, zone_t *zone)
 		zone->zonefile.retransfer = true;
 	}
 
-	int ret = zone_master_try(conf, zone, try_refresh, &trctx, "refresh");
+	int ret = KNOT_EAGAIN;
+	if (check == ZONE_SOA_CHECK_DONE && !trctx.force_axfr) {
+		ret = soa_check_result(conf, zone, check_ret, check_serial,
+		                       &check_remote, &trctx);
+	}
+	if (ret == KNOT_EAGAIN) {
+		ret = zone_master_try(conf, zone, try_refresh, &trctx, "refresh");
+		check_again = false;
+	}
 	zone_clear_preferred_master(zone);
 	if (ret != KNOT_EOK) {
 		log_zone_error(zone->name, "refresh, failed (%s)", knot_strerror(ret));
@@ -1271,17 +1465,21 @@ int event_refresh(conf_t *conf, zone_t *zone)
 	}
 
 	/* Check for allowed refresh interval limits. */
-	int64_t min_refresh = min_refresh_interval(conf, zone->name);
+	int64_t min_refresh = min_refresh_interval(conf, zone);
 	if(zone->timers.next_refresh < now + min_refresh) {
 		zone->timers.next_refresh = now + min_refresh;
 	}
-	int64_t max_refresh = max_refresh_interval(conf, zone->name);
+	int64_t max_refresh = max_refresh_interval(conf, zone);
 	if(zone->timers.next_refresh > now + max_refresh) {
 		zone->timers.next_refresh = now + max_refresh;
 	}
 
 	/* Reschedule events. */
 	replan_from_timers(conf, zone);
+	if (check_again) {
+		// Only the outcome of an earlier SOA query was used.
+		zone_events_schedule_now(zone, ZONE_EVENT_REFRESH);
+	}
 	if (trctx.send_notify) {
 		zone_events_schedule_at(zone, ZONE_EVENT_NOTIFY, time(NULL) + 1);
 	}
@@ -156,10 +156,10 @@ static int process_normal(conf_t *conf, zone_t *zone, list_t *requests)
 	}
 
 	// Sign update.
-	conf_val_t val = conf_zone_get(conf, C_DNSSEC_SIGNING, zone->name);
-	bool dnssec_enable = conf_bool(&val);
-	val = conf_zone_get(conf, C_ZONEMD_GENERATE, zone->name);
-	unsigned digest_alg = conf_opt(&val);
+	zone_settings_t local;
+	const zone_settings_t *settings = zone_get_settings(conf, zone, &local);
+	bool dnssec_enable = settings->dnssec_signing;
+	unsigned digest_alg = settings->zonemd_generate;
 	if (dnssec_enable) {
 		zone_sign_reschedule_t resch = { 0 };
 		ret = knot_dnssec_sign_update(&up, conf, &resch);
@@ -17,6 +17,7 @@
 #include <assert.h>
 
 #include "knot/events/replan.h"
+#include "knot/server/server.h"
 
 #define TIME_CANCEL 0
 #define TIME_IGNORE (-1)
@@ -48,9 +49,10 @@ static void replan_ddns(zone_t *zone, zone_t *old_zone)
 }
 
 /*!
- * \brief Replan NOTIFY event if it was queued for the old zone.
+ * \brief Replan NOTIFY event if it was queued for the old zone or if the old
+ *        zone still has NOTIFY messages waiting for acknowledgement.
  */
-static void replan_notify(zone_t *zone, const zone_t *old_zone)
+static void replan_notify(zone_t *zone, zone_t *old_zone)
 {
 	assert(zone);
 	assert(old_zone);
@@ -59,6 +61,12 @@ static void replan_notify(zone_t *zone, const zone_t *old_zone)
 	if (notify > 0) {
 		zone_events_schedule_at(zone, ZONE_EVENT_NOTIFY, notify);
 	}
+
+	// the old zone's NOTIFY messages would be dropped with it
+	if (old_zone->server != NULL &&
+	    udp_engine_cancel(&old_zone->server->notify_send, old_zone) > 0) {
+		zone_events_schedule_now(zone, ZONE_EVENT_NOTIFY);
+	}
 }
 
 /*!
@@ -71,8 +79,8 @@ static void replan_dnssec(conf_t *conf, zone_t *zone)
 	assert(conf);
 	assert(zone);
 
-	conf_val_t val = conf_zone_get(conf, C_DNSSEC_SIGNING, zone->name);
-	if (conf_bool(&val)) {
+	zone_settings_t local;
+	if (zone_get_settings(conf, zone, &local)->dnssec_signing) {
 		zone_events_schedule_now(zone, ZONE_EVENT_DNSSEC);
 	}
 }
@@ -92,8 +100,11 @@ void replan_from_timers(conf_t *conf, zone_t *zone)
 
 	time_t now = time(NULL);
 
+	zone_settings_t local;
+	const zone_settings_t *settings = zone_get_settings(conf, zone, &local);
+
 	time_t refresh = TIME_CANCEL;
-	if (zone_is_slave(conf, zone)) {
+	if (settings->is_slave) {
 		refresh = zone->timers.next_refresh;
 		if (zone->contents == NULL && zone->timers.last_refresh_ok) { // zone disappeared w/o expiry
 			refresh = now;
@@ -103,15 +114,14 @@ void replan_from_timers(conf_t *conf, zone_t *zone)
 
 	time_t expire_pre = TIME_IGNORE;
 	time_t expire = TIME_IGNORE;
-	if (zone_is_slave(conf, zone) && can_expire(zone)) {
+	if (settings->is_slave && can_expire(zone)) {
 		expire_pre = TIME_CANCEL;
 		expire = zone->timers.last_refresh + zone->timers.soa_expire;
 	}
 
 	time_t flush = TIME_IGNORE;
-	if (!zone_is_slave(conf, zone) || can_expire(zone)) {
-		conf_val_t val = conf_zone_get(conf, C_ZONEFILE_SYNC, zone->name);
-		int64_t sync_timeout = conf_int(&val);
+	if (!settings->is_slave || can_expire(zone)) {
+		int64_t sync_timeout = settings->zonefile_sync;
 		if (sync_timeout > 0) {
 			flush = zone->timers.last_flush + sync_timeout;
 		}
@@ -120,11 +130,10 @@ void replan_from_timers(conf_t *conf, zone_t *zone)
 	time_t resalt = TIME_CANCEL;
 	time_t ds_check = TIME_CANCEL;
 	time_t ds_push = TIME_CANCEL;
-	conf_val_t val = conf_zone_get(conf, C_DNSSEC_SIGNING, zone->name);
-	if (conf_bool(&val)) {
+	if (settings->dnssec_signing) {
 		conf_val_t policy = conf_zone_get(conf, C_DNSSEC_POLICY, zone->name);
 		conf_id_fix_default(&policy);
-		val = conf_id_get(conf, C_POLICY, C_NSEC3, &policy);
+		conf_val_t val = conf_id_get(conf, C_POLICY, C_NSEC3, &policy);
 		if (conf_bool(&val)) {
 			if (zone->timers.last_resalt == 0) {
 				resalt = now;
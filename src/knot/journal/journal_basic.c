@@ -16,6 +16,7 @@
 
 #include "knot/journal/journal_basic.h"
 #include "knot/journal/journal_metadata.h"
+#include "knot/zone/settings.h"
 #include "libknot/error.h"
 
 MDB_val journal_changeset_id_to_key(bool zone_in_journal, uint32_t serial, const knot_dname_t *zone)
@@ -49,11 +50,20 @@ void journal_del_zone(knot_lmdb_txn_t *txn, const knot_dname_t *zone)
 	free(prefix.mv_data);
 }
 
-void journal_make_header(void *chunk, uint32_t ch_serial_to)
+void journal_make_header(void *chunk, uint32_t ch_serial_to, uint32_t flags, uint32_t raw_size)
 {
-	knot_lmdb_make_key_part(chunk, JOURNAL_HEADER_SIZE, "IILLL", ch_serial_to,
+	knot_lmdb_make_key_part(chunk, JOURNAL_HEADER_SIZE, "IILIIL", ch_serial_to,
 	                        (uint32_t)0 /* we no longer care for # of chunks */,
-	                        (uint64_t)0, (uint64_t)0, (uint64_t)0);
+	                        (uint64_t)0, flags, raw_size, (uint64_t)0);
+}
+
+uint32_t journal_chunk_flags(const MDB_val *chunk, uint32_t *raw_size)
+{
+	if (chunk->mv_size < JOURNAL_HEADER_SIZE) {
+		return 0;
+	}
+	*raw_size = knot_wire_read_u32(chunk->mv_data + 20);
+	return knot_wire_read_u32(chunk->mv_data + 16);
 }
 
 uint32_t journal_next_serial(const MDB_val *chunk)
@@ -75,18 +85,37 @@ bool journal_serial_to(knot_lmdb_txn_t *txn, bool zij, uint32_t serial,
 
 bool journal_allow_flush(zone_journal_t j)
 {
+	if (j.settings != NULL) {
+		return j.settings->zonefile_sync >= 0;
+	}
 	conf_val_t val = conf_zone_get(j.conf, C_ZONEFILE_SYNC, j.zone);
 	return conf_int(&val) >= 0;
 }
 
 size_t journal_conf_max_usage(zone_journal_t j)
 {
+	if (j.settings != NULL) {
+		return j.settings->journal_max_usage;
+	}
 	conf_val_t val = conf_zone_get(j.conf, C_JOURNAL_MAX_USAGE, j.zone);
 	return conf_int(&val);
 }
 
 size_t journal_conf_max_changesets(zone_journal_t j)
 {
+	if (j.settings != NULL) {
+		return j.settings->journal_max_depth;
+	}
 	conf_val_t val = conf_zone_get(j.conf, C_JOURNAL_MAX_DEPTH, j.zone);
 	return conf_int(&val);
 }
+
+bool journal_conf_compress(zone_journal_t j)
+{
+#ifdef HAVE_LZ4
+	conf_val_t val = conf_db_param(j.conf, C_JOURNAL_DB_COMPRESS);
+	return conf_opt(&val) == JOURNAL_COMPRESS_LZ4;
+#else
+	return false;
+#endif
+}
@@ -25,12 +25,17 @@ typedef struct {
 	knot_lmdb_db_t *db;
 	const knot_dname_t *zone;
 	void *conf; // needed only for journal write operations
+	const struct zone_settings *settings; // resolved zone settings (optional)
 } zone_journal_t;
 
 #define JOURNAL_CHUNK_MAX (70 * 1024) // must be at least 64k + 6B
 #define JOURNAL_CHUNK_THRESH (15 * 1024)
 #define JOURNAL_HEADER_SIZE (32)
 
+enum journal_chunk_flags {
+	JOURNAL_CHUNK_LZ4 = (1 << 0), // chunk payload is LZ4-compressed
+};
+
 /*! \brief Convert journal_mode to LMDB environment flags. */
 inline static unsigned journal_env_flags(int journal_mode, bool readonly)
 {
@@ -72,10 +77,22 @@ void journal_del_zone(knot_lmdb_txn_t *txn, const knot_dname_t *zone);
 /*!
  * \brief Initialise chunk header.
  *
- * \param chunk   Pointer to the changeset chunk. It must be at least JOURNAL_HEADER_SIZE, perhaps more.
- * \param ch      Serial-to of the changeset being serialized.
+ * \param chunk      Pointer to the changeset chunk. It must be at least JOURNAL_HEADER_SIZE, perhaps more.
+ * \param ch         Serial-to of the changeset being serialized.
+ * \param flags      Chunk flags, see enum journal_chunk_flags.
+ * \param raw_size   Size of the uncompressed payload if compressed, otherwise zero.
  */
-void journal_make_header(void *chunk, uint32_t ch_serial_to);
+void journal_make_header(void *chunk, uint32_t ch_serial_to, uint32_t flags, uint32_t raw_size);
+
+/*!
+ * \brief Obtain chunk flags and size of the uncompressed payload.
+ *
+ * \param chunk      Any chunk of a serialized changeset.
+ * \param raw_size   Output: size of the uncompressed payload (if compressed).
+ *
+ * \return Chunk flags, see enum journal_chunk_flags.
+ */
+uint32_t journal_chunk_flags(const MDB_val *chunk, uint32_t *raw_size);
 
 /*!
  * \brief Obtain serial-to of the serialized changeset.
@@ -114,3 +131,6 @@ size_t journal_conf_max_usage(zone_journal_t j);
 
 /*! \brief Return configured maximal depth of journal. */
 size_t journal_conf_max_changesets(zone_journal_t j);
+
+/*! \brief Return true if stored chunks shall be compressed according to conf. */
+bool journal_conf_compress(zone_journal_t j);
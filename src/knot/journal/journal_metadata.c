@@ -198,6 +198,12 @@ void journal_load_metadata(knot_lmdb_txn_t *txn, const knot_dname_t *zone, journ
 		}
 	}
 	md->_new_zone = !get_metadata32(txn, zone, "flags", &md->flags);
+#ifndef HAVE_LZ4
+	if ((md->flags & JOURNAL_COMPRESSED)) {
+		txn->ret = KNOT_ENOTSUP;
+		return;
+	}
+#endif
 	(void)get_metadata32(txn, zone, "first_serial",    &md->first_serial);
 	(void)get_metadata32(txn, zone, "last_serial_to",  &md->serial_to);
 	(void)get_metadata32(txn, zone, "merged_serial",   &md->merged_serial);
@@ -32,6 +32,7 @@ enum journal_metadata_flags {
 	JOURNAL_LAST_FLUSHED_VALID   = (1 << 0), // deprecated
 	JOURNAL_SERIAL_TO_VALID      = (1 << 1),
 	JOURNAL_MERGED_SERIAL_VALID  = (1 << 2),
+	JOURNAL_COMPRESSED           = (1 << 3), // some chunks may be compressed
 };
 
 typedef int (*journals_walk_cb_t)(const knot_dname_t *zone, void *ctx);
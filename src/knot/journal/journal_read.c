@@ -14,6 +14,10 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
 #include "knot/journal/journal_read.h"
 
 #include "knot/journal/journal_metadata.h"
@@ -32,6 +36,7 @@ struct journal_read {
 	const knot_dname_t *zone;
 	wire_ctx_t wire;
 	uint32_t next;
+	uint8_t *buf; // decompressed chunk payload
 };
 
 int journal_read_get_error(const journal_read_t *ctx, int another_error)
@@ -39,10 +44,39 @@ int journal_read_get_error(const journal_read_t *ctx, int another_error)
 	return (ctx == NULL || ctx->txn.ret == KNOT_EOK ? another_error : ctx->txn.ret);
 }
 
-static void update_ctx_wire(journal_read_t *ctx)
+static bool update_ctx_wire(journal_read_t *ctx)
 {
-	ctx->wire = wire_ctx_init_const(ctx->txn.cur_val.mv_data, ctx->txn.cur_val.mv_size);
-	wire_ctx_skip(&ctx->wire, JOURNAL_HEADER_SIZE);
+	uint32_t raw_size = 0;
+	uint32_t flags = journal_chunk_flags(&ctx->txn.cur_val, &raw_size);
+	if (!(flags & JOURNAL_CHUNK_LZ4)) {
+		ctx->wire = wire_ctx_init_const(ctx->txn.cur_val.mv_data, ctx->txn.cur_val.mv_size);
+		wire_ctx_skip(&ctx->wire, JOURNAL_HEADER_SIZE);
+		return true;
+	}
+#ifdef HAVE_LZ4
+	if (ctx->buf == NULL) {
+		ctx->buf = malloc(JOURNAL_CHUNK_MAX);
+		if (ctx->buf == NULL) {
+			ctx->txn.ret = KNOT_ENOMEM;
+			return false;
+		}
+	}
+	int size = -1;
+	if (raw_size <= JOURNAL_CHUNK_MAX) {
+		size = LZ4_decompress_safe((const char *)ctx->txn.cur_val.mv_data + JOURNAL_HEADER_SIZE,
+		                           (char *)ctx->buf, ctx->txn.cur_val.mv_size - JOURNAL_HEADER_SIZE,
+		                           raw_size);
+	}
+	if (size != (int)raw_size) {
+		ctx->txn.ret = KNOT_EMALF;
+		return false;
+	}
+	ctx->wire = wire_ctx_init_const(ctx->buf, raw_size);
+	return true;
+#else
+	ctx->txn.ret = KNOT_ENOTSUP;
+	return false;
+#endif
 }
 
 static bool go_next_changeset(journal_read_t *ctx, bool go_zone, const knot_dname_t *zone)
@@ -57,8 +91,7 @@ static bool go_next_changeset(journal_read_t *ctx, bool go_zone, const knot_dnam
 		return false;
 	}
 	ctx->next = journal_next_serial(&ctx->txn.cur_val);
-	update_ctx_wire(ctx);
-	return true;
+	return update_ctx_wire(ctx);
 }
 
 int journal_read_begin(zone_journal_t j, bool read_zone, uint32_t serial_from, journal_read_t **ctx)
@@ -91,6 +124,7 @@ void journal_read_end(journal_read_t *ctx)
 {
 	if (ctx != NULL) {
 		free(ctx->key_prefix.mv_data);
+		free(ctx->buf);
 		knot_lmdb_abort(&ctx->txn);
 		free(ctx);
 	}
@@ -110,7 +144,7 @@ static bool make_data_available(journal_read_t *ctx)
 			ctx->txn.ret = KNOT_EMALF;
 			return false;
 		}
-		update_ctx_wire(ctx);
+		return update_ctx_wire(ctx);
 	}
 	return true;
 }
@@ -14,6 +14,10 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#ifdef HAVE_LZ4
+#include <lz4.h>
+#endif
+
 #include "knot/journal/journal_write.h"
 
 #include "contrib/macros.h"
@@ -22,8 +26,42 @@
 #include "knot/journal/serialization.h"
 #include "libknot/error.h"
 
-static void journal_write_serialize(knot_lmdb_txn_t *txn, serialize_ctx_t *ser, const changeset_t *ch, uint32_t ch_serial_to)
+#ifdef HAVE_LZ4
+static void journal_write_compressed(knot_lmdb_txn_t *txn, serialize_ctx_t *ser, MDB_val *key,
+                                     size_t raw_size, uint32_t ch_serial_to, uint8_t *buf)
+{
+	uint8_t *raw = buf + JOURNAL_CHUNK_MAX;
+	serialize_chunk(ser, raw, raw_size);
+
+	MDB_val chunk = { .mv_data = buf };
+	int comp_size = LZ4_compress_default((const char *)raw, (char *)buf + JOURNAL_HEADER_SIZE,
+	                                     raw_size, raw_size - 1);
+	if (comp_size > 0) {
+		journal_make_header(buf, ch_serial_to, JOURNAL_CHUNK_LZ4, raw_size);
+		chunk.mv_size = JOURNAL_HEADER_SIZE + comp_size;
+	} else { // incompressible data
+		journal_make_header(buf, ch_serial_to, 0, 0);
+		memcpy(buf + JOURNAL_HEADER_SIZE, raw, raw_size);
+		chunk.mv_size = JOURNAL_HEADER_SIZE + raw_size;
+	}
+	(void)knot_lmdb_insert(txn, key, &chunk);
+}
+#endif
+
+static void journal_write_serialize(knot_lmdb_txn_t *txn, serialize_ctx_t *ser, const changeset_t *ch,
+                                    uint32_t ch_serial_to, bool compress)
 {
+	uint8_t *buf = NULL;
+#ifdef HAVE_LZ4
+	if (compress) {
+		// compressed chunk followed by the uncompressed payload
+		buf = malloc(2 * JOURNAL_CHUNK_MAX);
+		if (buf == NULL) {
+			txn->ret = KNOT_ENOMEM;
+		}
+	}
+#endif
+
 	MDB_val chunk;
 	uint32_t i = 0;
 	while (serialize_unfinished(ser) && txn->ret == KNOT_EOK) {
@@ -32,31 +70,40 @@ static void journal_write_serialize(knot_lmdb_txn_t *txn, serialize_ctx_t *ser,
 		if (chunk.mv_size == 0) {
 			break; // beware! If this is ommited, it creates empty chunk => EMALF when reading.
 		}
+		MDB_val key = journal_changeset_to_chunk_key(ch, i);
+#ifdef HAVE_LZ4
+		if (buf != NULL) {
+			journal_write_compressed(txn, ser, &key, chunk.mv_size, ch_serial_to, buf);
+			free(key.mv_data);
+			i++;
+			continue;
+		}
+#endif
 		chunk.mv_size += JOURNAL_HEADER_SIZE;
 		chunk.mv_data = NULL;
-		MDB_val key = journal_changeset_to_chunk_key(ch, i);
 		if (knot_lmdb_insert(txn, &key, &chunk)) {
-			journal_make_header(chunk.mv_data, ch_serial_to);
+			journal_make_header(chunk.mv_data, ch_serial_to, 0, 0);
 			serialize_chunk(ser, chunk.mv_data + JOURNAL_HEADER_SIZE, chunk.mv_size - JOURNAL_HEADER_SIZE);
 		}
 		free(key.mv_data);
 		i++;
 	}
+	free(buf);
 	serialize_deinit(ser);
 	// return value is in the txn
 }
 
-void journal_write_changeset(knot_lmdb_txn_t *txn, const changeset_t *ch)
+void journal_write_changeset(knot_lmdb_txn_t *txn, const changeset_t *ch, bool compress)
 {
 	serialize_ctx_t *ser = serialize_init(ch);
 	if (ser == NULL) {
 		txn->ret = KNOT_ENOMEM;
 		return;
 	}
-	journal_write_serialize(txn, ser, ch, changeset_to(ch));
+	journal_write_serialize(txn, ser, ch, changeset_to(ch), compress);
 }
 
-void journal_write_zone(knot_lmdb_txn_t *txn, const zone_contents_t *z)
+void journal_write_zone(knot_lmdb_txn_t *txn, const zone_contents_t *z, bool compress)
 {
 	serialize_ctx_t *ser = serialize_zone_init(z);
 	if (ser == NULL) {
@@ -66,7 +113,7 @@ void journal_write_zone(knot_lmdb_txn_t *txn, const zone_contents_t *z)
 	changeset_t fake_ch;
 	fake_ch.soa_from = NULL;
 	fake_ch.add = (zone_contents_t *)z;
-	journal_write_serialize(txn, ser, &fake_ch, zone_contents_serial(z));
+	journal_write_serialize(txn, ser, &fake_ch, zone_contents_serial(z), compress);
 }
 
 static bool delete_one(knot_lmdb_txn_t *txn, bool del_zij, uint32_t del_serial,
@@ -113,7 +160,7 @@ void journal_merge(zone_journal_t j, knot_lmdb_txn_t *txn, bool merge_zij,
 	delete_one(txn, merge_zij, merge_serial, j.zone, &del_freed, &del_next_serial);
 	assert(del_freed > 0 && del_next_serial == *original_serial_to);
 
-	journal_write_changeset(txn, &merge);
+	journal_write_changeset(txn, &merge, journal_conf_compress(j));
 	journal_read_clear_changeset(&merge);
 }
 
@@ -150,6 +197,9 @@ void journal_try_flush(zone_journal_t j, knot_lmdb_txn_t *txn, journal_metadata_
 {
 	bool flush = journal_allow_flush(j);
 	uint32_t merge_orig = 0;
+	if (journal_conf_compress(j)) {
+		md->flags |= JOURNAL_COMPRESSED;
+	}
 	if (journal_contains(txn, true, 0, j.zone)) {
 		journal_merge(j, txn, true, 0, &merge_orig);
 		if (!flush) {
@@ -230,10 +280,11 @@ int journal_insert_zone(zone_journal_t j, const zone_contents_t *z)
 	update_last_inserter(&txn, j.zone);
 	journal_del_zone_txn(&txn, j.zone);
 
-	journal_write_zone(&txn, z);
+	bool compress = journal_conf_compress(j);
+	journal_write_zone(&txn, z, compress);
 
 	journal_metadata_t md = { 0 };
-	md.flags = JOURNAL_SERIAL_TO_VALID;
+	md.flags = JOURNAL_SERIAL_TO_VALID | (compress ? JOURNAL_COMPRESSED : 0);
 	md.serial_to = zone_contents_serial(z);
 	md.first_serial = md.serial_to;
 	journal_store_metadata(&txn, j.zone, &md);
@@ -242,34 +293,33 @@ int journal_insert_zone(zone_journal_t j, const zone_contents_t *z)
 	return txn.ret;
 }
 
-int journal_insert(zone_journal_t j, const changeset_t *ch, const changeset_t *extra)
+typedef struct {
+	zone_journal_t j;
+	const changeset_t *ch;
+	const changeset_t *extra;
+	size_t ch_size;
+	size_t max_usage;
+	bool compress;
+} insert_ctx_t;
+
+static void journal_insert_txn(knot_lmdb_txn_t *txn, void *ctx)
 {
-	size_t ch_size = changeset_serialized_size(ch);
-	size_t max_usage = journal_conf_max_usage(j);
-	if (ch_size >= max_usage) {
-		return KNOT_ESPACE;
-	}
-	if (extra != NULL && (changeset_to(extra) != changeset_to(ch) ||
-	     changeset_from(extra) == changeset_from(ch))) {
-		return KNOT_EINVAL;
-	}
-	int ret = knot_lmdb_open(j.db);
-	if (ret != KNOT_EOK) {
-		return ret;
-	}
-	knot_lmdb_txn_t txn = { 0 };
+	insert_ctx_t *ic = ctx;
+	zone_journal_t j = ic->j;
+	const changeset_t *ch = ic->ch, *extra = ic->extra;
+	size_t ch_size = ic->ch_size;
+
 	journal_metadata_t md = { 0 };
-	knot_lmdb_begin(j.db, &txn, true);
-	journal_load_metadata(&txn, j.zone, &md);
+	journal_load_metadata(txn, j.zone, &md);
 
-	update_last_inserter(&txn, j.zone);
+	update_last_inserter(txn, j.zone);
 
 	if (extra != NULL) {
-		if (journal_contains(&txn, true, 0, j.zone)) {
-			txn.ret = KNOT_ESEMCHECK;
+		if (journal_contains(txn, true, 0, j.zone)) {
+			txn->ret = KNOT_ESEMCHECK;
 		}
 		uint64_t merged_freed = 0;
-		delete_merged(&txn, j.zone, &md, &merged_freed);
+		delete_merged(txn, j.zone, &md, &merged_freed);
 		ch_size += changeset_serialized_size(extra);
 		ch_size -= merged_freed;
 		md.flushed_upto = md.serial_to; // set temporarily
@@ -277,32 +327,65 @@ int journal_insert(zone_journal_t j, const changeset_t *ch, const changeset_t *e
 	}
 
 	size_t chs_limit = journal_conf_max_changesets(j);
-	journal_fix_occupation(j, &txn, &md, max_usage - ch_size, chs_limit - 1);
+	journal_fix_occupation(j, txn, &md, ic->max_usage - ch_size, chs_limit - 1);
 
 	// avoid discontinuity
 	if ((md.flags & JOURNAL_SERIAL_TO_VALID) && md.serial_to != changeset_from(ch)) {
-		if (journal_contains(&txn, true, 0, j.zone)) {
-			txn.ret = KNOT_ESEMCHECK;
+		if (journal_contains(txn, true, 0, j.zone)) {
+			txn->ret = KNOT_ESEMCHECK;
 		} else {
-			journal_del_zone_txn(&txn, j.zone);
+			journal_del_zone_txn(txn, j.zone);
 			memset(&md, 0, sizeof(md));
 		}
 	}
 
 	// avoid cycle
-	if (journal_contains(&txn, false, changeset_to(ch), j.zone)) {
-		journal_fix_occupation(j, &txn, &md, INT64_MAX, 1);
+	if (journal_contains(txn, false, changeset_to(ch), j.zone)) {
+		journal_fix_occupation(j, txn, &md, INT64_MAX, 1);
 	}
 
-	journal_write_changeset(&txn, ch);
+	journal_write_changeset(txn, ch, ic->compress);
 	journal_metadata_after_insert(&md, changeset_from(ch), changeset_to(ch));
+	if (ic->compress) {
+		md.flags |= JOURNAL_COMPRESSED;
+	}
 
 	if (extra != NULL) {
-		journal_write_changeset(&txn, extra);
+		journal_write_changeset(txn, extra, ic->compress);
 		journal_metadata_after_extra(&md, changeset_from(extra), changeset_to(extra));
 	}
 
-	journal_store_metadata(&txn, j.zone, &md);
-	knot_lmdb_commit(&txn);
+	journal_store_metadata(txn, j.zone, &md);
+	knot_lmdb_commit(txn);
+}
+
+int journal_insert(zone_journal_t j, const changeset_t *ch, const changeset_t *extra)
+{
+	size_t ch_size = changeset_serialized_size(ch);
+	size_t max_usage = journal_conf_max_usage(j);
+	if (ch_size >= max_usage) {
+		return KNOT_ESPACE;
+	}
+	if (extra != NULL && (changeset_to(extra) != changeset_to(ch) ||
+	     changeset_from(extra) == changeset_from(ch))) {
+		return KNOT_EINVAL;
+	}
+	int ret = knot_lmdb_open(j.db);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	insert_ctx_t ctx = { j, ch, extra, ch_size, max_usage, journal_conf_compress(j) };
+
+	conf_val_t val = conf_db_param(j.conf, C_JOURNAL_DB_MODE);
+	if (conf_opt(&val) == JOURNAL_MODE_GROUP) {
+		val = conf_db_param(j.conf, C_JOURNAL_DB_GRP_WIN);
+		return knot_lmdb_group_write(j.db, j.zone, conf_int(&val),
+		                             journal_insert_txn, &ctx);
+	}
+
+	knot_lmdb_txn_t txn = { 0 };
+	knot_lmdb_begin(j.db, &txn, true);
+	journal_insert_txn(&txn, &ctx);
 	return txn.ret;
 }
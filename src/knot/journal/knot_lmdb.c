@@ -18,6 +18,7 @@
 #include <stdio.h> // snprintf
 #include <stdlib.h>
 #include <sys/stat.h>
+#include <time.h>
 #include <unistd.h>
 
 #include "knot/journal/knot_lmdb.h"
@@ -32,6 +33,17 @@
 #define LMDB_DIR_MODE   0770
 #define LMDB_FILE_MODE  0660
 
+#define LMDB_GROUP_MAX  128
+
+typedef struct knot_lmdb_group_job {
+	struct knot_lmdb_group_job *next;
+	const knot_dname_t *zone;
+	knot_lmdb_group_cb cb;
+	void *ctx;
+	int ret;
+	bool done;
+} group_job_t;
+
 static void err_to_knot(int *err)
 {
 	switch (*err) {
@@ -79,6 +91,10 @@ void knot_lmdb_init(knot_lmdb_db_t *db, const char *path, size_t mapsize, unsign
 	db->env_flags = env_flags;
 	db->dbname = dbname;
 	pthread_mutex_init(&db->opening_mutex, NULL);
+	pthread_mutex_init(&db->group_mutex, NULL);
+	pthread_cond_init(&db->group_cond, NULL);
+	db->group_queue = NULL;
+	db->group_leader = false;
 	db->maxdbs = 2;
 	db->maxreaders = conf_lmdb_readers(conf());
 }
@@ -267,12 +283,16 @@ void knot_lmdb_deinit(knot_lmdb_db_t *db)
 {
 	knot_lmdb_close(db);
 	pthread_mutex_destroy(&db->opening_mutex);
+	pthread_mutex_destroy(&db->group_mutex);
+	pthread_cond_destroy(&db->group_cond);
 	free(db->path);
 }
 
-void knot_lmdb_begin(knot_lmdb_db_t *db, knot_lmdb_txn_t *txn, bool rw)
+static void txn_begin(knot_lmdb_db_t *db, knot_lmdb_txn_t *txn,
+                      knot_lmdb_txn_t *parent, bool rw)
 {
-	txn->ret = mdb_txn_begin(db->env, NULL, rw ? 0 : MDB_RDONLY, &txn->txn);
+	txn->ret = mdb_txn_begin(db->env, parent == NULL ? NULL : parent->txn,
+	                         rw ? 0 : MDB_RDONLY, &txn->txn);
 	err_to_knot(&txn->ret);
 	if (txn->ret == KNOT_EOK) {
 		txn->opened = true;
@@ -281,6 +301,11 @@ void knot_lmdb_begin(knot_lmdb_db_t *db, knot_lmdb_txn_t *txn, bool rw)
 	}
 }
 
+void knot_lmdb_begin(knot_lmdb_db_t *db, knot_lmdb_txn_t *txn, bool rw)
+{
+	txn_begin(db, txn, NULL, rw);
+}
+
 void knot_lmdb_abort(knot_lmdb_txn_t *txn)
 {
 	if (txn->opened) {
@@ -319,6 +344,118 @@ void knot_lmdb_commit(knot_lmdb_txn_t *txn)
 	txn->opened = false;
 }
 
+static bool group_conflict(group_job_t *batch, group_job_t *job)
+{
+	for (; batch != NULL; batch = batch->next) {
+		if (knot_dname_is_equal(batch->zone, job->zone)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// move non-conflicting jobs from the queue to the batch, group_mutex must be locked
+static group_job_t *group_take(knot_lmdb_db_t *db)
+{
+	group_job_t *batch = NULL, **batch_end = &batch;
+	group_job_t **it = &db->group_queue;
+	size_t count = 0;
+	while (*it != NULL && count < LMDB_GROUP_MAX) {
+		group_job_t *job = *it;
+		if (group_conflict(batch, job)) {
+			it = &job->next;
+			continue;
+		}
+		*it = job->next;
+		job->next = NULL;
+		*batch_end = job;
+		batch_end = &job->next;
+		count++;
+	}
+	return batch;
+}
+
+static void group_run(knot_lmdb_db_t *db, group_job_t *batch)
+{
+	knot_lmdb_txn_t parent = { 0 };
+	knot_lmdb_begin(db, &parent, true);
+
+	for (group_job_t *job = batch; job != NULL; job = job->next) {
+		knot_lmdb_txn_t txn = { 0 };
+		if (parent.ret == KNOT_EOK) {
+			txn_begin(db, &txn, &parent, true);
+		} else {
+			txn.ret = parent.ret;
+		}
+		if (txn.ret == KNOT_EOK) {
+			job->cb(&txn, job->ctx);
+			knot_lmdb_abort(&txn); // if not finished by the callback
+		}
+		job->ret = txn.ret;
+	}
+
+	knot_lmdb_commit(&parent);
+	if (parent.ret != KNOT_EOK) {
+		for (group_job_t *job = batch; job != NULL; job = job->next) {
+			if (job->ret == KNOT_EOK) {
+				job->ret = parent.ret;
+			}
+		}
+	}
+}
+
+int knot_lmdb_group_write(knot_lmdb_db_t *db, const knot_dname_t *zone,
+                          unsigned delay, knot_lmdb_group_cb cb, void *ctx)
+{
+	if (db->env_flags & MDB_WRITEMAP) { // nested transactions not supported
+		knot_lmdb_txn_t txn = { 0 };
+		knot_lmdb_begin(db, &txn, true);
+		cb(&txn, ctx);
+		knot_lmdb_abort(&txn);
+		return txn.ret;
+	}
+
+	group_job_t job = { .zone = zone, .cb = cb, .ctx = ctx };
+
+	pthread_mutex_lock(&db->group_mutex);
+	group_job_t **end = &db->group_queue;
+	while (*end != NULL) {
+		end = &(*end)->next;
+	}
+	*end = &job;
+
+	while (!job.done) {
+		if (db->group_leader) {
+			pthread_cond_wait(&db->group_cond, &db->group_mutex);
+			continue;
+		}
+
+		db->group_leader = true;
+		if (delay > 0) {
+			pthread_mutex_unlock(&db->group_mutex);
+			struct timespec ts = { delay / 1000, (delay % 1000) * 1000000L };
+			nanosleep(&ts, NULL);
+			pthread_mutex_lock(&db->group_mutex);
+		}
+		group_job_t *batch = group_take(db);
+		pthread_mutex_unlock(&db->group_mutex);
+
+		group_run(db, batch);
+
+		pthread_mutex_lock(&db->group_mutex);
+		while (batch != NULL) {
+			group_job_t *next = batch->next;
+			batch->done = true; // the job may vanish now
+			batch = next;
+		}
+		db->group_leader = false;
+		pthread_cond_broadcast(&db->group_cond);
+	}
+	pthread_mutex_unlock(&db->group_mutex);
+
+	return job.ret;
+}
+
 // save the programmer's frequent checking for ENOMEM when creating search keys
 static bool txn_enomem(knot_lmdb_txn_t *txn, const MDB_val *tocheck)
 {
@@ -23,6 +23,10 @@
 #include <stdlib.h>
 #include <pthread.h>
 
+#include "libknot/dname.h"
+
+struct knot_lmdb_group_job;
+
 typedef struct knot_lmdb_db {
 	MDB_dbi dbi;
 	MDB_env *env;
@@ -37,6 +41,12 @@ typedef struct knot_lmdb_db {
 	unsigned env_flags; // MDB_NOTLS, MDB_RDONLY, MDB_WRITEMAP, MDB_DUPSORT, MDB_NOSYNC, MDB_MAPASYNC
 	const char *dbname;
 	char *path;
+
+	// group commit state, see knot_lmdb_group_write()
+	pthread_mutex_t group_mutex;
+	pthread_cond_t group_cond;
+	struct knot_lmdb_group_job *group_queue;
+	bool group_leader;
 } knot_lmdb_db_t;
 
 typedef struct {
@@ -188,6 +198,36 @@ void knot_lmdb_abort(knot_lmdb_txn_t *txn);
  */
 void knot_lmdb_commit(knot_lmdb_txn_t *txn);
 
+/*!
+ * \brief Callback performing a write operation in a grouped transaction.
+ *
+ * \note The callback receives an open read-write transaction, which it shall
+ *       commit or abort as if it was started by knot_lmdb_begin().
+ */
+typedef void (*knot_lmdb_group_cb)(knot_lmdb_txn_t *txn, void *ctx);
+
+/*!
+ * \brief Perform a write operation within a transaction shared with concurrent callers.
+ *
+ * The calling threads queue their operations and one of them executes all
+ * the queued ones, each in its own nested transaction, and commits them at
+ * once. The function returns after the shared transaction is committed.
+ *
+ * \param db      The database.
+ * \param zone    Zone the operation relates to. Operations of the same zone
+ *                aren't grouped together.
+ * \param delay   Time in milliseconds to wait for more operations to group.
+ * \param cb      Callback performing the operation.
+ * \param ctx     Arbitrary context for the callback.
+ *
+ * \note If the environment doesn't support nested transactions (MDB_WRITEMAP),
+ *       the operation is performed in a separate transaction.
+ *
+ * \return KNOT_E* as left in the transaction by the callback, or shared commit failure.
+ */
+int knot_lmdb_group_write(knot_lmdb_db_t *db, const knot_dname_t *zone,
+                          unsigned delay, knot_lmdb_group_cb cb, void *ctx);
+
 /*!
  * \brief Find a key in database. The matched key will be in txn->cur_key and its value in txn->cur_val.
  *
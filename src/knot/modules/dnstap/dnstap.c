@@ -21,15 +21,46 @@
 #include "contrib/dnstap/dnstap.pb-c.h"
 #include "contrib/dnstap/message.h"
 #include "contrib/dnstap/writer.h"
+#include "contrib/macros.h"
 #include "contrib/time.h"
 #include "knot/include/module.h"
 
+#ifdef HAVE_ATOMIC
+#define ATOMIC_SET(dst, val) __atomic_store_n(&(dst), (val), __ATOMIC_RELEASE)
+#define ATOMIC_GET(src)      __atomic_load_n(&(src), __ATOMIC_ACQUIRE)
+#else
+#define ATOMIC_SET(dst, val) ((dst) = (val))
+#define ATOMIC_GET(src)      (src)
+#endif
+
+/*! \brief Number of entries of each fstrm input queue (must be a power of 2). */
+#define QUEUE_SIZE		512
+/*! \brief Initial size of an encoding buffer. */
+#define BUF_MIN_SIZE		512
+/*! \brief Larger frames are encoded into one-off allocated buffers. */
+#define BUF_MAX_SIZE		(8 * 1024)
+
 #define MOD_SINK		"\x04""sink"
 #define MOD_IDENTITY		"\x08""identity"
 #define MOD_VERSION		"\x07""version"
 #define MOD_QUERIES		"\x0B""log-queries"
 #define MOD_RESPONSES		"\x0D""log-responses"
 #define MOD_WITH_QUERIES	"\x16""responses-with-queries"
+#define MOD_SAMPLE_RATE		"\x0B""sample-rate"
+#define MOD_QTYPE		"\x05""qtype"
+#define MOD_RCODE		"\x05""rcode"
+
+static int qtype_check(knotd_conf_check_args_t *args)
+{
+	uint16_t num;
+	int ret = knot_rrtype_from_string((const char *)args->data, &num);
+	if (ret != 0) {
+		args->err_str = "invalid RR type";
+		return KNOT_EINVAL;
+	}
+
+	return KNOT_EOK;
+}
 
 const yp_item_t dnstap_conf[] = {
 	{ MOD_SINK,         YP_TSTR,  YP_VNONE },
@@ -38,6 +69,9 @@ const yp_item_t dnstap_conf[] = {
 	{ MOD_QUERIES,      YP_TBOOL, YP_VBOOL = { true } },
 	{ MOD_RESPONSES,    YP_TBOOL, YP_VBOOL = { true } },
 	{ MOD_WITH_QUERIES, YP_TBOOL, YP_VBOOL = { false } },
+	{ MOD_SAMPLE_RATE,  YP_TINT,  YP_VINT = { 1, UINT16_MAX, 1 } },
+	{ MOD_QTYPE,        YP_TSTR,  YP_VNONE, YP_FMULTI, { qtype_check } },
+	{ MOD_RCODE,        YP_TOPT,  YP_VOPT = { knot_rcode_names, 0 }, YP_FMULTI },
 	{ NULL }
 };
 
@@ -52,15 +86,247 @@ int dnstap_conf_check(knotd_conf_check_args_t *args)
 	return KNOT_EOK;
 }
 
+enum {
+	CTR_ENCODED,
+	CTR_DROPPED,
+	CTR_QUEUED,
+};
+
+struct thread_bufs;
+
+/*! \brief Reusable encoding buffer, owned by the I/O thread while busy. */
+typedef struct {
+	struct thread_bufs *owner;
+	uint8_t *data;
+	size_t size;
+	bool busy;
+} frame_buf_t;
+
+/*! \brief Encoding buffers of one worker thread, used in a round-robin way. */
+typedef struct thread_bufs {
+	knotd_mod_t *mod;
+	unsigned thread_id;
+	unsigned next;
+	frame_buf_t bufs[QUEUE_SIZE];
+} thread_bufs_t;
+
 typedef struct {
 	struct fstrm_iothr *iothread;
+	thread_bufs_t **threads;
+	unsigned thread_count;
 	char *identity;
 	size_t identity_len;
 	char *version;
 	size_t version_len;
 	bool with_queries;
+	uint32_t sample_rate;
+	uint16_t *qtypes;
+	size_t qtype_count;
+	uint32_t rcodes; // Bitmap of allowed RCODEs, bit 31 for any higher RCODE.
 } dnstap_ctx_t;
 
+/*! \brief Called by the I/O thread once a pooled frame is written. */
+static void frame_buf_release(void *data, void *free_data)
+{
+	frame_buf_t *buf = free_data;
+	thread_bufs_t *thr = buf->owner;
+
+	knotd_mod_stats_decr(thr->mod, thr->thread_id, CTR_QUEUED, 0, 1);
+	ATOMIC_SET(buf->busy, false);
+}
+
+/*! \brief Called by the I/O thread once a one-off frame is written. */
+static void frame_free(void *data, void *free_data)
+{
+	thread_bufs_t *thr = free_data;
+
+	knotd_mod_stats_decr(thr->mod, thr->thread_id, CTR_QUEUED, 0, 1);
+	free(data);
+}
+
+static void thread_bufs_free(thread_bufs_t *thr)
+{
+	if (thr == NULL) {
+		return;
+	}
+
+	for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+		free(thr->bufs[i].data);
+	}
+	free(thr);
+}
+
+static thread_bufs_t *thread_bufs_new(knotd_mod_t *mod, unsigned thread_id)
+{
+	thread_bufs_t *thr = calloc(1, sizeof(*thr));
+	if (thr == NULL) {
+		return NULL;
+	}
+
+	thr->mod = mod;
+	thr->thread_id = thread_id;
+	for (unsigned i = 0; i < QUEUE_SIZE; i++) {
+		thr->bufs[i].owner = thr;
+	}
+
+	return thr;
+}
+
+/*!
+ * \brief Get the next free buffer of the thread, grow it if needed.
+ *
+ * Buffers are released by the I/O thread in the order they were submitted,
+ * so if the next one is still busy, the input queue is full.
+ */
+static frame_buf_t *frame_buf_get(thread_bufs_t *thr, size_t size)
+{
+	frame_buf_t *buf = &thr->bufs[thr->next];
+	if (ATOMIC_GET(buf->busy)) {
+		return NULL;
+	}
+
+	if (buf->size < size) {
+		size_t new_size = MAX(BUF_MIN_SIZE, 2 * buf->size);
+		while (new_size < size) {
+			new_size *= 2;
+		}
+		uint8_t *new_data = realloc(buf->data, new_size);
+		if (new_data == NULL) {
+			return NULL;
+		}
+		buf->data = new_data;
+		buf->size = new_size;
+	}
+
+	return buf;
+}
+
+static bool qtype_allowed(const dnstap_ctx_t *ctx, uint16_t qtype)
+{
+	if (ctx->qtype_count == 0) {
+		return true;
+	}
+
+	for (size_t i = 0; i < ctx->qtype_count; i++) {
+		if (ctx->qtypes[i] == qtype) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static uint16_t remote_port(const struct sockaddr_storage *addr)
+{
+	switch (addr->ss_family) {
+	case AF_INET:  return ((const struct sockaddr_in *)addr)->sin_port;
+	case AF_INET6: return ((const struct sockaddr_in6 *)addr)->sin6_port;
+	default:       return 0;
+	}
+}
+
+/*!
+ * \brief Decide if the transaction is sampled.
+ *
+ * The decision is based on the query ID and the remote port so that
+ * a query and its response are either both logged or both skipped.
+ */
+static bool sampled(const dnstap_ctx_t *ctx, knotd_qdata_t *qdata)
+{
+	if (ctx->sample_rate <= 1) {
+		return true;
+	}
+
+	uint16_t id = (qdata->query != NULL) ? knot_wire_get_id(qdata->query->wire) : 0;
+	uint32_t key = ((uint32_t)id << 16) | remote_port(knotd_qdata_remote_addr(qdata));
+	uint32_t hash = key * 0x9E3779B1U;
+
+	return ((uint64_t)hash * ctx->sample_rate) >> 32 == 0;
+}
+
+/*! \brief Apply sampling and filters, cheaply before anything is encoded. */
+static bool message_allowed(const dnstap_ctx_t *ctx, knotd_qdata_t *qdata,
+                            bool response)
+{
+	uint16_t qtype = (qdata->query != NULL) ? knot_pkt_qtype(qdata->query) : 0;
+	if (!sampled(ctx, qdata) || !qtype_allowed(ctx, qtype)) {
+		return false;
+	}
+
+	if (response && ctx->rcodes != 0) {
+		unsigned rcode = MIN(qdata->rcode, 31);
+		return ctx->rcodes & (1U << rcode);
+	}
+
+	return true;
+}
+
+/*!
+ * \brief Encode the frame and pass it to the I/O thread without blocking.
+ *
+ * Frames up to BUF_MAX_SIZE are encoded into the thread's reusable buffers,
+ * larger ones into a one-off allocation.
+ */
+static void submit_frame(dnstap_ctx_t *ctx, knotd_qdata_t *qdata,
+                         const Dnstap__Dnstap *dnstap)
+{
+	unsigned thread_id = qdata->params->thread_id;
+	assert(thread_id < ctx->thread_count);
+	thread_bufs_t *thr = ctx->threads[thread_id];
+	knotd_mod_t *mod = thr->mod;
+
+	size_t size = dnstap__dnstap__get_packed_size(dnstap);
+
+	frame_buf_t *buf = NULL;
+	uint8_t *frame = NULL;
+	if (size <= BUF_MAX_SIZE) {
+		buf = frame_buf_get(thr, size);
+		if (buf == NULL) {
+			knotd_mod_stats_incr(mod, thread_id, CTR_DROPPED, 0, 1);
+			return;
+		}
+		frame = buf->data;
+	} else {
+		frame = malloc(size);
+		if (frame == NULL) {
+			knotd_mod_stats_incr(mod, thread_id, CTR_DROPPED, 0, 1);
+			return;
+		}
+	}
+
+	size = dnstap__dnstap__pack(dnstap, frame);
+	knotd_mod_stats_incr(mod, thread_id, CTR_ENCODED, 0, 1);
+
+	struct fstrm_iothr_queue *ioq =
+		fstrm_iothr_get_input_queue_idx(ctx->iothread, thread_id);
+
+	if (buf != NULL) {
+		ATOMIC_SET(buf->busy, true);
+	}
+	knotd_mod_stats_incr(mod, thread_id, CTR_QUEUED, 0, 1);
+
+	fstrm_res res;
+	if (buf != NULL) {
+		res = fstrm_iothr_submit(ctx->iothread, ioq, frame, size,
+		                         frame_buf_release, buf);
+	} else {
+		res = fstrm_iothr_submit(ctx->iothread, ioq, frame, size,
+		                         frame_free, thr);
+	}
+
+	if (res != fstrm_res_success) {
+		knotd_mod_stats_decr(mod, thread_id, CTR_QUEUED, 0, 1);
+		knotd_mod_stats_incr(mod, thread_id, CTR_DROPPED, 0, 1);
+		if (buf != NULL) {
+			ATOMIC_SET(buf->busy, false);
+		} else {
+			free(frame);
+		}
+	} else if (buf != NULL) {
+		thr->next = (thr->next + 1) % QUEUE_SIZE;
+	}
+}
+
 static void msg_query_qname_restore(Dnstap__Message *msg, knotd_qdata_t *qdata)
 {
 	if (msg->query_message.data == NULL) {
@@ -97,19 +363,20 @@ static knotd_state_t log_message(knotd_state_t state, const knot_pkt_t *pkt,
 
 	dnstap_ctx_t *ctx = knotd_mod_ctx(mod);
 
-	struct fstrm_iothr_queue *ioq =
-		fstrm_iothr_get_input_queue_idx(ctx->iothread, qdata->params->thread_id);
-
-	/* Unless we want to measure the time it takes to process each query,
-	 * we can treat Q/R times the same. */
-	struct timespec tv = { .tv_sec = time(NULL) };
-
 	/* Determine query / response. */
 	Dnstap__Message__Type msgtype = DNSTAP__MESSAGE__TYPE__AUTH_QUERY;
 	if (knot_wire_get_qr(pkt->wire)) {
 		msgtype = DNSTAP__MESSAGE__TYPE__AUTH_RESPONSE;
 	}
 
+	if (!message_allowed(ctx, qdata, msgtype == DNSTAP__MESSAGE__TYPE__AUTH_RESPONSE)) {
+		return state;
+	}
+
+	/* Unless we want to measure the time it takes to process each query,
+	 * we can treat Q/R times the same. */
+	struct timespec tv = { .tv_sec = time(NULL) };
+
 	/* Determine whether we run on UDP/TCP. */
 	int protocol = IPPROTO_TCP;
 	if (qdata->params->flags & KNOTD_QUERY_FLAG_LIMIT_SIZE) {
@@ -153,23 +420,10 @@ static knotd_state_t log_message(knotd_state_t state, const knot_pkt_t *pkt,
 		msg.has_query_message = 1;
 	}
 
-	/* Pack the message. */
-	uint8_t *frame = NULL;
-	size_t size = 0;
+	/* Pack and submit the message. */
 	msg_query_qname_restore(&msg, qdata);
-	dt_pack(&dnstap, &frame, &size);
+	submit_frame(ctx, qdata, &dnstap);
 	msg_query_qname_case_lower(&msg);
-	if (frame == NULL) {
-		return state;
-	}
-
-	/* Submit a request. */
-	fstrm_res res = fstrm_iothr_submit(ctx->iothread, ioq, frame, size,
-	                                   fstrm_free_wrapper, NULL);
-	if (res != fstrm_res_success) {
-		free(frame);
-		return state;
-	}
 
 	return state;
 }
@@ -258,6 +512,18 @@ static struct fstrm_writer* dnstap_writer(const char *path)
 	return dnstap_file_writer(path);
 }
 
+static void ctx_free(dnstap_ctx_t *ctx)
+{
+	for (unsigned i = 0; ctx->threads != NULL && i < ctx->thread_count; i++) {
+		thread_bufs_free(ctx->threads[i]);
+	}
+	free(ctx->threads);
+	free(ctx->qtypes);
+	free(ctx->identity);
+	free(ctx->version);
+	free(ctx);
+}
+
 int dnstap_load(knotd_mod_t *mod)
 {
 	/* Create dnstap context. */
@@ -292,6 +558,58 @@ int dnstap_load(knotd_mod_t *mod)
 	conf = knotd_conf_mod(mod, MOD_WITH_QUERIES);
 	ctx->with_queries = conf.single.boolean;
 
+	/* Set sampling and filters. */
+	conf = knotd_conf_mod(mod, MOD_SAMPLE_RATE);
+	ctx->sample_rate = conf.single.integer;
+
+	conf = knotd_conf_mod(mod, MOD_QTYPE);
+	if (conf.count > 0) {
+		ctx->qtypes = calloc(conf.count, sizeof(*ctx->qtypes));
+		if (ctx->qtypes == NULL) {
+			knotd_conf_free(&conf);
+			ctx_free(ctx);
+			return KNOT_ENOMEM;
+		}
+		for (size_t i = 0; i < conf.count; i++) {
+			(void)knot_rrtype_from_string(conf.multi[i].string, &ctx->qtypes[i]);
+		}
+		ctx->qtype_count = conf.count;
+	}
+	knotd_conf_free(&conf);
+
+	conf = knotd_conf_mod(mod, MOD_RCODE);
+	for (size_t i = 0; i < conf.count; i++) {
+		ctx->rcodes |= 1U << MIN(conf.multi[i].option, 31);
+	}
+	knotd_conf_free(&conf);
+
+	/* Prepare per-thread encoding buffers. */
+	ctx->thread_count = knotd_mod_threads(mod);
+	ctx->threads = calloc(ctx->thread_count, sizeof(*ctx->threads));
+	if (ctx->threads == NULL) {
+		ctx_free(ctx);
+		return KNOT_ENOMEM;
+	}
+	for (unsigned i = 0; i < ctx->thread_count; i++) {
+		ctx->threads[i] = thread_bufs_new(mod, i);
+		if (ctx->threads[i] == NULL) {
+			ctx_free(ctx);
+			return KNOT_ENOMEM;
+		}
+	}
+
+	int ret = knotd_mod_stats_add(mod, "encoded", 1, NULL);
+	if (ret == KNOT_EOK) {
+		ret = knotd_mod_stats_add(mod, "dropped", 1, NULL);
+	}
+	if (ret == KNOT_EOK) {
+		ret = knotd_mod_stats_add(mod, "queued", 1, NULL);
+	}
+	if (ret != KNOT_EOK) {
+		ctx_free(ctx);
+		return ret;
+	}
+
 	/* Set sink. */
 	conf = knotd_conf_mod(mod, MOD_SINK);
 	const char *sink = conf.single.string;
@@ -316,8 +634,9 @@ int dnstap_load(knotd_mod_t *mod)
 		goto fail;
 	}
 
-	/* Initialize queues. */
-	fstrm_iothr_options_set_num_input_queues(opt, knotd_mod_threads(mod));
+	/* Initialize queues, one per thread with a buffer for each queue entry. */
+	fstrm_iothr_options_set_num_input_queues(opt, ctx->thread_count);
+	fstrm_iothr_options_set_input_queue_size(opt, QUEUE_SIZE);
 
 	/* Create the I/O thread. */
 	ctx->iothread = fstrm_iothr_init(opt, &writer);
@@ -341,9 +660,7 @@ int dnstap_load(knotd_mod_t *mod)
 fail:
 	knotd_mod_log(mod, LOG_ERR, "failed to init sink '%s'", sink);
 
-	free(ctx->identity);
-	free(ctx->version);
-	free(ctx);
+	ctx_free(ctx);
 
 	return KNOT_ENOMEM;
 }
@@ -352,10 +669,9 @@ void dnstap_unload(knotd_mod_t *mod)
 {
 	dnstap_ctx_t *ctx = knotd_mod_ctx(mod);
 
+	// Flushes the queues and releases the buffers of pending frames.
 	fstrm_iothr_destroy(&ctx->iothread);
-	free(ctx->identity);
-	free(ctx->version);
-	free(ctx);
+	ctx_free(ctx);
 }
 
 KNOTD_MOD_API(dnstap, KNOTD_MOD_FLAG_SCOPE_ANY,
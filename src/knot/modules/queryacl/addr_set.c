@@ -0,0 +1,312 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/modules/queryacl/addr_set.h"
+#include "contrib/qp-trie/trie.h"
+#include "contrib/sockaddr.h"
+#include "contrib/strtonum.h"
+#include "libknot/errcode.h"
+
+#define ADDR_MAXLEN	16
+#define KEY_MAXLEN	(1 + ADDR_MAXLEN)
+
+typedef struct {
+	uint8_t len;                 // Address length, distinguishes the family.
+	uint8_t min[ADDR_MAXLEN];
+	uint8_t max[ADDR_MAXLEN];
+} interval_t;
+
+struct addr_set {
+	interval_t *items;
+	size_t count;
+	size_t alloc;
+	trie_t *trie;                // Interval starts, NULL until built.
+};
+
+static size_t make_key(uint8_t *key, const uint8_t *addr, uint8_t len)
+{
+	key[0] = len;
+	memcpy(key + 1, addr, len);
+	return 1 + len;
+}
+
+/*! \brief Increment the address, false on overflow. */
+static bool addr_inc(uint8_t *addr, uint8_t len)
+{
+	for (int i = len - 1; i >= 0; i--) {
+		if (++addr[i] != 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static int interval_cmp(const void *a, const void *b)
+{
+	const interval_t *x = a, *y = b;
+	if (x->len != y->len) {
+		return (x->len < y->len) ? -1 : 1;
+	}
+	return memcmp(x->min, y->min, x->len);
+}
+
+static int interval_add(addr_set_t *set, const uint8_t *min, const uint8_t *max,
+                        uint8_t len)
+{
+	if (set->trie != NULL || memcmp(min, max, len) > 0) {
+		return KNOT_EINVAL;
+	}
+
+	if (set->count == set->alloc) {
+		size_t new_alloc = (set->alloc == 0) ? 16 : 2 * set->alloc;
+		interval_t *new_items = realloc(set->items, new_alloc * sizeof(*new_items));
+		if (new_items == NULL) {
+			return KNOT_ENOMEM;
+		}
+		set->items = new_items;
+		set->alloc = new_alloc;
+	}
+
+	interval_t *item = &set->items[set->count++];
+	item->len = len;
+	memcpy(item->min, min, len);
+	memcpy(item->max, max, len);
+
+	return KNOT_EOK;
+}
+
+addr_set_t *addr_set_new(void)
+{
+	return calloc(1, sizeof(addr_set_t));
+}
+
+void addr_set_free(addr_set_t *set)
+{
+	if (set == NULL) {
+		return;
+	}
+
+	trie_free(set->trie);
+	free(set->items);
+	free(set);
+}
+
+int addr_set_add_range(addr_set_t *set, const struct sockaddr_storage *min,
+                       const struct sockaddr_storage *max)
+{
+	if (set == NULL || min == NULL || max == NULL ||
+	    min->ss_family != max->ss_family) {
+		return KNOT_EINVAL;
+	}
+
+	size_t min_len = 0, max_len = 0;
+	const uint8_t *min_raw = sockaddr_raw(min, &min_len);
+	const uint8_t *max_raw = sockaddr_raw(max, &max_len);
+	if (min_raw == NULL || max_raw == NULL || min_len > ADDR_MAXLEN) {
+		return KNOT_EINVAL;
+	}
+
+	return interval_add(set, min_raw, max_raw, min_len);
+}
+
+int addr_set_add_net(addr_set_t *set, const struct sockaddr_storage *addr,
+                     unsigned prefix)
+{
+	if (set == NULL || addr == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	size_t len = 0;
+	const uint8_t *raw = sockaddr_raw(addr, &len);
+	if (raw == NULL || len > ADDR_MAXLEN || prefix > len * 8) {
+		return KNOT_EINVAL;
+	}
+
+	uint8_t min[ADDR_MAXLEN], max[ADDR_MAXLEN];
+	for (size_t i = 0; i < len; i++) {
+		unsigned bits = (prefix > i * 8) ? prefix - i * 8 : 0;
+		uint8_t mask = (bits >= 8) ? 0xff : (uint8_t)(0xff << (8 - bits));
+		min[i] = raw[i] & mask;
+		max[i] = raw[i] | ~mask;
+	}
+
+	return interval_add(set, min, max, len);
+}
+
+static int parse_addr(struct sockaddr_storage *ss, const char *str)
+{
+	int family = (strchr(str, ':') != NULL) ? AF_INET6 : AF_INET;
+	return (sockaddr_set(ss, family, str, 0) == KNOT_EOK) ? KNOT_EOK : KNOT_EMALF;
+}
+
+static int parse_line(addr_set_t *set, char *line)
+{
+	// Strip comments and white space.
+	char *end = strchr(line, '#');
+	if (end == NULL) {
+		end = line + strlen(line);
+	}
+	while (end > line && isspace((unsigned char)end[-1])) {
+		end--;
+	}
+	*end = '\0';
+	while (isspace((unsigned char)*line)) {
+		line++;
+	}
+	if (*line == '\0') {
+		return KNOT_EOK;
+	}
+
+	struct sockaddr_storage addr, max;
+	char *sep = strpbrk(line, "/-");
+	if (sep == NULL) {
+		if (parse_addr(&addr, line) != KNOT_EOK) {
+			return KNOT_EMALF;
+		}
+		return addr_set_add_range(set, &addr, &addr);
+	}
+
+	char type = *sep;
+	*sep = '\0';
+	if (parse_addr(&addr, line) != KNOT_EOK) {
+		return KNOT_EMALF;
+	}
+
+	if (type == '/') {
+		uint8_t prefix;
+		if (str_to_u8(sep + 1, &prefix) != KNOT_EOK) {
+			return KNOT_EMALF;
+		}
+		int ret = addr_set_add_net(set, &addr, prefix);
+		return (ret == KNOT_EINVAL) ? KNOT_EMALF : ret;
+	} else {
+		if (parse_addr(&max, sep + 1) != KNOT_EOK) {
+			return KNOT_EMALF;
+		}
+		int ret = addr_set_add_range(set, &addr, &max);
+		return (ret == KNOT_EINVAL) ? KNOT_EMALF : ret;
+	}
+}
+
+int addr_set_add_file(addr_set_t *set, const char *path, size_t *err_line)
+{
+	if (set == NULL || path == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	FILE *file = fopen(path, "r");
+	if (file == NULL) {
+		return knot_map_errno();
+	}
+
+	int ret = KNOT_EOK;
+	char *line = NULL;
+	size_t line_size = 0;
+	size_t line_num = 0;
+	while (ret == KNOT_EOK && getline(&line, &line_size, file) != -1) {
+		line_num++;
+		ret = parse_line(set, line);
+	}
+	if (ret == KNOT_EMALF && err_line != NULL) {
+		*err_line = line_num;
+	}
+
+	free(line);
+	fclose(file);
+
+	return ret;
+}
+
+int addr_set_build(addr_set_t *set)
+{
+	if (set == NULL || set->trie != NULL) {
+		return KNOT_EINVAL;
+	}
+
+	set->trie = trie_create(NULL);
+	if (set->trie == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	// Merge overlapping and adjacent intervals.
+	qsort(set->items, set->count, sizeof(*set->items), interval_cmp);
+	size_t merged = 0;
+	for (size_t i = 0; i < set->count; i++) {
+		interval_t *cur = &set->items[i];
+		if (merged > 0) {
+			interval_t *last = &set->items[merged - 1];
+			uint8_t next[ADDR_MAXLEN];
+			memcpy(next, last->max, last->len);
+			if (last->len == cur->len &&
+			    (!addr_inc(next, last->len) || memcmp(cur->min, next, cur->len) <= 0)) {
+				if (memcmp(cur->max, last->max, cur->len) > 0) {
+					memcpy(last->max, cur->max, cur->len);
+				}
+				continue;
+			}
+		}
+		set->items[merged++] = *cur;
+	}
+	set->count = merged;
+
+	for (size_t i = 0; i < set->count; i++) {
+		uint8_t key[KEY_MAXLEN];
+		size_t key_len = make_key(key, set->items[i].min, set->items[i].len);
+		trie_val_t *val = trie_get_ins(set->trie, key, key_len);
+		if (val == NULL) {
+			return KNOT_ENOMEM;
+		}
+		*val = &set->items[i];
+	}
+
+	return KNOT_EOK;
+}
+
+bool addr_set_match(const addr_set_t *set, const struct sockaddr_storage *addr)
+{
+	if (set == NULL || set->trie == NULL || addr == NULL) {
+		return false;
+	}
+
+	size_t len = 0;
+	const uint8_t *raw = sockaddr_raw(addr, &len);
+	if (raw == NULL || len > ADDR_MAXLEN) {
+		return false;
+	}
+
+	uint8_t key[KEY_MAXLEN];
+	size_t key_len = make_key(key, raw, len);
+	trie_val_t *val = NULL;
+	int ret = trie_get_leq(set->trie, key, key_len, &val);
+	if (ret < 0 || val == NULL) {
+		return false;
+	}
+
+	const interval_t *item = *val;
+	return item->len == len && memcmp(raw, item->max, len) <= 0;
+}
+
+size_t addr_set_size(const addr_set_t *set)
+{
+	return (set != NULL && set->trie != NULL) ? set->count : 0;
+}
@@ -0,0 +1,91 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Compiled set of address ranges.
+ *
+ * The ranges are merged into disjoint intervals indexed by their start
+ * addresses in a QP-trie. A lookup finds the nearest interval start not
+ * greater than the address, so its cost depends on the address length
+ * but not on the number of ranges.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <sys/socket.h>
+
+typedef struct addr_set addr_set_t;
+
+/*!
+ * \brief Create an empty set.
+ */
+addr_set_t *addr_set_new(void);
+
+/*!
+ * \brief Free the set.
+ */
+void addr_set_free(addr_set_t *set);
+
+/*!
+ * \brief Add an address range (inclusive) to the set.
+ *
+ * \return KNOT_EOK, KNOT_EINVAL, KNOT_ENOMEM
+ */
+int addr_set_add_range(addr_set_t *set, const struct sockaddr_storage *min,
+                       const struct sockaddr_storage *max);
+
+/*!
+ * \brief Add a network (address and prefix length) to the set.
+ *
+ * \return KNOT_EOK, KNOT_EINVAL, KNOT_ENOMEM
+ */
+int addr_set_add_net(addr_set_t *set, const struct sockaddr_storage *addr,
+                     unsigned prefix);
+
+/*!
+ * \brief Add ranges from a text file.
+ *
+ * Each line contains an address, a network (ADDR/INT), or a range (ADDR-ADDR).
+ * Empty lines and comments starting with '#' are skipped.
+ *
+ * \param set       Address set.
+ * \param path      File path.
+ * \param err_line  Output number of the malformed line if KNOT_EMALF.
+ *
+ * \return KNOT_EOK, KNOT_EMALF, KNOT_ENOMEM, or a file error.
+ */
+int addr_set_add_file(addr_set_t *set, const char *path, size_t *err_line);
+
+/*!
+ * \brief Compile the added ranges for lookups, no ranges can be added later.
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM
+ */
+int addr_set_build(addr_set_t *set);
+
+/*!
+ * \brief Check if the address falls into any range of the compiled set.
+ */
+bool addr_set_match(const addr_set_t *set, const struct sockaddr_storage *addr);
+
+/*!
+ * \brief Get the number of disjoint intervals of the compiled set.
+ */
+size_t addr_set_size(const addr_set_t *set);
@@ -14,23 +14,165 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <pthread.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <urcu.h>
+
 #include "knot/include/module.h"
-#include "contrib/sockaddr.h"
+#include "knot/modules/queryacl/addr_set.h"
 
-#define MOD_ADDRESS	"\x07""address"
-#define MOD_INTERFACE	"\x09""interface"
+#define MOD_ADDRESS		"\x07""address"
+#define MOD_ADDRESS_FILE	"\x0C""address-file"
+#define MOD_ADDRESS_FILE_CHECK	"\x12""address-file-check"
+#define MOD_INTERFACE		"\x09""interface"
 
 const yp_item_t queryacl_conf[] = {
-	{ MOD_ADDRESS,   YP_TNET, YP_VNONE, YP_FMULTI },
-	{ MOD_INTERFACE, YP_TNET, YP_VNONE, YP_FMULTI },
+	{ MOD_ADDRESS,            YP_TNET, YP_VNONE, YP_FMULTI },
+	{ MOD_ADDRESS_FILE,       YP_TSTR, YP_VNONE },
+	{ MOD_ADDRESS_FILE_CHECK, YP_TINT, YP_VINT = { 0, UINT32_MAX, 10, YP_STIME } },
+	{ MOD_INTERFACE,          YP_TNET, YP_VNONE, YP_FMULTI },
 	{ NULL }
 };
 
 typedef struct {
-	knotd_conf_t allow_addr;
-	knotd_conf_t allow_iface;
+	addr_set_t *allow_addr;   // RCU protected, replaced upon address file change.
+	addr_set_t *allow_iface;
+
+	// Watched address file.
+	knotd_conf_t addr_conf;
+	char *file;
+	uint32_t file_check;
+	struct timespec file_mtime;
+	off_t file_size;
+	bool file_missing;
+	pthread_t file_watch;
 } queryacl_ctx_t;
 
+static int set_add_conf(addr_set_t *set, knotd_conf_t *conf)
+{
+	for (size_t i = 0; i < conf->count; i++) {
+		knotd_conf_val_t *val = &conf->multi[i];
+		int ret;
+		if (val->addr_max.ss_family == AF_UNSPEC) {
+			int max_prefix = (val->addr.ss_family == AF_INET6) ? 128 : 32;
+			int prefix = val->addr_mask;
+			if (prefix < 0 || prefix > max_prefix) {
+				prefix = max_prefix;
+			}
+			ret = addr_set_add_net(set, &val->addr, prefix);
+		} else {
+			ret = addr_set_add_range(set, &val->addr, &val->addr_max);
+		}
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static int set_add_file(knotd_mod_t *mod, addr_set_t *set, const char *path)
+{
+	size_t line = 0;
+	int ret = addr_set_add_file(set, path, &line);
+	if (ret == KNOT_EMALF) {
+		knotd_mod_log(mod, LOG_ERR, "invalid address on line %zu in '%s'",
+		              line, path);
+	} else if (ret != KNOT_EOK) {
+		knotd_mod_log(mod, LOG_ERR, "failed to load '%s' (%s)",
+		              path, knot_strerror(ret));
+	} else {
+		knotd_mod_log(mod, LOG_INFO, "loaded addresses from '%s'", path);
+	}
+
+	return ret;
+}
+
+/*! \brief Compile configured ranges and optionally ranges from a file. */
+static int set_build(knotd_mod_t *mod, knotd_conf_t *conf, const char *file,
+                     addr_set_t **out)
+{
+	if (conf->count == 0 && file == NULL) {
+		*out = NULL;
+		return KNOT_EOK;
+	}
+
+	addr_set_t *set = addr_set_new();
+	if (set == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	int ret = set_add_conf(set, conf);
+	if (ret == KNOT_EOK && file != NULL) {
+		ret = set_add_file(mod, set, file);
+	}
+	if (ret == KNOT_EOK) {
+		ret = addr_set_build(set);
+	}
+	if (ret != KNOT_EOK) {
+		addr_set_free(set);
+		return ret;
+	}
+
+	*out = set;
+	return KNOT_EOK;
+}
+
+/*! \brief Check if the address file changed since the last check. */
+static bool file_changed(queryacl_ctx_t *ctx)
+{
+	struct stat st;
+	if (stat(ctx->file, &st) != 0) {
+		ctx->file_missing = true;
+		return false;
+	}
+
+	bool changed = ctx->file_missing || st.st_size != ctx->file_size ||
+	               st.st_mtim.tv_sec != ctx->file_mtime.tv_sec ||
+	               st.st_mtim.tv_nsec != ctx->file_mtime.tv_nsec;
+
+	ctx->file_missing = false;
+	ctx->file_size = st.st_size;
+	ctx->file_mtime = st.st_mtim;
+
+	return changed;
+}
+
+/*! \brief Replace the allowed addresses if the address file changed. */
+static void file_reload(knotd_mod_t *mod, queryacl_ctx_t *ctx)
+{
+	if (!file_changed(ctx)) {
+		return;
+	}
+
+	// Keep the current addresses if the file is invalid.
+	addr_set_t *set = NULL;
+	if (set_build(mod, &ctx->addr_conf, ctx->file, &set) != KNOT_EOK) {
+		return;
+	}
+
+	addr_set_t *old = rcu_xchg_pointer(&ctx->allow_addr, set);
+	synchronize_rcu();
+	addr_set_free(old);
+}
+
+static void *file_watch(void *data)
+{
+	knotd_mod_t *mod = data;
+	queryacl_ctx_t *ctx = knotd_mod_ctx(mod);
+
+	while (true) {
+		sleep(ctx->file_check);
+		pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
+		file_reload(mod, ctx);
+		pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
+	}
+
+	return NULL;
+}
+
 static knotd_state_t queryacl_process(knotd_state_t state, knot_pkt_t *pkt,
                                       knotd_qdata_t *qdata, knotd_mod_t *mod)
 {
@@ -43,18 +185,20 @@ static knotd_state_t queryacl_process(knotd_state_t state, knot_pkt_t *pkt,
 		return state;
 	}
 
-	if (ctx->allow_addr.count > 0) {
+	// Query processing holds the RCU read lock.
+	const addr_set_t *allow_addr = rcu_dereference(ctx->allow_addr);
+	if (allow_addr != NULL) {
 		const struct sockaddr_storage *addr = knotd_qdata_remote_addr(qdata);
-		if (!knotd_conf_addr_range_match(&ctx->allow_addr, addr)) {
+		if (!addr_set_match(allow_addr, addr)) {
 			qdata->rcode = KNOT_RCODE_NOTAUTH;
 			return KNOTD_STATE_FAIL;
 		}
 	}
 
-	if (ctx->allow_iface.count > 0) {
+	if (ctx->allow_iface != NULL) {
 		struct sockaddr_storage buff;
 		const struct sockaddr_storage *addr = knotd_qdata_local_addr(qdata, &buff);
-		if (!knotd_conf_addr_range_match(&ctx->allow_iface, addr)) {
+		if (!addr_set_match(ctx->allow_iface, addr)) {
 			qdata->rcode = KNOT_RCODE_NOTAUTH;
 			return KNOTD_STATE_FAIL;
 		}
@@ -63,6 +207,8 @@ static knotd_state_t queryacl_process(knotd_state_t state, knot_pkt_t *pkt,
 	return state;
 }
 
+void queryacl_unload(knotd_mod_t *mod);
+
 int queryacl_load(knotd_mod_t *mod)
 {
 	// Create module context.
@@ -70,11 +216,47 @@ int queryacl_load(knotd_mod_t *mod)
 	if (ctx == NULL) {
 		return KNOT_ENOMEM;
 	}
+	knotd_mod_ctx_set(mod, ctx);
 
-	ctx->allow_addr = knotd_conf_mod(mod, MOD_ADDRESS);
-	ctx->allow_iface = knotd_conf_mod(mod, MOD_INTERFACE);
+	knotd_conf_t conf = knotd_conf_mod(mod, MOD_ADDRESS_FILE);
+	if (conf.count == 1) {
+		ctx->file = strdup(conf.single.string);
+		if (ctx->file == NULL) {
+			knotd_conf_free(&conf);
+			queryacl_unload(mod);
+			return KNOT_ENOMEM;
+		}
+	}
+	knotd_conf_free(&conf);
 
-	knotd_mod_ctx_set(mod, ctx);
+	// The file status is taken before reading so that a concurrent change is noticed.
+	if (ctx->file != NULL) {
+		(void)file_changed(ctx);
+	}
+
+	ctx->addr_conf = knotd_conf_mod(mod, MOD_ADDRESS);
+	int ret = set_build(mod, &ctx->addr_conf, ctx->file, &ctx->allow_addr);
+	if (ret == KNOT_EOK) {
+		conf = knotd_conf_mod(mod, MOD_INTERFACE);
+		ret = set_build(mod, &conf, NULL, &ctx->allow_iface);
+		knotd_conf_free(&conf);
+	}
+	if (ret != KNOT_EOK) {
+		queryacl_unload(mod);
+		return ret;
+	}
+
+	// Start the address file watcher.
+	conf = knotd_conf_mod(mod, MOD_ADDRESS_FILE_CHECK);
+	if (ctx->file != NULL && conf.single.integer > 0) {
+		ctx->file_check = conf.single.integer;
+		if (pthread_create(&ctx->file_watch, NULL, file_watch, (void *)mod)) {
+			knotd_mod_log(mod, LOG_ERR, "failed to create the address file watcher");
+			ctx->file_check = 0;
+			queryacl_unload(mod);
+			return KNOT_ERROR;
+		}
+	}
 
 	return knotd_mod_hook(mod, KNOTD_STAGE_BEGIN, queryacl_process);
 }
@@ -83,10 +265,17 @@ void queryacl_unload(knotd_mod_t *mod)
 {
 	queryacl_ctx_t *ctx = knotd_mod_ctx(mod);
 	if (ctx != NULL) {
-		knotd_conf_free(&ctx->allow_addr);
-		knotd_conf_free(&ctx->allow_iface);
+		if (ctx->file_check > 0) {
+			(void)pthread_cancel(ctx->file_watch);
+			(void)pthread_join(ctx->file_watch, NULL);
+		}
+		knotd_conf_free(&ctx->addr_conf);
+		free(ctx->file);
+		addr_set_free(ctx->allow_addr);
+		addr_set_free(ctx->allow_iface);
 	}
 	free(ctx);
+	knotd_mod_ctx_set(mod, NULL);
 }
 
 KNOTD_MOD_API(queryacl, KNOTD_MOD_FLAG_SCOPE_ANY,
@@ -0,0 +1,337 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <assert.h>
+#include <string.h>
+#include <sys/socket.h>
+
+#include "knot/modules/synthrecord/synth_addr.h"
+#include "contrib/ctype.h"
+#include "libknot/errcode.h"
+
+#define IPV4_ADDR_LABELS	4
+#define IPV6_ADDR_LABELS	32
+#define IPV4_ARPA_DNAME		(const uint8_t *)"\x07""in-addr""\x04""arpa"
+#define IPV6_ARPA_DNAME		(const uint8_t *)"\x03""ip6""\x04""arpa"
+
+static const char hex_digits[] = "0123456789abcdef";
+
+static int hex_value(uint8_t ch)
+{
+	if (is_digit(ch)) {
+		return ch - '0';
+	} else if (is_xdigit(ch)) {
+		return (ch | 0x20) - 'a' + 10;
+	} else {
+		return -1;
+	}
+}
+
+/*! \brief Parse decimal octet without leading zeros (as inet_pton does). */
+static bool parse_octet(const uint8_t *text, size_t len, uint8_t *out)
+{
+	if (len == 0 || len > 3 || (len > 1 && text[0] == '0')) {
+		return false;
+	}
+
+	unsigned val = 0;
+	for (size_t i = 0; i < len; i++) {
+		if (!is_digit(text[i])) {
+			return false;
+		}
+		val = 10 * val + text[i] - '0';
+	}
+	if (val > 255) {
+		return false;
+	}
+
+	*out = val;
+	return true;
+}
+
+/*! \brief Parse dotted-quad IPv4 address with the given separator. */
+static bool parse_ipv4(const uint8_t *text, size_t len, uint8_t sep, uint8_t out[4])
+{
+	const uint8_t *end = text + len;
+
+	for (int i = 0; i < 4; i++) {
+		const uint8_t *pos = memchr(text, sep, end - text);
+		if (pos == NULL) {
+			pos = end;
+		}
+		if ((i < 3) != (pos < end) || !parse_octet(text, pos - text, &out[i])) {
+			return false;
+		}
+		text = pos + 1;
+	}
+
+	return true;
+}
+
+/*! \brief Parse IPv6 address with '-' or ':' separators (as inet_pton does). */
+static bool parse_ipv6(const uint8_t *text, size_t len, uint8_t out[16])
+{
+	const uint8_t *end = text + len;
+	uint8_t tmp[16] = { 0 };
+	uint8_t *tp = tmp, *tp_end = tmp + sizeof(tmp), *gap = NULL;
+
+	// Leading separator must be a double one.
+	if (text < end && (*text == '-' || *text == ':')) {
+		if (++text == end || (*text != '-' && *text != ':')) {
+			return false;
+		}
+	}
+
+	const uint8_t *token = text;
+	unsigned val = 0, digits = 0;
+	while (text < end) {
+		uint8_t ch = *text++;
+
+		int digit = hex_value(ch);
+		if (digit >= 0) {
+			if (++digits > 4) {
+				return false;
+			}
+			val = (val << 4) | digit;
+		} else if (ch == '-' || ch == ':') {
+			token = text;
+			if (digits == 0) {
+				if (gap != NULL) {
+					return false;
+				}
+				gap = tp;
+				continue;
+			} else if (text == end || tp + 2 > tp_end) {
+				return false;
+			}
+			*tp++ = val >> 8;
+			*tp++ = val;
+			val = 0;
+			digits = 0;
+		} else if (ch == '.' && tp + 4 <= tp_end &&
+		           parse_ipv4(token, end - token, '.', tp)) {
+			tp += 4;
+			digits = 0;
+			break;
+		} else {
+			return false;
+		}
+	}
+
+	if (digits > 0) {
+		if (tp + 2 > tp_end) {
+			return false;
+		}
+		*tp++ = val >> 8;
+		*tp++ = val;
+	}
+	if (gap != NULL) {
+		if (tp == tp_end) {
+			return false;
+		}
+		size_t tail = tp - gap;
+		memmove(tp_end - tail, gap, tail);
+		memset(gap, 0, tp_end - tail - gap);
+		tp = tp_end;
+	}
+	if (tp != tp_end) {
+		return false;
+	}
+
+	memcpy(out, tmp, sizeof(tmp));
+	return true;
+}
+
+int synth_addr_from_label(const uint8_t *text, size_t len, synth_addr_t *addr)
+{
+	assert(text && addr);
+
+	// Valid IPv4 address looks like A-B-C-D, shortened IPv6 contains "--".
+	unsigned hyphens = 0;
+	for (size_t i = 0; hyphens < 4 && i < len; i++) {
+		if (text[i] == '-') {
+			hyphens++;
+			if (++i < len && text[i] == '-') {
+				hyphens = 4;
+			}
+		}
+	}
+
+	if (hyphens == 3) {
+		addr->family = AF_INET;
+		memset(addr->bytes, 0, sizeof(addr->bytes));
+		return parse_ipv4(text, len, '-', addr->bytes) ? KNOT_EOK : KNOT_EINVAL;
+	} else {
+		addr->family = AF_INET6;
+		return parse_ipv6(text, len, addr->bytes) ? KNOT_EOK : KNOT_EINVAL;
+	}
+}
+
+int synth_addr_from_reverse(const knot_dname_t *name, synth_addr_t *addr, bool *parent)
+{
+	assert(name && addr && parent);
+
+	/* Required format is [address].[subnet/zone]
+	 * f.e.  [1.0...0].[h.g.f.e.0.0.0.0.d.c.b.a.ip6.arpa] represents
+	 *       [abcd:0:efgh::1] */
+	const uint8_t *labels[IPV6_ADDR_LABELS];
+	const uint8_t *label = name;
+	bool can_ipv4 = true;
+	bool can_ipv6 = true;
+	unsigned count = 0;
+
+	for ( ; count < IPV6_ADDR_LABELS; count++) {
+		if (*label == 0) {
+			return KNOT_EINVAL;
+		}
+		if (label[1] == 'i') {
+			break;
+		}
+		if (count < IPV4_ADDR_LABELS) {
+			if (*label > 3) {
+				return KNOT_EINVAL;
+			} else if (*label > 1) {
+				can_ipv6 = false;
+			}
+		} else {
+			can_ipv4 = false;
+			if (!can_ipv6 || *label != 1) {
+				return KNOT_EINVAL;
+			}
+		}
+		labels[count] = label;
+		label += *label + 1;
+	}
+
+	memset(addr->bytes, 0, sizeof(addr->bytes));
+
+	// The first label is the least significant part of the address.
+	if (can_ipv4 && knot_dname_is_equal(label, IPV4_ARPA_DNAME)) {
+		for (unsigned i = 0; i < count; i++) {
+			const uint8_t *l = labels[count - 1 - i];
+			if (!parse_octet(l + 1, *l, &addr->bytes[i])) {
+				return KNOT_EINVAL;
+			}
+		}
+		addr->family = AF_INET;
+		*parent = (count < IPV4_ADDR_LABELS);
+		return KNOT_EOK;
+	} else if (can_ipv6 && knot_dname_is_equal(label, IPV6_ARPA_DNAME)) {
+		for (unsigned i = 0; i < count; i++) {
+			int nibble = hex_value(labels[count - 1 - i][1]);
+			if (nibble < 0) {
+				return KNOT_EINVAL;
+			}
+			addr->bytes[i / 2] |= (i % 2 == 0) ? nibble << 4 : nibble;
+		}
+		addr->family = AF_INET6;
+		*parent = (count < IPV6_ADDR_LABELS);
+		return KNOT_EOK;
+	}
+
+	return KNOT_EINVAL;
+}
+
+static size_t write_octet(uint8_t val, uint8_t *out)
+{
+	size_t len = 0;
+
+	if (val >= 100) {
+		out[len++] = '0' + val / 100;
+	}
+	if (val >= 10) {
+		out[len++] = '0' + (val / 10) % 10;
+	}
+	out[len++] = '0' + val % 10;
+
+	return len;
+}
+
+static size_t write_block(uint16_t val, bool shorten, uint8_t *out)
+{
+	size_t len = 0;
+
+	for (int shift = 12; shift >= 0; shift -= 4) {
+		unsigned nibble = (val >> shift) & 0x0f;
+		if (!shorten || len > 0 || nibble != 0 || shift == 0) {
+			out[len++] = hex_digits[nibble];
+		}
+	}
+
+	return len;
+}
+
+size_t synth_addr_to_label(const synth_addr_t *addr, bool shorten, uint8_t *out)
+{
+	assert(addr && out);
+
+	size_t len = 0;
+
+	if (addr->family == AF_INET) {
+		for (int i = 0; i < 4; i++) {
+			len += write_octet(addr->bytes[i], out + len);
+			if (i < 3) {
+				out[len++] = '-';
+			}
+		}
+		return len;
+	}
+
+	uint16_t blocks[8];
+	for (int i = 0; i < 8; i++) {
+		blocks[i] = (addr->bytes[2 * i] << 8) | addr->bytes[2 * i + 1];
+	}
+
+	/* A label must not contain "--" in the third and fourth character positions
+	   and must not start or end with a "-". So we don't compress first, second,
+	   and last address blocks for simplicity. And we don't compress a single block.
+
+	   i:             0 1 2 3 4 5 6 7
+	   address block: A B C D E F G H
+	   compressibles:     0 0 0 0 0
+	                      0 0 0 0
+	                      0 0 0
+	                      0 0
+	 */
+	int compr_start = -1, compr_end = -1;
+	if (shorten) {
+		for (int i = 2; i < 7; i++) {
+			if (i < 6 && blocks[i] == 0 && blocks[i + 1] == 0) {
+				if (compr_start == -1) {
+					compr_start = i;
+				}
+			} else if (compr_start != -1) {
+				compr_end = i;
+				break;
+			}
+		}
+	}
+
+	for (int i = 0; i < 8; i++) {
+		if (compr_start == -1 || i < compr_start || i > compr_end) {
+			len += write_block(blocks[i], shorten, out + len);
+			if (i < 7) {
+				out[len++] = '-';
+			}
+		} else if (i == compr_end) {
+			out[len++] = '-';
+		}
+	}
+	assert(len <= SYNTH_ADDR_LABEL_MAXLEN);
+
+	return len;
+}
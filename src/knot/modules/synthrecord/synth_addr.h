@@ -0,0 +1,74 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libknot/dname.h"
+
+/*! \brief Maximum length of an address in the label form (IPv6 without shortening). */
+#define SYNTH_ADDR_LABEL_MAXLEN	39
+
+/*!
+ * \brief Binary address being synthesized.
+ */
+typedef struct {
+	int family;        //!< AF_INET or AF_INET6.
+	uint8_t bytes[16]; //!< Address in network byte order.
+} synth_addr_t;
+
+/*!
+ * \brief Parse an address from the label form used in forward names.
+ *
+ * The label form is the textual address with ':' or '.' replaced by '-',
+ * e.g. 192-0-2-1 or 2001-db8--1.
+ *
+ * \param text  Address part of the label.
+ * \param len   Length of the address part.
+ * \param addr  Output address.
+ *
+ * \return KNOT_EOK, KNOT_EINVAL
+ */
+int synth_addr_from_label(const uint8_t *text, size_t len, synth_addr_t *addr);
+
+/*!
+ * \brief Parse an address from a reverse (in-addr.arpa or ip6.arpa) name.
+ *
+ * Missing least significant labels are treated as zeros and the name is
+ * flagged as a parent of synthesized names.
+ *
+ * \param name    Reverse domain name (lower-case).
+ * \param addr    Output address.
+ * \param parent  Set if the name doesn't contain the full address.
+ *
+ * \return KNOT_EOK, KNOT_EINVAL
+ */
+int synth_addr_from_reverse(const knot_dname_t *name, synth_addr_t *addr, bool *parent);
+
+/*!
+ * \brief Write an address in the label form.
+ *
+ * \param addr     Address to be written.
+ * \param shorten  Drop leading zeros and compress zero IPv6 blocks.
+ * \param out      Output buffer of at least SYNTH_ADDR_LABEL_MAXLEN bytes.
+ *
+ * \return Length of the written text.
+ */
+size_t synth_addr_to_label(const synth_addr_t *addr, bool shorten, uint8_t *out);
@@ -14,12 +14,9 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
-#include "contrib/ctype.h"
-#include "contrib/macros.h"
-#include "contrib/net.h"
 #include "contrib/sockaddr.h"
-#include "contrib/wire_ctx.h"
 #include "knot/include/module.h"
+#include "knot/modules/synthrecord/synth_addr.h"
 
 #define MOD_NET		"\x07""network"
 #define MOD_ORIGIN	"\x06""origin"
@@ -99,14 +96,6 @@ int synth_record_conf_check(knotd_conf_check_args_t *args)
 	return KNOT_EOK;
 }
 
-#define ARPA_ZONE_LABELS	2
-#define IPV4_ADDR_LABELS	4
-#define IPV6_ADDR_LABELS	32
-#define IPV4_ARPA_DNAME		(uint8_t *)"\x07""in-addr""\x04""arpa"
-#define IPV6_ARPA_DNAME		(uint8_t *)"\x03""ip6""\x04""arpa"
-#define IPV4_ARPA_LEN		14
-#define IPV6_ARPA_LEN		10
-
 /*!
  * \brief Synthetic response template.
  */
@@ -120,7 +109,7 @@ typedef struct {
 	enum synth_template_type type;
 	char *prefix;
 	size_t prefix_len;
-	char *zone;
+	knot_dname_t *zone;
 	size_t zone_len;
 	uint32_t ttl;
 	size_t addr_count;
@@ -128,46 +117,6 @@ typedef struct {
 	bool reverse_short;
 } synth_template_t;
 
-typedef union {
-	uint32_t b32;
-	uint8_t b4[4];
-} addr_block_t;
-
-/*! \brief Write one IPV4 address block without redundant leading zeros. */
-static unsigned block_write(addr_block_t *block, char *addr_str)
-{
-	unsigned len = 0;
-
-	if (block->b4[0] != '0') {
-		addr_str[len++] = block->b4[0];
-	}
-	if (len > 0 || block->b4[1] != '0') {
-		addr_str[len++] = block->b4[1];
-	}
-	if (len > 0 || block->b4[2] != '0') {
-		addr_str[len++] = block->b4[2];
-	}
-	addr_str[len++] = block->b4[3];
-
-	return len;
-}
-
-/*! \brief Substitute all occurrences of given character. */
-static void str_subst(char *str, size_t len, char from, char to)
-{
-	for (int i = 0; i < len; ++i) {
-		if (str[i] == from) {
-			str[i] = to;
-		}
-	}
-}
-
-/*! \brief Separator character for address family. */
-static char str_separator(int addr_family)
-{
-	return (addr_family == AF_INET6) ? ':' : '.';
-}
-
 /*! \brief Return true if query type is satisfied with provided address family. */
 static bool query_satisfied_by_family(uint16_t qtype, int family)
 {
@@ -179,144 +128,8 @@ static bool query_satisfied_by_family(uint16_t qtype, int family)
 	}
 }
 
-/*! \brief Parse address from reverse query QNAME and return address family. */
-static int reverse_addr_parse(knotd_qdata_t *qdata, const synth_template_t *tpl,
-                              char *addr_str, int *addr_family, bool *parent)
-{
-	/* QNAME required format is [address].[subnet/zone]
-	 * f.e.  [1.0...0].[h.g.f.e.0.0.0.0.d.c.b.a.ip6.arpa] represents
-	 *       [abcd:0:efgh::1] */
-	const knot_dname_t *label = qdata->name; // uncompressed name
-
-	static const char ipv4_zero[] = "0.0.0.0";
-
-	bool can_ipv4 = true;
-	bool can_ipv6 = true;
-	unsigned labels = 0;
-
-	uint8_t buf4[16], *buf4_end = buf4 + sizeof(buf4), *buf4_pos = buf4_end;
-	uint8_t buf6[32], *buf6_end = buf6 + sizeof(buf6), *buf6_pos = buf6_end;
-
-	for ( ; labels < IPV6_ADDR_LABELS; labels++) {
-		if (unlikely(*label == 0)) {
-			return KNOT_EINVAL;
-		}
-		if (label[1] == 'i') {
-			break;
-		}
-		if (labels < IPV4_ADDR_LABELS) {
-			switch (*label) {
-			case 1:
-				assert(buf4 + 1 < buf4_pos && buf6 < buf6_pos);
-				*--buf6_pos = label[1];
-				*--buf4_pos = label[1];
-				*--buf4_pos = '.';
-				break;
-			case 2:
-			case 3:
-				assert(buf4 + *label < buf4_pos);
-				can_ipv6 = false;
-				buf4_pos -= *label;
-				memcpy(buf4_pos, label + 1, *label);
-				*--buf4_pos = '.';
-				break;
-			default:
-				return KNOT_EINVAL;
-			}
-		} else {
-			can_ipv4 = false;
-			if (!can_ipv6 || *label != 1) {
-				return KNOT_EINVAL;
-			}
-			assert(buf6 < buf6_pos);
-			*--buf6_pos = label[1];
-
-		}
-		label += *label + sizeof(*label);
-	}
-
-	if (can_ipv4 && knot_dname_is_equal(label, IPV4_ARPA_DNAME)) {
-		*addr_family = AF_INET;
-		*parent = (labels < IPV4_ADDR_LABELS);
-		int buf4_overweight = (buf4_end - buf4_pos) - (2 * labels);
-		assert(buf4_overweight >= 0);
-		memcpy(addr_str + buf4_overweight, ipv4_zero, sizeof(ipv4_zero));
-		if (labels > 0) {
-			buf4_pos++; // skip leading '.'
-			memcpy(addr_str, buf4_pos, buf4_end - buf4_pos);
-		}
-		return KNOT_EOK;
-	} else if (can_ipv6 && knot_dname_is_equal(label, IPV6_ARPA_DNAME)) {
-		*addr_family = AF_INET6;
-		*parent = (labels < IPV6_ADDR_LABELS);
-
-		addr_block_t blocks[8] = { { 0 } };
-		int compr_start = -1, compr_end = -1;
-
-		unsigned buf6_len = buf6_end - buf6_pos;
-		memcpy(blocks, buf6_pos, buf6_len);
-		memset(((uint8_t *)blocks) + buf6_len, 0x30, sizeof(blocks) - buf6_len);
-
-		for (int i = 0; i < 8; i++) {
-			addr_block_t *block = &blocks[i];
-
-			/* The Unicode string MUST NOT contain "--" in the third and fourth
-			   character positions and MUST NOT start or end with a "-".
-			   So we will not compress first, second, and last address blocks
-			   for simplicity. And we will not compress a single block.
-
-			   i:             0 1 2 3 4 5 6 7
-			   label block:   H:G:F:E:D:C:B:A
-			   address block: A B C D E F G H
-			   compressibles:     0 0 0 0 0
-			                      0 0 0 0
-			                      0 0 0
-			                      0 0
-			 */
-			// Check for trailing zero dual-blocks.
-			if (tpl->reverse_short && i > 1 && i < 6 &&
-			    block[0].b32 == 0x30303030UL && block[1].b32 == 0x30303030UL) {
-				if (compr_start == -1) {
-					compr_start = i;
-				}
-			} else {
-				if (compr_start != -1 && compr_end == -1) {
-					compr_end = i;
-				}
-			}
-		}
-
-		// Write address blocks.
-		unsigned addr_len = 0;
-		for (int i = 0; i < 8; i++) {
-			if (compr_start == -1 || i < compr_start || i > compr_end) {
-				// Write regular address block.
-				if (tpl->reverse_short) {
-					addr_len += block_write(&blocks[i], addr_str + addr_len);
-				} else {
-					assert(sizeof(blocks[i]) == 4);
-					memcpy(addr_str + addr_len, &blocks[i], 4);
-					addr_len += 4;
-				}
-				// Write separator
-				if (i < 7) {
-					addr_str[addr_len++] = ':';
-				}
-			} else if (compr_start != -1 && compr_end == i) {
-				// Write compression double colon.
-				addr_str[addr_len++] = ':';
-			}
-		}
-		addr_str[addr_len] = '\0';
-
-		return KNOT_EOK;
-	}
-
-	return KNOT_EINVAL;
-}
-
 static int forward_addr_parse(knotd_qdata_t *qdata, const synth_template_t *tpl,
-                              char *addr_str, int *addr_family)
+                              synth_addr_t *addr)
 {
 	const knot_dname_t *label = qdata->name;
 
@@ -326,148 +139,104 @@ static int forward_addr_parse(knotd_qdata_t *qdata, const synth_template_t *tpl,
 		return KNOT_EINVAL;
 	}
 
-	// Copy address part.
-	unsigned addr_len = label[0] - tpl->prefix_len;
-	memcpy(addr_str, label + 1 + tpl->prefix_len, addr_len);
-	addr_str[addr_len] = '\0';
-
-	// Determine address family.
-	unsigned hyphen_cnt = 0;
-	const char *ch = addr_str;
-	while (hyphen_cnt < 4 && ch < addr_str + addr_len) {
-		if (*ch == '-') {
-			hyphen_cnt++;
-			if (*++ch == '-') { // Check for shortened IPv6 notation.
-				hyphen_cnt = 4;
-				break;
-			}
-		}
-		ch++;
-	}
-	// Valid IPv4 address looks like A-B-C-D.
-	*addr_family = (hyphen_cnt == 3) ? AF_INET : AF_INET6;
-
-	// Restore correct address format.
-	const char sep = str_separator(*addr_family);
-	str_subst(addr_str, addr_len, '-', sep);
-
-	return KNOT_EOK;
+	return synth_addr_from_label(label + 1 + tpl->prefix_len,
+	                             label[0] - tpl->prefix_len, addr);
 }
 
-static int addr_parse(knotd_qdata_t *qdata, const synth_template_t *tpl, char *addr_str,
-                      int *addr_family, bool *parent)
+static int addr_parse(knotd_qdata_t *qdata, const synth_template_t *tpl,
+                      synth_addr_t *addr, bool *parent)
 {
 	switch (tpl->type) {
-	case SYNTH_REVERSE: return reverse_addr_parse(qdata, tpl, addr_str, addr_family, parent);
-	case SYNTH_FORWARD: return forward_addr_parse(qdata, tpl, addr_str, addr_family);
+	case SYNTH_REVERSE: return synth_addr_from_reverse(qdata->name, addr, parent);
+	case SYNTH_FORWARD: return forward_addr_parse(qdata, tpl, addr);
 	default:            return KNOT_EINVAL;
 	}
 }
 
-static knot_dname_t *synth_ptrname(uint8_t *out, const char *addr_str,
-                                   const synth_template_t *tpl, int addr_family)
+static void addr_to_sockaddr(const synth_addr_t *addr, struct sockaddr_storage *ss)
 {
-	knot_dname_txt_storage_t ptrname;
-	int addr_len = strlen(addr_str);
-	const char sep = str_separator(addr_family);
-
-	// PTR right-hand value is [prefix][address][zone]
-	wire_ctx_t ctx = wire_ctx_init((uint8_t *)ptrname, sizeof(ptrname));
-	wire_ctx_write(&ctx, tpl->prefix, tpl->prefix_len);
-	wire_ctx_write(&ctx, addr_str, addr_len);
-	wire_ctx_write_u8(&ctx, '.');
-	wire_ctx_write(&ctx, tpl->zone, tpl->zone_len);
-	wire_ctx_write_u8(&ctx, '\0');
-	if (ctx.error != KNOT_EOK) {
-		return NULL;
-	}
+	memset(ss, 0, sizeof(*ss));
+	ss->ss_family = addr->family;
 
-	// Substitute address separator by '-'.
-	str_subst(ptrname + tpl->prefix_len, addr_len, sep, '-');
-
-	// Convert to domain name.
-	return knot_dname_from_str(out, ptrname, KNOT_DNAME_MAXLEN);
+	if (addr->family == AF_INET6) {
+		struct sockaddr_in6 *ip = (struct sockaddr_in6 *)ss;
+		memcpy(&ip->sin6_addr, addr->bytes, sizeof(ip->sin6_addr));
+	} else {
+		struct sockaddr_in *ip = (struct sockaddr_in *)ss;
+		memcpy(&ip->sin_addr, addr->bytes, sizeof(ip->sin_addr));
+	}
 }
 
-static int reverse_rr(char *addr_str, const synth_template_t *tpl, knot_pkt_t *pkt,
-                      knot_rrset_t *rr, int addr_family)
+static int reverse_rr(const synth_addr_t *addr, const synth_template_t *tpl,
+                      knot_pkt_t *pkt, knot_rrset_t *rr)
 {
-	// Synthesize PTR record data.
+	// PTR right-hand value is [prefix][address].[zone]
 	knot_dname_storage_t ptrname;
-	if (synth_ptrname(ptrname, addr_str, tpl, addr_family) == NULL) {
+	if (tpl->prefix_len > KNOT_DNAME_MAXLABELLEN) {
+		return KNOT_EINVAL;
+	}
+	uint8_t *label = ptrname + 1;
+	memcpy(label, tpl->prefix, tpl->prefix_len);
+	size_t label_len = tpl->prefix_len +
+	                   synth_addr_to_label(addr, tpl->reverse_short,
+	                                       label + tpl->prefix_len);
+	if (label_len > KNOT_DNAME_MAXLABELLEN ||
+	    1 + label_len + tpl->zone_len > KNOT_DNAME_MAXLEN) {
 		return KNOT_EINVAL;
 	}
+	ptrname[0] = label_len;
+	memcpy(label + label_len, tpl->zone, tpl->zone_len);
 
 	rr->type = KNOT_RRTYPE_PTR;
-	knot_rrset_add_rdata(rr, ptrname, knot_dname_size(ptrname), &pkt->mm);
-
-	return KNOT_EOK;
+	return knot_rrset_add_rdata(rr, ptrname, 1 + label_len + tpl->zone_len, &pkt->mm);
 }
 
-static int forward_rr(char *addr_str, const synth_template_t *tpl, knot_pkt_t *pkt,
-                      knot_rrset_t *rr, int addr_family)
+static int forward_rr(const synth_addr_t *addr, knot_pkt_t *pkt, knot_rrset_t *rr)
 {
-	struct sockaddr_storage query_addr;
-	sockaddr_set(&query_addr, addr_family, addr_str, 0);
-
 	// Specify address type and data.
-	if (addr_family == AF_INET6) {
+	if (addr->family == AF_INET6) {
 		rr->type = KNOT_RRTYPE_AAAA;
-		const struct sockaddr_in6* ip = (const struct sockaddr_in6*)&query_addr;
-		knot_rrset_add_rdata(rr, (const uint8_t *)&ip->sin6_addr,
-		                     sizeof(struct in6_addr), &pkt->mm);
-	} else if (addr_family == AF_INET) {
+		return knot_rrset_add_rdata(rr, addr->bytes, sizeof(struct in6_addr), &pkt->mm);
+	} else if (addr->family == AF_INET) {
 		rr->type = KNOT_RRTYPE_A;
-		const struct sockaddr_in* ip = (const struct sockaddr_in*)&query_addr;
-		knot_rrset_add_rdata(rr, (const uint8_t *)&ip->sin_addr,
-		                     sizeof(struct in_addr), &pkt->mm);
+		return knot_rrset_add_rdata(rr, addr->bytes, sizeof(struct in_addr), &pkt->mm);
 	} else {
 		return KNOT_EINVAL;
 	}
-
-	return KNOT_EOK;
 }
 
-static knot_rrset_t *synth_rr(char *addr_str, const synth_template_t *tpl, knot_pkt_t *pkt,
-                              knotd_qdata_t *qdata, int addr_family)
+/*!
+ * \brief Synthesize the record into a caller-provided RRSet.
+ *
+ * The owner refers to the query name and the rdata is allocated from
+ * the per-query packet memory, which is released after the query.
+ */
+static int synth_rr(const synth_addr_t *addr, const synth_template_t *tpl,
+                    knot_pkt_t *pkt, knotd_qdata_t *qdata, knot_rrset_t *rr)
 {
-	knot_rrset_t *rr = knot_rrset_new(qdata->name, 0, KNOT_CLASS_IN, tpl->ttl,
-	                                  &pkt->mm);
-	if (rr == NULL) {
-		return NULL;
-	}
+	knot_rrset_init(rr, (knot_dname_t *)qdata->name, 0, KNOT_CLASS_IN, tpl->ttl);
 
 	// Fill in the specific data.
-	int ret = KNOT_ERROR;
 	switch (tpl->type) {
-	case SYNTH_REVERSE: ret = reverse_rr(addr_str, tpl, pkt, rr, addr_family); break;
-	case SYNTH_FORWARD: ret = forward_rr(addr_str, tpl, pkt, rr, addr_family); break;
-	default: break;
-	}
-
-	if (ret != KNOT_EOK) {
-		knot_rrset_free(rr, &pkt->mm);
-		return NULL;
+	case SYNTH_REVERSE: return reverse_rr(addr, tpl, pkt, rr);
+	case SYNTH_FORWARD: return forward_rr(addr, pkt, rr);
+	default:            return KNOT_ERROR;
 	}
-
-	return rr;
 }
 
 /*! \brief Check if query fits the template requirements. */
 static knotd_in_state_t template_match(knotd_in_state_t state, const synth_template_t *tpl,
                                        knot_pkt_t *pkt, knotd_qdata_t *qdata)
 {
-	int provided_af = AF_UNSPEC;
+	synth_addr_t addr;
 	struct sockaddr_storage query_addr;
-	char addr_str[SOCKADDR_STRLEN];
-	assert(SOCKADDR_STRLEN > KNOT_DNAME_MAXLABELLEN);
 	bool parent = false; // querying empty-non-terminal being (possibly indirect) parent of synthesized name
 
 	// Parse address from query name.
-	if (addr_parse(qdata, tpl, addr_str, &provided_af, &parent) != KNOT_EOK ||
-	    sockaddr_set(&query_addr, provided_af, addr_str, 0) != KNOT_EOK) {
+	if (addr_parse(qdata, tpl, &addr, &parent) != KNOT_EOK) {
 		return state;
 	}
+	addr_to_sockaddr(&addr, &query_addr);
 
 	// Try all available addresses.
 	int i;
@@ -493,7 +262,7 @@ static knotd_in_state_t template_match(knotd_in_state_t state, const synth_templ
 	switch (tpl->type) {
 	case SYNTH_FORWARD:
 		assert(!parent);
-		if (!query_satisfied_by_family(qtype, provided_af)) {
+		if (!query_satisfied_by_family(qtype, addr.family)) {
 			qdata->rcode = KNOT_RCODE_NOERROR;
 			return KNOTD_IN_STATE_NODATA;
 		}
@@ -509,14 +278,14 @@ static knotd_in_state_t template_match(knotd_in_state_t state, const synth_templ
 	}
 
 	// Synthesize record from template.
-	knot_rrset_t *rr = synth_rr(addr_str, tpl, pkt, qdata, provided_af);
-	if (rr == NULL) {
+	knot_rrset_t rr;
+	if (synth_rr(&addr, tpl, pkt, qdata, &rr) != KNOT_EOK) {
 		qdata->rcode = KNOT_RCODE_SERVFAIL;
 		return KNOTD_IN_STATE_ERROR;
 	}
 
 	// Insert synthetic response into packet.
-	if (knot_pkt_put(pkt, 0, rr, KNOT_PF_FREE) != KNOT_EOK) {
+	if (knot_pkt_put(pkt, 0, &rr, 0) != KNOT_EOK) {
 		return KNOTD_IN_STATE_ERROR;
 	}
 
@@ -560,13 +329,13 @@ int synth_record_load(knotd_mod_t *mod)
 	// Set origin if generating reverse record.
 	if (tpl->type == SYNTH_REVERSE) {
 		conf = knotd_conf_mod(mod, MOD_ORIGIN);
-		tpl->zone = knot_dname_to_str_alloc(conf.single.dname);
+		tpl->zone = knot_dname_copy(conf.single.dname, NULL);
 		if (tpl->zone == NULL) {
 			free(tpl->prefix);
 			free(tpl);
 			return KNOT_ENOMEM;
 		}
-		tpl->zone_len = strlen(tpl->zone);
+		tpl->zone_len = knot_dname_size(tpl->zone);
 	}
 
 	// Set ttl.
@@ -579,7 +348,7 @@ int synth_record_load(knotd_mod_t *mod)
 	tpl->addr = calloc(conf.count, sizeof(*tpl->addr));
 	if (tpl->addr == NULL) {
 		knotd_conf_free(&conf);
-		free(tpl->zone);
+		knot_dname_free(tpl->zone, NULL);
 		free(tpl->prefix);
 		free(tpl);
 		return KNOT_ENOMEM;
@@ -607,7 +376,7 @@ void synth_record_unload(knotd_mod_t *mod)
 	synth_template_t *tpl = knotd_mod_ctx(mod);
 
 	free(tpl->addr);
-	free(tpl->zone);
+	knot_dname_free(tpl->zone, NULL);
 	free(tpl->prefix);
 	free(tpl);
 }
@@ -24,11 +24,13 @@
 #include "knot/nameserver/ixfr.h"
 #include "knot/nameserver/log.h"
 #include "knot/nameserver/xfr.h"
+#include "knot/server/server.h"
 #include "knot/zone/serial.h"
 #include "libknot/libknot.h"
 
 #define ZONE_NAME(qdata) knot_pkt_qname((qdata)->query)
 #define REMOTE(qdata) (struct sockaddr *)knotd_qdata_remote_addr(qdata)
+#define IXFR_CACHE(qdata) (&((server_t *)(qdata)->params->server)->ixfr_cache)
 
 #define IXFROUT_LOG(priority, qdata, fmt...) \
 	ns_log(priority, ZONE_NAME(qdata), LOG_OPERATION_IXFR, \
@@ -101,6 +103,64 @@ static int ixfr_process_journal(knot_pkt_t *pkt, const void *item,
 
 #undef IXFR_SAFE_PUT
 
+/*! \brief Puts next cached message into packet. */
+static int ixfr_put_cached(knot_pkt_t *pkt, struct ixfr_proc *ixfr,
+                           knotd_qdata_t *qdata)
+{
+	assert(ixfr->cached_pos < ixfr->cached->msg_count);
+	const ixfr_cache_msg_t *msg = &ixfr->cached->msgs[ixfr->cached_pos];
+
+	/* Cached compression pointers are valid only right after the question. */
+	if (pkt->size != KNOT_WIRE_HEADER_SIZE + knot_pkt_question_size(pkt) ||
+	    pkt->size + msg->size > pkt->max_size - pkt->reserved) {
+		return KNOT_ENOXFR;
+	}
+
+	memcpy(pkt->wire + pkt->size, msg->wire, msg->size);
+	pkt->size += msg->size;
+	knot_wire_set_ancount(pkt->wire, msg->ancount);
+
+	xfr_stats_add(&ixfr->proc.stats, pkt->size + knot_rrset_size(&qdata->opt_rr));
+
+	ixfr->cached_pos++;
+	return (ixfr->cached_pos < ixfr->cached->msg_count) ? KNOT_ESPACE : KNOT_EOK;
+}
+
+/*! \brief Stores the answer section of the current message for later reuse. */
+static void ixfr_capture(knot_pkt_t *pkt, struct ixfr_proc *ixfr, int state)
+{
+	if (ixfr->capture == NULL) {
+		return;
+	}
+
+	int ret = KNOT_ERROR;
+	if (state == KNOT_EOK || state == KNOT_ESPACE) {
+		size_t offset = KNOT_WIRE_HEADER_SIZE + knot_pkt_question_size(pkt);
+		ret = ixfr_cache_entry_append(ixfr->capture, pkt->wire + offset,
+		                              pkt->size - offset,
+		                              knot_wire_get_ancount(pkt->wire));
+	}
+
+	if (ret != KNOT_EOK) {
+		ixfr_cache_entry_free(ixfr->capture);
+		ixfr->capture = NULL;
+	}
+}
+
+/*! \brief Hands over the captured messages of a finished transfer to the cache. */
+static void ixfr_capture_finish(struct ixfr_proc *ixfr, knotd_qdata_t *qdata)
+{
+	if (ixfr->capture == NULL) {
+		return;
+	}
+
+	int ret = ixfr_cache_insert(IXFR_CACHE(qdata), ixfr->capture, qdata->extra->zone);
+	if (ret != KNOT_EOK) {
+		ixfr_cache_entry_free(ixfr->capture);
+	}
+	ixfr->capture = NULL;
+}
+
 static int ixfr_load_chsets(journal_read_t **journal_read, zone_t *zone,
                             const zone_contents_t *contents, const knot_rrset_t *their_soa)
 {
@@ -155,15 +215,17 @@ static void ixfr_answer_cleanup(knotd_qdata_t *qdata)
 	knot_rrset_clear(&ixfr->cur_rr, NULL);
 	ptrlist_free(&ixfr->proc.nodes, mm);
 	journal_read_end(ixfr->journal_ctx);
+	ixfr_cache_release(IXFR_CACHE(qdata), ixfr->cached);
+	ixfr_cache_entry_free(ixfr->capture);
 	mm_free(mm, qdata->extra->ext);
 
 	/* Allow zone changes (finished). */
 	rcu_read_unlock();
 }
 
-static int ixfr_answer_init(knotd_qdata_t *qdata, uint32_t *serial_from)
+static int ixfr_answer_init(knot_pkt_t *pkt, knotd_qdata_t *qdata, uint32_t *serial_from)
 {
-	assert(qdata);
+	assert(pkt && qdata);
 
 	if (ixfr_query_check(qdata) == KNOT_STATE_FAIL) {
 		if (qdata->rcode == KNOT_RCODE_FORMERR) {
@@ -184,11 +246,31 @@ static int ixfr_answer_init(knotd_qdata_t *qdata, uint32_t *serial_from)
 	}
 	memset(xfer, 0, sizeof(*xfer));
 
-	int ret = ixfr_load_chsets(&xfer->journal_ctx, (zone_t *)qdata->extra->zone,
-	                           qdata->extra->contents, their_soa);
-	if (ret != KNOT_EOK) {
-		mm_free(mm, xfer);
-		return ret;
+	const zone_t *zone = qdata->extra->zone;
+	const zone_contents_t *contents = qdata->extra->contents;
+
+	/* Multi-message answers may be served from or stored to the cache. */
+	bool use_cache = !(qdata->params->flags & KNOTD_QUERY_FLAG_LIMIT_SIZE);
+	if (use_cache) {
+		/* Space for the answer section once TSIG is reserved. */
+		size_t used = pkt->reserved + pkt->size +
+		              knot_tsig_wire_size(&qdata->sign.tsig_key);
+		size_t room = (pkt->max_size > used) ? pkt->max_size - used : 0;
+		xfer->cached = ixfr_cache_get(IXFR_CACHE(qdata), zone->name,
+		                              *serial_from, contents, room);
+	}
+
+	if (xfer->cached == NULL) {
+		int ret = ixfr_load_chsets(&xfer->journal_ctx, (zone_t *)zone,
+		                           contents, their_soa);
+		if (ret != KNOT_EOK) {
+			mm_free(mm, xfer);
+			return ret;
+		}
+		if (use_cache) {
+			xfer->capture = ixfr_cache_entry_new(IXFR_CACHE(qdata), zone->name,
+			                                     *serial_from, contents);
+		}
 	}
 
 	xfr_stats_begin(&xfer->proc.stats);
@@ -197,7 +279,9 @@ static int ixfr_answer_init(knotd_qdata_t *qdata, uint32_t *serial_from)
 	knot_rrset_init_empty(&xfer->cur_rr);
 	xfer->qdata = qdata;
 
-	ptrlist_add(&xfer->proc.nodes, xfer->journal_ctx, mm);
+	if (xfer->journal_ctx != NULL) {
+		ptrlist_add(&xfer->proc.nodes, xfer->journal_ctx, mm);
+	}
 
 	xfer->soa_from = knot_soa_serial(their_soa->rrs.rdata);
 	xfer->soa_to = zone_contents_serial(qdata->extra->contents);
@@ -258,7 +342,7 @@ int ixfr_process_query(knot_pkt_t *pkt, knotd_qdata_t *qdata)
 	struct ixfr_proc *ixfr = qdata->extra->ext;
 	if (ixfr == NULL) {
 		uint32_t soa_from = 0;
-		int ret = ixfr_answer_init(qdata, &soa_from);
+		int ret = ixfr_answer_init(pkt, qdata, &soa_from);
 		ixfr = qdata->extra->ext;
 		switch (ret) {
 		case KNOT_EOK:       /* OK */
@@ -295,11 +379,17 @@ int ixfr_process_query(knot_pkt_t *pkt, knotd_qdata_t *qdata)
 	}
 
 	/* Answer current packet (or continue). */
-	ret = xfr_process_list(pkt, &ixfr_process_journal, qdata);
+	if (ixfr->cached != NULL) {
+		ret = ixfr_put_cached(pkt, ixfr, qdata);
+	} else {
+		ret = xfr_process_list(pkt, &ixfr_process_journal, qdata);
+		ixfr_capture(pkt, ixfr, ret);
+	}
 	switch (ret) {
 	case KNOT_ESPACE: /* Couldn't write more, send packet and continue. */
 		return KNOT_STATE_PRODUCE; /* Check for more. */
 	case KNOT_EOK:    /* Last response. */
+		ixfr_capture_finish(ixfr, qdata);
 		xfr_stats_end(&ixfr->proc.stats);
 		xfr_log_finished(ZONE_NAME(qdata), LOG_OPERATION_IXFR, LOG_DIRECTION_OUT,
 		                 REMOTE(qdata), &ixfr->proc.stats);
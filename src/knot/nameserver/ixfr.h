@@ -17,6 +17,7 @@
 #pragma once
 
 #include "knot/journal/journal_read.h"
+#include "knot/nameserver/ixfr_cache.h"
 #include "knot/nameserver/process_query.h"
 #include "knot/nameserver/xfr.h"
 #include "libknot/packet/pkt.h"
@@ -42,6 +43,13 @@ struct ixfr_proc {
 	/* Changes to be sent. */
 	journal_read_t *journal_ctx;
 
+	/* Cached messages being sent instead of the journal changes. */
+	ixfr_cache_entry_t *cached;
+	size_t cached_pos;
+
+	/* Messages being captured for the cache. */
+	ixfr_cache_entry_t *capture;
+
 	/* Currenty processed RRSet. */
 	knot_rrset_t cur_rr;
 
@@ -0,0 +1,323 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+#include <urcu.h>
+
+#include "contrib/macros.h"
+#include "knot/nameserver/ixfr_cache.h"
+#include "knot/zone/zone.h"
+#include "libknot/errcode.h"
+
+static size_t entry_base_size(const knot_dname_t *zone)
+{
+	return sizeof(ixfr_cache_entry_t) + knot_dname_size(zone);
+}
+
+static ixfr_cache_entry_t **zone_chain(ixfr_cache_t *cache, const knot_dname_t *zone,
+                                       bool create)
+{
+	if (create) {
+		return (ixfr_cache_entry_t **)trie_get_ins(cache->zones, zone,
+		                                           knot_dname_size(zone));
+	} else {
+		return (ixfr_cache_entry_t **)trie_get_try(cache->zones, zone,
+		                                           knot_dname_size(zone));
+	}
+}
+
+/*! \brief Remove the entry from the LRU and free it unless it's being sent. */
+static void entry_drop(ixfr_cache_t *cache, ixfr_cache_entry_t *entry)
+{
+	rem_node(&entry->n);
+	assert(cache->size >= entry->size);
+	cache->size -= entry->size;
+	entry->unlinked = true;
+	entry->next = NULL;
+
+	if (entry->refs == 0) {
+		ixfr_cache_entry_free(entry);
+	}
+}
+
+/*! \brief Remove the entry from its zone chain and drop it. */
+static void entry_unlink(ixfr_cache_t *cache, ixfr_cache_entry_t *entry)
+{
+	ixfr_cache_entry_t **chain = zone_chain(cache, entry->zone, false);
+	assert(chain != NULL);
+
+	for (ixfr_cache_entry_t **it = chain; *it != NULL; it = &(*it)->next) {
+		if (*it == entry) {
+			*it = entry->next;
+			break;
+		}
+	}
+
+	if (*chain == NULL) {
+		trie_del(cache->zones, entry->zone, knot_dname_size(entry->zone), NULL);
+	}
+
+	entry_drop(cache, entry);
+}
+
+static void evict(ixfr_cache_t *cache)
+{
+	while (cache->size > cache->max_size && !EMPTY_LIST(cache->lru)) {
+		entry_unlink(cache, TAIL(cache->lru));
+	}
+}
+
+int ixfr_cache_init(ixfr_cache_t *cache)
+{
+	assert(cache);
+
+	memset(cache, 0, sizeof(*cache));
+
+	cache->zones = trie_create(NULL);
+	if (cache->zones == NULL) {
+		return KNOT_ENOMEM;
+	}
+	init_list(&cache->lru);
+	pthread_mutex_init(&cache->lock, NULL);
+
+	return KNOT_EOK;
+}
+
+void ixfr_cache_deinit(ixfr_cache_t *cache)
+{
+	if (cache == NULL || cache->zones == NULL) {
+		return;
+	}
+
+	ixfr_cache_set_max_size(cache, 0);
+	assert(EMPTY_LIST(cache->lru));
+
+	trie_free(cache->zones);
+	cache->zones = NULL;
+	pthread_mutex_destroy(&cache->lock);
+}
+
+void ixfr_cache_set_max_size(ixfr_cache_t *cache, size_t max_size)
+{
+	assert(cache);
+
+	pthread_mutex_lock(&cache->lock);
+	cache->max_size = max_size;
+	evict(cache);
+	pthread_mutex_unlock(&cache->lock);
+}
+
+ixfr_cache_entry_t *ixfr_cache_get(ixfr_cache_t *cache, const knot_dname_t *zone,
+                                   uint32_t serial_from,
+                                   const struct zone_contents *contents,
+                                   size_t room)
+{
+	assert(cache && zone);
+
+	ixfr_cache_entry_t *found = NULL;
+
+	pthread_mutex_lock(&cache->lock);
+	ixfr_cache_entry_t **chain = zone_chain(cache, zone, false);
+	for (ixfr_cache_entry_t *it = (chain != NULL) ? *chain : NULL;
+	     it != NULL; it = it->next) {
+		if (it->serial_from == serial_from && it->contents == contents &&
+		    it->msg_max <= room) {
+			found = it;
+			break;
+		}
+	}
+	if (found != NULL) {
+		found->refs++;
+		rem_node(&found->n);
+		add_head(&cache->lru, &found->n);
+	}
+	pthread_mutex_unlock(&cache->lock);
+
+	return found;
+}
+
+void ixfr_cache_release(ixfr_cache_t *cache, ixfr_cache_entry_t *entry)
+{
+	if (entry == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&cache->lock);
+	assert(entry->refs > 0);
+	entry->refs--;
+	bool drop = (entry->refs == 0 && entry->unlinked);
+	pthread_mutex_unlock(&cache->lock);
+
+	if (drop) {
+		ixfr_cache_entry_free(entry);
+	}
+}
+
+ixfr_cache_entry_t *ixfr_cache_entry_new(ixfr_cache_t *cache, const knot_dname_t *zone,
+                                         uint32_t serial_from,
+                                         const struct zone_contents *contents)
+{
+	assert(cache && zone && contents);
+
+	pthread_mutex_lock(&cache->lock);
+	size_t limit = cache->max_size;
+	pthread_mutex_unlock(&cache->lock);
+
+	if (limit == 0 || entry_base_size(zone) > limit) {
+		return NULL;
+	}
+
+	ixfr_cache_entry_t *entry = calloc(1, sizeof(*entry));
+	if (entry == NULL) {
+		return NULL;
+	}
+
+	entry->zone = knot_dname_copy(zone, NULL);
+	if (entry->zone == NULL) {
+		free(entry);
+		return NULL;
+	}
+	entry->serial_from = serial_from;
+	entry->serial_to = zone_contents_serial(contents);
+	entry->contents = contents;
+	entry->size = entry_base_size(zone);
+	entry->limit = limit;
+
+	return entry;
+}
+
+int ixfr_cache_entry_append(ixfr_cache_entry_t *entry, const uint8_t *wire,
+                            size_t size, uint16_t ancount)
+{
+	assert(entry && wire);
+
+	if (size > IXFR_CACHE_MSG_MAX ||
+	    entry->size + sizeof(ixfr_cache_msg_t) + size > entry->limit) {
+		return KNOT_ESPACE;
+	}
+
+	if (entry->msg_count == entry->msg_alloc) {
+		size_t new_alloc = (entry->msg_alloc == 0) ? 4 : 2 * entry->msg_alloc;
+		ixfr_cache_msg_t *new_msgs = realloc(entry->msgs, new_alloc * sizeof(*new_msgs));
+		if (new_msgs == NULL) {
+			return KNOT_ENOMEM;
+		}
+		entry->msgs = new_msgs;
+		entry->msg_alloc = new_alloc;
+	}
+
+	ixfr_cache_msg_t *msg = &entry->msgs[entry->msg_count];
+	msg->wire = malloc(size);
+	if (msg->wire == NULL) {
+		return KNOT_ENOMEM;
+	}
+	memcpy(msg->wire, wire, size);
+	msg->size = size;
+	msg->ancount = ancount;
+	entry->msg_max = MAX(entry->msg_max, size);
+
+	entry->msg_count++;
+	entry->size += sizeof(*msg) + size;
+
+	return KNOT_EOK;
+}
+
+void ixfr_cache_entry_free(ixfr_cache_entry_t *entry)
+{
+	if (entry == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < entry->msg_count; i++) {
+		free(entry->msgs[i].wire);
+	}
+	free(entry->msgs);
+	knot_dname_free(entry->zone, NULL);
+	free(entry);
+}
+
+int ixfr_cache_insert(ixfr_cache_t *cache, ixfr_cache_entry_t *entry,
+                      const struct zone *zone)
+{
+	assert(cache && entry && zone);
+
+	if (entry->msg_count == 0) {
+		return KNOT_EINVAL;
+	}
+
+	int ret = KNOT_EOK;
+
+	pthread_mutex_lock(&cache->lock);
+
+	/* The zone changed during the transfer and the entry might
+	 * have already been invalidated. */
+	if (rcu_dereference(zone->contents) != entry->contents) {
+		ret = KNOT_EAGAIN;
+		goto done;
+	}
+
+	if (entry->size > cache->max_size) {
+		ret = KNOT_ESPACE;
+		goto done;
+	}
+
+	ixfr_cache_entry_t **chain = zone_chain(cache, entry->zone, true);
+	if (chain == NULL) {
+		ret = KNOT_ENOMEM;
+		goto done;
+	}
+	for (ixfr_cache_entry_t *it = *chain; it != NULL; it = it->next) {
+		if (it->serial_from == entry->serial_from &&
+		    it->contents == entry->contents &&
+		    it->msg_max == entry->msg_max) {
+			ret = KNOT_EEXIST;
+			goto done;
+		}
+	}
+
+	entry->next = *chain;
+	*chain = entry;
+	add_head(&cache->lru, &entry->n);
+	cache->size += entry->size;
+
+	evict(cache);
+done:
+	pthread_mutex_unlock(&cache->lock);
+
+	return ret;
+}
+
+void ixfr_cache_invalidate(ixfr_cache_t *cache, const knot_dname_t *zone)
+{
+	if (cache == NULL || cache->zones == NULL || zone == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&cache->lock);
+	ixfr_cache_entry_t **chain = zone_chain(cache, zone, false);
+	if (chain != NULL) {
+		ixfr_cache_entry_t *it = *chain;
+		trie_del(cache->zones, zone, knot_dname_size(zone), NULL);
+		while (it != NULL) {
+			ixfr_cache_entry_t *next = it->next;
+			entry_drop(cache, it);
+			it = next;
+		}
+	}
+	pthread_mutex_unlock(&cache->lock);
+}
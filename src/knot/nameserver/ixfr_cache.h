@@ -0,0 +1,174 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include "contrib/qp-trie/trie.h"
+#include "contrib/ucw/lists.h"
+#include "libknot/consts.h"
+#include "libknot/dname.h"
+
+struct zone;
+struct zone_contents;
+
+/*! \brief Largest answer section which is allowed to be cached. */
+#define IXFR_CACHE_MSG_MAX (KNOT_WIRE_MAX_PKTSIZE - KNOT_WIRE_HEADER_SIZE)
+
+/*!
+ * \brief Answer section of one IXFR-out message.
+ *
+ * The wire is only valid after the header and a question of the same
+ * length as the zone name (compression pointers refer to the QNAME).
+ */
+typedef struct {
+	uint8_t *wire;     //!< Answer section RRs in wire format.
+	uint16_t size;     //!< Size of the answer section.
+	uint16_t ancount;  //!< Number of RRs in the answer section.
+} ixfr_cache_msg_t;
+
+/*!
+ * \brief Encoded IXFR-out message sequence for one serial pair.
+ */
+typedef struct ixfr_cache_entry {
+	node_t n;                              //!< Node in the LRU list.
+	struct ixfr_cache_entry *next;         //!< Next entry of the same zone.
+	knot_dname_t *zone;                    //!< Zone name.
+	uint32_t serial_from;                  //!< Serial the secondary has.
+	uint32_t serial_to;                    //!< Serial of the cached contents.
+	const struct zone_contents *contents;  //!< Contents the transfer leads to.
+	ixfr_cache_msg_t *msgs;                //!< Message sequence.
+	size_t msg_count;                      //!< Number of messages.
+	size_t msg_alloc;                      //!< Allocated message slots.
+	size_t msg_max;                        //!< Largest answer section.
+	size_t size;                           //!< Memory accounted to the entry.
+	size_t limit;                          //!< Maximum size while capturing.
+	unsigned refs;                         //!< Number of transfers in progress.
+	bool unlinked;                         //!< Removed from cache, free when unused.
+} ixfr_cache_entry_t;
+
+/*!
+ * \brief Server-wide LRU cache of encoded IXFR-out message sequences.
+ */
+typedef struct {
+	pthread_mutex_t lock;  //!< Lock for accessing this structure.
+	trie_t *zones;         //!< Zone name -> chain of zone entries.
+	list_t lru;            //!< Entries, most recently used first.
+	size_t size;           //!< Memory occupied by all entries.
+	size_t max_size;       //!< Configured maximum size, 0 disables the cache.
+} ixfr_cache_t;
+
+/*!
+ * \brief Initialize IXFR cache.
+ *
+ * \param cache   Cache to be initialized.
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM
+ */
+int ixfr_cache_init(ixfr_cache_t *cache);
+
+/*!
+ * \brief Free all cache entries and deinitialize the cache.
+ */
+void ixfr_cache_deinit(ixfr_cache_t *cache);
+
+/*!
+ * \brief Set maximum size of the cache, evicting entries if necessary.
+ *
+ * \param cache      IXFR cache.
+ * \param max_size   New maximum size, 0 disables the cache.
+ */
+void ixfr_cache_set_max_size(ixfr_cache_t *cache, size_t max_size);
+
+/*!
+ * \brief Find an entry and take a reference to it.
+ *
+ * Entries captured with more space for the answer section than available
+ * (e.g. a shorter TSIG key or no EDNS) are skipped.
+ *
+ * \param cache         IXFR cache.
+ * \param zone          Zone name.
+ * \param serial_from   Serial the secondary has.
+ * \param contents      Current zone contents.
+ * \param room          Space available for the answer section of a message.
+ *
+ * \return Entry which must be returned with ixfr_cache_release(), or NULL.
+ */
+ixfr_cache_entry_t *ixfr_cache_get(ixfr_cache_t *cache, const knot_dname_t *zone,
+                                   uint32_t serial_from,
+                                   const struct zone_contents *contents,
+                                   size_t room);
+
+/*!
+ * \brief Return a reference taken by ixfr_cache_get().
+ */
+void ixfr_cache_release(ixfr_cache_t *cache, ixfr_cache_entry_t *entry);
+
+/*!
+ * \brief Create a new entry for capturing an outgoing IXFR.
+ *
+ * \param cache         IXFR cache.
+ * \param zone          Zone name.
+ * \param serial_from   Serial the secondary has.
+ * \param contents      Zone contents the transfer leads to.
+ *
+ * \return New entry or NULL if disabled or no memory.
+ */
+ixfr_cache_entry_t *ixfr_cache_entry_new(ixfr_cache_t *cache, const knot_dname_t *zone,
+                                         uint32_t serial_from,
+                                         const struct zone_contents *contents);
+
+/*!
+ * \brief Append the answer section of one message to the capturing entry.
+ *
+ * \param entry     Capturing entry.
+ * \param wire      Answer section RRs.
+ * \param size      Size of the answer section.
+ * \param ancount   Number of RRs in the answer section.
+ *
+ * \return KNOT_EOK, KNOT_ESPACE (too large for the cache), KNOT_ENOMEM
+ */
+int ixfr_cache_entry_append(ixfr_cache_entry_t *entry, const uint8_t *wire,
+                            size_t size, uint16_t ancount);
+
+/*!
+ * \brief Free an entry which is not inserted in the cache.
+ */
+void ixfr_cache_entry_free(ixfr_cache_entry_t *entry);
+
+/*!
+ * \brief Insert a captured entry into the cache.
+ *
+ * The entry is refused if the zone contents have changed meanwhile,
+ * so that no stale entry outlives ixfr_cache_invalidate().
+ *
+ * \param cache   IXFR cache.
+ * \param entry   Captured entry, owned by the cache on success.
+ * \param zone    Zone the entry belongs to.
+ *
+ * \return KNOT_EOK, KNOT_EEXIST, KNOT_EAGAIN (contents changed),
+ *         KNOT_ESPACE, KNOT_ENOMEM
+ */
+int ixfr_cache_insert(ixfr_cache_t *cache, ixfr_cache_entry_t *entry,
+                      const struct zone *zone);
+
+/*!
+ * \brief Drop all entries of the zone.
+ *
+ * \note Must be called after the zone contents pointer has been switched.
+ */
+void ixfr_cache_invalidate(ixfr_cache_t *cache, const knot_dname_t *zone);
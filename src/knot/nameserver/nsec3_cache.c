@@ -0,0 +1,119 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/dnssec/zone-nsec.h"
+#include "knot/nameserver/nsec3_cache.h"
+#include "libdnssec/error.h"
+#include "libknot/error.h"
+
+#define FNV_INIT	UINT64_C(14695981039346656037)
+#define FNV_PRIME	UINT64_C(1099511628211)
+
+static uint64_t fnv_add(uint64_t hash, const uint8_t *data, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash ^ data[i]) * FNV_PRIME;
+	}
+	return hash;
+}
+
+static uint64_t params_fingerprint(const dnssec_nsec3_params_t *params)
+{
+	uint8_t fixed[3] = { params->algorithm, params->iterations >> 8, params->iterations };
+	uint64_t hash = fnv_add(FNV_INIT, fixed, sizeof(fixed));
+	hash = fnv_add(hash, params->salt.data, params->salt.size);
+	return hash | 1;
+}
+
+/*! \brief Reallocate the table if the configured size changed. */
+static bool resize(nsec3_cache_t *cache)
+{
+	size_t max_size = __atomic_load_n(&cache->max_size, __ATOMIC_RELAXED);
+	size_t size = 0;
+	while (size < max_size && size * 2 <= max_size) {
+		size = (size == 0) ? 1 : size * 2;
+	}
+
+	if (size != cache->size) {
+		free(cache->entries);
+		cache->entries = (size > 0) ? calloc(size, sizeof(*cache->entries)) : NULL;
+		cache->size = (cache->entries != NULL) ? size : 0;
+	}
+
+	return cache->size > 0;
+}
+
+void nsec3_cache_set_size(nsec3_cache_t *cache, size_t max_size)
+{
+	assert(cache);
+
+	__atomic_store_n(&cache->max_size, max_size, __ATOMIC_RELAXED);
+}
+
+void nsec3_cache_deinit(nsec3_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	free(cache->entries);
+	dnssec_binary_free(&cache->scratch);
+	memset(cache, 0, sizeof(*cache));
+}
+
+int nsec3_cache_owner(nsec3_cache_t *cache, uint8_t *out, size_t out_size,
+                      const knot_dname_t *name, const knot_dname_t *zone_apex,
+                      const dnssec_nsec3_params_t *params)
+{
+	assert(out && name && zone_apex && params);
+
+	size_t name_size = knot_dname_size(name);
+	if (cache == NULL || name_size > NSEC3_CACHE_NAME_MAX || !resize(cache)) {
+		return knot_create_nsec3_owner(out, out_size, name, zone_apex, params);
+	}
+
+	uint64_t fingerprint = params_fingerprint(params);
+	uint64_t key = fnv_add(fingerprint, name, name_size);
+	nsec3_cache_entry_t *entry = &cache->entries[key & (cache->size - 1)];
+
+	if (entry->params == fingerprint && knot_dname_is_equal(entry->name, name)) {
+		cache->hits++;
+		return knot_nsec3_hash_to_dname(out, out_size, entry->hash,
+		                                entry->hash_size, zone_apex);
+	}
+
+	dnssec_binary_t data = { .data = (uint8_t *)name, .size = name_size };
+	int ret = dnssec_nsec3_hash(&data, params, &cache->scratch);
+	if (ret != DNSSEC_EOK) {
+		return knot_error_from_libdnssec(ret);
+	}
+	cache->misses++;
+
+	if (cache->scratch.size <= NSEC3_CACHE_HASH_MAX) {
+		entry->params = fingerprint;
+		entry->hash_size = cache->scratch.size;
+		memcpy(entry->hash, cache->scratch.data, cache->scratch.size);
+		memcpy(entry->name, name, name_size);
+	}
+
+	return knot_nsec3_hash_to_dname(out, out_size, cache->scratch.data,
+	                                cache->scratch.size, zone_apex);
+}
@@ -0,0 +1,80 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Per-thread cache of NSEC3 hashes of names.
+ *
+ * The NSEC3 hashes of existing names are precomputed in the zone, but the next
+ * closer name in a closest encloser proof must be hashed for each query. Each
+ * worker thread owns a cache so no locking is needed. The table is
+ * direct-mapped, a colliding name replaces the former one.
+ */
+
+#pragma once
+
+#include "libdnssec/nsec.h"
+#include "libknot/dname.h"
+
+#define NSEC3_CACHE_NAME_MAX	128 /*!< Longer names aren't cached. */
+#define NSEC3_CACHE_HASH_MAX	32
+
+typedef struct {
+	uint64_t params;                       //!< Fingerprint of NSEC3 parameters, 0 if empty.
+	uint8_t hash_size;                     //!< Size of the raw hash.
+	uint8_t hash[NSEC3_CACHE_HASH_MAX];    //!< Raw NSEC3 hash of the name.
+	uint8_t name[NSEC3_CACHE_NAME_MAX];    //!< Hashed name.
+} nsec3_cache_entry_t;
+
+typedef struct {
+	nsec3_cache_entry_t *entries;   //!< Table allocated upon first use.
+	size_t size;                    //!< Number of entries, power of two.
+	size_t max_size;                //!< Configured number of entries.
+	dnssec_binary_t scratch;        //!< Reused hash output buffer.
+	uint64_t hits;                  //!< Number of cache hits.
+	uint64_t misses;                //!< Number of computed hashes.
+} nsec3_cache_t;
+
+/*!
+ * \brief Set the maximum number of entries, 0 disables the cache.
+ *
+ * Can be called from another thread, the table is resized by its owner
+ * upon next use.
+ */
+void nsec3_cache_set_size(nsec3_cache_t *cache, size_t max_size);
+
+/*!
+ * \brief Free the cache, its owner thread must not be running.
+ */
+void nsec3_cache_deinit(nsec3_cache_t *cache);
+
+/*!
+ * \brief Create NSEC3 owner name for a name, using the cache if possible.
+ *
+ * \param cache      Cache of the current thread (can be NULL).
+ * \param out        Output buffer.
+ * \param out_size   Size of the output buffer.
+ * \param name       Name to be hashed (lower-case).
+ * \param zone_apex  Zone apex name.
+ * \param params     NSEC3 parameters of the zone.
+ *
+ * \return KNOT_E*
+ */
+int nsec3_cache_owner(nsec3_cache_t *cache, uint8_t *out, size_t out_size,
+                      const knot_dname_t *name, const knot_dname_t *zone_apex,
+                      const dnssec_nsec3_params_t *params);
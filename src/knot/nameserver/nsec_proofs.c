@@ -20,6 +20,8 @@
 #include "knot/nameserver/nsec_proofs.h"
 #include "knot/nameserver/internet.h"
 #include "knot/dnssec/zone-nsec.h"
+#include "knot/nameserver/nsec3_cache.h"
+#include "knot/server/server.h"
 
 /*!
  * \brief Check if node is empty non-terminal.
@@ -202,6 +204,19 @@ static int put_covering_nsec(const zone_contents_t *zone,
 	return put_nsec_from_node(proof, qdata, resp);
 }
 
+/*!
+ * \brief Get the NSEC3 hash cache of the current worker thread.
+ */
+static nsec3_cache_t *thread_nsec3_cache(knotd_qdata_t *qdata)
+{
+	server_t *server = qdata->params->server;
+	if (server == NULL || qdata->params->thread_id >= server->thread_cache_count) {
+		return NULL;
+	}
+
+	return &server->nsec3_caches[qdata->params->thread_id];
+}
+
 /*!
  * \brief Find NSEC3 covering the given name and put it into the response.
  */
@@ -213,7 +228,21 @@ static int put_covering_nsec3(const zone_contents_t *zone,
 	const zone_node_t *prev = NULL;
 	const zone_node_t *node = NULL;
 
-	int match = zone_contents_find_nsec3_for_name(zone, name, &node, &prev);
+	if (zone_tree_is_empty(zone->nsec3_nodes) || !knot_is_nsec3_enabled(zone)) {
+		// ignore if missing
+		return KNOT_EOK;
+	}
+
+	knot_dname_storage_t nsec3_name;
+	int ret = nsec3_cache_owner(thread_nsec3_cache(qdata), nsec3_name,
+	                            sizeof(nsec3_name), name, zone->apex->owner,
+	                            &zone->nsec3_params);
+	if (ret != KNOT_EOK) {
+		// ignore if missing
+		return KNOT_EOK;
+	}
+
+	int match = zone_contents_find_nsec3(zone, nsec3_name, &node, &prev);
 	if (match < 0) {
 		// ignore if missing
 		return KNOT_EOK;
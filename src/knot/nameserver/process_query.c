@@ -28,6 +28,7 @@
 #include "knot/nameserver/update.h"
 #include "knot/nameserver/nsec_proofs.h"
 #include "knot/nameserver/notify.h"
+#include "knot/nameserver/resp_cache.h"
 #include "knot/server/server.h"
 #include "libknot/libknot.h"
 #include "contrib/macros.h"
@@ -72,13 +73,17 @@ static void query_data_init(knot_layer_t *ctx, knotd_qdata_params_t *params,
 
 static int process_query_begin(knot_layer_t *ctx, void *params)
 {
-	/* Initialize context. */
+	/* Initialize context, use the query data provided by the caller. */
 	assert(ctx);
-	ctx->data = mm_alloc(ctx->mm, sizeof(knotd_qdata_t));
-	knotd_qdata_extra_t *extra = mm_alloc(ctx->mm, sizeof(*extra));
+	qdata_block_t *block = ctx->data;
+	if (block == NULL) {
+		block = mm_alloc(ctx->mm, sizeof(*block));
+		block->allocated = true;
+	}
+	ctx->data = &block->qdata;
 
 	/* Initialize persistent data. */
-	query_data_init(ctx, params, extra);
+	query_data_init(ctx, params, &block->extra);
 
 	/* Await packet. */
 	return KNOT_STATE_CONSUME;
@@ -110,8 +115,12 @@ static int process_query_reset(knot_layer_t *ctx)
 
 static int process_query_finish(knot_layer_t *ctx)
 {
+	qdata_block_t *block = ctx->data;
+
 	process_query_reset(ctx);
-	mm_free(ctx->mm, ctx->data);
+	if (block->allocated) {
+		mm_free(ctx->mm, block);
+	}
 	ctx->data = NULL;
 
 	return KNOT_STATE_NOOP;
@@ -454,6 +463,63 @@ static int prepare_answer(knot_pkt_t *query, knot_pkt_t *resp, knot_layer_t *ctx
 	return KNOT_EOK;
 }
 
+/*!
+ * \brief Get the response cache of the current thread if the query is eligible.
+ *
+ * Only plain queries without any processing depending on the client are
+ * answered from the cache.
+ */
+static resp_cache_t *answer_cache_prepare(knotd_qdata_t *qdata, const knot_pkt_t *resp,
+                                          bool has_plan, resp_cache_key_t *key)
+{
+	server_t *server = qdata->params->server;
+	const knot_pkt_t *query = qdata->query;
+
+	if (has_plan || server == NULL || qdata->params->thread_id >= server->thread_cache_count ||
+	    qdata->type != KNOTD_QUERY_TYPE_NORMAL || knot_pkt_qclass(query) != KNOT_CLASS_IN ||
+	    qdata->extra->contents == NULL || query->tsig_rr != NULL ||
+	    conf()->cache.srv_ans_rotate) {
+		return NULL;
+	}
+
+	uint8_t flags = 0;
+	if (qdata->params->flags & KNOTD_QUERY_FLAG_LIMIT_SIZE) {
+		flags |= RESP_CACHE_FLAG_LIMIT;
+	}
+	uint16_t payload = 0;
+	if (knot_pkt_has_edns(query)) {
+		if (query->opt_rr->rrs.rdata->len > 0) {
+			return NULL;
+		}
+		flags |= RESP_CACHE_FLAG_EDNS;
+		if (knot_pkt_has_dnssec(query)) {
+			flags |= RESP_CACHE_FLAG_DO;
+		}
+		payload = knot_edns_get_payload(&qdata->opt_rr);
+	}
+
+	resp_cache_key_init(key, knot_pkt_qname(query), knot_pkt_qtype(query),
+	                    flags, resp->max_size, payload);
+
+	return &server->resp_caches[qdata->params->thread_id];
+}
+
+/*! \brief Put a cached response into the packet. */
+static void answer_from_cache(knot_pkt_t *resp, knotd_qdata_t *qdata,
+                              const resp_cache_entry_t *entry)
+{
+	memcpy(resp->wire, resp_cache_entry_wire(entry), entry->wire_size);
+	resp->size = entry->wire_size;
+
+	knot_wire_set_id(resp->wire, knot_wire_get_id(qdata->query->wire));
+	if (knot_wire_get_rd(qdata->query->wire)) {
+		knot_wire_set_rd(resp->wire);
+	} else {
+		knot_wire_clear_rd(resp->wire);
+	}
+	process_query_qname_case_restore(resp, qdata);
+}
+
 static void set_rcode_to_packet(knot_pkt_t *pkt, knotd_qdata_t *qdata)
 {
 	uint8_t ext_rcode = KNOT_EDNS_RCODE_HI(qdata->rcode);
@@ -547,6 +613,8 @@ static int process_query_out(knot_layer_t *ctx, knot_pkt_t *pkt)
 	struct query_plan *plan = conf()->query_plan;
 	struct query_plan *zone_plan = NULL;
 	struct query_step *step;
+	resp_cache_t *cache = NULL;
+	resp_cache_key_t cache_key;
 
 	int next_state = KNOT_STATE_PRODUCE;
 
@@ -568,6 +636,20 @@ static int process_query_out(knot_layer_t *ctx, knot_pkt_t *pkt)
 		zone_plan = qdata->extra->zone->query_plan;
 	}
 
+	/* Answer from the response cache if possible. */
+	cache = answer_cache_prepare(qdata, pkt, plan != NULL || zone_plan != NULL,
+	                             &cache_key);
+	if (cache != NULL) {
+		const resp_cache_entry_t *entry = resp_cache_get(cache, &cache_key,
+		                                                 qdata->extra->contents->generation);
+		if (entry != NULL && entry->wire_size <= pkt->max_size) {
+			answer_from_cache(pkt, qdata, entry);
+			cache = NULL;
+			next_state = KNOT_STATE_FINAL;
+			goto finish;
+		}
+	}
+
 	/* Before query processing code. */
 	PROCESS_BEGIN(plan, step, next_state, qdata);
 	PROCESS_BEGIN(zone_plan, step, next_state, qdata);
@@ -627,6 +709,15 @@ finish:
 		break;
 	default:
 		set_rcode_to_packet(pkt, qdata);
+
+		/* Store the final response if it's eligible. */
+		if (cache != NULL && next_state == KNOT_STATE_DONE &&
+		    qdata->rcode_ede == KNOT_EDNS_EDE_NONE &&
+		    (qdata->rcode == KNOT_RCODE_NOERROR || qdata->rcode == KNOT_RCODE_NXDOMAIN) &&
+		    qdata->extra->contents != NULL) {
+			resp_cache_put(cache, &cache_key, qdata->extra->contents->generation,
+			               pkt->wire, pkt->size);
+		}
 	}
 
 	/* After query processing code. */
@@ -657,28 +748,30 @@ bool process_query_acl_check(conf_t *conf, acl_action_t action,
 		tsig.algorithm = knot_tsig_rdata_alg(query->tsig_rr);
 	}
 
-	/* Log ACL details. */
-	char addr_str[SOCKADDR_STRLEN];
-	if (sockaddr_tostr(addr_str, sizeof(addr_str), query_source) <= 0) {
-		addr_str[0] = '\0';
-	}
-	knot_dname_txt_storage_t key_name;
-	if (knot_dname_to_str(key_name, tsig.name, sizeof(key_name)) == NULL) {
-		key_name[0] = '\0';
-	}
-	const knot_lookup_t *act = knot_lookup_by_id((knot_lookup_t *)acl_actions, action);
-
 	conf_val_t acl = conf_zone_get(conf, C_ACL, zone_name);
 	bool allowed = acl_allowed(conf, &acl, action, query_source, &tsig, zone_name, query);
 
-	log_zone_debug(zone_name,
-	               "ACL, %s, action %s, remote %s, key %s%s%s",
-	               allowed ? "allowed" : "denied",
-	               (act != NULL) ? act->name : "query",
-	               addr_str,
-	               (key_name[0] != '\0') ? "'" : "",
-	               (key_name[0] != '\0') ? key_name : "none",
-	               (key_name[0] != '\0') ? "'" : "");
+	/* Log ACL details. */
+	if (log_enabled(LOG_DEBUG, LOG_SOURCE_ZONE)) {
+		char addr_str[SOCKADDR_STRLEN];
+		if (sockaddr_tostr(addr_str, sizeof(addr_str), query_source) <= 0) {
+			addr_str[0] = '\0';
+		}
+		knot_dname_txt_storage_t key_name;
+		if (knot_dname_to_str(key_name, tsig.name, sizeof(key_name)) == NULL) {
+			key_name[0] = '\0';
+		}
+		const knot_lookup_t *act = knot_lookup_by_id((knot_lookup_t *)acl_actions, action);
+
+		log_zone_debug(zone_name,
+		               "ACL, %s, action %s, remote %s, key %s%s%s",
+		               allowed ? "allowed" : "denied",
+		               (act != NULL) ? act->name : "query",
+		               addr_str,
+		               (key_name[0] != '\0') ? "'" : "",
+		               (key_name[0] != '\0') ? key_name : "none",
+		               (key_name[0] != '\0') ? "'" : "");
+	}
 
 	/* Check if authorized. */
 	if (!allowed) {
@@ -877,32 +970,20 @@ int process_query_put_rr(knot_pkt_t *pkt, knotd_qdata_t *qdata,
 		expand = knot_dname_is_wildcard(rr->owner);
 	}
 
-	int ret = KNOT_EOK;
-
 	/* If we already have compressed name on the wire and compression hint,
 	 * we can just insert RRSet and fake synthesis by using compression
-	 * hint. */
-	knot_rrset_t to_add;
-	if (compr_hint == KNOT_COMPR_HINT_NONE && expand) {
-		knot_dname_t *qname_cpy = knot_dname_copy(qdata->name, &pkt->mm);
-		if (qname_cpy == NULL) {
-			return KNOT_ENOMEM;
-		}
-		knot_rrset_init(&to_add, qname_cpy, rr->type, rr->rclass, rr->ttl);
-		ret = knot_rdataset_copy(&to_add.rrs, &rr->rrs, &pkt->mm);
-		if (ret != KNOT_EOK) {
-			knot_dname_free(qname_cpy, &pkt->mm);
-			return ret;
-		}
-		to_add.additional = rr->additional;
-		flags |= KNOT_PF_FREE;
-	} else {
-		to_add = *rr;
+	 * hint. Otherwise the zone RRSet is written with the QNAME as its owner
+	 * (packet-owned RRSets already carry the synthesized owner). */
+	knot_rrset_t to_add = *rr;
+	if (compr_hint == KNOT_COMPR_HINT_NONE && expand && !(flags & KNOT_PF_FREE)) {
+		to_add.owner = (knot_dname_t *)qdata->name;
+		/* Expanded RRSets were never considered duplicates. */
+		flags &= ~KNOT_PF_CHECKDUP;
 	}
 
 	uint16_t rotate = conf()->cache.srv_ans_rotate ? knot_wire_get_id(qdata->query->wire) : 0;
 	uint16_t prev_count = pkt->rrset_count;
-	ret = knot_pkt_put_rotate(pkt, compr_hint, &to_add, rotate, flags);
+	int ret = knot_pkt_put_rotate(pkt, compr_hint, &to_add, rotate, flags);
 	if (ret != KNOT_EOK && (flags & KNOT_PF_FREE)) {
 		knot_rrset_clear(&to_add, &pkt->mm);
 		return ret;
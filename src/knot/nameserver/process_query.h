@@ -44,6 +44,18 @@ typedef struct knotd_qdata_extra {
 	void (*ext_cleanup)(knotd_qdata_t *); /*!< Extensions cleanup callback. */
 } knotd_qdata_extra_t;
 
+/*!
+ * \brief Query data and its extension allocated at once.
+ *
+ * The caller can provide the block in the layer data before knot_layer_begin(),
+ * otherwise it's allocated from the layer memory context.
+ */
+typedef struct {
+	knotd_qdata_t qdata;
+	knotd_qdata_extra_t extra;
+	bool allocated;  /*!< Allocated by the layer. */
+} qdata_block_t;
+
 /*! \brief Visited wildcard node list. */
 struct wildcard_hit {
 	node_t n;
@@ -0,0 +1,174 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/nameserver/resp_cache.h"
+#include "libknot/wire.h"
+
+/*! \brief Expected average memory per entry, determines the number of slots. */
+#define SLOT_MEM	512
+
+#define FNV_INIT	UINT64_C(14695981039346656037)
+#define FNV_PRIME	UINT64_C(1099511628211)
+
+static size_t entry_size(const resp_cache_entry_t *entry)
+{
+	return sizeof(*entry) + entry->key_size + entry->wire_size;
+}
+
+static void flush(resp_cache_t *cache)
+{
+	for (size_t i = 0; i < cache->slot_count; i++) {
+		free(cache->slots[i]);
+	}
+	free(cache->slots);
+	cache->slots = NULL;
+	cache->slot_count = 0;
+	cache->size = 0;
+}
+
+/*! \brief Rebuild the table if the configured limit changed. */
+static bool resize(resp_cache_t *cache)
+{
+	size_t limit = __atomic_load_n(&cache->max_size, __ATOMIC_RELAXED);
+	if (limit == cache->limit) {
+		return cache->slot_count > 0;
+	}
+
+	flush(cache);
+	cache->limit = limit;
+
+	size_t count = 0;
+	while (count < limit / SLOT_MEM && count * 2 <= limit / SLOT_MEM) {
+		count = (count == 0) ? 1 : count * 2;
+	}
+	if (count == 0 && limit > 0) {
+		count = 1;
+	}
+
+	if (count > 0) {
+		cache->slots = calloc(count, sizeof(*cache->slots));
+		cache->slot_count = (cache->slots != NULL) ? count : 0;
+	}
+
+	return cache->slot_count > 0;
+}
+
+static resp_cache_entry_t **slot(resp_cache_t *cache, const resp_cache_key_t *key)
+{
+	return &cache->slots[key->hash & (cache->slot_count - 1)];
+}
+
+void resp_cache_set_size(resp_cache_t *cache, size_t max_size)
+{
+	assert(cache);
+
+	__atomic_store_n(&cache->max_size, max_size, __ATOMIC_RELAXED);
+}
+
+void resp_cache_deinit(resp_cache_t *cache)
+{
+	if (cache == NULL) {
+		return;
+	}
+
+	flush(cache);
+	memset(cache, 0, sizeof(*cache));
+}
+
+void resp_cache_key_init(resp_cache_key_t *key, const knot_dname_t *qname,
+                         uint16_t qtype, uint8_t flags, uint16_t max_size,
+                         uint16_t edns_payload)
+{
+	assert(key && qname);
+
+	uint8_t *pos = key->data;
+	*pos++ = flags;
+	knot_wire_write_u16(pos, qtype);
+	pos += sizeof(uint16_t);
+	knot_wire_write_u16(pos, max_size);
+	pos += sizeof(uint16_t);
+	knot_wire_write_u16(pos, edns_payload);
+	pos += sizeof(uint16_t);
+	size_t qname_size = knot_dname_size(qname);
+	memcpy(pos, qname, qname_size);
+	key->size = pos + qname_size - key->data;
+
+	key->hash = FNV_INIT;
+	for (size_t i = 0; i < key->size; i++) {
+		key->hash = (key->hash ^ key->data[i]) * FNV_PRIME;
+	}
+}
+
+const resp_cache_entry_t *resp_cache_get(resp_cache_t *cache,
+                                         const resp_cache_key_t *key,
+                                         uint64_t generation)
+{
+	assert(cache && key);
+
+	if (!resize(cache)) {
+		return NULL;
+	}
+
+	resp_cache_entry_t *entry = *slot(cache, key);
+	if (entry == NULL || entry->generation != generation ||
+	    entry->key_size != key->size || memcmp(entry->data, key->data, key->size) != 0) {
+		cache->misses++;
+		return NULL;
+	}
+
+	cache->hits++;
+	return entry;
+}
+
+void resp_cache_put(resp_cache_t *cache, const resp_cache_key_t *key,
+                    uint64_t generation, const uint8_t *wire, size_t size)
+{
+	assert(cache && key && wire);
+
+	if (!resize(cache) || size > UINT16_MAX) {
+		return;
+	}
+
+	resp_cache_entry_t **entry = slot(cache, key);
+	if (*entry != NULL) {
+		cache->size -= entry_size(*entry);
+		free(*entry);
+		*entry = NULL;
+	}
+
+	size_t new_size = sizeof(**entry) + key->size + size;
+	if (cache->size + new_size > cache->limit) {
+		return;
+	}
+
+	resp_cache_entry_t *new_entry = malloc(new_size);
+	if (new_entry == NULL) {
+		return;
+	}
+	new_entry->generation = generation;
+	new_entry->key_size = key->size;
+	new_entry->wire_size = size;
+	memcpy(new_entry->data, key->data, key->size);
+	memcpy(new_entry->data + key->size, wire, size);
+
+	*entry = new_entry;
+	cache->size += new_size;
+}
@@ -0,0 +1,132 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Per-thread cache of encoded responses.
+ *
+ * Responses to normal queries are kept in wire format, keyed by the lower-case
+ * QNAME, QTYPE, EDNS presence, DO bit and response size limits. An entry is
+ * only valid for the zone contents generation it was created from. Upon hit,
+ * the message ID, the RD flag and the QNAME case are patched from the query.
+ *
+ * Each worker thread owns a cache so no locking is needed. The table is
+ * direct-mapped, a colliding response replaces the former one.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "libknot/dname.h"
+
+#define RESP_CACHE_FLAG_EDNS	(1 << 0) /*!< The query has EDNS. */
+#define RESP_CACHE_FLAG_DO	(1 << 1) /*!< The query has the DO bit set. */
+#define RESP_CACHE_FLAG_LIMIT	(1 << 2) /*!< The response size is limited (UDP). */
+
+/*!
+ * \brief Response cache key.
+ */
+typedef struct {
+	uint64_t hash;                         //!< Hash of the key data.
+	uint16_t size;                         //!< Size of the key data.
+	uint8_t data[KNOT_DNAME_MAXLEN + 8];   //!< Key data.
+} resp_cache_key_t;
+
+/*!
+ * \brief Cached response.
+ */
+typedef struct {
+	uint64_t generation;   //!< Zone contents generation.
+	uint16_t key_size;     //!< Size of the key data.
+	uint16_t wire_size;    //!< Size of the response.
+	uint8_t data[];        //!< Key data followed by the response.
+} resp_cache_entry_t;
+
+/*!
+ * \brief Response cache.
+ */
+typedef struct {
+	resp_cache_entry_t **slots;   //!< Table allocated upon first use.
+	size_t slot_count;            //!< Number of slots, power of two.
+	size_t size;                  //!< Memory occupied by entries.
+	size_t limit;                 //!< Memory limit the table was built for.
+	size_t max_size;              //!< Configured memory limit.
+	uint64_t hits;                //!< Number of cache hits.
+	uint64_t misses;              //!< Number of cache misses.
+} resp_cache_t;
+
+/*!
+ * \brief Set the memory limit, 0 disables the cache.
+ *
+ * Can be called from another thread, the cache is flushed and resized by
+ * its owner upon next use.
+ */
+void resp_cache_set_size(resp_cache_t *cache, size_t max_size);
+
+/*!
+ * \brief Free the cache, its owner thread must not be running.
+ */
+void resp_cache_deinit(resp_cache_t *cache);
+
+/*!
+ * \brief Initialize the cache key.
+ *
+ * \param key          Key to be initialized.
+ * \param qname        Lower-case QNAME.
+ * \param qtype        QTYPE.
+ * \param flags        RESP_CACHE_FLAG_* flags.
+ * \param max_size     Maximum response size.
+ * \param edns_payload Payload size advertised in the response OPT.
+ */
+void resp_cache_key_init(resp_cache_key_t *key, const knot_dname_t *qname,
+                         uint16_t qtype, uint8_t flags, uint16_t max_size,
+                         uint16_t edns_payload);
+
+/*!
+ * \brief Find a cached response.
+ *
+ * \param cache       Cache of the current thread.
+ * \param key         Cache key.
+ * \param generation  Current zone contents generation.
+ *
+ * \return Cached response or NULL.
+ */
+const resp_cache_entry_t *resp_cache_get(resp_cache_t *cache,
+                                         const resp_cache_key_t *key,
+                                         uint64_t generation);
+
+/*!
+ * \brief Store a response.
+ *
+ * \param cache       Cache of the current thread.
+ * \param key         Cache key.
+ * \param generation  Zone contents generation the response comes from.
+ * \param wire        Response wire.
+ * \param size        Response size.
+ */
+void resp_cache_put(resp_cache_t *cache, const resp_cache_key_t *key,
+                    uint64_t generation, const uint8_t *wire, size_t size);
+
+/*! \brief Get the response wire of a cached entry. */
+static inline const uint8_t *resp_cache_entry_wire(const resp_cache_entry_t *entry)
+{
+	return entry->data + entry->key_size;
+}
@@ -0,0 +1,244 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "contrib/sockaddr.h"
+#include "knot/query/conn_pool.h"
+#include "libknot/errcode.h"
+
+conn_pool_t *global_conn_pool = NULL;
+
+/*! \brief Check if the remote hasn't closed the idle connection or sent garbage. */
+static bool conn_idle(int fd)
+{
+	struct pollfd pfd = { .fd = fd, .events = POLLIN };
+	return poll(&pfd, 1, 0) == 0;
+}
+
+static void memb_remove(conn_pool_t *pool, size_t idx, bool close_fd)
+{
+	assert(idx < pool->usage);
+
+	if (close_fd) {
+		close(pool->conns[idx].fd);
+	}
+	pool->conns[idx] = pool->conns[--pool->usage];
+}
+
+static size_t oldest(conn_pool_t *pool)
+{
+	assert(pool->usage > 0);
+
+	size_t res = 0;
+	for (size_t i = 1; i < pool->usage; i++) {
+		if (pool->conns[i].last_active < pool->conns[res].last_active) {
+			res = i;
+		}
+	}
+
+	return res;
+}
+
+/*! \brief Close expired connections, return the next expiration time or 0. */
+static knot_time_t close_idle(conn_pool_t *pool, knot_time_t now)
+{
+	knot_time_t next = 0;
+
+	for (size_t i = 0; i < pool->usage; ) {
+		knot_time_t expire = knot_time_add(pool->conns[i].last_active, pool->timeout);
+		if (expire <= now) {
+			memb_remove(pool, i, true);
+		} else {
+			next = knot_time_min(next, expire);
+			i++;
+		}
+	}
+
+	return next;
+}
+
+static int closing_run(dthread_t *thread)
+{
+	conn_pool_t *pool = thread->data;
+
+	pthread_mutex_lock(&pool->lock);
+	while (!dt_is_cancelled(thread)) {
+		knot_time_t next = close_idle(pool, knot_time());
+		if (next == 0) {
+			pthread_cond_wait(&pool->wakeup, &pool->lock);
+		} else {
+			struct timespec abstime = { .tv_sec = next };
+			pthread_cond_timedwait(&pool->wakeup, &pool->lock, &abstime);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return KNOT_EOK;
+}
+
+int conn_pool_init(conn_pool_t *pool)
+{
+	if (pool == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	memset(pool, 0, sizeof(*pool));
+	pthread_mutex_init(&pool->lock, NULL);
+	pthread_cond_init(&pool->wakeup, NULL);
+
+	pool->thread = dt_create(1, closing_run, NULL, pool);
+	if (pool->thread == NULL) {
+		conn_pool_deinit(pool);
+		return KNOT_ENOMEM;
+	}
+
+	return KNOT_EOK;
+}
+
+void conn_pool_deinit(conn_pool_t *pool)
+{
+	if (pool == NULL) {
+		return;
+	}
+
+	dt_delete(&pool->thread);
+
+	while (pool->usage > 0) {
+		memb_remove(pool, 0, true);
+	}
+	free(pool->conns);
+
+	pthread_cond_destroy(&pool->wakeup);
+	pthread_mutex_destroy(&pool->lock);
+	memset(pool, 0, sizeof(*pool));
+}
+
+void conn_pool_start(conn_pool_t *pool)
+{
+	dt_start(pool->thread);
+}
+
+void conn_pool_stop(conn_pool_t *pool)
+{
+	dt_stop(pool->thread);
+
+	pthread_mutex_lock(&pool->lock);
+	pthread_cond_signal(&pool->wakeup);
+	pthread_mutex_unlock(&pool->lock);
+}
+
+void conn_pool_join(conn_pool_t *pool)
+{
+	dt_join(pool->thread);
+}
+
+int conn_pool_set_limits(conn_pool_t *pool, size_t capacity, knot_timediff_t timeout)
+{
+	assert(pool);
+
+	int ret = KNOT_EOK;
+
+	pthread_mutex_lock(&pool->lock);
+
+	while (pool->usage > capacity) {
+		memb_remove(pool, oldest(pool), true);
+	}
+
+	if (capacity == 0) {
+		free(pool->conns);
+		pool->conns = NULL;
+		pool->capacity = 0;
+	} else if (capacity != pool->capacity) {
+		conn_pool_memb_t *conns = realloc(pool->conns, capacity * sizeof(*conns));
+		if (conns != NULL) {
+			pool->conns = conns;
+			pool->capacity = capacity;
+		} else {
+			ret = KNOT_ENOMEM;
+		}
+	}
+	pool->timeout = timeout;
+
+	pthread_cond_signal(&pool->wakeup);
+	pthread_mutex_unlock(&pool->lock);
+
+	return ret;
+}
+
+int conn_pool_get(conn_pool_t *pool, const struct sockaddr_storage *src,
+                  const struct sockaddr_storage *dst)
+{
+	if (pool == NULL) {
+		return -1;
+	}
+
+	int fd = -1;
+
+	pthread_mutex_lock(&pool->lock);
+	for (size_t i = pool->usage; fd < 0 && i-- > 0; ) {
+		conn_pool_memb_t *memb = &pool->conns[i];
+		if (sockaddr_cmp(&memb->dst, dst, false) != 0 ||
+		    sockaddr_cmp(&memb->src, src, false) != 0) {
+			continue;
+		}
+		if (conn_idle(memb->fd)) {
+			fd = memb->fd;
+			memb_remove(pool, i, false);
+		} else {
+			memb_remove(pool, i, true);
+		}
+	}
+	pthread_mutex_unlock(&pool->lock);
+
+	return fd;
+}
+
+void conn_pool_put(conn_pool_t *pool, const struct sockaddr_storage *src,
+                   const struct sockaddr_storage *dst, int fd)
+{
+	if (fd < 0) {
+		return;
+	}
+	if (pool == NULL) {
+		close(fd);
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	if (pool->capacity == 0) {
+		pthread_mutex_unlock(&pool->lock);
+		close(fd);
+		return;
+	}
+
+	if (pool->usage == pool->capacity) {
+		memb_remove(pool, oldest(pool), true);
+	}
+
+	conn_pool_memb_t *memb = &pool->conns[pool->usage++];
+	memcpy(&memb->src, src, sizeof(memb->src));
+	memcpy(&memb->dst, dst, sizeof(memb->dst));
+	memb->fd = fd;
+	memb->last_active = knot_time();
+
+	pthread_cond_signal(&pool->wakeup);
+	pthread_mutex_unlock(&pool->lock);
+}
@@ -0,0 +1,129 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * \brief Pool of idle outgoing TCP connections.
+ *
+ * Connections of successfully finished requests are kept open and reused
+ * by following requests to the same remote from the same source address.
+ * Connections idle for too long are closed by a separate thread.
+ */
+
+#pragma once
+
+#include <pthread.h>
+#include <sys/socket.h>
+
+#include "contrib/time.h"
+#include "knot/server/dthreads.h"
+
+/*!
+ * \brief Idle connection.
+ */
+typedef struct {
+	struct sockaddr_storage src;  //!< Source address (AF_UNSPEC if not set).
+	struct sockaddr_storage dst;  //!< Remote address.
+	int fd;                       //!< Connected socket.
+	knot_time_t last_active;      //!< Time the connection was returned to the pool.
+} conn_pool_memb_t;
+
+/*!
+ * \brief Connection pool.
+ */
+typedef struct {
+	pthread_mutex_t lock;         //!< Lock for accessing this structure.
+	pthread_cond_t wakeup;        //!< Wakes up the closing thread.
+	dt_unit_t *thread;            //!< Thread closing idle connections.
+	conn_pool_memb_t *conns;      //!< Idle connections.
+	size_t capacity;              //!< Maximum number of idle connections, 0 disables.
+	size_t usage;                 //!< Number of idle connections.
+	knot_timediff_t timeout;      //!< Idle timeout in seconds.
+} conn_pool_t;
+
+/*!
+ * \brief Connection pool used by the requestor (NULL if not available).
+ */
+extern conn_pool_t *global_conn_pool;
+
+/*!
+ * \brief Initialize connection pool, it's disabled until limits are set.
+ *
+ * \param pool  Pool to be initialized.
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM
+ */
+int conn_pool_init(conn_pool_t *pool);
+
+/*!
+ * \brief Close all idle connections and deinitialize the pool.
+ */
+void conn_pool_deinit(conn_pool_t *pool);
+
+/*!
+ * \brief Start the thread closing idle connections.
+ */
+void conn_pool_start(conn_pool_t *pool);
+
+/*!
+ * \brief Stop the thread closing idle connections.
+ */
+void conn_pool_stop(conn_pool_t *pool);
+
+/*!
+ * \brief Wait for the thread closing idle connections to finish.
+ */
+void conn_pool_join(conn_pool_t *pool);
+
+/*!
+ * \brief Set pool limits, superfluous connections are closed.
+ *
+ * \param pool      Connection pool.
+ * \param capacity  Maximum number of idle connections, 0 disables the pool.
+ * \param timeout   Idle timeout in seconds.
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM
+ */
+int conn_pool_set_limits(conn_pool_t *pool, size_t capacity, knot_timediff_t timeout);
+
+/*!
+ * \brief Take an idle connection out of the pool.
+ *
+ * Connections closed by the remote meanwhile are discarded.
+ *
+ * \param pool  Connection pool (optional).
+ * \param src   Source address (AF_UNSPEC if not set).
+ * \param dst   Remote address.
+ *
+ * \return Connected socket or -1 if none available.
+ */
+int conn_pool_get(conn_pool_t *pool, const struct sockaddr_storage *src,
+                  const struct sockaddr_storage *dst);
+
+/*!
+ * \brief Return a connection to the pool.
+ *
+ * If the pool is full, the least recently used connection is closed.
+ * The socket is closed if it can't be kept.
+ *
+ * \param pool  Connection pool (optional).
+ * \param src   Source address (AF_UNSPEC if not set).
+ * \param dst   Remote address.
+ * \param fd    Connected socket.
+ */
+void conn_pool_put(conn_pool_t *pool, const struct sockaddr_storage *src,
+                   const struct sockaddr_storage *dst, int fd);
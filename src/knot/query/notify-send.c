@@ -0,0 +1,98 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "knot/query/notify-send.h"
+#include "libknot/libknot.h"
+
+#define ATTEMPTS	3
+
+typedef struct {
+	notify_send_cb cb;
+	knot_rrset_t *soa;
+} notify_send_data_t;
+
+static void notify_data_free(void *ptr)
+{
+	notify_send_data_t *data = ptr;
+	knot_rrset_free(data->soa, NULL);
+	free(data);
+}
+
+static int notify_produce(udp_query_t *query, knot_pkt_t *pkt)
+{
+	notify_send_data_t *data = query->data;
+
+	// mandatory: NOTIFY opcode, AA flag, SOA qtype
+	knot_wire_set_opcode(pkt->wire, KNOT_OPCODE_NOTIFY);
+	knot_wire_set_aa(pkt->wire);
+	int ret = knot_pkt_put_question(pkt, query->zone, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+
+	// unsecure hint: new SOA
+	knot_pkt_begin(pkt, KNOT_ANSWER);
+	return knot_pkt_put(pkt, KNOT_COMPR_HINT_QNAME, data->soa, 0);
+}
+
+static void notify_done(udp_query_t *query, int ret)
+{
+	notify_send_data_t *data = query->data;
+
+	data->cb(query->ctx, ret, &query->targets[query->cur].remote.addr,
+	         knot_soa_serial(data->soa->rrs.rdata), query->rcode);
+}
+
+static const udp_query_api_t NOTIFY_SEND_API = {
+	.produce = notify_produce,
+	.done = notify_done,
+	.free_data = notify_data_free,
+	.attempts = ATTEMPTS,
+	.final_error = KNOT_EDENIED,
+	.replace = true,
+};
+
+int notify_send_submit(udp_engine_t *engine, const knot_dname_t *zone,
+                       const knot_rrset_t *soa, const udp_target_t *targets,
+                       size_t count, notify_send_cb cb, void *ctx)
+{
+	if (engine == NULL || zone == NULL || soa == NULL || targets == NULL ||
+	    count == 0 || cb == NULL || ctx == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	notify_send_data_t *data = calloc(1, sizeof(*data));
+	if (data == NULL) {
+		return KNOT_ENOMEM;
+	}
+	data->cb = cb;
+	data->soa = knot_rrset_copy(soa, NULL);
+	if (data->soa == NULL) {
+		free(data);
+		return KNOT_ENOMEM;
+	}
+
+	udp_query_t *query = udp_query_new(&NOTIFY_SEND_API, zone, targets, count,
+	                                   ctx, data);
+	if (query == NULL) {
+		notify_data_free(data);
+		return KNOT_ENOMEM;
+	}
+
+	return udp_engine_submit(engine, query);
+}
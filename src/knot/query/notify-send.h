@@ -0,0 +1,69 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Asynchronous outgoing NOTIFY.
+ *
+ * NOTIFY messages are sent by the UDP query engine, which also retransmits
+ * them, so that a slow or unresponsive secondary doesn't occupy the background
+ * workers. A NOTIFY submitted while another one of the same zone to the same
+ * remote is pending replaces it.
+ */
+
+#pragma once
+
+#include "knot/query/udp-engine.h"
+
+/*!
+ * \brief Callback with the result of the NOTIFY.
+ *
+ * Called from the engine thread once per submitted NOTIFY, unless replaced.
+ *
+ * \param ctx     Context passed to notify_send_submit().
+ * \param ret     KNOT_EOK if acknowledged, KNOT_EDENIED if the remote
+ *                responded with an error, or another error of the last
+ *                address tried.
+ * \param remote  Address of the last remote tried.
+ * \param serial  Notified SOA serial.
+ * \param rcode   Response code (if KNOT_EDENIED).
+ */
+typedef void (*notify_send_cb)(void *ctx, int ret,
+                               const struct sockaddr_storage *remote,
+                               uint32_t serial, uint16_t rcode);
+
+/*!
+ * \brief Submit a NOTIFY to one remote.
+ *
+ * The addresses of the remote are tried one by one until a response is received.
+ * Each address is tried several times before moving to the next one. Pending
+ * NOTIFYs can be cancelled by udp_engine_cancel() with the same context.
+ *
+ * \param engine   UDP query engine.
+ * \param zone     Zone name.
+ * \param soa      Zone SOA to be put into the answer section.
+ * \param targets  Addresses of the remote (TSIG keys are copied).
+ * \param count    Number of addresses.
+ * \param cb       Callback for the result.
+ * \param ctx      Callback context identifying the zone.
+ *
+ * \return KNOT_EOK, KNOT_ENOTSUP (disabled), KNOT_ENOMEM
+ */
+int notify_send_submit(udp_engine_t *engine, const knot_dname_t *zone,
+                       const knot_rrset_t *soa, const udp_target_t *targets,
+                       size_t count, notify_send_cb cb, void *ctx);
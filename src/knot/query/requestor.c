@@ -17,6 +17,7 @@
 #include <assert.h>
 
 #include "libknot/attribute.h"
+#include "knot/query/conn_pool.h"
 #include "knot/query/requestor.h"
 #include "libknot/errcode.h"
 #include "contrib/mempattern.h"
@@ -40,6 +41,15 @@ static int request_ensure_connected(knot_request_t *request)
 		return KNOT_EOK;
 	}
 
+	if (use_tcp(request)) {
+		request->fd = conn_pool_get(global_conn_pool, &request->source,
+		                            &request->remote);
+		if (request->fd >= 0) {
+			request->flags |= KNOT_REQUEST_REUSED;
+			return KNOT_EOK;
+		}
+	}
+
 	int sock_type = use_tcp(request) ? SOCK_STREAM : SOCK_DGRAM;
 	request->fd = net_connected_socket(sock_type,
 	                                   &request->remote,
@@ -52,6 +62,20 @@ static int request_ensure_connected(knot_request_t *request)
 	return KNOT_EOK;
 }
 
+/*! \brief Drop a pooled connection the remote closed meanwhile, use a new one. */
+static bool request_drop_reused(knot_request_t *request)
+{
+	if (!(request->flags & KNOT_REQUEST_REUSED)) {
+		return false;
+	}
+
+	request->flags &= ~KNOT_REQUEST_REUSED;
+	close(request->fd);
+	request->fd = -1;
+
+	return true;
+}
+
 static int request_send(knot_request_t *request, int timeout_ms)
 {
 	/* Initiate non-blocking connect if not connected. */
@@ -64,7 +88,8 @@ static int request_send(knot_request_t *request, int timeout_ms)
 	knot_pkt_t *query = request->query;
 	uint8_t *wire = query->wire;
 	size_t wire_len = query->size;
-	struct sockaddr_storage *tfo_addr = (request->flags & KNOT_REQUEST_TFO) ?
+	struct sockaddr_storage *tfo_addr = (request->flags & KNOT_REQUEST_TFO) &&
+	                                    !(request->flags & KNOT_REQUEST_REUSED) ?
 	                                    &request->remote : NULL;
 
 	/* Send query. */
@@ -75,6 +100,9 @@ static int request_send(knot_request_t *request, int timeout_ms)
 		ret = net_dgram_send(request->fd, wire, wire_len, NULL);
 	}
 	if (ret != wire_len) {
+		if (request_drop_reused(request)) {
+			return request_send(request, timeout_ms);
+		}
 		return KNOT_ECONN;
 	}
 
@@ -100,12 +128,20 @@ static int request_recv(knot_request_t *request, int timeout_ms)
 	}
 	if (ret <= 0) {
 		resp->size = 0;
+		if (ret != KNOT_ETIMEOUT && request_drop_reused(request)) {
+			/* Resend the query over a new connection. */
+			ret = request_send(request, timeout_ms);
+			return (ret == KNOT_EOK) ? request_recv(request, timeout_ms) : ret;
+		}
 		if (ret == 0) {
 			return KNOT_ECONN;
 		}
 		return ret;
 	}
 
+	/* The pooled connection is alive. */
+	request->flags &= ~KNOT_REQUEST_REUSED;
+
 	resp->size = ret;
 	return ret;
 }
@@ -263,6 +299,16 @@ static int request_consume(knot_requestor_t *req, knot_request_t *last,
 	return KNOT_EOK;
 }
 
+/*! \brief Close the connection possibly left in an inconsistent state. */
+static void request_close(knot_request_t *request)
+{
+	if (use_tcp(request) && request->fd >= 0) {
+		close(request->fd);
+		request->fd = -1;
+	}
+	request->flags &= ~KNOT_REQUEST_REUSED;
+}
+
 static bool layer_active(knot_layer_state_t state)
 {
 	switch (state) {
@@ -306,6 +352,7 @@ int knot_requestor_exec(knot_requestor_t *requestor, knot_request_t *request,
 		ret = request_io(requestor, request, timeout_ms);
 		if (ret != KNOT_EOK) {
 			knot_layer_finish(&requestor->layer);
+			request_close(request);
 			return ret;
 		}
 	}
@@ -323,5 +370,15 @@ int knot_requestor_exec(knot_requestor_t *requestor, knot_request_t *request,
 	/* Finish current query processing. */
 	knot_layer_finish(&requestor->layer);
 
+	/* Keep the connection for other requests to the remote. */
+	if (ret == KNOT_EOK && use_tcp(request) && request->fd >= 0 &&
+	    !(requestor->layer.flags & KNOT_REQUESTOR_CLOSE)) {
+		conn_pool_put(global_conn_pool, &request->source, &request->remote,
+		              request->fd);
+		request->fd = -1;
+	} else {
+		request_close(request);
+	}
+
 	return ret;
 }
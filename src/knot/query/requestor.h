@@ -28,6 +28,7 @@ typedef enum {
 	KNOT_REQUEST_NONE = 0,       /*!< Empty flag. */
 	KNOT_REQUEST_UDP  = 1 << 0,  /*!< Use UDP for requests. */
 	KNOT_REQUEST_TFO  = 1 << 1,  /*!< Enable TCP Fast Open for requests. */
+	KNOT_REQUEST_REUSED = 1 << 2, /*!< TCP connection taken from the connection pool. */
 } knot_request_flag_t;
 
 typedef enum {
@@ -106,6 +107,9 @@ void knot_requestor_clear(knot_requestor_t *requestor);
 /*!
  * \brief Execute a request.
  *
+ * TCP connections are taken from the global connection pool if possible.
+ * After a successful execution, the TCP connection is returned to the pool.
+ *
  * \param requestor  Requestor instance.
  * \param request    Request instance.
  * \param timeout_ms Timeout of each operation in miliseconds (-1 for infinity).
@@ -0,0 +1,87 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+
+#include "knot/query/soa-check.h"
+#include "libknot/libknot.h"
+
+typedef struct {
+	soa_check_cb cb;
+	uint32_t serial;
+} soa_check_data_t;
+
+static int soa_produce(udp_query_t *query, knot_pkt_t *pkt)
+{
+	return knot_pkt_put_question(pkt, query->zone, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+}
+
+static int soa_consume(udp_query_t *query, knot_pkt_t *pkt)
+{
+	soa_check_data_t *data = query->data;
+
+	const knot_pktsection_t *answer = knot_pkt_section(pkt, KNOT_ANSWER);
+	const knot_rrset_t *rr = answer->count == 1 ? knot_pkt_rr(answer, 0) : NULL;
+	if (!rr || rr->type != KNOT_RRTYPE_SOA || rr->rrs.count != 1) {
+		return KNOT_EMALF;
+	}
+
+	data->serial = knot_soa_serial(rr->rrs.rdata);
+
+	return KNOT_EOK;
+}
+
+static void soa_done(udp_query_t *query, int ret)
+{
+	soa_check_data_t *data = query->data;
+
+	data->cb(query->ctx, ret, &query->targets[query->cur].remote.addr,
+	         (ret == KNOT_EOK) ? data->serial : 0);
+}
+
+static const udp_query_api_t SOA_CHECK_API = {
+	.produce = soa_produce,
+	.consume = soa_consume,
+	.done = soa_done,
+	.free_data = free,
+	.attempts = 1,
+	.final_error = KNOT_ENOTSUP,
+};
+
+int soa_check_submit(udp_engine_t *engine, const knot_dname_t *zone,
+                     const udp_target_t *targets, size_t count,
+                     soa_check_cb cb, void *ctx)
+{
+	if (engine == NULL || zone == NULL || targets == NULL || count == 0 ||
+	    cb == NULL || ctx == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	soa_check_data_t *data = calloc(1, sizeof(*data));
+	if (data == NULL) {
+		return KNOT_ENOMEM;
+	}
+	data->cb = cb;
+
+	udp_query_t *query = udp_query_new(&SOA_CHECK_API, zone, targets, count,
+	                                   ctx, data);
+	if (query == NULL) {
+		free(data);
+		return KNOT_ENOMEM;
+	}
+
+	return udp_engine_submit(engine, query);
+}
@@ -0,0 +1,63 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Asynchronous SOA queries.
+ *
+ * SOA queries of secondary zones are sent by the UDP query engine, so that
+ * refreshing many zones doesn't occupy the background workers.
+ */
+
+#pragma once
+
+#include "knot/query/udp-engine.h"
+
+/*!
+ * \brief Callback with the result of the SOA check.
+ *
+ * Called from the engine thread once per submitted check.
+ *
+ * \param ctx     Context passed to soa_check_submit().
+ * \param ret     KNOT_EOK if a SOA was received, KNOT_ENOTSUP if the answer
+ *                was truncated, or another error of the last remote tried.
+ * \param remote  Address of the last remote tried.
+ * \param serial  Remote SOA serial (if KNOT_EOK).
+ */
+typedef void (*soa_check_cb)(void *ctx, int ret,
+                             const struct sockaddr_storage *remote,
+                             uint32_t serial);
+
+/*!
+ * \brief Submit a SOA check.
+ *
+ * The remotes are queried one by one until a SOA is received. The check can
+ * be cancelled by udp_engine_cancel() with the same context.
+ *
+ * \param engine   UDP query engine.
+ * \param zone     Zone name.
+ * \param targets  Remotes to be queried (TSIG keys are copied).
+ * \param count    Number of remotes.
+ * \param cb       Callback for the result.
+ * \param ctx      Callback context identifying the check.
+ *
+ * \return KNOT_EOK, KNOT_ENOTSUP (disabled), KNOT_EEXIST, KNOT_ENOMEM
+ */
+int soa_check_submit(udp_engine_t *engine, const knot_dname_t *zone,
+                     const udp_target_t *targets, size_t count,
+                     soa_check_cb cb, void *ctx);
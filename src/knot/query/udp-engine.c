@@ -0,0 +1,805 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "contrib/macros.h"
+#include "contrib/net.h"
+#include "contrib/sockaddr.h"
+#include "contrib/time.h"
+#include "knot/query/udp-engine.h"
+#include "libdnssec/random.h"
+#include "libknot/libknot.h"
+
+#define ID_COUNT	(UINT16_MAX + 1)
+#define RECV_BATCH	64
+#define TIMEOUT_DEFAULT	5000
+#define SOCKET_QUERIES	32	// Queries sent over one socket before it's replaced.
+
+/*! \brief UDP socket used by a limited number of queries. */
+typedef struct udp_socket {
+	node_t n;                      //!< Node in the list of sockets.
+	int fd;                        //!< Socket descriptor.
+	unsigned used;                 //!< Number of queries sent over the socket.
+	unsigned inflight;             //!< Number of queries waiting for a response.
+} socket_t;
+
+/*! \brief Remote with queries in flight or waiting. */
+typedef struct udp_remote {
+	node_t n;                      //!< Node in the list of ready remotes.
+	char key[SOCKADDR_STRLEN];     //!< Remote address as a string.
+	unsigned inflight;             //!< Number of queries in flight.
+	list_t waiting;                //!< Queries waiting for sending.
+	bool ready;                    //!< Remote is in the list of ready remotes.
+} remote_t;
+
+static unsigned remote_capacity(udp_engine_t *engine)
+{
+	// Already submitted queries are finished even if disabled meanwhile.
+	return MAX(engine->remote_limit, 1);
+}
+
+static remote_t *remote_get(udp_engine_t *engine, const struct sockaddr_storage *addr)
+{
+	char key[SOCKADDR_STRLEN] = { 0 };
+	if (sockaddr_tostr(key, sizeof(key), addr) <= 0) {
+		return NULL;
+	}
+
+	trie_val_t *val = trie_get_ins(engine->remotes, (const trie_key_t *)key, strlen(key));
+	if (val == NULL) {
+		return NULL;
+	}
+
+	if (*val == NULL) {
+		remote_t *remote = calloc(1, sizeof(*remote));
+		if (remote == NULL) {
+			trie_del(engine->remotes, (const trie_key_t *)key, strlen(key), NULL);
+			return NULL;
+		}
+		memcpy(remote->key, key, sizeof(key));
+		init_list(&remote->waiting);
+		*val = remote;
+	}
+
+	return *val;
+}
+
+/*! \brief Update membership in the ready list and free the remote if unused. */
+static void remote_update(udp_engine_t *engine, remote_t *remote)
+{
+	bool ready = !EMPTY_LIST(remote->waiting) &&
+	             remote->inflight < remote_capacity(engine);
+	if (ready && !remote->ready) {
+		add_tail(&engine->ready, &remote->n);
+		remote->ready = true;
+	} else if (!ready && remote->ready) {
+		rem_node(&remote->n);
+		remote->ready = false;
+	}
+
+	if (remote->inflight == 0 && EMPTY_LIST(remote->waiting)) {
+		trie_del(engine->remotes, (const trie_key_t *)remote->key,
+		         strlen(remote->key), NULL);
+		free(remote);
+	}
+}
+
+udp_query_t *udp_query_new(const udp_query_api_t *api, const knot_dname_t *zone,
+                           const udp_target_t *targets, size_t count,
+                           void *ctx, void *data)
+{
+	if (api == NULL || zone == NULL || targets == NULL || count == 0 ||
+	    ctx == NULL) {
+		return NULL;
+	}
+
+	udp_query_t *q = calloc(1, sizeof(*q));
+	if (q == NULL) {
+		return NULL;
+	}
+	q->api = api;
+	q->ctx = ctx;
+	q->zone = knot_dname_copy(zone, NULL);
+	q->targets = calloc(count, sizeof(*targets));
+	if (q->zone == NULL || q->targets == NULL) {
+		udp_query_free(q);
+		return NULL;
+	}
+	for (size_t i = 0; i < count; i++, q->count++) {
+		q->targets[i] = targets[i];
+		memset(&q->targets[i].remote.key, 0, sizeof(knot_tsig_key_t));
+		if (targets[i].remote.key.algorithm != DNSSEC_TSIG_UNKNOWN &&
+		    knot_tsig_key_copy(&q->targets[i].remote.key, &targets[i].remote.key) != KNOT_EOK) {
+			udp_query_free(q);
+			return NULL;
+		}
+	}
+	q->data = data;
+
+	return q;
+}
+
+void udp_query_free(udp_query_t *q)
+{
+	if (q == NULL) {
+		return;
+	}
+
+	for (size_t i = 0; i < q->count; i++) {
+		knot_tsig_key_deinit(&q->targets[i].remote.key);
+	}
+	if (q->data != NULL && q->api->free_data != NULL) {
+		q->api->free_data(q->data);
+	}
+	tsig_cleanup(&q->tsig);
+	free(q->targets);
+	knot_dname_free(q->zone, NULL);
+	free(q);
+}
+
+static bool query_inflight(udp_engine_t *engine, udp_query_t *q)
+{
+	return q->sock != NULL && engine->ids[q->id] == q;
+}
+
+static int query_enqueue(udp_engine_t *engine, udp_query_t *q)
+{
+	remote_t *remote = remote_get(engine, &q->targets[q->cur].remote.addr);
+	if (remote == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	q->remote = remote;
+	add_tail(&remote->waiting, &q->n);
+	remote_update(engine, remote);
+
+	return KNOT_EOK;
+}
+
+/*! \brief Remove the query from the chain of its context. */
+static void query_unchain(udp_engine_t *engine, udp_query_t *q)
+{
+	const trie_key_t *key = (const trie_key_t *)&q->ctx;
+	trie_val_t *val = trie_get_try(engine->queries, key, sizeof(q->ctx));
+	assert(val != NULL);
+
+	for (udp_query_t **it = (udp_query_t **)val; *it != NULL; it = &(*it)->next) {
+		if (*it == q) {
+			*it = q->next;
+			break;
+		}
+	}
+
+	if (*val == NULL) {
+		trie_del(engine->queries, key, sizeof(q->ctx), NULL);
+	}
+}
+
+/*! \brief Retransmit, continue with the next remote, or report the result. */
+static void query_next(udp_engine_t *engine, udp_query_t *q, int ret)
+{
+	bool again = false;
+	if (q->resend) {
+		// The result concerns replaced data, start over.
+		q->resend = false;
+		q->cur = 0;
+		q->attempt = 0;
+		again = true;
+	} else if (ret == KNOT_ETIMEOUT && q->attempt + 1 < q->api->attempts) {
+		q->attempt++;
+		again = true;
+	} else if (ret != KNOT_EOK && ret != q->api->final_error && q->cur + 1 < q->count) {
+		q->cur++;
+		q->attempt = 0;
+		again = true;
+	}
+
+	if (again) {
+		int enq = query_enqueue(engine, q);
+		if (enq == KNOT_EOK) {
+			return;
+		}
+		ret = enq;
+	}
+
+	query_unchain(engine, q);
+	q->api->done(q, ret);
+	udp_query_free(q);
+}
+
+/*! \brief Finish the query in flight. */
+static void query_finish(udp_engine_t *engine, udp_query_t *q, int ret)
+{
+	rem_node(&q->n);
+	engine->ids[q->id] = NULL;
+	engine->inflight_count--;
+
+	q->sock->inflight--;
+	q->sock = NULL;
+
+	remote_t *remote = q->remote;
+	q->remote = NULL;
+	remote->inflight--;
+	remote_update(engine, remote);
+
+	query_next(engine, q, ret);
+}
+
+static void socket_close(udp_engine_t *engine, socket_t *sock)
+{
+	rem_node(&sock->n);
+	engine->socket_count--;
+	close(sock->fd);
+	free(sock);
+}
+
+/*! \brief Close replaced sockets without queries in flight (engine thread only). */
+static void socket_sweep(udp_engine_t *engine)
+{
+	socket_t *sock, *nxt;
+	WALK_LIST_DELSAFE(sock, nxt, engine->sockets) {
+		if (sock->inflight == 0 && sock != engine->cur[0] && sock != engine->cur[1]) {
+			socket_close(engine, sock);
+		}
+	}
+}
+
+static int socket_get(udp_engine_t *engine, const struct sockaddr_storage *addr,
+                      socket_t **out)
+{
+	int idx = (addr->ss_family == AF_INET6) ? 1 : 0;
+	socket_t *sock = engine->cur[idx];
+	if (sock != NULL && sock->used < SOCKET_QUERIES) {
+		*out = sock;
+		return KNOT_EOK;
+	}
+
+	// A fresh socket gets a new random source port.
+	int fd = net_unbound_socket(SOCK_DGRAM, addr);
+	if (fd < 0) {
+		return fd;
+	}
+	sock = calloc(1, sizeof(*sock));
+	if (sock == NULL) {
+		close(fd);
+		return KNOT_ENOMEM;
+	}
+	sock->fd = fd;
+	add_tail(&engine->sockets, &sock->n);
+	engine->socket_count++;
+
+	// The replaced socket is closed once its queries are finished.
+	engine->cur[idx] = sock;
+	*out = sock;
+
+	return KNOT_EOK;
+}
+
+static int query_send(udp_engine_t *engine, udp_query_t *q, uint8_t *buf, size_t buf_size)
+{
+	udp_target_t *target = &q->targets[q->cur];
+	const struct sockaddr_storage *addr = &target->remote.addr;
+
+	socket_t *sock = NULL;
+	int ret = socket_get(engine, addr, &sock);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	sock->used++;
+
+	knot_pkt_t *pkt = knot_pkt_new(buf, buf_size, NULL);
+	if (pkt == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	query_init_pkt(pkt);
+	knot_wire_set_id(pkt->wire, q->id);
+
+	ret = q->api->produce(q, pkt);
+	if (ret == KNOT_EOK && !target->remote.no_edns) {
+		ret = query_put_edns(pkt, &target->edns);
+	}
+	if (ret == KNOT_EOK) {
+		tsig_cleanup(&q->tsig);
+		bool signed_query = (target->remote.key.algorithm != DNSSEC_TSIG_UNKNOWN);
+		tsig_init(&q->tsig, signed_query ? &target->remote.key : NULL);
+		ret = tsig_sign_packet(&q->tsig, pkt);
+	}
+	if (ret == KNOT_EOK &&
+	    sendto(sock->fd, pkt->wire, pkt->size, 0, (const struct sockaddr *)addr,
+	           sockaddr_len(addr)) != pkt->size) {
+		ret = knot_map_errno();
+	}
+	if (ret == KNOT_EOK) {
+		q->opcode = knot_wire_get_opcode(pkt->wire);
+		q->qtype = knot_pkt_qtype(pkt);
+		q->sock = sock;
+		sock->inflight++;
+	}
+
+	knot_pkt_free(pkt);
+
+	return ret;
+}
+
+static bool assign_id(udp_engine_t *engine, udp_query_t *q)
+{
+	uint16_t id = dnssec_random_uint16_t();
+	for (size_t i = 0; i < ID_COUNT; i++, id++) {
+		if (engine->ids[id] == NULL) {
+			engine->ids[id] = q;
+			q->id = id;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+static void send_ready(udp_engine_t *engine, uint8_t *buf, size_t buf_size)
+{
+	while (!EMPTY_LIST(engine->ready) && engine->inflight_count < ID_COUNT) {
+		remote_t *remote = HEAD(engine->ready);
+		assert(!EMPTY_LIST(remote->waiting));
+
+		udp_query_t *q = HEAD(remote->waiting);
+		rem_node(&q->n);
+
+		bool ok = assign_id(engine, q);
+		assert(ok);
+		(void)ok;
+
+		int ret = query_send(engine, q, buf, buf_size);
+		if (ret != KNOT_EOK) {
+			engine->ids[q->id] = NULL;
+			q->remote = NULL;
+			remote_update(engine, remote);
+			query_next(engine, q, ret);
+			continue;
+		}
+
+		q->deadline = time_now();
+		q->deadline.tv_sec += engine->timeout / 1000;
+		q->deadline.tv_nsec += (engine->timeout % 1000) * 1000000L;
+		if (q->deadline.tv_nsec >= 1000000000L) {
+			q->deadline.tv_sec++;
+			q->deadline.tv_nsec -= 1000000000L;
+		}
+
+		add_tail(&engine->inflight, &q->n);
+		engine->inflight_count++;
+		remote->inflight++;
+		// Round-robin over the remotes.
+		if (remote->ready) {
+			rem_node(&remote->n);
+			add_tail(&engine->ready, &remote->n);
+		}
+		remote_update(engine, remote);
+	}
+}
+
+/*! \brief Time out expired queries, return time to the next expiration. */
+static int expire(udp_engine_t *engine)
+{
+	struct timespec now = time_now();
+
+	while (!EMPTY_LIST(engine->inflight)) {
+		udp_query_t *q = HEAD(engine->inflight);
+		double left = time_diff_ms(&now, &q->deadline);
+		if (left > 0) {
+			return (int)left + 1;
+		}
+		query_finish(engine, q, KNOT_ETIMEOUT);
+	}
+
+	return -1;
+}
+
+static int process_pkt(udp_query_t *q, knot_pkt_t *pkt)
+{
+	if (knot_wire_get_tc(pkt->wire)) {
+		return KNOT_ENOTSUP;
+	}
+
+	int ret = tsig_verify_packet(&q->tsig, pkt);
+	if (ret != KNOT_EOK) {
+		return ret;
+	} else if (tsig_unsigned_count(&q->tsig) != 0) {
+		return KNOT_EMALF;
+	}
+
+	q->rcode = knot_pkt_ext_rcode(pkt);
+	if (q->rcode != KNOT_RCODE_NOERROR) {
+		return KNOT_EDENIED;
+	}
+
+	return (q->api->consume != NULL) ? q->api->consume(q, pkt) : KNOT_EOK;
+}
+
+static void process_response(udp_engine_t *engine, socket_t *sock, uint8_t *wire,
+                             size_t size, const struct sockaddr_storage *from)
+{
+	if (size < KNOT_WIRE_HEADER_SIZE || !knot_wire_get_qr(wire)) {
+		return;
+	}
+
+	udp_query_t *q = engine->ids[knot_wire_get_id(wire)];
+	if (q == NULL || q->sock != sock || knot_wire_get_opcode(wire) != q->opcode ||
+	    sockaddr_cmp(from, &q->targets[q->cur].remote.addr, false) != 0) {
+		return;
+	}
+
+	knot_pkt_t *pkt = knot_pkt_new(wire, size, NULL);
+	if (pkt == NULL) {
+		return;
+	}
+
+	int ret = knot_pkt_parse(pkt, 0);
+	if (ret == KNOT_EOK) {
+		if (knot_pkt_qtype(pkt) != q->qtype ||
+		    knot_pkt_qclass(pkt) != KNOT_CLASS_IN ||
+		    !knot_dname_is_case_equal(knot_pkt_qname(pkt), q->zone)) {
+			knot_pkt_free(pkt);
+			return; // Not a response to our query.
+		}
+		ret = process_pkt(q, pkt);
+	} else if (knot_wire_get_tc(wire)) {
+		ret = KNOT_ENOTSUP;
+	}
+	knot_pkt_free(pkt);
+
+	query_finish(engine, q, ret);
+}
+
+static void receive(udp_engine_t *engine, socket_t *sock, uint8_t *buf, size_t buf_size)
+{
+	for (int i = 0; i < RECV_BATCH; i++) {
+		struct sockaddr_storage from = { 0 };
+		socklen_t from_len = sizeof(from);
+		ssize_t len = recvfrom(sock->fd, buf, buf_size, 0, (struct sockaddr *)&from,
+		                       &from_len);
+		if (len < 0) {
+			break;
+		}
+
+		pthread_mutex_lock(&engine->lock);
+		process_response(engine, sock, buf, len, &from);
+		pthread_mutex_unlock(&engine->lock);
+	}
+}
+
+static int udp_engine_run(dthread_t *thread)
+{
+	udp_engine_t *engine = thread->data;
+
+	uint8_t *buf = malloc(KNOT_WIRE_MAX_PKTSIZE);
+	if (buf == NULL) {
+		return KNOT_ENOMEM;
+	}
+	struct pollfd *pfd = NULL;
+	size_t pfd_max = 0;
+
+	while (!dt_is_cancelled(thread)) {
+		pthread_mutex_lock(&engine->lock);
+		send_ready(engine, buf, KNOT_WIRE_MAX_PKTSIZE);
+		int timeout = expire(engine);
+		// Expired queries might have been queued for retransmission.
+		if (!EMPTY_LIST(engine->ready)) {
+			send_ready(engine, buf, KNOT_WIRE_MAX_PKTSIZE);
+			timeout = expire(engine);
+		}
+		socket_sweep(engine);
+
+		size_t nfds = 1 + engine->socket_count;
+		if (nfds > pfd_max) {
+			struct pollfd *new_pfd = realloc(pfd, nfds * sizeof(*pfd));
+			if (new_pfd != NULL) {
+				pfd = new_pfd;
+				pfd_max = nfds;
+			}
+		}
+		nfds = MIN(nfds, pfd_max);
+		if (nfds > 0) {
+			pfd[0] = (struct pollfd){ .fd = engine->wakeup[0], .events = POLLIN };
+		}
+		size_t i = 1;
+		socket_t *sock;
+		WALK_LIST(sock, engine->sockets) {
+			if (i >= nfds) {
+				break;
+			}
+			pfd[i++] = (struct pollfd){ .fd = sock->fd, .events = POLLIN };
+		}
+		pthread_mutex_unlock(&engine->lock);
+
+		if (nfds == 0) {
+			poll(NULL, 0, MIN(timeout, 100));
+			continue;
+		} else if (poll(pfd, nfds, timeout) <= 0) {
+			continue;
+		}
+
+		if (pfd[0].revents & POLLIN) {
+			uint8_t drain[64];
+			while (read(engine->wakeup[0], drain, sizeof(drain)) > 0);
+		}
+		// Sockets are added and closed by this thread only.
+		i = 1;
+		WALK_LIST(sock, engine->sockets) {
+			if (i >= nfds) {
+				break;
+			}
+			if (pfd[i++].revents & POLLIN) {
+				receive(engine, sock, buf, KNOT_WIRE_MAX_PKTSIZE);
+			}
+		}
+	}
+
+	free(pfd);
+	free(buf);
+
+	return KNOT_EOK;
+}
+
+static void wakeup(udp_engine_t *engine)
+{
+	uint8_t byte = 0;
+	if (write(engine->wakeup[1], &byte, sizeof(byte)) < 0) {
+		// Pipe full, the thread is going to wake up anyway.
+	}
+}
+
+static int set_nonblock(int fd)
+{
+	int flags = fcntl(fd, F_GETFL, 0);
+	if (flags < 0 || fcntl(fd, F_SETFL, flags | O_NONBLOCK) != 0) {
+		return knot_map_errno();
+	}
+
+	return KNOT_EOK;
+}
+
+int udp_engine_init(udp_engine_t *engine)
+{
+	if (engine == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	memset(engine, 0, sizeof(*engine));
+	engine->wakeup[0] = engine->wakeup[1] = -1;
+	pthread_mutex_init(&engine->lock, NULL);
+	init_list(&engine->sockets);
+	init_list(&engine->ready);
+	init_list(&engine->inflight);
+
+	engine->queries = trie_create(NULL);
+	engine->remotes = trie_create(NULL);
+	engine->ids = calloc(ID_COUNT, sizeof(*engine->ids));
+	if (engine->queries == NULL || engine->remotes == NULL || engine->ids == NULL) {
+		udp_engine_deinit(engine);
+		return KNOT_ENOMEM;
+	}
+
+	if (pipe(engine->wakeup) != 0) {
+		int ret = knot_map_errno();
+		engine->wakeup[0] = engine->wakeup[1] = -1;
+		udp_engine_deinit(engine);
+		return ret;
+	}
+	int ret = set_nonblock(engine->wakeup[0]);
+	if (ret == KNOT_EOK) {
+		ret = set_nonblock(engine->wakeup[1]);
+	}
+	if (ret != KNOT_EOK) {
+		udp_engine_deinit(engine);
+		return ret;
+	}
+
+	engine->thread = dt_create(1, udp_engine_run, NULL, engine);
+	if (engine->thread == NULL) {
+		udp_engine_deinit(engine);
+		return KNOT_ENOMEM;
+	}
+
+	return KNOT_EOK;
+}
+
+static int free_chain(trie_val_t *val, void *ctx)
+{
+	udp_query_t *q = *val;
+	while (q != NULL) {
+		udp_query_t *next = q->next;
+		udp_query_free(q);
+		q = next;
+	}
+	return KNOT_EOK;
+}
+
+static int free_remote(trie_val_t *val, void *ctx)
+{
+	free(*val);
+	return KNOT_EOK;
+}
+
+void udp_engine_deinit(udp_engine_t *engine)
+{
+	if (engine == NULL) {
+		return;
+	}
+
+	dt_delete(&engine->thread);
+
+	if (engine->queries != NULL) {
+		trie_apply(engine->queries, free_chain, NULL);
+		trie_free(engine->queries);
+	}
+	if (engine->remotes != NULL) {
+		trie_apply(engine->remotes, free_remote, NULL);
+		trie_free(engine->remotes);
+	}
+	free(engine->ids);
+
+	for (int i = 0; i < 2; i++) {
+		if (engine->wakeup[i] >= 0) {
+			close(engine->wakeup[i]);
+		}
+	}
+	socket_t *sock, *nxt;
+	WALK_LIST_DELSAFE(sock, nxt, engine->sockets) {
+		socket_close(engine, sock);
+	}
+
+	pthread_mutex_destroy(&engine->lock);
+	memset(engine, 0, sizeof(*engine));
+}
+
+void udp_engine_start(udp_engine_t *engine)
+{
+	dt_start(engine->thread);
+}
+
+void udp_engine_stop(udp_engine_t *engine)
+{
+	dt_stop(engine->thread);
+	wakeup(engine);
+}
+
+void udp_engine_join(udp_engine_t *engine)
+{
+	dt_join(engine->thread);
+}
+
+void udp_engine_set_limits(udp_engine_t *engine, unsigned remote_limit, int timeout)
+{
+	assert(engine);
+
+	pthread_mutex_lock(&engine->lock);
+	engine->remote_limit = remote_limit;
+	engine->timeout = (timeout > 0) ? timeout : TIMEOUT_DEFAULT;
+	pthread_mutex_unlock(&engine->lock);
+
+	wakeup(engine);
+}
+
+/*! \brief Replace the data of a pending query to the same remote, if any. */
+static bool replace(udp_engine_t *engine, udp_query_t *chain, udp_query_t *q)
+{
+	for (udp_query_t *it = chain; it != NULL; it = it->next) {
+		if (it->api == q->api && it->count == q->count &&
+		    sockaddr_cmp(&it->targets[0].remote.addr, &q->targets[0].remote.addr, false) == 0) {
+			void *data = it->data;
+			it->data = q->data;
+			q->data = data;
+			if (query_inflight(engine, it)) {
+				it->resend = true;
+			}
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int udp_engine_submit(udp_engine_t *engine, udp_query_t *q)
+{
+	if (engine == NULL || q == NULL) {
+		udp_query_free(q);
+		return KNOT_EINVAL;
+	}
+
+	pthread_mutex_lock(&engine->lock);
+
+	int ret = KNOT_EOK;
+	if (engine->remote_limit == 0) {
+		ret = KNOT_ENOTSUP;
+		goto done;
+	}
+
+	trie_val_t *val = trie_get_ins(engine->queries, (const trie_key_t *)&q->ctx,
+	                               sizeof(q->ctx));
+	if (val == NULL) {
+		ret = KNOT_ENOMEM;
+		goto done;
+	} else if (*val != NULL) {
+		if (!q->api->replace) {
+			ret = KNOT_EEXIST;
+			goto done;
+		} else if (replace(engine, *val, q)) {
+			goto done;
+		}
+	}
+
+	ret = query_enqueue(engine, q);
+	if (ret != KNOT_EOK) {
+		if (*val == NULL) {
+			trie_del(engine->queries, (const trie_key_t *)&q->ctx,
+			         sizeof(q->ctx), NULL);
+		}
+		goto done;
+	}
+	q->next = *val;
+	*val = q;
+	q = NULL;
+done:
+	pthread_mutex_unlock(&engine->lock);
+
+	if (q != NULL) {
+		udp_query_free(q);
+	} else {
+		wakeup(engine);
+	}
+
+	return ret;
+}
+
+size_t udp_engine_cancel(udp_engine_t *engine, void *ctx)
+{
+	if (engine == NULL || engine->queries == NULL) {
+		return 0;
+	}
+
+	pthread_mutex_lock(&engine->lock);
+
+	size_t count = 0;
+	trie_val_t val = NULL;
+	if (trie_del(engine->queries, (const trie_key_t *)&ctx, sizeof(ctx), &val) == KNOT_EOK) {
+		udp_query_t *q = val;
+		while (q != NULL) {
+			udp_query_t *next = q->next;
+			rem_node(&q->n);
+			if (query_inflight(engine, q)) {
+				engine->ids[q->id] = NULL;
+				engine->inflight_count--;
+				q->remote->inflight--;
+				q->sock->inflight--;
+			}
+			remote_update(engine, q->remote);
+			udp_query_free(q);
+			q = next;
+			count++;
+		}
+	}
+
+	pthread_mutex_unlock(&engine->lock);
+
+	return count;
+}
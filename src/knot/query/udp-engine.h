@@ -0,0 +1,198 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Asynchronous UDP queries.
+ *
+ * Queries of many zones are multiplexed over UDP sockets by a single thread,
+ * which also waits for the responses and retransmits. Each socket is used for
+ * a limited number of queries only, so that the source port keeps changing.
+ * The number of queries in flight to one remote is limited, other queries to
+ * the remote wait in a queue.
+ *
+ * The engine takes care of message IDs, EDNS, TSIG, and response matching.
+ * The query contents and the response processing are provided by the query
+ * type callbacks (e.g. SOA check, NOTIFY).
+ */
+
+#pragma once
+
+#include <pthread.h>
+
+#include "contrib/qp-trie/trie.h"
+#include "contrib/ucw/lists.h"
+#include "knot/conf/conf.h"
+#include "knot/nameserver/tsig_ctx.h"
+#include "knot/query/query.h"
+#include "knot/server/dthreads.h"
+
+/*!
+ * \brief Remote to be queried.
+ */
+typedef struct {
+	conf_remote_t remote;         //!< Remote address and TSIG key.
+	struct query_edns_data edns;  //!< EDNS data to be used (unless no_edns).
+} udp_target_t;
+
+struct udp_query;
+struct udp_remote;
+struct udp_socket;
+
+/*!
+ * \brief Query type callbacks and parameters.
+ *
+ * The callbacks are called from the engine thread with the engine locked.
+ */
+typedef struct {
+	/*! Put the question and other sections before EDNS into the query. */
+	int (*produce)(struct udp_query *query, knot_pkt_t *pkt);
+	/*! Process a NOERROR response with verified TSIG (optional). */
+	int (*consume)(struct udp_query *query, knot_pkt_t *pkt);
+	/*! Report the result, called once unless cancelled. */
+	void (*done)(struct udp_query *query, int ret);
+	/*! Free the query type data (optional). */
+	void (*free_data)(void *data);
+	unsigned attempts;  //!< Number of attempts to one remote if timed out.
+	int final_error;    //!< Error after which no other remote is tried.
+	bool replace;       //!< Replace data of a pending query with the same context and remote.
+} udp_query_api_t;
+
+/*!
+ * \brief One submitted query.
+ */
+typedef struct udp_query {
+	node_t n;                      //!< Node in the remote queue or in-flight list.
+	struct udp_query *next;        //!< Next query with the same context.
+	const udp_query_api_t *api;    //!< Query type callbacks.
+	void *ctx;                     //!< Context identifying the submitter.
+	void *data;                    //!< Query type data.
+	knot_dname_t *zone;            //!< Zone name.
+	udp_target_t *targets;         //!< Remotes to be tried.
+	size_t count;                  //!< Number of remotes.
+	size_t cur;                    //!< Currently tried remote.
+	unsigned attempt;              //!< Attempt to the current remote.
+	bool resend;                   //!< Data replaced while in flight.
+	uint8_t opcode;                //!< Opcode of the query in flight.
+	uint16_t qtype;                //!< Question type of the query in flight.
+	uint16_t id;                   //!< Message ID of the query in flight.
+	uint16_t rcode;                //!< Response code (if KNOT_EDENIED).
+	struct udp_remote *remote;     //!< State of the currently tried remote.
+	struct udp_socket *sock;       //!< Socket of the query in flight.
+	tsig_ctx_t tsig;               //!< TSIG context of the query in flight.
+	struct timespec deadline;      //!< Timeout of the query in flight.
+} udp_query_t;
+
+/*!
+ * \brief UDP query engine.
+ */
+typedef struct {
+	pthread_mutex_t lock;            //!< Lock for accessing this structure.
+	dt_unit_t *thread;               //!< Engine thread.
+	int wakeup[2];                   //!< Pipe for waking up the thread.
+	list_t sockets;                  //!< Open UDP sockets.
+	size_t socket_count;             //!< Number of open UDP sockets.
+	struct udp_socket *cur[2];       //!< Sockets for new queries (IPv4, IPv6).
+	trie_t *queries;                 //!< Submitted queries indexed by context.
+	trie_t *remotes;                 //!< Remotes with pending queries.
+	list_t ready;                    //!< Remotes with waiting queries and free capacity.
+	list_t inflight;                 //!< Queries sent, oldest first.
+	udp_query_t **ids;               //!< Queries sent, indexed by message ID.
+	size_t inflight_count;           //!< Number of queries sent.
+	unsigned remote_limit;           //!< Maximum queries in flight per remote, 0 disables.
+	int timeout;                     //!< Query timeout in milliseconds.
+} udp_engine_t;
+
+/*!
+ * \brief Initialize UDP query engine.
+ *
+ * \param engine  Engine to be initialized.
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM, or a pipe error.
+ */
+int udp_engine_init(udp_engine_t *engine);
+
+/*!
+ * \brief Deinitialize UDP query engine, pending queries are dropped.
+ */
+void udp_engine_deinit(udp_engine_t *engine);
+
+/*!
+ * \brief Start the engine thread.
+ */
+void udp_engine_start(udp_engine_t *engine);
+
+/*!
+ * \brief Stop the engine thread.
+ */
+void udp_engine_stop(udp_engine_t *engine);
+
+/*!
+ * \brief Wait for the engine thread to finish.
+ */
+void udp_engine_join(udp_engine_t *engine);
+
+/*!
+ * \brief Set engine limits.
+ *
+ * \param engine        UDP query engine.
+ * \param remote_limit  Maximum number of queries in flight per remote, 0 disables new queries.
+ * \param timeout       Query timeout in milliseconds, non-positive for default.
+ */
+void udp_engine_set_limits(udp_engine_t *engine, unsigned remote_limit, int timeout);
+
+/*!
+ * \brief Create a query to be submitted.
+ *
+ * \param api      Query type callbacks.
+ * \param zone     Zone name.
+ * \param targets  Remotes to be tried one by one (TSIG keys are copied).
+ * \param count    Number of remotes.
+ * \param ctx      Context identifying the submitter.
+ * \param data     Query type data, owned by the query if created.
+ *
+ * \return New query or NULL if an error occurred.
+ */
+udp_query_t *udp_query_new(const udp_query_api_t *api, const knot_dname_t *zone,
+                           const udp_target_t *targets, size_t count,
+                           void *ctx, void *data);
+
+/*!
+ * \brief Free a query which hasn't been submitted.
+ */
+void udp_query_free(udp_query_t *query);
+
+/*!
+ * \brief Submit a query, the engine takes its ownership even on failure.
+ *
+ * \param engine  UDP query engine.
+ * \param query   Query to be submitted.
+ *
+ * \return KNOT_EOK, KNOT_ENOTSUP (disabled), KNOT_EEXIST, KNOT_ENOMEM
+ */
+int udp_engine_submit(udp_engine_t *engine, udp_query_t *query);
+
+/*!
+ * \brief Cancel all pending queries of the context, no callback is called.
+ *
+ * \param engine  UDP query engine.
+ * \param ctx     Context of the submitted queries.
+ *
+ * \return Number of cancelled queries.
+ */
+size_t udp_engine_cancel(udp_engine_t *engine, void *ctx);
@@ -0,0 +1,112 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <assert.h>
+#include <string.h>
+
+#include "contrib/mempattern.h"
+#include "knot/server/query_arena.h"
+#include "libknot/errcode.h"
+
+/* The counter is written by the owning thread only. */
+#ifdef HAVE_ATOMIC
+ #define COUNTER_INC(dst) __atomic_store_n(&(dst), \
+                                           __atomic_load_n(&(dst), __ATOMIC_RELAXED) + 1, \
+                                           __ATOMIC_RELAXED)
+#else
+ #define COUNTER_INC(dst) ((dst)++)
+#endif
+
+/*! \brief Size of the memory pool chunk. */
+#define ARENA_CHUNK_SIZE (16 * MM_DEFAULT_BLKSIZE)
+
+static void *arena_alloc(void *ctx, size_t size)
+{
+	query_arena_t *arena = ctx;
+
+	if (arena->allocs != NULL) {
+		COUNTER_INC(*arena->allocs);
+	}
+
+	return mp_alloc(arena->pool, size);
+}
+
+int query_arena_init(query_arena_t *arena, uint64_t *allocs)
+{
+	assert(arena);
+
+	memset(arena, 0, sizeof(*arena));
+
+	arena->pool = mp_new(ARENA_CHUNK_SIZE);
+	if (arena->pool == NULL) {
+		return KNOT_ENOMEM;
+	}
+	arena->allocs = allocs;
+
+	arena->mm.ctx = arena;
+	arena->mm.alloc = arena_alloc;
+	arena->mm.free = NULL;
+
+	return KNOT_EOK;
+}
+
+void query_arena_deinit(query_arena_t *arena)
+{
+	if (arena == NULL || arena->pool == NULL) {
+		return;
+	}
+
+	mp_delete(arena->pool);
+	arena->pool = NULL;
+}
+
+void query_arena_begin(query_arena_t *arena, knot_layer_t *layer,
+                       knotd_qdata_params_t *params)
+{
+	assert(arena && layer && layer->mm == &arena->mm);
+
+	arena->qdata.allocated = false;
+	layer->data = &arena->qdata;
+
+	knot_layer_begin(layer, params);
+}
+
+knot_pkt_t *query_arena_query(query_arena_t *arena, void *wire, uint16_t len)
+{
+	assert(arena && wire);
+
+	knot_pkt_init(&arena->query, wire, len, &arena->mm, arena->query_rr_info,
+	              arena->query_rr, QUERY_ARENA_QUERY_RRS);
+
+	return &arena->query;
+}
+
+knot_pkt_t *query_arena_answer(query_arena_t *arena, void *wire, uint16_t len)
+{
+	assert(arena && wire);
+
+	knot_pkt_init(&arena->answer, wire, len, &arena->mm, arena->answer_rr_info,
+	              arena->answer_rr, QUERY_ARENA_ANSWER_RRS);
+
+	return &arena->answer;
+}
+
+void query_arena_flush(query_arena_t *arena)
+{
+	assert(arena);
+
+	mp_flush(arena->pool);
+}
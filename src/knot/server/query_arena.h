@@ -0,0 +1,90 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+/*!
+ * \file
+ *
+ * \brief Per-thread memory for query processing.
+ *
+ * The query and answer packets including their RR arrays and the query
+ * processing data are preallocated so that a typical query is processed
+ * without any allocation. The remaining
+ * per-query allocations are served from a memory pool flushed after each
+ * query and counted.
+ */
+
+#pragma once
+
+#include "contrib/ucw/mempool.h"
+#include "knot/nameserver/process_query.h"
+#include "libknot/packet/pkt.h"
+
+#define QUERY_ARENA_QUERY_RRS	4
+#define QUERY_ARENA_ANSWER_RRS	32
+
+typedef struct {
+	knot_mm_t mm;            /*!< Counting memory context for query processing. */
+	struct mempool *pool;    /*!< Per-query memory pool. */
+	uint64_t *allocs;        /*!< Allocation counter (optional). */
+
+	knot_pkt_t query;
+	knot_pkt_t answer;
+	knot_rrinfo_t query_rr_info[QUERY_ARENA_QUERY_RRS];
+	knot_rrset_t query_rr[QUERY_ARENA_QUERY_RRS];
+	knot_rrinfo_t answer_rr_info[QUERY_ARENA_ANSWER_RRS];
+	knot_rrset_t answer_rr[QUERY_ARENA_ANSWER_RRS];
+	qdata_block_t qdata;
+} query_arena_t;
+
+/*!
+ * \brief Initialize the arena.
+ *
+ * \param arena   Arena to be initialized.
+ * \param allocs  Counter of allocations from the arena memory context (optional).
+ *
+ * \return KNOT_EOK, KNOT_ENOMEM
+ */
+int query_arena_init(query_arena_t *arena, uint64_t *allocs);
+
+/*!
+ * \brief Free the arena memory pool.
+ */
+void query_arena_deinit(query_arena_t *arena);
+
+/*!
+ * \brief Start processing of a query with the arena query data.
+ *
+ * \param arena   Arena.
+ * \param layer   Query processing layer using the arena memory context.
+ * \param params  Query processing parameters.
+ */
+void query_arena_begin(query_arena_t *arena, knot_layer_t *layer,
+                       knotd_qdata_params_t *params);
+
+/*!
+ * \brief Initialize the arena query packet over the given wire.
+ */
+knot_pkt_t *query_arena_query(query_arena_t *arena, void *wire, uint16_t len);
+
+/*!
+ * \brief Initialize the arena answer packet over the given wire.
+ */
+knot_pkt_t *query_arena_answer(query_arena_t *arena, void *wire, uint16_t len);
+
+/*!
+ * \brief Release the per-query memory, the packets become invalid.
+ */
+void query_arena_flush(query_arena_t *arena);
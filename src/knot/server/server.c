@@ -37,6 +37,7 @@
 #include "knot/server/tcp-handler.h"
 #include "knot/zone/timers.h"
 #include "knot/zone/zonedb-load.h"
+#include "knot/worker/compute.h"
 #include "knot/worker/pool.h"
 #include "contrib/net.h"
 #include "contrib/openbsd/strlcat.h"
@@ -602,6 +603,19 @@ static int configure_sockets(conf_t *conf, server_t *s)
 	return KNOT_EOK;
 }
 
+/*! \brief Initialize the control lock so that exclusive commands aren't starved. */
+static void ctl_lock_init(pthread_rwlock_t *lock)
+{
+	pthread_rwlockattr_t attr;
+	pthread_rwlockattr_init(&attr);
+#ifdef __GLIBC__
+	/* Readers are preferred by default. */
+	pthread_rwlockattr_setkind_np(&attr, PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP);
+#endif
+	pthread_rwlock_init(lock, &attr);
+	pthread_rwlockattr_destroy(&attr);
+}
+
 int server_init(server_t *server, int bg_workers)
 {
 	if (server == NULL) {
@@ -629,7 +643,47 @@ int server_init(server_t *server, int bg_workers)
 		return ret;
 	}
 
+	ret = ixfr_cache_init(&server->ixfr_cache);
+	if (ret != KNOT_EOK) {
+		catalog_update_deinit(&server->catalog_upd);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return ret;
+	}
+
+	ret = udp_engine_init(&server->soa_check);
+	if (ret != KNOT_EOK) {
+		ixfr_cache_deinit(&server->ixfr_cache);
+		catalog_update_deinit(&server->catalog_upd);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return ret;
+	}
+
+	ret = udp_engine_init(&server->notify_send);
+	if (ret != KNOT_EOK) {
+		udp_engine_deinit(&server->soa_check);
+		ixfr_cache_deinit(&server->ixfr_cache);
+		catalog_update_deinit(&server->catalog_upd);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return ret;
+	}
+
+	ret = conn_pool_init(&server->conn_pool);
+	if (ret != KNOT_EOK) {
+		udp_engine_deinit(&server->notify_send);
+		udp_engine_deinit(&server->soa_check);
+		ixfr_cache_deinit(&server->ixfr_cache);
+		catalog_update_deinit(&server->catalog_upd);
+		worker_pool_destroy(server->workers);
+		evsched_deinit(&server->sched);
+		return ret;
+	}
+	global_conn_pool = &server->conn_pool;
+
 	zone_backups_init(&server->backup_ctxs);
+	ctl_lock_init(&server->ctl_lock);
 
 	char *catalog_dir = conf_db(conf(), C_CATALOG_DB);
 	conf_val_t catalog_size = conf_db_param(conf(), C_CATALOG_DB_MAX_SIZE);
@@ -660,10 +714,12 @@ void server_deinit(server_t *server)
 	}
 
 	zone_backups_deinit(&server->backup_ctxs);
+	pthread_rwlock_destroy(&server->ctl_lock);
 
 	/* Save zone timers. */
 	if (server->zone_db != NULL) {
 		log_info("updating persistent timer DB");
+		knot_zonedb_foreach(server->zone_db, zone_notified_apply);
 		int ret = zone_timers_write_all(&server->timerdb, server->zone_db);
 		if (ret != KNOT_EOK) {
 			log_warning("failed to update persistent timer DB (%s)",
@@ -676,10 +732,33 @@ void server_deinit(server_t *server)
 
 	/* Free threads and event handlers. */
 	worker_pool_destroy(server->workers);
+	compute_pool_deinit();
 
 	/* Free zone database. */
 	knot_zonedb_deep_free(&server->zone_db, true);
 
+	/* Free cached outgoing IXFRs. */
+	ixfr_cache_deinit(&server->ixfr_cache);
+
+	/* Free per-thread caches. */
+	for (unsigned i = 0; i < server->thread_cache_count; i++) {
+		nsec3_cache_deinit(&server->nsec3_caches[i]);
+		resp_cache_deinit(&server->resp_caches[i]);
+	}
+	free(server->nsec3_caches);
+	free(server->resp_caches);
+	free(server->query_allocs);
+
+	/* Free pending SOA queries. */
+	udp_engine_deinit(&server->soa_check);
+
+	/* Free pending NOTIFYs. */
+	udp_engine_deinit(&server->notify_send);
+
+	/* Close idle outgoing connections. */
+	global_conn_pool = NULL;
+	conn_pool_deinit(&server->conn_pool);
+
 	/* Free remaining events. */
 	evsched_deinit(&server->sched);
 
@@ -778,6 +857,15 @@ int server_start(server_t *server, bool async)
 	/* Start evsched handler. */
 	evsched_start(&server->sched);
 
+	/* Start asynchronous SOA queries. */
+	udp_engine_start(&server->soa_check);
+
+	/* Start asynchronous NOTIFYs. */
+	udp_engine_start(&server->notify_send);
+
+	/* Start closing idle outgoing connections. */
+	conn_pool_start(&server->conn_pool);
+
 	/* Start I/O handlers. */
 	server->state |= ServerRunning;
 	for (int proto = IO_UDP; proto <= IO_XDP; ++proto) {
@@ -799,7 +887,10 @@ void server_wait(server_t *server)
 	}
 
 	evsched_join(&server->sched);
+	udp_engine_join(&server->soa_check);
+	udp_engine_join(&server->notify_send);
 	worker_pool_join(server->workers);
+	conn_pool_join(&server->conn_pool);
 
 	for (int proto = IO_UDP; proto <= IO_XDP; ++proto) {
 		if (server->handlers[proto].size > 0) {
@@ -1034,6 +1125,10 @@ int server_reload(server_t *server)
 	if (full || (flags & (CONF_IO_FRLD_ZONES | CONF_IO_FRLD_ZONE))) {
 		server_update_zones(conf(), server);
 	}
+	if (!full) {
+		/* Reused zones have settings resolved from the old config. */
+		zonedb_reload_settings(conf(), server);
+	}
 
 	/* Free old config needed for module unload in zone reload. */
 	conf_free(old_conf);
@@ -1060,8 +1155,14 @@ void server_stop(server_t *server)
 
 	/* Stop scheduler. */
 	evsched_stop(&server->sched);
+	/* Stop asynchronous SOA queries. */
+	udp_engine_stop(&server->soa_check);
+	/* Stop asynchronous NOTIFYs. */
+	udp_engine_stop(&server->notify_send);
 	/* Interrupt background workers. */
 	worker_pool_stop(server->workers);
+	/* Stop closing idle outgoing connections. */
+	conn_pool_stop(&server->conn_pool);
 
 	/* Clear 'running' flag. */
 	server->state &= ~ServerRunning;
@@ -1134,6 +1235,87 @@ static int reconfigure_timer_db(conf_t *conf, server_t *server)
 	return ret;
 }
 
+static void reconfigure_ixfr_cache(conf_t *conf, server_t *server)
+{
+	conf_val_t val = conf_get(conf, C_SRV, C_IXFR_CACHE_SIZE);
+	ixfr_cache_set_max_size(&server->ixfr_cache, conf_int(&val));
+}
+
+static int configure_thread_caches(server_t *server)
+{
+	unsigned count = 0;
+	for (unsigned proto = IO_UDP; proto <= IO_XDP; ++proto) {
+		dt_unit_t *tu = server->handlers[proto].handler.unit;
+		count += (tu != NULL) ? tu->size : 0;
+	}
+
+	server->nsec3_caches = calloc(count, sizeof(*server->nsec3_caches));
+	server->resp_caches = calloc(count, sizeof(*server->resp_caches));
+	server->query_allocs = calloc(count, sizeof(*server->query_allocs));
+	if (server->nsec3_caches == NULL || server->resp_caches == NULL ||
+	    server->query_allocs == NULL) {
+		free(server->nsec3_caches);
+		free(server->resp_caches);
+		free(server->query_allocs);
+		server->nsec3_caches = NULL;
+		server->resp_caches = NULL;
+		server->query_allocs = NULL;
+		return KNOT_ENOMEM;
+	}
+	server->thread_cache_count = count;
+
+	return KNOT_EOK;
+}
+
+static void reconfigure_thread_caches(conf_t *conf, server_t *server)
+{
+	conf_val_t nsec3_val = conf_get(conf, C_SRV, C_NSEC3_CACHE_SIZE);
+	conf_val_t resp_val = conf_get(conf, C_SRV, C_RESP_CACHE_SIZE);
+	for (unsigned i = 0; i < server->thread_cache_count; i++) {
+		nsec3_cache_set_size(&server->nsec3_caches[i], conf_int(&nsec3_val));
+		resp_cache_set_size(&server->resp_caches[i], conf_int(&resp_val));
+	}
+}
+
+static void reconfigure_worker_limits(conf_t *conf, server_t *server)
+{
+	conf_val_t val = conf_get(conf, C_SRV, C_BG_REFRESH_LIMIT);
+	worker_pool_set_limit(server->workers, WORKER_PRIO_REFRESH, conf_int(&val));
+
+	val = conf_get(conf, C_SRV, C_BG_MAINT_LIMIT);
+	int64_t maint_limit = conf_int(&val);
+	if (maint_limit == YP_NIL) {
+		maint_limit = (conf->cache.srv_bg_threads + 1) / 2;
+	}
+	worker_pool_set_limit(server->workers, WORKER_PRIO_MAINTENANCE, maint_limit);
+}
+
+static void reconfigure_soa_check(conf_t *conf, server_t *server)
+{
+	conf_val_t val = conf_get(conf, C_SRV, C_SOA_QUERY_LIMIT);
+	udp_engine_set_limits(&server->soa_check, conf_int(&val),
+	                      conf->cache.srv_tcp_remote_io_timeout);
+}
+
+static void reconfigure_notify_send(conf_t *conf, server_t *server)
+{
+	conf_val_t val = conf_get(conf, C_SRV, C_NOTIFY_QUERY_LIMIT);
+	udp_engine_set_limits(&server->notify_send, conf_int(&val),
+	                      conf->cache.srv_tcp_remote_io_timeout);
+}
+
+static void reconfigure_conn_pool(conf_t *conf, server_t *server)
+{
+	conf_val_t limit_val = conf_get(conf, C_SRV, C_RMT_POOL_LIMIT);
+	conf_val_t timeout_val = conf_get(conf, C_SRV, C_RMT_POOL_TIMEOUT);
+	int ret = conn_pool_set_limits(&server->conn_pool, conf_int(&limit_val),
+	                               conf_int(&timeout_val));
+	if (ret != KNOT_EOK) {
+		log_error("failed to reconfigure connection pool (%s)",
+		          knot_strerror(ret));
+	}
+}
+
 int server_reconfigure(conf_t *conf, server_t *server)
 {
 	if (conf == NULL || server == NULL) {
@@ -1167,6 +1349,13 @@ int server_reconfigure(conf_t *conf, server_t *server)
 			return ret;
 		}
 
+		/* Configure per-thread caches. */
+		if ((ret = configure_thread_caches(server)) != KNOT_EOK) {
+			log_error("failed to configure thread caches (%s)",
+			          knot_strerror(ret));
+			return ret;
+		}
+
 		if (conf_lmdb_readers(conf) > CONF_MAX_DB_READERS) {
 			log_warning("config, exceeded number of database readers");
 		}
@@ -1190,6 +1379,24 @@ int server_reconfigure(conf_t *conf, server_t *server)
 		          knot_strerror(ret));
 	}
 
+	/* Reconfigure IXFR cache. */
+	reconfigure_ixfr_cache(conf, server);
+
+	/* Reconfigure per-thread caches. */
+	reconfigure_thread_caches(conf, server);
+
+	/* Reconfigure SOA check limits. */
+	reconfigure_soa_check(conf, server);
+
+	/* Reconfigure NOTIFY limits. */
+	reconfigure_notify_send(conf, server);
+
+	/* Reconfigure outgoing connection pool. */
+	reconfigure_conn_pool(conf, server);
+
+	/* Reconfigure background worker limits. */
+	reconfigure_worker_limits(conf, server);
+
 	return KNOT_EOK;
 }
 
@@ -1220,3 +1427,36 @@ void server_update_zones(conf_t *conf, server_t *server)
 		knot_zonedb_foreach(server->zone_db, zone_events_start);
 	}
 }
+
+void server_update_catalog_zones(conf_t *conf, server_t *server)
+{
+	if (conf == NULL || server == NULL) {
+		return;
+	}
+
+	if (server->zone_db == NULL) {
+		server_update_zones(conf, server);
+		return;
+	}
+
+	/* Suspend adding events to worker pool queue, wait for queued events.
+	 * Only the affected zones are frozen when being replaced. */
+	evsched_pause(&server->sched);
+	worker_pool_wait(server->workers);
+
+	/* Apply catalog changes and free removed or replaced zones. */
+	zonedb_update_catalog(conf, server);
+
+	/* Resume processing events, new zones have been already planned. */
+	evsched_resume(&server->sched);
+}
+
+uint64_t *server_query_allocs(server_t *server, unsigned thread_id)
+{
+	if (server == NULL || server->query_allocs == NULL ||
+	    thread_id >= server->thread_cache_count) {
+		return NULL;
+	}
+
+	return &server->query_allocs[thread_id];
+}
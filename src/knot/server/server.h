@@ -21,6 +21,11 @@
 #include "knot/common/evsched.h"
 #include "knot/common/fdset.h"
 #include "knot/journal/knot_lmdb.h"
+#include "knot/nameserver/ixfr_cache.h"
+#include "knot/nameserver/nsec3_cache.h"
+#include "knot/nameserver/resp_cache.h"
+#include "knot/query/conn_pool.h"
+#include "knot/query/udp-engine.h"
 #include "knot/server/dthreads.h"
 #include "knot/worker/pool.h"
 #include "knot/zone/backup.h"
@@ -86,6 +91,24 @@ typedef struct server {
 	knot_lmdb_db_t kaspdb;
 	catalog_t catalog;
 
+	/*! \brief Encoded outgoing IXFRs. */
+	ixfr_cache_t ixfr_cache;
+
+	/*! \brief Per-thread caches indexed by thread ID. */
+	nsec3_cache_t *nsec3_caches;
+	resp_cache_t *resp_caches;
+	uint64_t *query_allocs;
+	unsigned thread_cache_count;
+
+	/*! \brief Asynchronous SOA queries of secondary zones. */
+	udp_engine_t soa_check;
+
+	/*! \brief Asynchronous outgoing NOTIFYs. */
+	udp_engine_t notify_send;
+
+	/*! \brief Idle outgoing TCP connections. */
+	conn_pool_t conn_pool;
+
 	/*! \brief I/O handlers. */
 	struct {
 		unsigned size;
@@ -107,6 +130,9 @@ typedef struct server {
 
 	/*! \brief Context of pending zones' backup. */
 	zone_backup_ctxs_t backup_ctxs;
+
+	/*! \brief Serialization of control commands and reloads. */
+	pthread_rwlock_t ctl_lock;
 } server_t;
 
 /*!
@@ -175,3 +201,17 @@ int server_reconfigure(conf_t *conf, server_t *server);
  * Routine for dynamic server zones reconfiguration.
  */
 void server_update_zones(conf_t *conf, server_t *server);
+
+/*!
+ * \brief Apply pending catalog changes to the zone database.
+ *
+ * Only the zones affected by the catalog changes are processed.
+ */
+void server_update_catalog_zones(conf_t *conf, server_t *server);
+
+/*!
+ * \brief Get the query processing allocation counter of the given thread.
+ *
+ * \return Counter or NULL if not available.
+ */
+uint64_t *server_query_allocs(server_t *server, unsigned thread_id);
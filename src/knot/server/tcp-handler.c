@@ -35,17 +35,17 @@
 #include "knot/common/fdset.h"
 #include "knot/nameserver/process_query.h"
 #include "knot/query/layer.h"
+#include "knot/server/query_arena.h"
 #include "contrib/macros.h"
-#include "contrib/mempattern.h"
 #include "contrib/net.h"
 #include "contrib/openbsd/strlcpy.h"
 #include "contrib/sockaddr.h"
 #include "contrib/time.h"
-#include "contrib/ucw/mempool.h"
 
 /*! \brief TCP context data. */
 typedef struct tcp_context {
 	knot_layer_t layer;              /*!< Query processing layer. */
+	query_arena_t arena;             /*!< Per-query packets and memory. */
 	server_t *server;                /*!< Name server structure. */
 	struct iovec iov[2];             /*!< TX/RX buffers. */
 	unsigned client_threshold;       /*!< Index of first TCP client. */
@@ -186,11 +186,11 @@ static int tcp_handle(tcp_context_t *tcp, int fd, struct iovec *rx, struct iovec
 	}
 
 	/* Initialize processing layer. */
-	knot_layer_begin(&tcp->layer, &params);
+	query_arena_begin(&tcp->arena, &tcp->layer, &params);
 
-	/* Create packets. */
-	knot_pkt_t *ans = knot_pkt_new(tx->iov_base, tx->iov_len, tcp->layer.mm);
-	knot_pkt_t *query = knot_pkt_new(rx->iov_base, rx->iov_len, tcp->layer.mm);
+	/* Initialize preallocated packets. */
+	knot_pkt_t *ans = query_arena_answer(&tcp->arena, tx->iov_base, tx->iov_len);
+	knot_pkt_t *query = query_arena_query(&tcp->arena, rx->iov_base, rx->iov_len);
 
 	/* Input packet. */
 	int ret = knot_pkt_parse(query, 0);
@@ -217,8 +217,8 @@ static int tcp_handle(tcp_context_t *tcp, int fd, struct iovec *rx, struct iovec
 	/* Reset after processing. */
 	knot_layer_finish(&tcp->layer);
 
-	/* Flush per-query memory (including query and answer packets). */
-	mp_flush(tcp->layer.mm->ctx);
+	/* Flush per-query memory. */
+	query_arena_flush(&tcp->arena);
 
 	return ret;
 }
@@ -319,19 +319,18 @@ int tcp_master(dthread_t *thread)
 	}
 #endif
 
-	int ret = KNOT_EOK;
-
-	/* Create big enough memory cushion. */
-	knot_mm_t mm;
-	mm_ctx_mempool(&mm, 16 * MM_DEFAULT_BLKSIZE);
-
 	/* Create TCP answering context. */
 	tcp_context_t tcp = {
 		.server = handler->server,
 		.is_throttled = false,
 		.thread_id = thread_id,
 	};
-	knot_layer_init(&tcp.layer, &mm, process_query_layer());
+	int ret = query_arena_init(&tcp.arena, server_query_allocs(handler->server,
+	                                                           thread_id));
+	if (ret != KNOT_EOK) {
+		goto finish;
+	}
+	knot_layer_init(&tcp.layer, &tcp.arena.mm, process_query_layer());
 
 	/* Create iovec abstraction. */
 	for (unsigned i = 0; i < 2; ++i) {
@@ -381,7 +380,7 @@ int tcp_master(dthread_t *thread)
 finish:
 	free(tcp.iov[0].iov_base);
 	free(tcp.iov[1].iov_base);
-	mp_delete(mm.ctx);
+	query_arena_deinit(&tcp.arena);
 	fdset_clear(&tcp.set);
 
 	return ret;
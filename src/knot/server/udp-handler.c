@@ -37,6 +37,7 @@
 #include "knot/common/fdset.h"
 #include "knot/nameserver/process_query.h"
 #include "knot/query/layer.h"
+#include "knot/server/query_arena.h"
 #include "knot/server/server.h"
 #include "knot/server/udp-handler.h"
 #include "knot/server/xdp-handler.h"
@@ -50,9 +51,10 @@ enum {
 
 /*! \brief UDP context data. */
 typedef struct {
-	knot_layer_t layer; /*!< Query processing layer. */
-	server_t *server;   /*!< Name server structure. */
-	unsigned thread_id; /*!< Thread identifier. */
+	knot_layer_t layer;   /*!< Query processing layer. */
+	query_arena_t arena;  /*!< Per-query packets and memory. */
+	server_t *server;     /*!< Name server structure. */
+	unsigned thread_id;   /*!< Thread identifier. */
 } udp_context_t;
 
 static bool udp_state_active(int state)
@@ -75,11 +77,11 @@ static void udp_handle(udp_context_t *udp, int fd, struct sockaddr_storage *ss,
 	};
 
 	/* Start query processing. */
-	knot_layer_begin(&udp->layer, &params);
+	query_arena_begin(&udp->arena, &udp->layer, &params);
 
-	/* Create packets. */
-	knot_pkt_t *query = knot_pkt_new(rx->iov_base, rx->iov_len, udp->layer.mm);
-	knot_pkt_t *ans = knot_pkt_new(tx->iov_base, tx->iov_len, udp->layer.mm);
+	/* Initialize preallocated packets. */
+	knot_pkt_t *query = query_arena_query(&udp->arena, rx->iov_base, rx->iov_len);
+	knot_pkt_t *ans = query_arena_answer(&udp->arena, tx->iov_base, tx->iov_len);
 
 	/* Input packet. */
 	int ret = knot_pkt_parse(query, 0);
@@ -103,8 +105,8 @@ static void udp_handle(udp_context_t *udp, int fd, struct sockaddr_storage *ss,
 	/* Reset after processing. */
 	knot_layer_finish(&udp->layer);
 
-	/* Flush per-query memory (including query and answer packets). */
-	mp_flush(udp->layer.mm->ctx);
+	/* Flush per-query memory. */
+	query_arena_flush(&udp->arena);
 }
 
 typedef struct {
@@ -367,7 +369,7 @@ static int xdp_recvmmsg_recv(_unused_ int fd, void *d)
 
 static void xdp_recvmmsg_handle(udp_context_t *ctx, void *d)
 {
-	xdp_handle_msgs(d, &ctx->layer, ctx->server, ctx->thread_id);
+	xdp_handle_msgs(d, &ctx->layer, &ctx->arena, ctx->server, ctx->thread_id);
 }
 
 static void xdp_recvmmsg_send(void *d)
@@ -490,16 +492,17 @@ int udp_master(dthread_t *thread)
 	}
 	void *api_ctx = NULL;
 
-	/* Create big enough memory cushion. */
-	knot_mm_t mm;
-	mm_ctx_mempool(&mm, 16 * MM_DEFAULT_BLKSIZE);
-
 	/* Create UDP answering context. */
 	udp_context_t udp = {
 		.server = handler->server,
 		.thread_id = thread_id,
 	};
-	knot_layer_init(&udp.layer, &mm, process_query_layer());
+	int ret = query_arena_init(&udp.arena, server_query_allocs(handler->server,
+	                                                           thread_id));
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	knot_layer_init(&udp.layer, &udp.arena.mm, process_query_layer());
 
 	/* Allocate descriptors for the configured interfaces. */
 	void *xdp_socket = NULL;
@@ -550,7 +553,7 @@ int udp_master(dthread_t *thread)
 
 finish:
 	api->udp_deinit(api_ctx);
-	mp_delete(mm.ctx);
+	query_arena_deinit(&udp.arena);
 	fdset_clear(&fds);
 
 	return KNOT_EOK;
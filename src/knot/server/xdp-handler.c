@@ -22,9 +22,9 @@
 
 #include "knot/server/xdp-handler.h"
 #include "knot/common/log.h"
+#include "knot/server/query_arena.h"
 #include "knot/server/server.h"
 #include "contrib/sockaddr.h"
-#include "contrib/ucw/mempool.h"
 #include "libknot/error.h"
 #include "libknot/xdp/tcp.h"
 
@@ -107,7 +107,8 @@ int xdp_handle_recv(xdp_handle_ctx_t *ctx)
 }
 
 static void handle_init(knotd_qdata_params_t *params, knot_layer_t *layer,
-                        const knot_xdp_msg_t *msg, const struct iovec *payload)
+                        query_arena_t *arena, const knot_xdp_msg_t *msg,
+                        const struct iovec *payload)
 {
 	params->remote = (struct sockaddr_storage *)&msg->ip_from;
 	params->xdp_msg = msg;
@@ -117,9 +118,9 @@ static void handle_init(knotd_qdata_params_t *params, knot_layer_t *layer,
 		                KNOTD_QUERY_FLAG_LIMIT_SIZE;
 	}
 
-	knot_layer_begin(layer, params);
+	query_arena_begin(arena, layer, params);
 
-	knot_pkt_t *query = knot_pkt_new(payload->iov_base, payload->iov_len, layer->mm);
+	knot_pkt_t *query = query_arena_query(arena, payload->iov_base, payload->iov_len);
 	int ret = knot_pkt_parse(query, 0);
 	if (ret != KNOT_EOK && query->parsed > 0) { // parsing failed (e.g. 2x OPT)
 		query->parsed--; // artificially decreasing "parsed" leads to FORMERR
@@ -127,16 +128,16 @@ static void handle_init(knotd_qdata_params_t *params, knot_layer_t *layer,
 	knot_layer_consume(layer, query);
 }
 
-static void handle_finish(knot_layer_t *layer)
+static void handle_finish(knot_layer_t *layer, query_arena_t *arena)
 {
 	knot_layer_finish(layer);
 
-	// Flush per-query memory (including query and answer packets).
-	mp_flush(layer->mm->ctx);
+	// Flush per-query memory.
+	query_arena_flush(arena);
 }
 
 static void handle_udp(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
-                       knotd_qdata_params_t *params)
+                       query_arena_t *arena, knotd_qdata_params_t *params)
 {
 	ctx->msg_udp_count = 0;
 
@@ -158,11 +159,11 @@ static void handle_udp(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
 		ctx->msg_udp_count++;
 
 		// Consume the query.
-		handle_init(params, layer, msg_recv, &msg_recv->payload);
+		handle_init(params, layer, arena, msg_recv, &msg_recv->payload);
 
 		// Process the reply.
-		knot_pkt_t *ans = knot_pkt_new(msg_send->payload.iov_base,
-		                               msg_send->payload.iov_len, layer->mm);
+		knot_pkt_t *ans = query_arena_answer(arena, msg_send->payload.iov_base,
+		                                     msg_send->payload.iov_len);
 		while (udp_state_active(layer->state)) {
 			knot_layer_produce(layer, ans);
 		}
@@ -174,12 +175,12 @@ static void handle_udp(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
 		}
 
 		// Reset the processing.
-		handle_finish(layer);
+		handle_finish(layer, arena);
 	}
 }
 
 static void handle_tcp(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
-                       knotd_qdata_params_t *params)
+                       query_arena_t *arena, knotd_qdata_params_t *params)
 {
 	uint32_t ack_errors = 0;
 	int ret = knot_tcp_relay(ctx->sock, ctx->msg_recv, ctx->msg_recv_count,
@@ -203,10 +204,10 @@ static void handle_tcp(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
 		}
 
 		// Consume the query.
-		handle_init(params, layer, rl->msg, &rl->data);
+		handle_init(params, layer, arena, rl->msg, &rl->data);
 
 		// Process the reply.
-		knot_pkt_t *ans = knot_pkt_new(ans_buf, sizeof(ans_buf), layer->mm);
+		knot_pkt_t *ans = query_arena_answer(arena, ans_buf, sizeof(ans_buf));
 		while (tcp_active_state(layer->state)) {
 			knot_layer_produce(layer, ans);
 			if (!tcp_send_state(layer->state)) {
@@ -224,12 +225,12 @@ static void handle_tcp(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
 			}
 		}
 
-		handle_finish(layer);
+		handle_finish(layer, arena);
 	}
 }
 
 void xdp_handle_msgs(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
-                     server_t *server, unsigned thread_id)
+                     query_arena_t *arena, server_t *server, unsigned thread_id)
 {
 	assert(ctx->msg_recv_count > 0);
 
@@ -241,9 +242,9 @@ void xdp_handle_msgs(xdp_handle_ctx_t *ctx, knot_layer_t *layer,
 
 	knot_xdp_send_prepare(ctx->sock);
 
-	handle_udp(ctx, layer, &params);
+	handle_udp(ctx, layer, arena, &params);
 	if (ctx->tcp) {
-		handle_tcp(ctx, layer, &params);
+		handle_tcp(ctx, layer, arena, &params);
 	}
 
 	knot_xdp_recv_finish(ctx->sock, ctx->msg_recv, ctx->msg_recv_count);
@@ -19,6 +19,7 @@
 #ifdef ENABLE_XDP
 
 #include "knot/query/layer.h"
+#include "knot/server/query_arena.h"
 #include "libknot/xdp/xdp.h"
 
 #define XDP_BATCHLEN  32 /*!< XDP receive batch size. */
@@ -47,7 +48,8 @@ int xdp_handle_recv(struct xdp_handle_ctx *ctx);
  * \warning In case of TCP, this also sends some packets, e.g. ACK.
  */
 void xdp_handle_msgs(struct xdp_handle_ctx *ctx, knot_layer_t *layer,
-                     struct server *server, unsigned thread_id);
+                     query_arena_t *arena, struct server *server,
+                     unsigned thread_id);
 
 /*!
  * \brief Send packets thru XDP socket.
@@ -14,9 +14,57 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <urcu.h>
+
 #include "knot/updates/acl.h"
+#include "contrib/mempattern.h"
+#include "contrib/qp-trie/trie.h"
+#include "contrib/sockaddr.h"
+#include "contrib/ucw/mempool.h"
 #include "contrib/wire_ctx.h"
 
+/*! \brief Compiled TSIG key. */
+typedef struct {
+	const knot_dname_t *name;
+	dnssec_tsig_algorithm_t algorithm;
+	const uint8_t *secret;
+	size_t secret_size;
+} acl_key_t;
+
+/*! \brief Compiled address, network, or address range. */
+typedef struct {
+	struct sockaddr_storage min;
+	struct sockaddr_storage max; //!< AF_UNSPEC unless address range.
+	int prefix;                  //!< Network prefix length, -1 if exact address.
+} acl_addr_t;
+
+/*! \brief Compiled remote or ACL address and key lists. */
+typedef struct {
+	acl_addr_t *addrs;     //!< Empty matches any address.
+	size_t addr_count;
+	const acl_key_t **keys;
+	size_t key_count;
+} acl_peer_t;
+
+/*! \brief Compiled ACL rule. */
+typedef struct {
+	acl_peer_t *peers;               //!< Remotes, or the ACL itself.
+	size_t peer_count;
+	bool remote;                     //!< Remotes are used.
+	bool deny;
+	unsigned actions;                //!< Bitmap of allowed actions.
+	conf_val_t update_types;
+	conf_val_t update_names;
+	acl_update_owner_t update_owner;
+	acl_update_owner_match_t update_match;
+} acl_rule_t;
+
+struct acl_compiled {
+	knot_mm_t mm;
+	trie_t *keys;  //!< TSIG keys indexed by name.
+	trie_t *rules; //!< ACL rules indexed by identifier.
+};
+
 static bool match_type(uint16_t type, conf_val_t *types)
 {
 	if (types == NULL) {
@@ -85,37 +133,30 @@ static bool match_names(const knot_dname_t *rr_owner, const knot_dname_t *zone_n
 	return false;
 }
 
-static bool update_match(conf_t *conf, conf_val_t *acl, knot_dname_t *key_name,
+static bool update_match(const acl_rule_t *rule, knot_dname_t *key_name,
                          const knot_dname_t *zone_name, knot_pkt_t *query)
 {
 	if (query == NULL) {
 		return true;
 	}
 
-	conf_val_t val_types = conf_id_get(conf, C_ACL, C_UPDATE_TYPE, acl);
+	/* Local copies as the iteration modifies the values. */
+	conf_val_t val_types = rule->update_types;
 	conf_val_t *types = (conf_val_count(&val_types) > 0) ? &val_types : NULL;
 
-	conf_val_t val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER, acl);
-	acl_update_owner_t owner = conf_opt(&val);
+	acl_update_owner_t owner = rule->update_owner;
 
 	/* Return if no specific requirements configured. */
 	if (types == NULL && owner == ACL_UPDATE_OWNER_NONE) {
 		return true;
 	}
 
-	acl_update_owner_match_t match = ACL_UPDATE_MATCH_SUBEQ;
-	if (owner != ACL_UPDATE_OWNER_NONE) {
-		val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_MATCH, acl);
-		match = conf_opt(&val);
-	}
+	acl_update_owner_match_t match = rule->update_match;
 
 	conf_val_t *names = NULL;
-	conf_val_t val_names;
-	if (owner == ACL_UPDATE_OWNER_NAME) {
-		val_names = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_NAME, acl);
-		if (conf_val_count(&val_names) > 0) {
-			names = &val_names;
-		}
+	conf_val_t val_names = rule->update_names;
+	if (owner == ACL_UPDATE_OWNER_NAME && conf_val_count(&val_names) > 0) {
+		names = &val_names;
 	}
 
 	/* Updated RRs are contained in the Authority section of the query
@@ -154,142 +195,332 @@ static bool update_match(conf_t *conf, conf_val_t *acl, knot_dname_t *key_name,
 	return true;
 }
 
-static bool check_addr_key(conf_t *conf, conf_val_t *addr_val, conf_val_t *key_val,
-                           bool remote, const struct sockaddr_storage *addr,
-                           const knot_tsig_key_t *tsig, bool deny)
+static bool match_addr(const acl_peer_t *peer, const struct sockaddr_storage *addr)
 {
-	/* Check if the address matches the acl address list or remote addresses. */
-	if (addr_val->code != KNOT_ENOENT) {
-		if (remote) {
-			if (!conf_addr_match(addr_val, addr)) {
-				return false;
+	if (peer->addr_count == 0) {
+		return true;
+	}
+
+	for (size_t i = 0; i < peer->addr_count; i++) {
+		const acl_addr_t *it = &peer->addrs[i];
+		if (it->max.ss_family != AF_UNSPEC) {
+			if (sockaddr_range_match(addr, &it->min, &it->max)) {
+				return true;
 			}
-		} else {
-			if (!conf_addr_range_match(addr_val, addr)) {
-				return false;
+		} else if (it->prefix < 0) {
+			if (sockaddr_cmp(&it->min, addr, true) == 0) {
+				return true;
 			}
+		} else if (sockaddr_net_match(addr, &it->min, it->prefix)) {
+			return true;
 		}
 	}
 
-	/* Check if the key matches the acl key list or remote key. */
-	while (key_val->code == KNOT_EOK) {
-		/* No key provided, but required. */
-		if (tsig->name == NULL) {
-			goto next_key;
+	return false;
+}
+
+static bool match_peer(const acl_peer_t *peer, const struct sockaddr_storage *addr,
+                       const knot_tsig_key_t *tsig, const acl_key_t *tsig_key,
+                       bool deny, const acl_key_t **matched)
+{
+	/* Check if the address matches the address list. */
+	if (!match_addr(peer, addr)) {
+		return false;
+	}
+
+	/* Empty key list matches without key provided or if denied. */
+	if (peer->key_count == 0) {
+		*matched = NULL;
+		return tsig->name == NULL || deny;
+	}
+
+	/* Check if the key (name and algorithm) matches the key list. */
+	if (tsig_key == NULL) {
+		return false;
+	}
+	for (size_t i = 0; i < peer->key_count; i++) {
+		if (peer->keys[i] == tsig_key) {
+			*matched = tsig_key;
+			return true;
 		}
+	}
+
+	return false;
+}
+
+static const acl_key_t *compile_key_ref(acl_compiled_t *compiled, conf_val_t *val)
+{
+	const knot_dname_t *name = conf_dname(val);
+	trie_val_t *key = trie_get_try(compiled->keys, (const trie_key_t *)name,
+	                               knot_dname_size(name));
+	return (key != NULL) ? *key : NULL;
+}
 
-		/* Compare key names (both in lower-case). */
-		const knot_dname_t *key_name = conf_dname(key_val);
-		if (!knot_dname_is_equal(key_name, tsig->name)) {
-			goto next_key;
+static int compile_keys(conf_t *conf, acl_compiled_t *compiled)
+{
+	for (conf_iter_t iter = conf_iter(conf, C_KEY); iter.code == KNOT_EOK;
+	     conf_iter_next(conf, &iter)) {
+		conf_val_t id = conf_iter_id(conf, &iter);
+
+		acl_key_t *key = mm_alloc(&compiled->mm, sizeof(*key));
+		trie_val_t *val = trie_get_ins(compiled->keys, (const trie_key_t *)conf_dname(&id),
+		                               knot_dname_size(conf_dname(&id)));
+		if (key == NULL || val == NULL) {
+			conf_iter_finish(conf, &iter);
+			return KNOT_ENOMEM;
 		}
 
-		/* Compare key algorithms. */
-		conf_val_t alg_val = conf_id_get(conf, C_KEY, C_ALG, key_val);
-		if (conf_opt(&alg_val) != tsig->algorithm) {
-			goto next_key;
+		key->name = conf_dname(&id);
+		conf_val_t alg = conf_id_get(conf, C_KEY, C_ALG, &id);
+		key->algorithm = conf_opt(&alg);
+		conf_val_t secret = conf_id_get(conf, C_KEY, C_SECRET, &id);
+		key->secret = conf_bin(&secret, &key->secret_size);
+		*val = key;
+	}
+
+	return KNOT_EOK;
+}
+
+static int compile_peer(acl_compiled_t *compiled, acl_peer_t *peer,
+                        conf_val_t *addr_val, conf_val_t *key_val, bool remote)
+{
+	if (addr_val->code == KNOT_EOK) {
+		peer->addrs = mm_alloc(&compiled->mm, conf_val_count(addr_val) *
+		                                      sizeof(*peer->addrs));
+		if (peer->addrs == NULL) {
+			return KNOT_ENOMEM;
 		}
+		while (addr_val->code == KNOT_EOK) {
+			acl_addr_t *addr = &peer->addrs[peer->addr_count++];
+			if (remote) {
+				addr->min = conf_addr(addr_val, NULL);
+				addr->max.ss_family = AF_UNSPEC;
+				addr->prefix = -1;
+			} else {
+				addr->min = conf_addr_range(addr_val, &addr->max, &addr->prefix);
+			}
+			conf_val_next(addr_val);
+		}
+	}
 
-		break;
-	next_key:
-		if (remote) {
-			assert(!(key_val->item->flags & YP_FMULTI));
-			key_val->code = KNOT_EOF;
-			break;
-		} else {
-			assert(key_val->item->flags & YP_FMULTI);
+	if (key_val->code == KNOT_EOK) {
+		peer->keys = mm_alloc(&compiled->mm, conf_val_count(key_val) *
+		                                     sizeof(*peer->keys));
+		if (peer->keys == NULL) {
+			return KNOT_ENOMEM;
+		}
+		while (key_val->code == KNOT_EOK) {
+			/* Unknown key (NULL) never matches. */
+			peer->keys[peer->key_count++] = compile_key_ref(compiled, key_val);
+			if (remote) {
+				break; // Single-valued item.
+			}
 			conf_val_next(key_val);
 		}
 	}
-	switch (key_val->code) {
-	case KNOT_EOK:
-		// Key match.
-		break;
-	case KNOT_ENOENT:
-		// Empty list without key provided or denied.
-		if (tsig->name == NULL || deny) {
-			break;
+
+	return KNOT_EOK;
+}
+
+static int compile_rule(conf_t *conf, acl_compiled_t *compiled, conf_val_t *id,
+                        acl_rule_t *rule)
+{
+	conf_val_t val = conf_id_get(conf, C_ACL, C_DENY, id);
+	rule->deny = conf_bool(&val);
+
+	val = conf_id_get(conf, C_ACL, C_ACTION, id);
+	while (val.code == KNOT_EOK) {
+		rule->actions |= 1 << conf_opt(&val);
+		conf_val_next(&val);
+	}
+
+	rule->update_types = conf_id_get(conf, C_ACL, C_UPDATE_TYPE, id);
+	val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER, id);
+	rule->update_owner = conf_opt(&val);
+	val = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_MATCH, id);
+	rule->update_match = (rule->update_owner != ACL_UPDATE_OWNER_NONE) ?
+	                     conf_opt(&val) : ACL_UPDATE_MATCH_SUBEQ;
+	rule->update_names = conf_id_get(conf, C_ACL, C_UPDATE_OWNER_NAME, id);
+
+	conf_val_t rmt_val = conf_id_get(conf, C_ACL, C_RMT, id);
+	rule->remote = (rmt_val.code == KNOT_EOK);
+	rule->peer_count = rule->remote ? conf_val_count(&rmt_val) : 1;
+	rule->peers = mm_calloc(&compiled->mm, rule->peer_count, sizeof(*rule->peers));
+	if (rule->peers == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	if (!rule->remote) {
+		conf_val_t addr_val = conf_id_get(conf, C_ACL, C_ADDR, id);
+		conf_val_t key_val = conf_id_get(conf, C_ACL, C_KEY, id);
+		return compile_peer(compiled, rule->peers, &addr_val, &key_val, false);
+	}
+
+	for (size_t i = 0; rmt_val.code == KNOT_EOK; i++) {
+		conf_val_t addr_val = conf_id_get(conf, C_RMT, C_ADDR, &rmt_val);
+		conf_val_t key_val = conf_id_get(conf, C_RMT, C_KEY, &rmt_val);
+		int ret = compile_peer(compiled, &rule->peers[i], &addr_val, &key_val, true);
+		if (ret != KNOT_EOK) {
+			return ret;
 		}
-		// FALLTHROUGH
-	default:
-		return false;
+		conf_val_next(&rmt_val);
 	}
 
-	return true;
+	return KNOT_EOK;
+}
+
+static int compile_rules(conf_t *conf, acl_compiled_t *compiled)
+{
+	for (conf_iter_t iter = conf_iter(conf, C_ACL); iter.code == KNOT_EOK;
+	     conf_iter_next(conf, &iter)) {
+		conf_val_t id = conf_iter_id(conf, &iter);
+		size_t id_len;
+		const uint8_t *id_data = conf_data(&id, &id_len);
+
+		acl_rule_t *rule = mm_calloc(&compiled->mm, 1, sizeof(*rule));
+		trie_val_t *val = trie_get_ins(compiled->rules, (const trie_key_t *)id_data,
+		                               id_len);
+		if (rule == NULL || val == NULL) {
+			conf_iter_finish(conf, &iter);
+			return KNOT_ENOMEM;
+		}
+
+		int ret = compile_rule(conf, compiled, &id, rule);
+		if (ret != KNOT_EOK) {
+			conf_iter_finish(conf, &iter);
+			return ret;
+		}
+		*val = rule;
+	}
+
+	return KNOT_EOK;
+}
+
+acl_compiled_t *acl_compile(conf_t *conf)
+{
+	if (conf == NULL) {
+		return NULL;
+	}
+
+	acl_compiled_t *compiled = calloc(1, sizeof(*compiled));
+	if (compiled == NULL) {
+		return NULL;
+	}
+
+	mm_ctx_mempool(&compiled->mm, MM_DEFAULT_BLKSIZE);
+	compiled->keys = trie_create(&compiled->mm);
+	compiled->rules = trie_create(&compiled->mm);
+	if (compiled->keys == NULL || compiled->rules == NULL ||
+	    compile_keys(conf, compiled) != KNOT_EOK ||
+	    compile_rules(conf, compiled) != KNOT_EOK) {
+		acl_compiled_free(compiled);
+		return NULL;
+	}
+
+	return compiled;
+}
+
+void acl_compiled_free(acl_compiled_t *compiled)
+{
+	if (compiled == NULL) {
+		return;
+	}
+
+	mp_delete(compiled->mm.ctx);
+	free(compiled);
+}
+
+/*! \brief Get the compiled ACL of the configuration, compile it on first use. */
+static acl_compiled_t *compiled_get(conf_t *conf)
+{
+	acl_compiled_t *compiled = rcu_dereference(conf->acl);
+	if (compiled != NULL) {
+		return compiled;
+	}
+
+	compiled = acl_compile(conf);
+	if (compiled == NULL) {
+		return NULL;
+	}
+
+	/* Another thread may have been faster. */
+	acl_compiled_t *current = rcu_cmpxchg_pointer(&conf->acl, NULL, compiled);
+	if (current != NULL) {
+		acl_compiled_free(compiled);
+		return current;
+	}
+
+	return compiled;
 }
 
 bool acl_allowed(conf_t *conf, conf_val_t *acl, acl_action_t action,
                  const struct sockaddr_storage *addr, knot_tsig_key_t *tsig,
                  const knot_dname_t *zone_name, knot_pkt_t *query)
 {
-	if (acl == NULL || addr == NULL || tsig == NULL) {
+	if (conf == NULL || acl == NULL || addr == NULL || tsig == NULL) {
 		return false;
 	}
 
-	while (acl->code == KNOT_EOK) {
-		conf_val_t rmt_val = conf_id_get(conf, C_ACL, C_RMT, acl);
-		bool remote = (rmt_val.code == KNOT_EOK);
-		conf_val_t deny_val = conf_id_get(conf, C_ACL, C_DENY, acl);
-		bool deny = conf_bool(&deny_val);
-
-		/* Check if a remote matches given address and key. */
-		conf_val_t addr_val, key_val;
-		while (rmt_val.code == KNOT_EOK) {
-			addr_val = conf_id_get(conf, C_RMT, C_ADDR, &rmt_val);
-			key_val = conf_id_get(conf, C_RMT, C_KEY, &rmt_val);
-			if (check_addr_key(conf, &addr_val, &key_val, remote, addr, tsig, deny)) {
-				break;
-			}
-			conf_val_next(&rmt_val);
+	acl_compiled_t *compiled = compiled_get(conf);
+	if (compiled == NULL) {
+		return false;
+	}
+
+	/* Look up the TSIG key, the algorithm must match too. */
+	const acl_key_t *tsig_key = NULL;
+	if (tsig->name != NULL) {
+		trie_val_t *val = trie_get_try(compiled->keys, (const trie_key_t *)tsig->name,
+		                               knot_dname_size(tsig->name));
+		if (val != NULL && ((acl_key_t *)*val)->algorithm == tsig->algorithm) {
+			tsig_key = *val;
 		}
-		if (rmt_val.code == KNOT_EOF) {
+	}
+
+	while (acl->code == KNOT_EOK) {
+		size_t id_len;
+		const uint8_t *id = conf_data(acl, &id_len);
+		trie_val_t *val = trie_get_try(compiled->rules, (const trie_key_t *)id, id_len);
+		if (val == NULL) {
 			goto next_acl;
 		}
-		/* Or check if acl address/key matches given address and key. */
-		if (!remote) {
-			addr_val = conf_id_get(conf, C_ACL, C_ADDR, acl);
-			key_val = conf_id_get(conf, C_ACL, C_KEY, acl);
-			if (!check_addr_key(conf, &addr_val, &key_val, remote, addr, tsig, deny)) {
-				goto next_acl;
-			}
+		const acl_rule_t *rule = *val;
+
+		/* Check if a remote or the ACL matches given address and key. */
+		const acl_key_t *matched = NULL;
+		size_t i = 0;
+		while (i < rule->peer_count &&
+		       !match_peer(&rule->peers[i], addr, tsig, tsig_key, rule->deny, &matched)) {
+			i++;
+		}
+		if (i == rule->peer_count) {
+			goto next_acl;
 		}
 
 		/* Check if the action is allowed. */
 		if (action != ACL_ACTION_NONE) {
-			conf_val_t val = conf_id_get(conf, C_ACL, C_ACTION, acl);
-			while (val.code == KNOT_EOK) {
-				if (conf_opt(&val) != action) {
-					conf_val_next(&val);
-					continue;
-				}
-
-				break;
-			}
-			switch (val.code) {
-			case KNOT_EOK: /* Check for action match. */
-				break;
-			case KNOT_ENOENT: /* Empty action list allowed with deny only. */
+			if (rule->actions == 0) {
+				/* Empty action list allowed with deny only. */
 				return false;
-			default: /* No match. */
+			} else if (!(rule->actions & (1 << action))) {
 				goto next_acl;
 			}
 		}
 
 		/* If the action is update, check for update rule match. */
 		if (action == ACL_ACTION_UPDATE &&
-		    !update_match(conf, acl, tsig->name, zone_name, query)) {
+		    !update_match(rule, tsig->name, zone_name, query)) {
 			goto next_acl;
 		}
 
 		/* Check if denied. */
-		if (deny) {
+		if (rule->deny) {
 			return false;
 		}
 
 		/* Fill the output with tsig secret if provided. */
-		if (tsig->name != NULL) {
-			conf_val_t val = conf_id_get(conf, C_KEY, C_SECRET, &key_val);
-			tsig->secret.data = (uint8_t *)conf_bin(&val, &tsig->secret.size);
+		if (tsig->name != NULL && matched != NULL) {
+			tsig->secret.data = (uint8_t *)matched->secret;
+			tsig->secret.size = matched->secret_size;
 		}
 
 		return true;
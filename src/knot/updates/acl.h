@@ -45,10 +45,31 @@ typedef enum {
 	ACL_UPDATE_MATCH_SUB   = 2,
 } acl_update_owner_match_t;
 
+/*! \brief ACL rules and TSIG keys of a configuration in a binary form. */
+typedef struct acl_compiled acl_compiled_t;
+
+/*!
+ * \brief Compiles all ACL rules and TSIG keys of the configuration.
+ *
+ * \note The result references the configuration data, so it's valid only
+ *       until the configuration read transaction is refreshed.
+ *
+ * \param conf  Configuration.
+ *
+ * \return Compiled ACL or NULL if an error occurred.
+ */
+acl_compiled_t *acl_compile(conf_t *conf);
+
+/*!
+ * \brief Deallocates compiled ACL.
+ */
+void acl_compiled_free(acl_compiled_t *compiled);
+
 /*!
  * \brief Checks if the address and/or tsig key matches given ACL list.
  *
  * If a proper ACL rule is found and tsig.name is not empty, tsig.secret is filled.
+ * The ACL rules are compiled once per configuration on first use.
  *
  * \param conf       Configuration.
  * \param acl        Pointer to ACL config multivalued identifier.
@@ -663,14 +663,15 @@ int zone_update_increment_soa(zone_update_t *update, conf_t *conf)
 		return KNOT_EINVAL;
 	}
 
-	conf_val_t val = conf_zone_get(conf, C_SERIAL_POLICY, update->zone->name);
-	return set_new_soa(update, conf_opt(&val));
+	zone_settings_t local;
+	const zone_settings_t *settings = zone_get_settings(conf, update->zone, &local);
+	return set_new_soa(update, settings->serial_policy);
 }
 
 static int commit_journal(conf_t *conf, zone_update_t *update)
 {
-	conf_val_t val = conf_zone_get(conf, C_JOURNAL_CONTENT, update->zone->name);
-	unsigned content = conf_opt(&val);
+	zone_settings_t local;
+	unsigned content = zone_get_settings(conf, update->zone, &local)->journal_content;
 	int ret = KNOT_EOK;
 	if ((update->flags & UPDATE_INCREMENTAL) ||
 	    (update->flags & UPDATE_HYBRID)) {
@@ -855,8 +856,8 @@ int zone_update_semcheck(zone_update_t *update)
 
 int zone_update_verify_digest(conf_t *conf, zone_update_t *update)
 {
-	conf_val_t val = conf_zone_get(conf, C_ZONEMD_VERIFY, update->zone->name);
-	if (!conf_bool(&val)) {
+	zone_settings_t local;
+	if (!zone_get_settings(conf, update->zone, &local)->zonemd_verify) {
 		return KNOT_EOK;
 	}
 
@@ -893,14 +894,14 @@ int zone_update_commit(conf_t *conf, zone_update_t *update)
 		return ret;
 	}
 
-	conf_val_t val = conf_zone_get(conf, C_DNSSEC_SIGNING, update->zone->name);
-	bool dnssec = conf_bool(&val);
+	zone_settings_t local;
+	const zone_settings_t *settings = zone_get_settings(conf, update->zone, &local);
+	bool dnssec = settings->dnssec_signing;
 
-	conf_val_t thr = conf_zone_get(conf, C_ADJUST_THR, update->zone->name);
 	if ((update->flags & (UPDATE_HYBRID | UPDATE_FULL))) {
-		ret = zone_adjust_full(update->new_cont, conf_int(&thr));
+		ret = zone_adjust_full(update->new_cont, settings->adjust_threads);
 	} else {
-		ret = zone_adjust_incremental_update(update, conf_int(&thr));
+		ret = zone_adjust_incremental_update(update, settings->adjust_threads);
 	}
 	if (ret != KNOT_EOK) {
 		discard_adds_tree(update);
@@ -908,16 +909,12 @@ int zone_update_commit(conf_t *conf, zone_update_t *update)
 	}
 
 	/* Check the zone size. */
-	val = conf_zone_get(conf, C_ZONE_MAX_SIZE, update->zone->name);
-	size_t size_limit = conf_int(&val);
-
-	if (update->new_cont->size > size_limit) {
+	if (update->new_cont->size > settings->max_zone_size) {
 		discard_adds_tree(update);
 		return KNOT_EZONESIZE;
 	}
 
-	val = conf_zone_get(conf, C_DNSSEC_VALIDATION, update->zone->name);
-	if (conf_bool(&val)) {
+	if (settings->dnssec_validation) {
 		bool incr_valid = update->flags & UPDATE_INCREMENTAL;
 		const char *msg_valid = incr_valid ? "incremental " : "";
 
@@ -987,8 +984,7 @@ int zone_update_commit(conf_t *conf, zone_update_t *update)
 	}
 
 	/* Sync zonefile immediately if configured. */
-	val = conf_zone_get(conf, C_ZONEFILE_SYNC, update->zone->name);
-	if (conf_int(&val) == 0) {
+	if (settings->zonefile_sync == 0) {
 		zone_events_schedule_now(update->zone, ZONE_EVENT_FLUSH);
 	}
 
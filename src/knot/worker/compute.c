@@ -0,0 +1,182 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <assert.h>
+#include <pthread.h>
+#include <stdbool.h>
+
+#include "knot/worker/compute.h"
+#include "libknot/errcode.h"
+
+#define COMPUTE_THREADS_MAX	256
+
+typedef struct compute_batch {
+	struct compute_batch *next;
+	compute_job_cb cb;
+	void *ctx;
+	unsigned jobs;
+	unsigned next_job;   /*!< Next job to be taken (atomic). */
+	unsigned workers;    /*!< Maximum number of workers. */
+	unsigned joined;     /*!< Number of workers joined so far. */
+	unsigned active;     /*!< Number of helper threads working on the batch. */
+	int ret;             /*!< First error (atomic). */
+	pthread_cond_t done;
+} compute_batch_t;
+
+static struct {
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	compute_batch_t *batches;   /*!< Batches waiting for more workers. */
+	pthread_t threads[COMPUTE_THREADS_MAX];
+	unsigned thread_count;
+	bool terminating;
+} pool = {
+	.lock = PTHREAD_MUTEX_INITIALIZER,
+	.wake = PTHREAD_COND_INITIALIZER,
+};
+
+static void batch_work(compute_batch_t *batch, unsigned worker)
+{
+	while (true) {
+		unsigned job = __atomic_fetch_add(&batch->next_job, 1, __ATOMIC_RELAXED);
+		if (job >= batch->jobs) {
+			break;
+		}
+
+		int ret = batch->cb(job, worker, batch->ctx);
+		if (ret != KNOT_EOK) {
+			int expected = KNOT_EOK;
+			__atomic_compare_exchange_n(&batch->ret, &expected, ret, false,
+			                            __ATOMIC_RELAXED, __ATOMIC_RELAXED);
+			__atomic_store_n(&batch->next_job, batch->jobs, __ATOMIC_RELAXED);
+		}
+	}
+}
+
+/*! \brief Remove the batch from the waiting list, locked. */
+static void batch_unlink(compute_batch_t *batch)
+{
+	for (compute_batch_t **it = &pool.batches; *it != NULL; it = &(*it)->next) {
+		if (*it == batch) {
+			*it = batch->next;
+			break;
+		}
+	}
+}
+
+static void *helper_thread(void *arg)
+{
+	(void)arg;
+
+	pthread_mutex_lock(&pool.lock);
+	while (!pool.terminating) {
+		compute_batch_t *batch = pool.batches;
+		if (batch == NULL) {
+			pthread_cond_wait(&pool.wake, &pool.lock);
+			continue;
+		}
+
+		unsigned worker = batch->joined++;
+		batch->active++;
+		if (batch->joined == batch->workers) {
+			batch_unlink(batch);
+		}
+		pthread_mutex_unlock(&pool.lock);
+
+		batch_work(batch, worker);
+
+		pthread_mutex_lock(&pool.lock);
+		if (--batch->active == 0) {
+			pthread_cond_signal(&batch->done);
+		}
+	}
+	pthread_mutex_unlock(&pool.lock);
+
+	return NULL;
+}
+
+/*! \brief Create helper threads if needed, locked. */
+static void ensure_threads(unsigned count)
+{
+	while (pool.thread_count < count && pool.thread_count < COMPUTE_THREADS_MAX) {
+		if (pthread_create(&pool.threads[pool.thread_count], NULL,
+		                   helper_thread, NULL) != 0) {
+			break;
+		}
+		pool.thread_count++;
+	}
+}
+
+int compute_run(unsigned jobs, unsigned workers, compute_job_cb cb, void *ctx)
+{
+	assert(cb);
+
+	compute_batch_t batch = {
+		.cb = cb,
+		.ctx = ctx,
+		.jobs = jobs,
+		.workers = (workers < jobs) ? workers : jobs,
+		.joined = 1,
+		.ret = KNOT_EOK,
+	};
+
+	if (batch.workers > 1) {
+		pthread_cond_init(&batch.done, NULL);
+
+		pthread_mutex_lock(&pool.lock);
+		ensure_threads(batch.workers - 1);
+		compute_batch_t **tail = &pool.batches;
+		while (*tail != NULL) {
+			tail = &(*tail)->next;
+		}
+		*tail = &batch;
+		pthread_cond_broadcast(&pool.wake);
+		pthread_mutex_unlock(&pool.lock);
+	}
+
+	batch_work(&batch, 0);
+
+	if (batch.workers > 1) {
+		pthread_mutex_lock(&pool.lock);
+		batch_unlink(&batch);
+		while (batch.active > 0) {
+			pthread_cond_wait(&batch.done, &pool.lock);
+		}
+		pthread_mutex_unlock(&pool.lock);
+
+		pthread_cond_destroy(&batch.done);
+	}
+
+	return batch.ret;
+}
+
+void compute_pool_deinit(void)
+{
+	pthread_mutex_lock(&pool.lock);
+	pool.terminating = true;
+	pthread_cond_broadcast(&pool.wake);
+	pthread_mutex_unlock(&pool.lock);
+
+	for (unsigned i = 0; i < pool.thread_count; i++) {
+		pthread_join(pool.threads[i], NULL);
+	}
+
+	pthread_mutex_lock(&pool.lock);
+	pool.thread_count = 0;
+	pool.terminating = false;
+	pthread_mutex_unlock(&pool.lock);
+}
@@ -0,0 +1,59 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Shared pool of threads for CPU-bound parallel passes.
+ *
+ * The helper threads are created upon demand and kept for later passes, so
+ * a pass doesn't pay for creating threads. The calling thread takes part in
+ * the work too, so a pass completes even if no helper thread is available.
+ */
+
+#pragma once
+
+/*!
+ * \brief Job callback.
+ *
+ * \param job     Job number.
+ * \param worker  Worker number, lower than the number of workers requested.
+ * \param ctx     Context passed to compute_run().
+ *
+ * \return KNOT_E*
+ */
+typedef int (*compute_job_cb)(unsigned job, unsigned worker, void *ctx);
+
+/*!
+ * \brief Run the jobs in parallel and wait for their completion.
+ *
+ * Each worker runs its jobs sequentially, so per-worker data can be
+ * used without locking. The remaining jobs are skipped after an error.
+ *
+ * \param jobs     Number of jobs.
+ * \param workers  Maximum number of workers, including the calling thread.
+ * \param cb       Job callback.
+ * \param ctx      Job context.
+ *
+ * \return KNOT_EOK or the first error returned by the callback.
+ */
+int compute_run(unsigned jobs, unsigned workers, compute_job_cb cb, void *ctx);
+
+/*!
+ * \brief Terminate the helper threads, no pass may be running.
+ */
+void compute_pool_deinit(void);
@@ -24,6 +24,26 @@
 #include "knot/server/dthreads.h"
 #include "knot/worker/pool.h"
 
+/*!
+ * \brief Number of consecutive tasks taken from each priority class per round.
+ */
+static const unsigned PRIO_WEIGHTS[WORKER_PRIO_COUNT] = {
+	[WORKER_PRIO_CONTROL]     = 8,
+	[WORKER_PRIO_UPDATE]      = 4,
+	[WORKER_PRIO_REFRESH]     = 2,
+	[WORKER_PRIO_MAINTENANCE] = 1,
+};
+
+/*!
+ * \brief Tasks of one priority class.
+ */
+typedef struct {
+	worker_queue_t tasks;
+	unsigned running;	/*!< Number of threads running tasks of this class. */
+	unsigned limit;		/*!< Maximum number of running threads, 0 unlimited. */
+	unsigned credit;	/*!< Remaining tasks in the current round. */
+} worker_class_t;
+
 /*!
  * \brief Worker pool state.
  */
@@ -36,9 +56,49 @@ struct worker_pool {
 	bool terminating;	/*!< Is the pool terminating? .*/
 	bool suspended;		/*!< Is execution temporarily suspended? .*/
 	int running;		/*!< Number of running threads. */
-	worker_queue_t tasks;
+	worker_class_t classes[WORKER_PRIO_COUNT];
 };
 
+static bool class_ready(worker_class_t *cls)
+{
+	return !EMPTY_LIST(cls->tasks.list) &&
+	       (cls->limit == 0 || cls->running < cls->limit);
+}
+
+/*!
+ * \brief Take the next task in weighted round-robin order over the classes.
+ */
+static worker_task_t *pool_dequeue(worker_pool_t *pool)
+{
+	for (int round = 0; round < 2; round++) {
+		for (int i = 0; i < WORKER_PRIO_COUNT; i++) {
+			worker_class_t *cls = &pool->classes[i];
+			if (cls->credit > 0 && class_ready(cls)) {
+				cls->credit -= 1;
+				return worker_queue_dequeue(&cls->tasks);
+			}
+		}
+
+		// Start a new round.
+		for (int i = 0; i < WORKER_PRIO_COUNT; i++) {
+			pool->classes[i].credit = PRIO_WEIGHTS[i];
+		}
+	}
+
+	return NULL;
+}
+
+static bool pool_empty(worker_pool_t *pool)
+{
+	for (int i = 0; i < WORKER_PRIO_COUNT; i++) {
+		if (!EMPTY_LIST(pool->classes[i].tasks.list)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
 /*!
  * \brief Worker thread.
  *
@@ -63,7 +123,7 @@ static int worker_main(dthread_t *thread)
 
 		worker_task_t *task = NULL;
 		if (!pool->suspended) {
-			task = worker_queue_dequeue(&pool->tasks);
+			task = pool_dequeue(pool);
 		}
 
 		if (task == NULL) {
@@ -72,13 +132,18 @@ static int worker_main(dthread_t *thread)
 		}
 
 		assert(task->run);
+		assert(task->prio < WORKER_PRIO_COUNT);
+		// The task may be reassigned with another priority while running.
+		worker_class_t *cls = &pool->classes[task->prio];
 		pool->running += 1;
+		cls->running += 1;
 
 		pthread_mutex_unlock(&pool->lock);
 		task->run(task);
 		pthread_mutex_lock(&pool->lock);
 
 		pool->running -= 1;
+		cls->running -= 1;
 		pthread_cond_broadcast(&pool->wake);
 	}
 
@@ -110,7 +175,10 @@ worker_pool_t *worker_pool_create(unsigned threads)
 		goto fail;
 	}
 
-	worker_queue_init(&pool->tasks);
+	for (int i = 0; i < WORKER_PRIO_COUNT; i++) {
+		worker_queue_init(&pool->classes[i].tasks);
+		pool->classes[i].credit = PRIO_WEIGHTS[i];
+	}
 
 	return pool;
 
@@ -131,7 +199,9 @@ void worker_pool_destroy(worker_pool_t *pool)
 	pthread_mutex_destroy(&pool->lock);
 	pthread_cond_destroy(&pool->wake);
 
-	worker_queue_deinit(&pool->tasks);
+	for (int i = 0; i < WORKER_PRIO_COUNT; i++) {
+		worker_queue_deinit(&pool->classes[i].tasks);
+	}
 
 	free(pool);
 }
@@ -198,7 +268,7 @@ void worker_pool_wait_cb(worker_pool_t *pool, wait_callback_t cb)
 	}
 
 	pthread_mutex_lock(&pool->lock);
-	while (!EMPTY_LIST(pool->tasks.list) || pool->running > 0) {
+	while (!pool_empty(pool) || pool->running > 0) {
 		if (cb != NULL) {
 			cb(pool);
 		}
@@ -212,14 +282,28 @@ void worker_pool_wait(worker_pool_t *pool)
 	worker_pool_wait_cb(pool, NULL);
 }
 
+void worker_pool_set_limit(worker_pool_t *pool, worker_prio_t prio, unsigned limit)
+{
+	if (!pool || prio >= WORKER_PRIO_COUNT) {
+		return;
+	}
+
+	pthread_mutex_lock(&pool->lock);
+	pool->classes[prio].limit = limit;
+	pthread_cond_broadcast(&pool->wake);
+	pthread_mutex_unlock(&pool->lock);
+}
+
 void worker_pool_assign(worker_pool_t *pool, struct task *task)
 {
 	if (!pool || !task) {
 		return;
 	}
 
+	assert(task->prio < WORKER_PRIO_COUNT);
+
 	pthread_mutex_lock(&pool->lock);
-	worker_queue_enqueue(&pool->tasks, task);
+	worker_queue_enqueue(&pool->classes[task->prio].tasks, task);
 	pthread_cond_signal(&pool->wake);
 	pthread_mutex_unlock(&pool->lock);
 }
@@ -231,8 +315,10 @@ void worker_pool_clear(worker_pool_t *pool)
 	}
 
 	pthread_mutex_lock(&pool->lock);
-	worker_queue_deinit(&pool->tasks);
-	worker_queue_init(&pool->tasks);
+	for (int i = 0; i < WORKER_PRIO_COUNT; i++) {
+		worker_queue_deinit(&pool->classes[i].tasks);
+		worker_queue_init(&pool->classes[i].tasks);
+	}
 	pthread_mutex_unlock(&pool->lock);
 }
 
@@ -247,7 +333,10 @@ void worker_pool_status(worker_pool_t *pool, bool locked, int *running, int *que
 		pthread_mutex_lock(&pool->lock);
 	}
 	*running = pool->running;
-	*queued = worker_queue_length(&pool->tasks);
+	*queued = 0;
+	for (int i = 0; i < WORKER_PRIO_COUNT; i++) {
+		*queued += worker_queue_length(&pool->classes[i].tasks);
+	}
 	if (!locked) {
 		pthread_mutex_unlock(&pool->lock);
 	}
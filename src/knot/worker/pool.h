@@ -75,8 +75,20 @@ void worker_pool_wait(worker_pool_t *pool);
  */
 void worker_pool_wait_cb(worker_pool_t *pool, wait_callback_t cb);
 
+/*!
+ * \brief Limit the number of workers running tasks of the given priority class.
+ *
+ * \param pool   Worker pool.
+ * \param prio   Priority class.
+ * \param limit  Maximum number of workers, 0 for no limit.
+ */
+void worker_pool_set_limit(worker_pool_t *pool, worker_prio_t prio, unsigned limit);
+
 /*!
  * \brief Assign a task to be performed by a worker in the pool.
+ *
+ * Tasks of different priority classes are taken in weighted round-robin
+ * order, tasks of the same class in FIFO order.
  */
 void worker_pool_assign(worker_pool_t *pool, struct task *task);
 
@@ -21,12 +21,24 @@
 struct task;
 typedef void (*task_cb)(struct task *);
 
+/*!
+ * \brief Task priority classes, the most urgent first.
+ */
+typedef enum {
+	WORKER_PRIO_CONTROL = 0, /*!< Operations invoked by the user. */
+	WORKER_PRIO_UPDATE,      /*!< Dynamic updates. */
+	WORKER_PRIO_REFRESH,     /*!< Zone loading, refresh and transfers. */
+	WORKER_PRIO_MAINTENANCE, /*!< Signing, flushing and backup. */
+	WORKER_PRIO_COUNT
+} worker_prio_t;
+
 /*!
  * \brief Task executable by a worker.
  */
 typedef struct task {
 	void *ctx;
 	task_cb run;
+	worker_prio_t prio;
 } worker_task_t;
 
 /*!
@@ -332,14 +332,6 @@ typedef struct {
 	adjust_cb_t adjust_cb;
 	bool adjust_prevs;
 	measure_t *m;
-
-	// just for parallel
-	unsigned threads;
-	unsigned thr_id;
-	size_t i;
-	pthread_t thread;
-	int ret;
-	zone_tree_t *tree;
 } zone_adjust_arg_t;
 
 static int adjust_single(zone_node_t *node, void *data)
@@ -349,13 +341,6 @@ static int adjust_single(zone_node_t *node, void *data)
 
 	zone_adjust_arg_t *args = (zone_adjust_arg_t *)data;
 
-	// parallel adjust support
-	if (args->threads > 1) {
-		if (args->i++ % args->threads != args->thr_id) {
-			return KNOT_EOK;
-		}
-	}
-
 	if (args->m != NULL) {
 		knot_measure_node(node, args->m);
 	}
@@ -411,15 +396,6 @@ static int zone_adjust_tree(zone_tree_t *tree, adjust_ctx_t *ctx, adjust_cb_t ad
 	return KNOT_EOK;
 }
 
-static void *adjust_tree_thread(void *ctx)
-{
-	zone_adjust_arg_t *arg = ctx;
-
-	arg->ret = zone_tree_apply(arg->tree, adjust_single, ctx);
-
-	return NULL;
-}
-
 static int zone_adjust_tree_parallel(zone_tree_t *tree, adjust_ctx_t *ctx,
                                      adjust_cb_t adjust_cb, unsigned threads)
 {
@@ -428,20 +404,14 @@ static int zone_adjust_tree_parallel(zone_tree_t *tree, adjust_ctx_t *ctx,
 	}
 
 	zone_adjust_arg_t args[threads];
+	void *data[threads];
 	memset(args, 0, sizeof(args));
 	int ret = KNOT_EOK;
 
 	for (unsigned i = 0; i < threads; i++) {
-		args[i].first_node = NULL;
 		args[i].ctx = *ctx;
 		args[i].adjust_cb = adjust_cb;
-		args[i].adjust_prevs = false;
-		args[i].m = NULL;
-		args[i].tree = tree;
-		args[i].threads = threads;
-		args[i].i = 0;
-		args[i].thr_id = i;
-		args[i].ret = -1;
+		data[i] = &args[i];
 		if (ctx->changed_nodes != NULL) {
 			args[i].ctx.changed_nodes = zone_tree_create(true);
 			if (args[i].ctx.changed_nodes == NULL) {
@@ -458,17 +428,9 @@ static int zone_adjust_tree_parallel(zone_tree_t *tree, adjust_ctx_t *ctx,
 		return ret;
 	}
 
-	for (unsigned i = 0; i < threads; i++) {
-		args[i].ret = pthread_create(&args[i].thread, NULL, adjust_tree_thread, &args[i]);
-	}
+	ret = zone_tree_apply_parallel(tree, adjust_single, data, threads);
 
 	for (unsigned i = 0; i < threads; i++) {
-		if (args[i].ret == 0) {
-			args[i].ret = pthread_join(args[i].thread, NULL);
-		}
-		if (args[i].ret != 0) {
-			ret = knot_map_errno_code(args[i].ret);
-		}
 		if (ret == KNOT_EOK && ctx->changed_nodes != NULL) {
 			ret = zone_tree_merge(ctx->changed_nodes, args[i].ctx.changed_nodes);
 		}
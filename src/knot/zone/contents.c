@@ -158,6 +158,13 @@ static int remove_rr(zone_contents_t *z, const knot_rrset_t *rr,
 	return KNOT_EOK;
 }
 
+/*! \brief Get a new contents generation, never reused unlike the pointers. */
+static uint64_t next_generation(void)
+{
+	static uint64_t generation = 0;
+	return __atomic_add_fetch(&generation, 1, __ATOMIC_RELAXED);
+}
+
 // Public API
 
 zone_contents_t *zone_contents_new(const knot_dname_t *apex_name, bool use_binodes)
@@ -186,6 +193,7 @@ zone_contents_t *zone_contents_new(const knot_dname_t *apex_name, bool use_binod
 	}
 	contents->apex->flags |= NODE_FLAGS_APEX;
 	contents->max_ttl = UINT32_MAX;
+	contents->generation = next_generation();
 
 	return contents;
 
@@ -475,6 +483,7 @@ int zone_contents_cow(zone_contents_t *from, zone_contents_t **to)
 	if (contents == NULL) {
 		return KNOT_ENOMEM;
 	}
+	contents->generation = next_generation();
 
 	contents->nodes = zone_tree_cow(from->nodes);
 	if (contents->nodes == NULL) {
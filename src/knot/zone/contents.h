@@ -38,6 +38,8 @@ typedef struct zone_contents {
 	size_t size;
 	uint32_t max_ttl;
 	bool dnssec;
+
+	uint64_t generation;     /*!< Unique identifier of this contents instance. */
 } zone_contents_t;
 
 /*!
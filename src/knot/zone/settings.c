@@ -0,0 +1,88 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "knot/zone/settings.h"
+
+void zone_settings_load(conf_t *conf, const knot_dname_t *zone,
+                        zone_settings_t *settings)
+{
+	assert(conf);
+	assert(zone);
+	assert(settings);
+
+	conf_val_t val = conf_zone_get(conf, C_MASTER, zone);
+	settings->is_slave = conf_val_count(&val) > 0;
+
+	val = conf_zone_get(conf, C_DNSSEC_SIGNING, zone);
+	settings->dnssec_signing = conf_bool(&val);
+
+	val = conf_zone_get(conf, C_DNSSEC_VALIDATION, zone);
+	settings->dnssec_validation = conf_bool(&val);
+
+	val = conf_zone_get(conf, C_ZONEMD_VERIFY, zone);
+	settings->zonemd_verify = conf_bool(&val);
+
+	val = conf_zone_get(conf, C_ZONEMD_GENERATE, zone);
+	settings->zonemd_generate = conf_opt(&val);
+
+	val = conf_zone_get(conf, C_SERIAL_POLICY, zone);
+	settings->serial_policy = conf_opt(&val);
+
+	val = conf_zone_get(conf, C_JOURNAL_CONTENT, zone);
+	settings->journal_content = conf_opt(&val);
+
+	val = conf_zone_get(conf, C_ADJUST_THR, zone);
+	settings->adjust_threads = conf_int(&val);
+
+	val = conf_zone_get(conf, C_ZONEFILE_SYNC, zone);
+	settings->zonefile_sync = conf_int(&val);
+
+	val = conf_zone_get(conf, C_JOURNAL_MAX_USAGE, zone);
+	settings->journal_max_usage = conf_int(&val);
+
+	val = conf_zone_get(conf, C_JOURNAL_MAX_DEPTH, zone);
+	settings->journal_max_depth = conf_int(&val);
+
+	val = conf_zone_get(conf, C_ZONE_MAX_SIZE, zone);
+	settings->max_zone_size = conf_int(&val);
+
+	val = conf_zone_get(conf, C_REFRESH_MIN_INTERVAL, zone);
+	settings->refresh_min_interval = conf_int(&val);
+
+	val = conf_zone_get(conf, C_REFRESH_MAX_INTERVAL, zone);
+	settings->refresh_max_interval = conf_int(&val);
+}
+
+zone_settings_t *zone_settings_new(conf_t *conf, const knot_dname_t *zone)
+{
+	zone_settings_t *settings = malloc(sizeof(*settings));
+	if (settings == NULL) {
+		return NULL;
+	}
+
+	zone_settings_load(conf, zone, settings);
+
+	return settings;
+}
+
+void zone_settings_free(zone_settings_t *settings)
+{
+	free(settings);
+}
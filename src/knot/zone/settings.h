@@ -0,0 +1,81 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Resolved per-zone configuration.
+ *
+ * Frequently used zone options are resolved once when the zone structure is
+ * created, so that zone events and updates don't have to look them up in
+ * the configuration database repeatedly. The snapshot is immutable, a new one
+ * is published via RCU whenever the configuration is reloaded or committed.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "knot/conf/conf.h"
+#include "libknot/dname.h"
+
+/*!
+ * \brief Resolved zone settings.
+ */
+typedef struct zone_settings {
+	bool is_slave;                 //!< Some master is configured.
+	bool dnssec_signing;           //!< Automatic DNSSEC signing.
+	bool dnssec_validation;        //!< DNSSEC validation of updates.
+	bool zonemd_verify;            //!< ZONEMD verification of transfers.
+	unsigned zonemd_generate;      //!< ZONEMD generation algorithm.
+	unsigned serial_policy;        //!< SOA serial policy.
+	unsigned journal_content;      //!< Journal content.
+	unsigned adjust_threads;       //!< Number of zone adjusting threads.
+	int64_t zonefile_sync;         //!< Zone file synchronization timeout.
+	size_t journal_max_usage;      //!< Maximal journal usage.
+	size_t journal_max_depth;      //!< Maximal journal depth.
+	size_t max_zone_size;          //!< Maximal zone size.
+	uint32_t refresh_min_interval; //!< Minimal refresh interval.
+	uint32_t refresh_max_interval; //!< Maximal refresh interval.
+} zone_settings_t;
+
+/*!
+ * \brief Resolve zone settings from the configuration.
+ *
+ * \param conf      Configuration.
+ * \param zone      Zone name.
+ * \param settings  Output settings.
+ */
+void zone_settings_load(conf_t *conf, const knot_dname_t *zone,
+                        zone_settings_t *settings);
+
+/*!
+ * \brief Allocate and resolve zone settings.
+ *
+ * \param conf  Configuration.
+ * \param zone  Zone name.
+ *
+ * \return Zone settings or NULL if an error occurred.
+ */
+zone_settings_t *zone_settings_new(conf_t *conf, const knot_dname_t *zone);
+
+/*!
+ * \brief Deallocate zone settings.
+ */
+void zone_settings_free(zone_settings_t *settings);
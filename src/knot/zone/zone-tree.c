@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <stdlib.h>
 
+#include "knot/worker/compute.h"
 #include "knot/zone/zone-tree.h"
 #include "libknot/consts.h"
 #include "libknot/errcode.h"
@@ -302,6 +303,62 @@ int zone_tree_apply(zone_tree_t *tree, zone_tree_apply_cb_t function, void *data
 	return trie_apply(tree->trie, tree_apply_cb, &f);
 }
 
+/*! \brief Number of tree parts per worker, allows balancing uneven parts. */
+#define PARTS_PER_WORKER	16
+
+typedef struct {
+	trie_part_t *parts;
+	zone_tree_apply_cb_t func;
+	void **data;
+	int binode_second;
+} zone_tree_parallel_t;
+
+static int tree_part_job(unsigned job, unsigned worker, void *ctx)
+{
+	zone_tree_parallel_t *p = ctx;
+	zone_tree_func_t f = {
+		.func = p->func,
+		.data = p->data[worker],
+		.binode_second = p->binode_second,
+	};
+
+	return trie_part_apply(p->parts[job], tree_apply_cb, &f);
+}
+
+int zone_tree_apply_parallel(zone_tree_t *tree, zone_tree_apply_cb_t function,
+                             void **data, unsigned workers)
+{
+	if (function == NULL || data == NULL || workers == 0) {
+		return KNOT_EINVAL;
+	}
+
+	if (workers == 1) {
+		return zone_tree_apply(tree, function, data[0]);
+	}
+
+	if (zone_tree_is_empty(tree)) {
+		return KNOT_EOK;
+	}
+
+	size_t max_parts = (size_t)workers * PARTS_PER_WORKER;
+	zone_tree_parallel_t p = {
+		.parts = malloc(max_parts * sizeof(*p.parts)),
+		.func = function,
+		.data = data,
+		.binode_second = ((tree->flags & ZONE_TREE_BINO_SECOND) ? 1 : 0),
+	};
+	if (p.parts == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	size_t count = trie_split(tree->trie, p.parts, max_parts);
+	int ret = compute_run(count, workers, tree_part_job, &p);
+
+	free(p.parts);
+
+	return ret;
+}
+
 int zone_tree_sub_apply(zone_tree_t *tree, const knot_dname_t *sub_root,
                         bool excl_root, zone_tree_apply_cb_t function, void *data)
 {
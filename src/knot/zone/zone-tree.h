@@ -221,6 +221,23 @@ int zone_tree_del_node(zone_tree_t *tree, zone_node_t *node, bool free_deleted);
  */
 int zone_tree_apply(zone_tree_t *tree, zone_tree_apply_cb_t function, void *data);
 
+/*!
+ * \brief Applies the given function to each node in the zone using parallel workers.
+ *
+ * The tree is split into disjoint parts processed by the shared compute pool.
+ * The nodes of each part are processed in order, but there is no order among
+ * the parts.
+ *
+ * \param tree      Zone tree to apply the function to.
+ * \param function  Function to be applied to each node of the zone.
+ * \param data      Array of data for each worker, passed to the function.
+ * \param workers   Number of workers (size of the data array).
+ *
+ * \return KNOT_E*
+ */
+int zone_tree_apply_parallel(zone_tree_t *tree, zone_tree_apply_cb_t function,
+                             void **data, unsigned workers);
+
 /*!
  * \brief Applies given function to each node in a subtree.
  *
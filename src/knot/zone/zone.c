@@ -68,8 +68,8 @@ static int flush_journal(conf_t *conf, zone_t *zone, bool allow_empty_zone, bool
 
 	bool force = zone_get_flag(zone, ZONE_FORCE_FLUSH, true);
 
-	conf_val_t val = conf_zone_get(conf, C_ZONEFILE_SYNC, zone->name);
-	int64_t sync_timeout = conf_int(&val);
+	zone_settings_t local;
+	int64_t sync_timeout = zone_get_settings(conf, zone, &local)->zonefile_sync;
 
 	if (zone_contents_is_empty(zone->contents)) {
 		if (allow_empty_zone && journal_is_existing(j)) {
@@ -189,6 +189,38 @@ zone_t* zone_new(const knot_dname_t *name)
 	return zone;
 }
 
+const zone_settings_t *zone_get_settings(conf_t *conf, const zone_t *zone,
+                                         zone_settings_t *local)
+{
+	assert(zone);
+	assert(local);
+
+	rcu_read_lock();
+	const zone_settings_t *settings = rcu_dereference(zone->settings);
+	if (settings != NULL) {
+		*local = *settings;
+	}
+	rcu_read_unlock();
+
+	if (settings == NULL) {
+		zone_settings_load(conf, zone->name, local);
+	}
+
+	return local;
+}
+
+zone_settings_t *zone_reload_settings(conf_t *conf, zone_t *zone)
+{
+	assert(zone);
+
+	zone_settings_t *settings = zone_settings_new(conf, zone->name);
+	if (settings == NULL) {
+		return NULL;
+	}
+
+	return rcu_xchg_pointer(&zone->settings, settings);
+}
+
 void zone_control_clear(zone_t *zone)
 {
 	if (zone == NULL) {
@@ -208,6 +240,17 @@ void zone_free(zone_t **zone_ptr)
 
 	zone_t *zone = *zone_ptr;
 
+	/* Drop pending SOA query and NOTIFYs. */
+	if (zone->server != NULL) {
+		udp_engine_cancel(&zone->server->soa_check, zone);
+		udp_engine_cancel(&zone->server->notify_send, zone);
+	}
+
+	/* Cached outgoing IXFRs lead to the contents freed below. */
+	if (zone->server != NULL && zone->contents != NULL) {
+		ixfr_cache_invalidate(&zone->server->ixfr_cache, zone->name);
+	}
+
 	zone_events_deinit(zone);
 
 	knot_dname_free(zone->name, NULL);
@@ -232,6 +275,8 @@ void zone_free(zone_t **zone_ptr)
 
 	conf_deactivate_modules(&zone->query_modules, &zone->query_plan);
 
+	zone_settings_free(zone->settings);
+
 	free(zone);
 	*zone_ptr = NULL;
 }
@@ -278,7 +323,9 @@ int zone_change_store(conf_t *conf, zone_t *zone, changeset_t *change, changeset
 		return KNOT_EINVAL;
 	}
 
-	zone_journal_t j = { zone_journaldb(zone), zone->name, conf };
+	zone_settings_t local;
+	zone_journal_t j = { zone_journaldb(zone), zone->name, conf,
+	                     zone_get_settings(conf, zone, &local) };
 
 	int ret = journal_insert(j, change, extra);
 	if (ret == KNOT_EBUSY) {
@@ -313,7 +360,9 @@ int zone_in_journal_store(conf_t *conf, zone_t *zone, zone_contents_t *new_conte
 		return KNOT_EEMPTYZONE;
 	}
 
-	zone_journal_t j = { zone_journaldb(zone), zone->name, conf };
+	zone_settings_t local;
+	zone_journal_t j = { zone_journaldb(zone), zone->name, conf,
+	                     zone_get_settings(conf, zone, &local) };
 
 	int ret = journal_insert_zone(j, new_contents);
 	if (ret == KNOT_EOK) {
@@ -350,6 +399,11 @@ zone_contents_t *zone_switch_contents(zone_t *zone, zone_contents_t *new_content
 	zone_contents_t **current_contents = &zone->contents;
 	old_contents = rcu_xchg_pointer(current_contents, new_contents);
 
+	/* Cached outgoing IXFRs lead to the previous contents. */
+	if (zone->server != NULL) {
+		ixfr_cache_invalidate(&zone->server->ixfr_cache, zone->name);
+	}
+
 	return old_contents;
 }
 
@@ -359,6 +413,14 @@ bool zone_is_slave(conf_t *conf, const zone_t *zone)
 		return false;
 	}
 
+	rcu_read_lock();
+	const zone_settings_t *settings = rcu_dereference(zone->settings);
+	bool is_slave = (settings != NULL) && settings->is_slave;
+	rcu_read_unlock();
+	if (settings != NULL) {
+		return is_slave;
+	}
+
 	conf_val_t val = conf_zone_get(conf, C_MASTER, zone->name);
 	return conf_val_count(&val) > 0 ? true : false;
 }
@@ -388,6 +450,31 @@ void zone_clear_preferred_master(zone_t *zone)
 	pthread_mutex_unlock(&zone->preferred_lock);
 }
 
+void zone_notified_post(zone_t *zone, uint32_t serial)
+{
+	if (zone == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&zone->preferred_lock);
+	zone->notified_serial = (serial | LAST_NOTIFIED_SERIAL_VALID);
+	pthread_mutex_unlock(&zone->preferred_lock);
+}
+
+void zone_notified_apply(zone_t *zone)
+{
+	if (zone == NULL) {
+		return;
+	}
+
+	pthread_mutex_lock(&zone->preferred_lock);
+	if (zone->notified_serial != 0) {
+		zone->timers.last_notified_serial = zone->notified_serial;
+		zone->notified_serial = 0;
+	}
+	pthread_mutex_unlock(&zone->preferred_lock);
+}
+
 void zone_set_flag(zone_t *zone, zone_flag_t flag)
 {
 	if (zone == NULL) {
@@ -650,8 +737,8 @@ int slave_zone_serial(zone_t *zone, conf_t *conf, uint32_t *serial)
 	assert(zone->contents != NULL);
 	*serial = zone_contents_serial(zone->contents);
 
-	conf_val_t val = conf_zone_get(conf, C_DNSSEC_SIGNING, zone->name);
-	if (conf_bool(&val)) {
+	zone_settings_t local;
+	if (zone_get_settings(conf, zone, &local)->dnssec_signing) {
 		ret = zone_get_master_serial(zone, serial);
 	}
 
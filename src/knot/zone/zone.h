@@ -24,6 +24,7 @@
 #include "knot/events/events.h"
 #include "knot/updates/changesets.h"
 #include "knot/zone/contents.h"
+#include "knot/zone/settings.h"
 #include "knot/zone/timers.h"
 #include "libknot/dname.h"
 #include "libknot/packet/pkt.h"
@@ -44,6 +45,15 @@ typedef enum {
 	ZONE_IS_CAT_MEMBER  = 1 << 6, /*!< This zone exists according to a catalog. */
 } zone_flag_t;
 
+/*!
+ * \brief State of the asynchronous SOA query.
+ */
+typedef enum {
+	ZONE_SOA_CHECK_NONE = 0, /*!< No query submitted. */
+	ZONE_SOA_CHECK_PENDING,  /*!< Query submitted, waiting for the result. */
+	ZONE_SOA_CHECK_DONE,     /*!< Result available for the refresh event. */
+} zone_soa_check_state_t;
+
 /*!
  * \brief Structure for holding DNS zone.
  */
@@ -57,6 +67,9 @@ typedef struct zone
 	/*! \brief Dynamic configuration zone change type. */
 	conf_io_type_t change_type;
 
+	/*! \brief Resolved zone configuration (NULL if not available), RCU protected. */
+	zone_settings_t *settings;
+
 	/*! \brief Zonefile parameters. */
 	struct {
 		struct timespec mtime;
@@ -97,6 +110,18 @@ typedef struct zone
 	/*! \brief Preferred master for remote operation. */
 	struct sockaddr_storage *preferred_master;
 
+	/*! \brief Asynchronous SOA query (protected by preferred_lock). */
+	struct {
+		zone_soa_check_state_t state;
+		int ret;
+		uint32_t serial;
+		struct sockaddr_storage remote;
+		bool again; //!< Another refresh requested while pending.
+	} soa_check;
+
+	/*! \brief Serial acknowledged by asynchronous NOTIFY (protected by preferred_lock). */
+	uint64_t notified_serial;
+
 	/*! \brief Query modules. */
 	list_t query_modules;
 	struct query_plan *query_plan;
@@ -111,6 +136,29 @@ typedef struct zone
  */
 zone_t* zone_new(const knot_dname_t *name);
 
+/*!
+ * \brief Returns resolved zone settings.
+ *
+ * \param conf   Configuration used if the zone has no resolved settings.
+ * \param zone   Zone.
+ * \param local  Storage for a copy of the settings.
+ *
+ * \return Resolved zone settings (always local).
+ */
+const zone_settings_t *zone_get_settings(conf_t *conf, const zone_t *zone,
+                                         zone_settings_t *local);
+
+/*!
+ * \brief Resolves the zone settings again and publishes them via RCU.
+ *
+ * \param conf  Configuration.
+ * \param zone  Zone.
+ *
+ * \return Previous settings to be freed after RCU synchronization, NULL if
+ *         there were none or if an error occurred (settings not changed).
+ */
+zone_settings_t *zone_reload_settings(conf_t *conf, zone_t *zone);
+
 /*!
  * \brief Deallocates the zone structure.
  *
@@ -148,7 +196,7 @@ catalog_update_t *zone_catalog_upd(const zone_t *zone);
  */
 inline static zone_journal_t zone_journal(zone_t *zone)
 {
-	zone_journal_t j = { zone_journaldb(zone), zone->name, NULL };
+	zone_journal_t j = { zone_journaldb(zone), zone->name, NULL, NULL };
 	return j;
 }
 
@@ -175,6 +223,16 @@ void zone_set_preferred_master(zone_t *zone, const struct sockaddr_storage *addr
 /*! \brief Clears the current preferred master address. */
 void zone_clear_preferred_master(zone_t *zone);
 
+/*!
+ * \brief Records a serial acknowledged by an asynchronous NOTIFY.
+ *
+ * The zone timers are updated later by zone_notified_apply().
+ */
+void zone_notified_post(zone_t *zone, uint32_t serial);
+
+/*! \brief Moves the posted NOTIFY serial into the zone timers. */
+void zone_notified_apply(zone_t *zone);
+
 /*! \brief Sets a zone flag. */
 void zone_set_flag(zone_t *zone, zone_flag_t flag);
 
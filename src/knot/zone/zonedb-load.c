@@ -64,7 +64,8 @@ static void zone_get_catalog_group(conf_t *conf, zone_t *zone)
 	}
 }
 
-static zone_t *create_zone_from(const knot_dname_t *name, server_t *server)
+static zone_t *create_zone_from(conf_t *conf, const knot_dname_t *name,
+                                server_t *server)
 {
 	zone_t *zone = zone_new(name);
 	if (!zone) {
@@ -73,6 +74,12 @@ static zone_t *create_zone_from(const knot_dname_t *name, server_t *server)
 
 	zone->server = server;
 
+	zone->settings = zone_settings_new(conf, name);
+	if (zone->settings == NULL) {
+		zone_free(&zone);
+		return NULL;
+	}
+
 	int result = zone_events_setup(zone, server->workers, &server->sched);
 	if (result != KNOT_EOK) {
 		zone_free(&zone);
@@ -85,7 +92,7 @@ static zone_t *create_zone_from(const knot_dname_t *name, server_t *server)
 static zone_t *create_zone_reload(conf_t *conf, const knot_dname_t *name,
                                   server_t *server, zone_t *old_zone)
 {
-	zone_t *zone = create_zone_from(name, server);
+	zone_t *zone = create_zone_from(conf, name, server);
 	if (!zone) {
 		return NULL;
 	}
@@ -93,13 +100,14 @@ static zone_t *create_zone_reload(conf_t *conf, const knot_dname_t *name,
 	zone->contents = old_zone->contents;
 	zone_set_flag(zone, zone_get_flag(old_zone, ZONE_IS_CATALOG | ZONE_IS_CAT_MEMBER, false));
 
+	zone_notified_apply(old_zone);
 	zone->timers = old_zone->timers;
 	zone_timers_sanitize(conf, zone);
 
 	bool conf_updated = (old_zone->change_type & CONF_IO_TRELOAD);
 
-	conf_val_t digest = conf_zone_get(conf, C_ZONEMD_GENERATE, name);
-	if (zone->contents != NULL && !zone_contents_digest_exists(zone->contents, conf_opt(&digest), true)) {
+	unsigned digest = zone->settings->zonemd_generate;
+	if (zone->contents != NULL && !zone_contents_digest_exists(zone->contents, digest, true)) {
 		conf_updated = true;
 	}
 
@@ -127,7 +135,7 @@ static zone_t *create_zone_reload(conf_t *conf, const knot_dname_t *name,
 static zone_t *create_zone_new(conf_t *conf, const knot_dname_t *name,
                                server_t *server)
 {
-	zone_t *zone = create_zone_from(name, server);
+	zone_t *zone = create_zone_from(conf, name, server);
 	if (!zone) {
 		return NULL;
 	}
@@ -578,6 +586,144 @@ void zonedb_reload(conf_t *conf, server_t *server)
 	remove_old_zonedb(conf, db_old, server);
 }
 
+/*!
+ * \brief Apply catalog changes to the copy of zone database.
+ *
+ * \param conf              Configuration.
+ * \param server            Server instance.
+ * \param db_new            Copy-on-write clone of the current zone database.
+ * \param expired_contents  Out: ptrlist of zone_contents_t to be deep freed after sync RCU.
+ * \param old_zones         Out: ptrlist of replaced or removed zones to be freed after sync RCU.
+ */
+static void update_zonedb(conf_t *conf, server_t *server, knot_zonedb_t *db_new,
+                          list_t *expired_contents, list_t *old_zones)
+{
+	catalog_it_t *it = catalog_it_begin(&server->catalog_upd);
+	while (!catalog_it_finished(it)) {
+		catalog_upd_val_t *val = catalog_it_val(it);
+		catalog_it_next(it);
+
+		zone_t *old_zone = knot_zonedb_find(server->zone_db, val->member);
+		zone_t *new_zone = NULL;
+
+		if (old_zone == NULL || !zone_get_flag(old_zone, ZONE_IS_CAT_MEMBER, false)) {
+			new_zone = add_member_zone(val, db_new, server, conf);
+			if (new_zone != NULL) {
+				knot_zonedb_insert(db_new, new_zone);
+				catalogs_generate_zone(db_new, NULL, new_zone);
+			}
+			continue;
+		}
+
+		zone_events_freeze(old_zone);
+
+		new_zone = reuse_member_zone(old_zone, server, conf, expired_contents);
+		if (new_zone != NULL) {
+			knot_zonedb_insert(db_new, new_zone);
+		} else {
+			knot_zonedb_del(db_new, old_zone->name);
+		}
+		catalogs_generate_zone(db_new, old_zone, new_zone);
+
+		ptrlist_add(old_zones, old_zone, NULL);
+	}
+	catalog_it_free(it);
+}
+
+void zonedb_update_catalog(conf_t *conf, server_t *server)
+{
+	if (conf == NULL || server == NULL) {
+		return;
+	}
+
+	if (server->zone_db == NULL) {
+		zonedb_reload(conf, server);
+		return;
+	}
+
+	list_t contents_tofree, zones_tofree;
+	init_list(&contents_tofree);
+	init_list(&zones_tofree);
+
+	catalog_update_finalize(&server->catalog_upd, &server->catalog, conf);
+
+	/* Copy only the changed part of the zone DB. */
+	knot_zonedb_t *db_new = knot_zonedb_cow(server->zone_db);
+	if (db_new == NULL) {
+		log_error("failed to create new zone database");
+		return;
+	}
+
+	int ret = catalog_update_commit(&server->catalog_upd, &server->catalog);
+	if (ret != KNOT_EOK) {
+		log_error("catalog, failed to apply changes (%s)", knot_strerror(ret));
+	} else {
+		update_zonedb(conf, server, db_new, &contents_tofree, &zones_tofree);
+	}
+
+	/* Switch the databases. */
+	knot_zonedb_t **db_current = &server->zone_db;
+	knot_zonedb_t *db_old = rcu_xchg_pointer(db_current, db_new);
+
+	/* Wait for readers to finish reading old zone database. */
+	synchronize_rcu();
+
+	ptrlist_free_custom(&contents_tofree, NULL, (ptrlist_free_cb)zone_contents_deep_free);
+
+	catalog_commit_cleanup(&server->catalog);
+
+	ptrnode_t *n;
+	WALK_LIST(n, zones_tofree) {
+		zone_t *zone = n->d;
+		catalog_upd_val_t *upd = catalog_update_get(&server->catalog_upd, zone->name);
+		if (upd != NULL && upd->type == CAT_UPD_REM) {
+			zone_purge(conf, zone, server);
+		}
+		/* Check if reloaded (reused contents). */
+		if (knot_zonedb_find(db_new, zone->name) != NULL) {
+			zone->contents = NULL;
+		}
+		zone_free(&zone);
+	}
+	ptrlist_free(&zones_tofree, NULL);
+
+	/* Clear catalog changes. No need to use mutex as this is done from main
+	 * thread while all zone events are paused. */
+	catalog_update_clear(&server->catalog_upd);
+
+	knot_zonedb_cow_commit(&db_old, db_new);
+}
+
+void zonedb_reload_settings(conf_t *conf, server_t *server)
+{
+	if (conf == NULL || server == NULL) {
+		return;
+	}
+
+	list_t settings_tofree;
+	init_list(&settings_tofree);
+
+	rcu_read_lock();
+	knot_zonedb_t *zonedb = rcu_dereference(server->zone_db);
+	if (zonedb != NULL) {
+		knot_zonedb_iter_t *it = knot_zonedb_iter_begin(zonedb);
+		while (!knot_zonedb_iter_finished(it)) {
+			zone_settings_t *old = zone_reload_settings(conf, knot_zonedb_iter_val(it));
+			if (old != NULL) {
+				ptrlist_add(&settings_tofree, old, NULL);
+			}
+			knot_zonedb_iter_next(it);
+		}
+		knot_zonedb_iter_free(it);
+	}
+	rcu_read_unlock();
+
+	/* Wait for readers to finish reading old settings. */
+	synchronize_rcu();
+
+	ptrlist_free_custom(&settings_tofree, NULL, (ptrlist_free_cb)zone_settings_free);
+}
+
 int zone_reload_modules(conf_t *conf, server_t *server, const knot_dname_t *zone_name)
 {
 	zone_t **zone = knot_zonedb_find_ptr(server->zone_db, zone_name);
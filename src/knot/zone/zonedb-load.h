@@ -27,6 +27,29 @@
  */
 void zonedb_reload(conf_t *conf, server_t *server);
 
+/*!
+ * \brief Apply pending catalog changes to the zone database.
+ *
+ * Unlike zonedb_reload(), only the added, removed, or changed catalog
+ * member zones are processed and the zone database is updated in place
+ * using copy-on-write.
+ *
+ * \param[in] conf Configuration.
+ * \param[in] server Server instance.
+ */
+void zonedb_update_catalog(conf_t *conf, server_t *server);
+
+/*!
+ * \brief Resolve settings of all zones in the zone database again.
+ *
+ * Zones which are not re-created upon a configuration change keep their
+ * zone_t, so their cached settings must be refreshed explicitly.
+ *
+ * \param[in] conf Configuration.
+ * \param[in] server Server instance.
+ */
+void zonedb_reload_settings(conf_t *conf, server_t *server);
+
 /*!
  * \brief Re-create zone_t struct in zoneDB so that the zone is reloaded incl modules.
  *
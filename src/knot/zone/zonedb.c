@@ -20,8 +20,6 @@
 #include "knot/journal/journal_metadata.h"
 #include "knot/zone/zonedb.h"
 #include "libknot/packet/wire.h"
-#include "contrib/mempattern.h"
-#include "contrib/ucw/mempool.h"
 
 /*! \brief Discard zone in zone database. */
 static void discard_zone(zone_t *zone, bool abort_txn)
@@ -53,11 +51,8 @@ knot_zonedb_t *knot_zonedb_new(void)
 		return NULL;
 	}
 
-	mm_ctx_mempool(&db->mm, MM_DEFAULT_BLKSIZE);
-
-	db->trie = trie_create(&db->mm);
+	db->trie = trie_create(NULL);
 	if (db->trie == NULL) {
-		mp_delete(db->mm.ctx);
 		free(db);
 		return NULL;
 	}
@@ -65,6 +60,41 @@ knot_zonedb_t *knot_zonedb_new(void)
 	return db;
 }
 
+knot_zonedb_t *knot_zonedb_cow(knot_zonedb_t *db)
+{
+	if (db == NULL || db->cow != NULL) {
+		return NULL;
+	}
+
+	knot_zonedb_t *db_new = calloc(1, sizeof(knot_zonedb_t));
+	if (db_new == NULL) {
+		return NULL;
+	}
+
+	db_new->cow = trie_cow(db->trie, NULL, NULL);
+	if (db_new->cow == NULL) {
+		free(db_new);
+		return NULL;
+	}
+	db_new->trie = trie_cow_new(db_new->cow);
+
+	return db_new;
+}
+
+void knot_zonedb_cow_commit(knot_zonedb_t **db_old, knot_zonedb_t *db_new)
+{
+	if (db_old == NULL || *db_old == NULL || db_new == NULL || db_new->cow == NULL) {
+		return;
+	}
+
+	// The old trie is freed except for the parts shared with the new one.
+	trie_cow_commit(db_new->cow, NULL, NULL);
+	db_new->cow = NULL;
+
+	free(*db_old);
+	*db_old = NULL;
+}
+
 int knot_zonedb_insert(knot_zonedb_t *db, zone_t *zone)
 {
 	if (db == NULL || zone == NULL) {
@@ -76,7 +106,12 @@ int knot_zonedb_insert(knot_zonedb_t *db, zone_t *zone)
 	uint8_t *lf = knot_dname_lf(zone->name, lf_storage);
 	assert(lf);
 
-	*trie_get_ins(db->trie, lf + 1, *lf) = zone;
+	trie_val_t *val = (db->cow != NULL) ? trie_get_cow(db->cow, lf + 1, *lf) :
+	                                      trie_get_ins(db->trie, lf + 1, *lf);
+	if (val == NULL) {
+		return KNOT_ENOMEM;
+	}
+	*val = zone;
 
 	return KNOT_EOK;
 }
@@ -96,6 +131,9 @@ int knot_zonedb_del(knot_zonedb_t *db, const knot_dname_t *zone_name)
 		return KNOT_ENOENT;
 	}
 
+	if (db->cow != NULL) {
+		return trie_del_cow(db->cow, lf + 1, *lf, NULL);
+	}
 	return trie_del(db->trie, lf + 1, *lf, NULL);
 }
 
@@ -172,7 +210,8 @@ void knot_zonedb_free(knot_zonedb_t **db)
 		return;
 	}
 
-	mp_delete((*db)->mm.ctx);
+	assert((*db)->cow == NULL);
+	trie_free((*db)->trie);
 	free(*db);
 	*db = NULL;
 }
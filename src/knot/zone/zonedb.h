@@ -28,7 +28,7 @@
 
 struct knot_zonedb {
 	trie_t *trie;
-	knot_mm_t mm;
+	trie_cow_t *cow; // non-NULL only during incremental update
 };
 
 /*
@@ -62,6 +62,30 @@ typedef trie_it_t knot_zonedb_iter_t;
  */
 knot_zonedb_t *knot_zonedb_new(void);
 
+/*!
+ * \brief Starts an incremental update of the zone database.
+ *
+ * The new database shares unchanged parts with the old one, which remains
+ * valid for readers until knot_zonedb_cow_commit() is called. The old
+ * database must not be modified meanwhile.
+ *
+ * \param db  Current zone database.
+ *
+ * \return New zone database or NULL if an error occurred.
+ */
+knot_zonedb_t *knot_zonedb_cow(knot_zonedb_t *db);
+
+/*!
+ * \brief Finishes the incremental update and frees the old database
+ *        (but not the zones within).
+ *
+ * \note Must be called once no reader uses the old database.
+ *
+ * \param db_old  Old zone database to be freed.
+ * \param db_new  Zone database returned by knot_zonedb_cow().
+ */
+void knot_zonedb_cow_commit(knot_zonedb_t **db_old, knot_zonedb_t *db_new);
+
 /*!
  * \brief Adds new zone to the database.
  *
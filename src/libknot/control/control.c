@@ -53,11 +53,15 @@ struct knot_ctl {
 	int timeout;
 	/*! Server listening socket. */
 	int listen_sock;
+	/*! Descriptor interrupting the accept (not owned). */
+	int wakeup_fd;
 	/*! Remote server/client socket. */
 	int sock;
 
 	/*! The latter read data. */
 	knot_ctl_data_t data;
+	/*! Lengths of the latter read data items. */
+	uint16_t data_len[KNOT_CTL_IDX__COUNT];
 
 	/*! Write wire context. */
 	wire_ctx_t wire_out;
@@ -132,6 +136,7 @@ static void clean_data(knot_ctl_t *ctx)
 {
 	mp_flush(ctx->mm.ctx);
 	memzero(ctx->data, sizeof(ctx->data));
+	memzero(ctx->data_len, sizeof(ctx->data_len));
 }
 
 static void close_sock(int *sock)
@@ -155,6 +160,7 @@ knot_ctl_t* knot_ctl_alloc(void)
 	mm_ctx_mempool(&ctx->mm, MM_DEFAULT_BLKSIZE);
 	ctx->timeout = DEFAULT_TIMEOUT;
 	ctx->listen_sock = -1;
+	ctx->wakeup_fd = -1;
 	ctx->sock = -1;
 
 	reset_buffers(ctx);
@@ -240,6 +246,16 @@ void knot_ctl_unbind(knot_ctl_t *ctx)
 	close_sock(&ctx->listen_sock);
 }
 
+_public_
+void knot_ctl_set_wakeup(knot_ctl_t *ctx, int fd)
+{
+	if (ctx == NULL) {
+		return;
+	}
+
+	ctx->wakeup_fd = fd;
+}
+
 _public_
 int knot_ctl_accept(knot_ctl_t *ctx)
 {
@@ -249,12 +265,18 @@ int knot_ctl_accept(knot_ctl_t *ctx)
 
 	knot_ctl_close(ctx);
 
-	// Control interface.
-	struct pollfd pfd = { .fd = ctx->listen_sock, .events = POLLIN };
-	int ret = poll(&pfd, 1, -1);
+	// Control interface and optional wakeup descriptor.
+	struct pollfd pfd[2] = {
+		{ .fd = ctx->listen_sock, .events = POLLIN },
+		{ .fd = ctx->wakeup_fd,   .events = POLLIN }, // Ignored if negative.
+	};
+	int ret = poll(pfd, 2, -1);
 	if (ret <= 0) {
 		return knot_map_errno();
 	}
+	if (!(pfd[0].revents & POLLIN)) {
+		return KNOT_EAGAIN;
+	}
 
 	int client = net_accept(ctx->listen_sock, NULL);
 	if (client < 0) {
@@ -268,6 +290,22 @@ int knot_ctl_accept(knot_ctl_t *ctx)
 	return KNOT_EOK;
 }
 
+_public_
+int knot_ctl_move(knot_ctl_t *ctx, knot_ctl_t *target)
+{
+	if (ctx == NULL || target == NULL || ctx->sock < 0 || target->sock >= 0) {
+		return KNOT_EINVAL;
+	}
+
+	target->sock = ctx->sock;
+	target->timeout = ctx->timeout;
+	ctx->sock = -1;
+
+	reset_buffers(target);
+
+	return KNOT_EOK;
+}
+
 _public_
 int knot_ctl_connect(knot_ctl_t *ctx, const char *path)
 {
@@ -325,7 +363,8 @@ static int ensure_output(knot_ctl_t *ctx, uint16_t len)
 	return KNOT_EOK;
 }
 
-static int send_item(knot_ctl_t *ctx, uint8_t code, const char *data, bool flush)
+static int send_item(knot_ctl_t *ctx, uint8_t code, const char *data,
+                     size_t data_len, bool flush)
 {
 	wire_ctx_t *w = &ctx->wire_out;
 
@@ -341,8 +380,7 @@ static int send_item(knot_ctl_t *ctx, uint8_t code, const char *data, bool flush
 
 	// Control block data is optional.
 	if (data != NULL) {
-		// Get the data length.
-		size_t data_len = strlen(data);
+		// Check the data length.
 		if (data_len > UINT16_MAX) {
 			return KNOT_ERANGE;
 		}
@@ -382,13 +420,9 @@ static int send_item(knot_ctl_t *ctx, uint8_t code, const char *data, bool flush
 	return KNOT_EOK;
 }
 
-_public_
-int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data)
+static int send_unit(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data,
+                     int bin_idx, size_t bin_len)
 {
-	if (ctx == NULL) {
-		return KNOT_EINVAL;
-	}
-
 	// Get the type code.
 	int code = type_to_code(type);
 	if (code == -1) {
@@ -396,7 +430,7 @@ int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data)
 	}
 
 	// Send unit type.
-	int ret = send_item(ctx, code, NULL, !is_data_type(type));
+	int ret = send_item(ctx, code, NULL, 0, !is_data_type(type));
 	if (ret != KNOT_EOK) {
 		return ret;
 	}
@@ -410,7 +444,8 @@ int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data)
 				continue;
 			}
 
-			ret = send_item(ctx, idx_to_code(i), value, false);
+			size_t len = (i == bin_idx) ? bin_len : strlen(value);
+			ret = send_item(ctx, idx_to_code(i), value, len, false);
 			if (ret != KNOT_EOK) {
 				return ret;
 			}
@@ -420,6 +455,27 @@ int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data)
 	return KNOT_EOK;
 }
 
+_public_
+int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data)
+{
+	if (ctx == NULL) {
+		return KNOT_EINVAL;
+	}
+
+	return send_unit(ctx, type, data, -1, 0);
+}
+
+_public_
+int knot_ctl_send_bin(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data,
+                      knot_ctl_idx_t bin_idx, size_t bin_len)
+{
+	if (ctx == NULL || bin_idx >= KNOT_CTL_IDX__COUNT || bin_len > UINT16_MAX) {
+		return KNOT_EINVAL;
+	}
+
+	return send_unit(ctx, type, data, bin_idx, bin_len);
+}
+
 static int ensure_input(knot_ctl_t *ctx, uint16_t len)
 {
 	wire_ctx_t *w = &ctx->wire_in;
@@ -467,7 +523,7 @@ static int receive_item_code(knot_ctl_t *ctx, uint8_t *code)
 	return KNOT_EOK;
 }
 
-static int receive_item_value(knot_ctl_t *ctx, char **value)
+static int receive_item_value(knot_ctl_t *ctx, char **value, uint16_t *value_len)
 {
 	wire_ctx_t *w = &ctx->wire_in;
 
@@ -495,6 +551,7 @@ static int receive_item_value(knot_ctl_t *ctx, char **value)
 		return w->error;
 	}
 	(*value)[data_len] = '\0';
+	*value_len = data_len;
 
 	return KNOT_EOK;
 }
@@ -549,7 +606,8 @@ int knot_ctl_receive(knot_ctl_t *ctx, knot_ctl_type_t *type, knot_ctl_data_t *da
 		}
 
 		// Store the item data value.
-		ret = receive_item_value(ctx, (char **)&ctx->data[idx]);
+		ret = receive_item_value(ctx, (char **)&ctx->data[idx],
+		                         &ctx->data_len[idx]);
 		if (ret != KNOT_EOK) {
 			return ret;
 		}
@@ -562,3 +620,13 @@ int knot_ctl_receive(knot_ctl_t *ctx, knot_ctl_type_t *type, knot_ctl_data_t *da
 
 	return KNOT_EOK;
 }
+
+_public_
+size_t knot_ctl_data_len(knot_ctl_t *ctx, knot_ctl_idx_t idx)
+{
+	if (ctx == NULL || idx >= KNOT_CTL_IDX__COUNT) {
+		return 0;
+	}
+
+	return ctx->data_len[idx];
+}
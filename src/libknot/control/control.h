@@ -25,6 +25,8 @@
 
 #pragma once
 
+#include <stddef.h>
+
 /*! Control data item indexes. */
 typedef enum {
 	KNOT_CTL_IDX_CMD = 0, /*!< Control command name. */
@@ -114,6 +116,18 @@ void knot_ctl_unbind(knot_ctl_t *ctx);
  */
 int knot_ctl_connect(knot_ctl_t *ctx, const char *path);
 
+/*!
+ * Sets a descriptor which interrupts waiting for a connection when readable.
+ *
+ * The descriptor is neither read nor closed by the control context.
+ *
+ * \note Server operation.
+ *
+ * \param[in] ctx  Control context.
+ * \param[in] fd   Descriptor to be polled, -1 to disable.
+ */
+void knot_ctl_set_wakeup(knot_ctl_t *ctx, int fd);
+
 /*!
  * Waits for an incoming connection.
  *
@@ -121,10 +135,26 @@ int knot_ctl_connect(knot_ctl_t *ctx, const char *path);
  *
  * \param[in] ctx  Control context.
  *
- * \return Error code, KNOT_EOK if successful.
+ * \return Error code, KNOT_EOK if successful, KNOT_EAGAIN if interrupted
+ *         by the wakeup descriptor.
  */
 int knot_ctl_accept(knot_ctl_t *ctx);
 
+/*!
+ * Moves the accepted connection to another control context.
+ *
+ * The source context can accept a new connection afterwards, while the
+ * connection is being processed using the target context.
+ *
+ * \note Server operation.
+ *
+ * \param[in] ctx     Control context with an accepted connection.
+ * \param[in] target  Unconnected control context.
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int knot_ctl_move(knot_ctl_t *ctx, knot_ctl_t *target);
+
 /*!
  * Closes the remote connections.
  *
@@ -145,6 +175,23 @@ void knot_ctl_close(knot_ctl_t *ctx);
  */
 int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data);
 
+/*!
+ * Sends one control unit with a binary data item.
+ *
+ * The same as knot_ctl_send(), but the specified data item is sent with
+ * the explicit length, so it can contain zero bytes.
+ *
+ * \param[in] ctx      Control context.
+ * \param[in] type     Unit type to send.
+ * \param[in] data     Data unit to send (optional, ignored if non-data type).
+ * \param[in] bin_idx  Index of the binary data item.
+ * \param[in] bin_len  Length of the binary data item (max 65535).
+ *
+ * \return Error code, KNOT_EOK if successful.
+ */
+int knot_ctl_send_bin(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data,
+                      knot_ctl_idx_t bin_idx, size_t bin_len);
+
 /*!
  * Receives one control unit.
  *
@@ -156,4 +203,16 @@ int knot_ctl_send(knot_ctl_t *ctx, knot_ctl_type_t type, knot_ctl_data_t *data);
  */
 int knot_ctl_receive(knot_ctl_t *ctx, knot_ctl_type_t *type, knot_ctl_data_t *data);
 
+/*!
+ * Returns the length of a data item of the last received unit.
+ *
+ * \note Required for binary data items, which can contain zero bytes.
+ *
+ * \param[in] ctx  Control context.
+ * \param[in] idx  Data item index.
+ *
+ * \return Data item length, 0 if not present.
+ */
+size_t knot_ctl_data_len(knot_ctl_t *ctx, knot_ctl_idx_t idx);
+
 /*! @} */
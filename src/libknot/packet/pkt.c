@@ -161,9 +161,12 @@ static int pkt_rr_array_alloc(knot_pkt_t *pkt, uint16_t count)
 	if (pkt->rrset_allocd > 0) {
 		memcpy(rr_info, pkt->rr_info, pkt->rrset_allocd * sizeof(knot_rrinfo_t));
 		memcpy(rr, pkt->rr, pkt->rrset_allocd * sizeof(knot_rrset_t));
-		mm_free(&pkt->mm, pkt->rr);
-		mm_free(&pkt->mm, pkt->rr_info);
+		if (!(pkt->flags & KNOT_PF_EXTRR)) {
+			mm_free(&pkt->mm, pkt->rr);
+			mm_free(&pkt->mm, pkt->rr_info);
+		}
 	}
+	pkt->flags &= ~KNOT_PF_EXTRR;
 	pkt->rr = rr;
 	pkt->rr_info = rr_info;
 	pkt->rrset_allocd = next_size;
@@ -263,6 +266,31 @@ static int append_tsig(knot_pkt_t *dst, const knot_pkt_t *src)
 	return KNOT_EOK;
 }
 
+_public_
+void knot_pkt_init(knot_pkt_t *pkt, void *wire, uint16_t len, knot_mm_t *mm,
+                   knot_rrinfo_t *rr_info, knot_rrset_t *rr, uint16_t rr_count)
+{
+	if (pkt == NULL || wire == NULL) {
+		return;
+	}
+
+	/* Default memory allocator if NULL. */
+	knot_mm_t _mm;
+	if (mm == NULL) {
+		mm_ctx_init(&_mm);
+		mm = &_mm;
+	}
+
+	(void)pkt_init(pkt, wire, len, mm);
+
+	if (rr_info != NULL && rr != NULL && rr_count > 0) {
+		pkt->rr_info = rr_info;
+		pkt->rr = rr;
+		pkt->rrset_allocd = rr_count;
+		pkt->flags |= KNOT_PF_EXTRR;
+	}
+}
+
 _public_
 int knot_pkt_copy(knot_pkt_t *dst, const knot_pkt_t *src)
 {
@@ -289,6 +317,7 @@ int knot_pkt_copy(knot_pkt_t *dst, const knot_pkt_t *src)
 	dst->rr_info = NULL;
 	dst->rrset_count = 0;
 	dst->rrset_allocd = 0;
+	dst->flags &= ~KNOT_PF_EXTRR;
 
 	/* @note This could be done more effectively if needed. */
 	return knot_pkt_parse(dst, 0);
@@ -389,8 +418,10 @@ void knot_pkt_free(knot_pkt_t *pkt)
 	pkt_free_data(pkt);
 
 	/* Free RR/RR info arrays. */
-	mm_free(&pkt->mm, pkt->rr);
-	mm_free(&pkt->mm, pkt->rr_info);
+	if (!(pkt->flags & KNOT_PF_EXTRR)) {
+		mm_free(&pkt->mm, pkt->rr);
+		mm_free(&pkt->mm, pkt->rr_info);
+	}
 
 	/* Free the space for wireformat. */
 	if (pkt->flags & KNOT_PF_FREE) {
@@ -52,6 +52,7 @@ enum {
 	KNOT_PF_NOCANON   = 1 << 5, /*!< Don't canonicalize rrsets during parsing. */
 	KNOT_PF_ORIGTTL   = 1 << 6, /*!< Write RRSIGs with their original TTL. */
 	KNOT_PF_SOAMINTTL = 1 << 7, /*!< Write SOA with its minimum-ttl as TTL. */
+	KNOT_PF_EXTRR     = 1 << 8, /*!< RR arrays are owned by the caller. */
 };
 
 typedef struct knot_pkt knot_pkt_t;
@@ -119,6 +120,26 @@ struct knot_pkt {
  */
 knot_pkt_t *knot_pkt_new(void *wire, uint16_t len, knot_mm_t *mm);
 
+/*!
+ * \brief Initialize a packet structure provided by the caller over existing memory.
+ *
+ * Unlike knot_pkt_new(), neither the packet structure nor the RR arrays
+ * are allocated. The RR arrays provided by the caller are used until they
+ * get full, then larger ones are allocated from the memory context.
+ *
+ * \note The packet must not be freed by knot_pkt_free().
+ *
+ * \param pkt       Packet structure to be initialized.
+ * \param wire      Wire format of the packet.
+ * \param len       Wire format length.
+ * \param mm        Memory context (NULL for default).
+ * \param rr_info   RR info array (optional).
+ * \param rr        RR array (optional).
+ * \param rr_count  Number of items of the RR arrays.
+ */
+void knot_pkt_init(knot_pkt_t *pkt, void *wire, uint16_t len, knot_mm_t *mm,
+                   knot_rrinfo_t *rr_info, knot_rrset_t *rr, uint16_t rr_count);
+
 /*!
  * \brief Copy packet.
  *
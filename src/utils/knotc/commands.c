@@ -14,6 +14,7 @@
     along with this program.  If not, see <https://www.gnu.org/licenses/>.
  */
 
+#include <inttypes.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -29,6 +30,8 @@
 #include "contrib/string.h"
 #include "contrib/strtonum.h"
 #include "contrib/openbsd/strlcat.h"
+#include "contrib/openbsd/strlcpy.h"
+#include "libzscanner/scanner.h"
 #include "utils/knotc/commands.h"
 
 #define CMD_EXIT		"exit"
@@ -81,6 +84,8 @@
 
 #define CTL_LOG_STR		"failed to control"
 
+#define FILTER_FILE		"+file"
+
 #define CTL_SEND(type, data) \
 	ret = knot_ctl_send(args->ctl, (type), (data)); \
 	if (ret != KNOT_EOK) { \
@@ -404,7 +409,10 @@ static void format_block(ctl_cmd_t cmd, bool failed, bool empty)
 	}
 }
 
-static int ctl_receive(cmd_args_t *args)
+/*!
+ * Receive one answer block, its result is printed only if last or failed.
+ */
+static int ctl_receive_block(cmd_args_t *args, bool last)
 {
 	bool failed = false;
 	bool empty = true;
@@ -424,7 +432,9 @@ static int ctl_receive(cmd_args_t *args)
 			log_error(CTL_LOG_STR" (%s)", knot_strerror(KNOT_EMALF));
 			return KNOT_EMALF;
 		case KNOT_CTL_TYPE_BLOCK:
-			format_block(args->desc->cmd, failed, empty);
+			if (last || failed) {
+				format_block(args->desc->cmd, failed, empty);
+			}
 			return failed ? KNOT_ERROR : KNOT_EOK;
 		case KNOT_CTL_TYPE_DATA:
 		case KNOT_CTL_TYPE_EXTRA:
@@ -443,6 +453,11 @@ static int ctl_receive(cmd_args_t *args)
 	return KNOT_EOK;
 }
 
+static int ctl_receive(cmd_args_t *args)
+{
+	return ctl_receive_block(args, true);
+}
+
 static int cmd_ctl(cmd_args_t *args)
 {
 	int ret = check_args(args, 0, (args->desc->cmd == CTL_STATUS ? 1 : 0));
@@ -867,8 +882,140 @@ static int set_node_items(cmd_args_t *args, knot_ctl_data_t *data, char *rdata,
 	return KNOT_EOK;
 }
 
+typedef struct {
+	cmd_args_t *args;
+	knot_ctl_data_t data;
+	int ret;
+	size_t wire_len;
+	uint8_t wire[UINT16_MAX];
+	uint8_t rdata[sizeof(knot_rdata_t) + UINT16_MAX];
+} bulk_ctx_t;
+
+/*!
+ * Send pending records as a separate command and wait for its answer.
+ */
+static int bulk_send(bulk_ctx_t *ctx, bool last)
+{
+	cmd_args_t *args = ctx->args;
+
+	if (ctx->wire_len == 0) {
+		// Nothing to be sent, only possible if no records at all.
+		if (last) {
+			format_block(args->desc->cmd, false, true);
+		}
+		return KNOT_EOK;
+	}
+
+	int ret = knot_ctl_send_bin(args->ctl, KNOT_CTL_TYPE_DATA, &ctx->data,
+	                            KNOT_CTL_IDX_DATA, ctx->wire_len);
+	if (ret == KNOT_EOK) {
+		ret = knot_ctl_send(args->ctl, KNOT_CTL_TYPE_BLOCK, NULL);
+	}
+	ctx->wire_len = 0;
+	if (ret != KNOT_EOK) {
+		log_error(CTL_LOG_STR" (%s)", knot_strerror(ret));
+		return ret;
+	}
+
+	return ctl_receive_block(args, last);
+}
+
+static void bulk_record(zs_scanner_t *scanner)
+{
+	bulk_ctx_t *ctx = scanner->process.data;
+
+	knot_rdata_t *rdata = (knot_rdata_t *)ctx->rdata;
+	knot_rdata_init(rdata, scanner->r_data_length, scanner->r_data);
+
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, scanner->r_owner, scanner->r_type, scanner->r_class,
+	                scanner->r_ttl);
+	rr.rrs.count = 1;
+	rr.rrs.size = knot_rdata_size(rdata->len);
+	rr.rrs.rdata = rdata;
+
+	// Pack as many records as possible into one data unit.
+	int ret = knot_rrset_to_wire(&rr, ctx->wire + ctx->wire_len,
+	                             sizeof(ctx->wire) - ctx->wire_len, NULL);
+	if (ret == KNOT_ESPACE && ctx->wire_len > 0) {
+		ret = bulk_send(ctx, false);
+		if (ret == KNOT_EOK) {
+			ret = knot_rrset_to_wire(&rr, ctx->wire, sizeof(ctx->wire), NULL);
+		}
+	}
+	if (ret < 0) {
+		ctx->ret = ret;
+		scanner->state = ZS_STATE_STOP;
+		return;
+	}
+
+	ctx->wire_len += ret;
+}
+
+static void bulk_error(zs_scanner_t *scanner)
+{
+	bulk_ctx_t *ctx = scanner->process.data;
+
+	log_error("file '%s', line %"PRIu64" (%s)", scanner->file.name,
+	          scanner->line_counter, zs_strerror(scanner->error.code));
+
+	ctx->ret = KNOT_EPARSEFAIL;
+	scanner->state = ZS_STATE_STOP;
+}
+
+static int cmd_zone_bulk_ctl(cmd_args_t *args)
+{
+	const char *zone = args->argv[0];
+	const char *file = args->argv[2];
+
+	bulk_ctx_t *ctx = malloc(sizeof(*ctx));
+	if (ctx == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	char flags[sizeof(args->flags) + 1];
+	strlcpy(flags, args->flags, sizeof(flags));
+	strlcat(flags, CTL_FLAG_WIRE, sizeof(flags));
+
+	*ctx = (bulk_ctx_t) {
+		.args = args,
+		.data = {
+			[KNOT_CTL_IDX_CMD] = ctl_cmd_to_str(args->desc->cmd),
+			[KNOT_CTL_IDX_FLAGS] = flags,
+			[KNOT_CTL_IDX_ZONE] = zone,
+			[KNOT_CTL_IDX_DATA] = (const char *)ctx->wire,
+		},
+	};
+
+	// Records are parsed locally and sent in wire format.
+	zs_scanner_t scanner;
+	int ret = KNOT_EOK;
+	if (zs_init(&scanner, zone, KNOT_CLASS_IN, 3600) != 0 ||
+	    zs_set_input_file(&scanner, file) != 0 ||
+	    zs_set_processing(&scanner, bulk_record, bulk_error, ctx) != 0) {
+		log_error("failed to open file '%s' (%s)", file,
+		          zs_strerror(scanner.error.code));
+		ret = KNOT_EFILE;
+	} else if (zs_parse_all(&scanner) != 0 || ctx->ret != KNOT_EOK) {
+		ret = (ctx->ret != KNOT_EOK) ? ctx->ret : KNOT_EPARSEFAIL;
+	}
+	zs_deinit(&scanner);
+
+	if (ret == KNOT_EOK) {
+		ret = bulk_send(ctx, true);
+	}
+	free(ctx);
+
+	return ret;
+}
+
 static int cmd_zone_node_ctl(cmd_args_t *args)
 {
+	if ((args->desc->cmd == CTL_ZONE_SET || args->desc->cmd == CTL_ZONE_UNSET) &&
+	    args->argc == 3 && strcmp(args->argv[1], FILTER_FILE) == 0) {
+		return cmd_zone_bulk_ctl(args);
+	}
+
 	knot_ctl_data_t data = {
 		[KNOT_CTL_IDX_CMD] = ctl_cmd_to_str(args->desc->cmd),
 		[KNOT_CTL_IDX_FLAGS] = args->flags,
@@ -1111,7 +1258,9 @@ static const cmd_help_t cmd_help_table[] = {
 	{ CMD_ZONE_DIFF,       "<zone>",                                     "Get zone changes within the transaction." },
 	{ CMD_ZONE_GET,        "<zone> [<owner> [<type>]]",                  "Get zone data within the transaction." },
 	{ CMD_ZONE_SET,        "<zone>  <owner> [<ttl>] <type> <rdata>",     "Add zone record within the transaction." },
+	{ CMD_ZONE_SET,        "<zone>  +file <filename>",                   "Add zone records from a file within the transaction." },
 	{ CMD_ZONE_UNSET,      "<zone>  <owner> [<type> [<rdata>]]",         "Remove zone data within the transaction." },
+	{ CMD_ZONE_UNSET,      "<zone>  +file <filename>",                   "Remove zone records from a file within the transaction." },
 	{ CMD_ZONE_PURGE,      "<zone>... [<filter>...]",                    "Purge zone data, zone file, journal, timers, and KASP data. (#)" },
 	{ CMD_ZONE_STATS,      "<zone> [<module>[.<counter>]]",              "Show zone statistics counter(s)."},
 	{ CMD_ZONE_STATUS,     "<zone> [<filter>...]",                       "Show the zone status." },
@@ -15,6 +15,7 @@
  */
 
 #include <dirent.h>
+#include <errno.h>
 #include <fcntl.h>
 #include <poll.h>
 #include <stdbool.h>
@@ -32,6 +33,7 @@
 
 #include "libdnssec/crypto.h"
 #include "libknot/libknot.h"
+#include "contrib/semaphore.h"
 #include "contrib/strtonum.h"
 #include "knot/ctl/process.h"
 #include "knot/conf/conf.h"
@@ -47,9 +49,23 @@
 #define PROGRAM_NAME "knotd"
 
 /* Signal flags. */
-static volatile bool sig_req_stop = false;
-static volatile bool sig_req_reload = false;
-static volatile bool sig_req_zones_reload = false;
+static volatile sig_atomic_t sig_req_stop = false;
+static volatile sig_atomic_t sig_req_reload = false;
+static volatile sig_atomic_t sig_req_zones_reload = false;
+
+/* Pipe waking up the event loop waiting for a control connection. */
+static int wakeup_pipe[2] = { -1, -1 };
+
+/*! \brief Interrupt the event loop (async-signal-safe). */
+static void wakeup_event_loop(void)
+{
+	if (wakeup_pipe[1] >= 0) {
+		int errno_orig = errno;
+		uint8_t byte = 0;
+		(void)write(wakeup_pipe[1], &byte, sizeof(byte));
+		errno = errno_orig;
+	}
+}
 
 static int make_daemon(int nochdir, int noclose)
 {
@@ -116,7 +132,7 @@ struct signal {
 /*! \brief Signals used by the server. */
 static const struct signal SIGNALS[] = {
 	{ SIGHUP,  true  },  /* Reload server. */
-	{ SIGUSR1, true  },  /* Reload zones. */
+	{ SIGUSR1, true  },  /* Apply catalog changes. */
 	{ SIGINT,  true  },  /* Terminate server. */
 	{ SIGTERM, true  },  /* Terminate server. */
 	{ SIGALRM, false },  /* Internal thread synchronization. */
@@ -145,6 +161,8 @@ static void handle_signal(int signum)
 		/* ignore */
 		break;
 	}
+
+	wakeup_event_loop();
 }
 
 /*! \brief Setup signal handlers and blocking mask. */
@@ -203,6 +221,62 @@ static void drop_capabilities(void)
 #endif /* ENABLE_CAP_NG */
 }
 
+/*! \brief Control session processed by a control worker. */
+typedef struct {
+	worker_task_t task;
+	knot_ctl_t *ctl;
+	server_t *server;
+	knot_sem_t *slots;
+} ctl_session_t;
+
+static void ctl_session_run(worker_task_t *task)
+{
+	ctl_session_t *session = task->ctx;
+
+	int ret = ctl_process(session->ctl, session->server);
+	knot_ctl_free(session->ctl);
+
+	if (ret == KNOT_CTL_ESTOP) {
+		sig_req_stop = true;
+		wakeup_event_loop();
+	}
+
+	knot_sem_post(session->slots);
+	free(session);
+}
+
+/*! \brief Hand the accepted connection over to a control worker. */
+static int ctl_session_start(knot_ctl_t *ctl, server_t *server,
+                             worker_pool_t *pool, knot_sem_t *slots)
+{
+	ctl_session_t *session = calloc(1, sizeof(*session));
+	if (session == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	session->ctl = knot_ctl_alloc();
+	if (session->ctl == NULL) {
+		free(session);
+		return KNOT_ENOMEM;
+	}
+
+	int ret = knot_ctl_move(ctl, session->ctl);
+	if (ret != KNOT_EOK) {
+		knot_ctl_free(session->ctl);
+		free(session);
+		return ret;
+	}
+
+	session->server = server;
+	session->slots = slots;
+	session->task.ctx = session;
+	session->task.run = ctl_session_run;
+
+	worker_pool_assign(pool, &session->task);
+
+	return KNOT_EOK;
+}
+
 /*! \brief Event loop listening for signals and remote commands. */
 static void event_loop(server_t *server, const char *socket)
 {
@@ -233,6 +307,23 @@ static void event_loop(server_t *server, const char *socket)
 		return;
 	}
 
+	/* Start control workers. */
+	conf_val_t workers_val = conf_get(conf(), C_CTL, C_WORKERS);
+	unsigned workers = conf_int(&workers_val);
+	worker_pool_t *pool = worker_pool_create(workers);
+	if (pool == NULL) {
+		knot_ctl_free(ctl);
+		log_fatal("control, failed to initialize (%s)",
+		          knot_strerror(KNOT_ENOMEM));
+		free(listen);
+		return;
+	}
+	worker_pool_start(pool);
+
+	/* Each worker processes one session at a time. */
+	knot_sem_t slots;
+	knot_sem_init(&slots, workers);
+
 	log_info("control, binding to '%s'", listen);
 
 	/* Bind the control socket. */
@@ -242,10 +333,20 @@ static void event_loop(server_t *server, const char *socket)
 		log_fatal("control, failed to bind socket '%s' (%s)",
 		          listen, knot_strerror(ret));
 		free(listen);
-		return;
+		goto finish;
 	}
 	free(listen);
 
+	/* Wake up the event loop upon signals and stop requests. */
+	if (pipe(wakeup_pipe) != 0 ||
+	    fcntl(wakeup_pipe[0], F_SETFL, O_NONBLOCK) != 0 ||
+	    fcntl(wakeup_pipe[1], F_SETFL, O_NONBLOCK) != 0) {
+		log_fatal("control, failed to initialize (%s)",
+		          knot_strerror(knot_map_errno()));
+		goto unbind;
+	}
+	knot_ctl_set_wakeup(ctl, wakeup_pipe[0]);
+
 	enable_signals();
 
 	/* Notify systemd about successful start. */
@@ -253,14 +354,22 @@ static void event_loop(server_t *server, const char *socket)
 
 	/* Run event loop. */
 	for (;;) {
+		/* Consume wakeups, the flags are checked afterwards. */
+		uint8_t drain[64];
+		while (read(wakeup_pipe[0], drain, sizeof(drain)) > 0);
+
 		/* Interrupts. */
 		if (sig_req_reload && !sig_req_stop) {
 			sig_req_reload = false;
+			pthread_rwlock_wrlock(&server->ctl_lock);
 			server_reload(server);
+			pthread_rwlock_unlock(&server->ctl_lock);
 		}
 		if (sig_req_zones_reload && !sig_req_stop) {
 			sig_req_zones_reload = false;
-			server_update_zones(conf(), server);
+			pthread_rwlock_wrlock(&server->ctl_lock);
+			server_update_catalog_zones(conf(), server);
+			pthread_rwlock_unlock(&server->ctl_lock);
 		}
 		if (sig_req_stop) {
 			break;
@@ -274,16 +383,35 @@ static void event_loop(server_t *server, const char *socket)
 			continue;
 		}
 
-		ret = ctl_process(ctl, server);
-		knot_ctl_close(ctl);
-		if (ret == KNOT_CTL_ESTOP) {
-			break;
+		knot_sem_wait(&slots);
+		ret = ctl_session_start(ctl, server, pool, &slots);
+		if (ret != KNOT_EOK) {
+			log_ctl_error("control, failed to start session (%s)",
+			              knot_strerror(ret));
+			knot_ctl_close(ctl);
+			knot_sem_post(&slots);
 		}
 	}
 
+unbind:
 	/* Unbind the control socket. */
 	knot_ctl_unbind(ctl);
 	knot_ctl_free(ctl);
+finish:
+	/* Wait for running sessions. */
+	worker_pool_wait(pool);
+	worker_pool_stop(pool);
+	worker_pool_join(pool);
+	worker_pool_destroy(pool);
+	knot_sem_destroy(&slots);
+
+	for (int i = 1; i >= 0; i--) {
+		int fd = wakeup_pipe[i];
+		wakeup_pipe[i] = -1;
+		if (fd >= 0) {
+			close(fd);
+		}
+	}
 }
 
 static void print_help(void)
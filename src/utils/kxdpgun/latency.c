@@ -0,0 +1,187 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "utils/kxdpgun/latency.h"
+
+#define SUB_BUCKETS  (1 << LATENCY_SUB_BITS)
+#define PORT_COUNT   (UINT16_MAX + 1)
+#define TIME_BITS    48
+#define BAR_WIDTH    40
+
+uint64_t latency_now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static unsigned bucket_idx(uint64_t val)
+{
+	if (val < SUB_BUCKETS) {
+		return val;
+	}
+
+	unsigned order = 63 - __builtin_clzll(val);
+	unsigned sub = (val >> (order - LATENCY_SUB_BITS)) & (SUB_BUCKETS - 1);
+	unsigned idx = ((order - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) + sub;
+
+	return idx < LATENCY_BUCKETS ? idx : LATENCY_BUCKETS - 1;
+}
+
+static uint64_t bucket_low(unsigned idx)
+{
+	if (idx < SUB_BUCKETS) {
+		return idx;
+	}
+
+	unsigned order = (idx >> LATENCY_SUB_BITS) + LATENCY_SUB_BITS - 1;
+	unsigned sub = idx & (SUB_BUCKETS - 1);
+
+	return (uint64_t)(SUB_BUCKETS + sub) << (order - LATENCY_SUB_BITS);
+}
+
+void latency_add(latency_stats_t *st, uint64_t rtt)
+{
+	if (st->count == 0 || rtt < st->min) {
+		st->min = rtt;
+	}
+	if (rtt > st->max) {
+		st->max = rtt;
+	}
+	st->count++;
+	st->sum += rtt;
+	st->hist[bucket_idx(rtt)]++;
+}
+
+void latency_merge(latency_stats_t *into, const latency_stats_t *what)
+{
+	if (what->count == 0) {
+		return;
+	}
+	if (into->count == 0 || what->min < into->min) {
+		into->min = what->min;
+	}
+	if (what->max > into->max) {
+		into->max = what->max;
+	}
+	into->count += what->count;
+	into->sum += what->sum;
+	for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+		into->hist[i] += what->hist[i];
+	}
+}
+
+uint64_t latency_percentile(const latency_stats_t *st, double pct)
+{
+	if (st->count == 0) {
+		return 0;
+	}
+
+	uint64_t rank = pct / 100.0 * st->count;
+	uint64_t seen = 0;
+	for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+		seen += st->hist[i];
+		if (seen > rank) {
+			/* Middle of the bucket, clamped to the observed range. */
+			uint64_t val = (bucket_low(i) + bucket_low(i + 1)) / 2;
+			return val < st->min ? st->min : (val > st->max ? st->max : val);
+		}
+	}
+
+	return st->max;
+}
+
+void latency_print(const latency_stats_t *st)
+{
+	if (st->count == 0) {
+		return;
+	}
+
+#define us(ns) ((ns) / 1000.0)
+
+	printf("latency min/avg/max: %.1f/%.1f/%.1f us\n",
+	       us(st->min), us(st->sum / st->count), us(st->max));
+	printf("latency p50/p99/p99.9: %.1f/%.1f/%.1f us\n",
+	       us(latency_percentile(st, 50)), us(latency_percentile(st, 99)),
+	       us(latency_percentile(st, 99.9)));
+
+	/* Histogram with power-of-two rows. */
+	uint64_t rows[LATENCY_BUCKETS / SUB_BUCKETS] = { 0 };
+	unsigned first = LATENCY_BUCKETS, last = 0;
+	for (unsigned i = 0; i < LATENCY_BUCKETS; i++) {
+		rows[i / SUB_BUCKETS] += st->hist[i];
+		if (st->hist[i] > 0) {
+			first = (i < first) ? i : first;
+			last = i;
+		}
+	}
+	uint64_t peak = 0;
+	for (unsigned row = first / SUB_BUCKETS; row <= last / SUB_BUCKETS; row++) {
+		peak = (rows[row] > peak) ? rows[row] : peak;
+	}
+	for (unsigned row = first / SUB_BUCKETS; row <= last / SUB_BUCKETS; row++) {
+		int bar = rows[row] * BAR_WIDTH / peak;
+		printf("  %9.1f - %9.1f us: %12"PRIu64" %5.1f%% %.*s\n",
+		       us(bucket_low(row * SUB_BUCKETS)),
+		       us(bucket_low((row + 1) * SUB_BUCKETS)), rows[row],
+		       100.0 * rows[row] / st->count, bar,
+		       "########################################");
+	}
+
+#undef us
+}
+
+bool latency_table_init(latency_table_t *table)
+{
+	table->slots = calloc(PORT_COUNT, sizeof(*table->slots));
+	table->start = latency_now();
+	return table->slots != NULL;
+}
+
+void latency_table_deinit(latency_table_t *table)
+{
+	free(table->slots);
+	table->slots = NULL;
+}
+
+void latency_sent(latency_table_t *table, uint16_t key, uint16_t msgid, uint64_t now)
+{
+	uint64_t sent = (now - table->start) & ((UINT64_C(1) << TIME_BITS) - 1);
+	__atomic_store_n(&table->slots[key], (sent << 16) | msgid, __ATOMIC_RELAXED);
+}
+
+bool latency_recv(latency_table_t *table, uint16_t key, uint16_t msgid,
+                  uint64_t now, uint64_t *rtt)
+{
+	uint64_t slot = __atomic_load_n(&table->slots[key], __ATOMIC_RELAXED);
+	if (slot == 0 || (slot & UINT16_MAX) != msgid ||
+	    !__atomic_compare_exchange_n(&table->slots[key], &slot, 0, false,
+	                                 __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+		return false;
+	}
+
+	uint64_t sent = slot >> 16;
+	uint64_t recv = (now - table->start) & ((UINT64_C(1) << TIME_BITS) - 1);
+	*rtt = (recv - sent) & ((UINT64_C(1) << TIME_BITS) - 1);
+
+	return true;
+}
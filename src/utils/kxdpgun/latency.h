@@ -0,0 +1,77 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define LATENCY_SUB_BITS 3
+#define LATENCY_BUCKETS  (40 << LATENCY_SUB_BITS)
+
+/*!
+ * \brief Latency statistics with a log-linear histogram (nanoseconds).
+ *
+ * Each power-of-two range is split into 8 buckets, so the percentiles are
+ * accurate to about 6 %.
+ */
+typedef struct {
+	uint64_t count;
+	uint64_t sum;
+	uint64_t min;
+	uint64_t max;
+	uint64_t hist[LATENCY_BUCKETS];
+} latency_stats_t;
+
+/*!
+ * \brief Send times of outstanding queries indexed by a 16-bit key.
+ *
+ * The key is the local port in the XDP mode or the message ID in the socket
+ * mode. Each slot holds the send time relative to the table creation and
+ * the message ID of the last query with the key, so a late response to an older
+ * query from a reused port isn't matched.
+ */
+typedef struct {
+	uint64_t *slots;
+	uint64_t start;
+} latency_table_t;
+
+/*! \brief Get monotonic time in nanoseconds. */
+uint64_t latency_now(void);
+
+void latency_add(latency_stats_t *st, uint64_t rtt);
+
+void latency_merge(latency_stats_t *into, const latency_stats_t *what);
+
+uint64_t latency_percentile(const latency_stats_t *st, double pct);
+
+void latency_print(const latency_stats_t *st);
+
+bool latency_table_init(latency_table_t *table);
+
+void latency_table_deinit(latency_table_t *table);
+
+/*! \brief Record a query sent with the key (thread-safe). */
+void latency_sent(latency_table_t *table, uint16_t key, uint16_t msgid, uint64_t now);
+
+/*!
+ * \brief Match a response with the query sent with the key (thread-safe).
+ *
+ * \return True if matched, the query is forgotten and its RTT is stored.
+ */
+bool latency_recv(latency_table_t *table, uint16_t key, uint16_t msgid,
+                  uint64_t now, uint64_t *rtt);
@@ -19,9 +19,15 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <netinet/in.h>
 
 #include "load_queries.h"
 #include <libknot/libknot.h>
+#include "contrib/macros.h"
+#if USE_DNSTAP
+# include "contrib/dnstap/convert.h"
+# include "contrib/dnstap/reader.h"
+#endif // USE_DNSTAP
 
 #define ERR_PREFIX "failed loading queries "
 
@@ -32,6 +38,8 @@ enum qflags {
 
 struct pkt_payload *global_payloads = NULL;
 
+uint64_t global_payloads_span = 0;
+
 void free_global_payloads()
 {
 	struct pkt_payload *g_payloads_p = global_payloads, *tmp;
@@ -40,6 +48,409 @@ void free_global_payloads()
 		g_payloads_p = tmp->next;
 		free(tmp);
 	}
+	global_payloads = NULL;
+	global_payloads_span = 0;
+}
+
+#define PCAP_MAGIC       0xa1b2c3d4
+#define PCAP_MAGIC_NS    0xa1b23c4d
+#define PCAPNG_SHB       0x0a0d0d0a
+#define PCAPNG_BOM       0x1a2b3c4d
+#define PCAPNG_IDB       1
+#define PCAPNG_SPB       3
+#define PCAPNG_EPB       6
+#define PCAPNG_IF_MAX    32
+#define FSTRM_ESCAPE     0x00000000
+
+#define LINKTYPE_NULL    0
+#define LINKTYPE_ETHER   1
+#define LINKTYPE_RAW     101
+#define LINKTYPE_SLL     113
+#define LINKTYPE_IPV4    228
+#define LINKTYPE_IPV6    229
+#define LINKTYPE_SLL2    276
+
+#define CAPTURE_SNAPLEN  (256 * 1024)
+
+typedef struct {
+	struct pkt_payload *top;
+	uint16_t msgid;
+	bool first;
+	uint64_t first_time;
+	uint64_t last_time;
+	size_t count;
+	size_t skipped;
+} capture_ctx_t;
+
+static uint32_t cap_u32(const uint8_t *data, bool swap)
+{
+	uint32_t val;
+	memcpy(&val, data, sizeof(val));
+	return swap ? __builtin_bswap32(val) : val;
+}
+
+static uint16_t cap_u16(const uint8_t *data, bool swap)
+{
+	uint16_t val;
+	memcpy(&val, data, sizeof(val));
+	return swap ? __builtin_bswap16(val) : val;
+}
+
+static uint32_t src_hash(const uint8_t *addr, size_t len)
+{
+	uint32_t hash = 2166136261U; // FNV-1a
+	for (size_t i = 0; i < len; i++) {
+		hash = (hash ^ addr[i]) * 16777619U;
+	}
+	return hash;
+}
+
+static bool add_query(capture_ctx_t *cap, const uint8_t *wire, size_t len,
+                      uint64_t time, uint32_t src)
+{
+	// Only standard queries fitting any buffer.
+	if (len < KNOT_WIRE_HEADER_SIZE || len > KNOT_WIRE_MIN_PKTSIZE ||
+	    (wire[2] & 0xf8) != 0) {
+		cap->skipped++;
+		return true;
+	}
+
+	struct pkt_payload *pkt = calloc(1, sizeof(struct pkt_payload) + len);
+	if (pkt == NULL) {
+		printf(ERR_PREFIX "(out of memory)\n");
+		return false;
+	}
+	pkt->len = len;
+	memcpy(pkt->payload, wire, len);
+	memcpy(pkt->payload, &cap->msgid, sizeof(cap->msgid));
+	pkt->src = src;
+
+	if (cap->first) {
+		cap->first = false;
+		cap->first_time = time;
+	}
+	// Keep the order even if the capture isn't ordered.
+	uint64_t rel_time = (time > cap->first_time) ? time - cap->first_time : 0;
+	pkt->time = MAX(rel_time, cap->last_time);
+	cap->last_time = pkt->time;
+
+	if (cap->top == NULL) {
+		global_payloads = pkt;
+	} else {
+		cap->top->next = pkt;
+	}
+	cap->top = pkt;
+	cap->count++;
+
+	return true;
+}
+
+/*! \brief Find the DNS payload of a UDP packet in the captured frame. */
+static bool parse_frame(const uint8_t *data, size_t len, unsigned linktype,
+                        const uint8_t **dns, size_t *dns_len, uint32_t *src)
+{
+	uint16_t proto = 0;
+	switch (linktype) {
+	case LINKTYPE_NULL:
+		if (len < 4) {
+			return false;
+		}
+		uint32_t family = cap_u32(data, false);
+		family = (family > 0xffff) ? __builtin_bswap32(family) : family;
+		proto = (family == 2) ? 0x0800 : 0x86dd; // BSD AF_INET6 values vary
+		data += 4;
+		len -= 4;
+		break;
+	case LINKTYPE_ETHER:
+		if (len < 14) {
+			return false;
+		}
+		proto = knot_wire_read_u16(data + 12);
+		data += 14;
+		len -= 14;
+		while ((proto == 0x8100 || proto == 0x88a8) && len >= 4) {
+			proto = knot_wire_read_u16(data + 2);
+			data += 4;
+			len -= 4;
+		}
+		break;
+	case LINKTYPE_SLL:
+		if (len < 16) {
+			return false;
+		}
+		proto = knot_wire_read_u16(data + 14);
+		data += 16;
+		len -= 16;
+		break;
+	case LINKTYPE_SLL2:
+		if (len < 20) {
+			return false;
+		}
+		proto = knot_wire_read_u16(data);
+		data += 20;
+		len -= 20;
+		break;
+	case LINKTYPE_RAW:
+	case LINKTYPE_IPV4:
+	case LINKTYPE_IPV6:
+	case 12: // DLT_RAW on some platforms
+	case 14:
+		if (len < 1) {
+			return false;
+		}
+		proto = ((data[0] >> 4) == 4) ? 0x0800 : 0x86dd;
+		break;
+	default:
+		return false;
+	}
+
+	const uint8_t *udp;
+	if (proto == 0x0800) {
+		if (len < 20 || (data[0] >> 4) != 4 || data[9] != IPPROTO_UDP ||
+		    (knot_wire_read_u16(data + 6) & 0x3fff) != 0) { // fragments
+			return false;
+		}
+		size_t hdr_len = (data[0] & 0x0f) * 4;
+		size_t total = knot_wire_read_u16(data + 2);
+		if (hdr_len < 20 || total < hdr_len || total > len) {
+			return false;
+		}
+		*src = src_hash(data + 12, 4);
+		udp = data + hdr_len;
+		len = total - hdr_len;
+	} else if (proto == 0x86dd) {
+		if (len < 40 || (data[0] >> 4) != 6 || data[6] != IPPROTO_UDP) {
+			return false;
+		}
+		size_t total = 40 + knot_wire_read_u16(data + 4);
+		if (total > len) {
+			return false;
+		}
+		*src = src_hash(data + 8, 16);
+		udp = data + 40;
+		len = total - 40;
+	} else {
+		return false;
+	}
+
+	size_t udp_len = (len >= 8) ? knot_wire_read_u16(udp + 4) : 0;
+	if (udp_len < 8 || udp_len > len) {
+		return false;
+	}
+	*dns = udp + 8;
+	*dns_len = udp_len - 8;
+
+	return true;
+}
+
+static bool add_frame(capture_ctx_t *cap, const uint8_t *data, size_t len,
+                      unsigned linktype, uint64_t time)
+{
+	const uint8_t *dns;
+	size_t dns_len;
+	uint32_t src;
+	if (!parse_frame(data, len, linktype, &dns, &dns_len, &src)) {
+		cap->skipped++;
+		return true;
+	}
+	return add_query(cap, dns, dns_len, time, src);
+}
+
+static uint64_t ticks_to_usecs(uint64_t ticks, uint64_t per_sec)
+{
+	return (ticks / per_sec) * 1000000 + (ticks % per_sec) * 1000000 / per_sec;
+}
+
+static bool load_pcap(FILE *f, capture_ctx_t *cap, uint8_t *buf)
+{
+	uint8_t hdr[24];
+	if (fread(hdr, sizeof(hdr), 1, f) != 1) {
+		printf(ERR_PREFIX "(truncated pcap header)\n");
+		return false;
+	}
+	uint32_t magic = cap_u32(hdr, false);
+	bool swap = (magic != PCAP_MAGIC && magic != PCAP_MAGIC_NS);
+	bool nsec = (cap_u32(hdr, swap) == PCAP_MAGIC_NS);
+	unsigned linktype = cap_u32(hdr + 20, swap) & 0x0fffffff;
+
+	uint8_t rec[16];
+	while (fread(rec, sizeof(rec), 1, f) == 1) {
+		uint64_t sec = cap_u32(rec, swap), frac = cap_u32(rec + 4, swap);
+		uint32_t caplen = cap_u32(rec + 8, swap);
+		if (caplen > CAPTURE_SNAPLEN || fread(buf, caplen, 1, f) != 1) {
+			printf(ERR_PREFIX "(truncated pcap record)\n");
+			return false;
+		}
+		uint64_t time = sec * 1000000 + (nsec ? frac / 1000 : frac);
+		if (!add_frame(cap, buf, caplen, linktype, time)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool load_pcapng(FILE *f, capture_ctx_t *cap, uint8_t *buf)
+{
+	struct {
+		unsigned linktype;
+		uint64_t per_sec;
+	} ifaces[PCAPNG_IF_MAX];
+	unsigned if_count = 0;
+	bool swap = false;
+
+	uint8_t hdr[8];
+	while (fread(hdr, sizeof(hdr), 1, f) == 1) {
+		uint32_t type = cap_u32(hdr, false);
+		if (type == PCAPNG_SHB) {
+			uint8_t bom[4];
+			if (fread(bom, sizeof(bom), 1, f) != 1) {
+				break;
+			}
+			swap = (cap_u32(bom, false) != PCAPNG_BOM);
+			if_count = 0;
+			if (fseek(f, -(long)sizeof(bom), SEEK_CUR) != 0) {
+				break;
+			}
+		} else {
+			type = cap_u32(hdr, swap);
+		}
+		uint32_t total = cap_u32(hdr + 4, swap);
+		if (total < 12 || total % 4 != 0 || total - 8 > CAPTURE_SNAPLEN ||
+		    fread(buf, total - 8, 1, f) != 1) {
+			printf(ERR_PREFIX "(truncated pcapng block)\n");
+			return false;
+		}
+		size_t body_len = total - 12; // Without the trailing length.
+
+		if (type == PCAPNG_IDB && body_len >= 8) {
+			if (if_count == PCAPNG_IF_MAX) {
+				printf(ERR_PREFIX "(too many pcapng interfaces)\n");
+				return false;
+			}
+			ifaces[if_count].linktype = cap_u16(buf, swap);
+			ifaces[if_count].per_sec = 1000000;
+			for (size_t pos = 8; pos + 4 <= body_len; ) {
+				uint16_t code = cap_u16(buf + pos, swap);
+				uint16_t len = cap_u16(buf + pos + 2, swap);
+				if (code == 0 || pos + 4 + len > body_len) {
+					break;
+				} else if (code == 9 && len >= 1) { // if_tsresol
+					uint8_t res = buf[pos + 4];
+					uint64_t per_sec = 1;
+					for (int i = 0; i < (res & 0x7f) && per_sec < UINT64_MAX / 10; i++) {
+						per_sec *= (res & 0x80) ? 2 : 10;
+					}
+					ifaces[if_count].per_sec = per_sec;
+				}
+				pos += 4 + ((len + 3) & ~3);
+			}
+			if_count++;
+		} else if (type == PCAPNG_EPB && body_len >= 20) {
+			uint32_t iface = cap_u32(buf, swap);
+			uint32_t caplen = cap_u32(buf + 12, swap);
+			if (iface >= if_count || caplen > body_len - 20) {
+				continue;
+			}
+			uint64_t ticks = ((uint64_t)cap_u32(buf + 4, swap) << 32) |
+			                 cap_u32(buf + 8, swap);
+			uint64_t time = ticks_to_usecs(ticks, ifaces[iface].per_sec);
+			if (!add_frame(cap, buf + 20, caplen, ifaces[iface].linktype, time)) {
+				return false;
+			}
+		} else if (type == PCAPNG_SPB && body_len >= 4 && if_count > 0) {
+			// No timestamp, the queries are sent evenly.
+			uint32_t len = MIN(cap_u32(buf, swap), body_len - 4);
+			if (!add_frame(cap, buf + 4, len, ifaces[0].linktype, cap->last_time)) {
+				return false;
+			}
+		}
+	}
+
+	return true;
+}
+
+#if USE_DNSTAP
+static bool load_dnstap(const char *filename, capture_ctx_t *cap)
+{
+	dt_reader_t *reader = dt_reader_create(filename);
+	if (reader == NULL) {
+		printf(ERR_PREFIX "(can't open dnstap file)\n");
+		return false;
+	}
+
+	bool ret = true;
+	while (ret) {
+		Dnstap__Dnstap *frame = NULL;
+		int read = dt_reader_read(reader, &frame);
+		if (read == KNOT_EOF) {
+			break;
+		} else if (read != KNOT_EOK) {
+			printf(ERR_PREFIX "(faulty dnstap message)\n");
+			ret = false;
+			break;
+		}
+
+		Dnstap__Message *msg = frame->message;
+		if (frame->type == DNSTAP__DNSTAP__TYPE__MESSAGE &&
+		    dt_message_type_is_query(msg->type) && msg->has_query_message) {
+			uint64_t time = msg->query_time_sec * 1000000 +
+			                msg->query_time_nsec / 1000;
+			uint32_t src = src_hash(msg->query_address.data,
+			                        msg->query_address.len);
+			ret = add_query(cap, msg->query_message.data,
+			                msg->query_message.len, time, src);
+		} else {
+			cap->skipped++;
+		}
+		dt_reader_free_frame(reader, &frame);
+	}
+
+	dt_reader_free(reader);
+	return ret;
+}
+#endif // USE_DNSTAP
+
+static bool load_capture(FILE *f, const char *filename, uint32_t magic, uint16_t msgid)
+{
+	capture_ctx_t cap = { .msgid = msgid, .first = true };
+
+	uint8_t *buf = malloc(CAPTURE_SNAPLEN);
+	if (buf == NULL) {
+		printf(ERR_PREFIX "(out of memory)\n");
+		return false;
+	}
+
+	bool ret;
+	if (magic == PCAPNG_SHB) {
+		ret = load_pcapng(f, &cap, buf);
+	} else if (magic == FSTRM_ESCAPE) {
+#if USE_DNSTAP
+		ret = load_dnstap(filename, &cap);
+#else
+		printf(ERR_PREFIX "(dnstap not supported)\n");
+		ret = false;
+#endif
+	} else {
+		ret = load_pcap(f, &cap, buf);
+	}
+	free(buf);
+
+	if (ret && global_payloads == NULL) {
+		printf(ERR_PREFIX "(no UDP queries in capture)\n");
+		ret = false;
+	}
+	if (!ret) {
+		free_global_payloads();
+		return false;
+	}
+
+	// The next loop starts one average gap after the last query.
+	global_payloads_span = cap.last_time + MAX(cap.last_time / cap.count, 1);
+	printf("loaded %zu queries spanning %.3f s, skipped %zu packets\n",
+	       cap.count, cap.last_time / 1000000.0, cap.skipped);
+
+	return true;
 }
 
 bool load_queries(const char *filename, uint16_t edns_size, uint16_t msgid)
@@ -49,6 +460,22 @@ bool load_queries(const char *filename, uint16_t edns_size, uint16_t msgid)
 		printf(ERR_PREFIX "file '%s' (%s)\n", filename, strerror(errno));
 		return false;
 	}
+
+	uint8_t magic_buf[4];
+	if (fread(magic_buf, sizeof(magic_buf), 1, f) == 1) {
+		uint32_t magic;
+		memcpy(&magic, magic_buf, sizeof(magic));
+		if (magic == PCAP_MAGIC || magic == __builtin_bswap32(PCAP_MAGIC) ||
+		    magic == PCAP_MAGIC_NS || magic == __builtin_bswap32(PCAP_MAGIC_NS) ||
+		    magic == PCAPNG_SHB || magic == FSTRM_ESCAPE) {
+			rewind(f);
+			bool ret = load_capture(f, filename, magic, msgid);
+			fclose(f);
+			return ret;
+		}
+	}
+	rewind(f);
+
 	struct pkt_payload *g_payloads_top = NULL;
 
 	struct {
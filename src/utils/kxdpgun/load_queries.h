@@ -21,12 +21,24 @@
 
 struct pkt_payload {
 	struct pkt_payload *next;
+	uint64_t time; // Capture time relative to the first query (usecs).
+	uint32_t src;  // Hash of the original source address.
 	size_t len;
 	uint8_t payload[];
 };
 
 extern struct pkt_payload *global_payloads;
 
+/*! \brief Replay period of the loaded capture (usecs), 0 for a textual file. */
+extern uint64_t global_payloads_span;
+
+/*!
+ * \brief Load queries from a textual file or a capture.
+ *
+ * Captures in the pcap, pcapng, or dnstap (if supported) format are detected
+ * automatically. DNS queries over UDP are taken from them verbatim along
+ * with their timing and source addresses.
+ */
 bool load_queries(const char *filename, uint16_t edns_size, uint16_t msgid);
 
 void free_global_payloads(void);
@@ -41,6 +41,7 @@
 #include "libknot/xdp.h"
 #include "contrib/macros.h"
 #include "contrib/mempattern.h"
+#include "contrib/net.h"
 #include "contrib/openbsd/strlcat.h"
 #include "contrib/openbsd/strlcpy.h"
 #include "contrib/os.h"
@@ -48,6 +49,7 @@
 #include "contrib/ucw/mempool.h"
 #include "utils/common/params.h"
 #include "utils/kxdpgun/ip_route.h"
+#include "utils/kxdpgun/latency.h"
 #include "utils/kxdpgun/load_queries.h"
 
 #define PROGRAM_NAME "kxdpgun"
@@ -69,6 +71,7 @@ unsigned global_cpu_aff_step = 1;
 #define LOCAL_PORT_DEFAULT 53
 #define LOCAL_PORT_MIN   2000
 #define LOCAL_PORT_MAX  65535
+#define LOCAL_PORT_COUNT (LOCAL_PORT_MAX + 1 - LOCAL_PORT_MIN)
 
 #define RCODE_MAX (0x0F + 1)
 
@@ -83,11 +86,14 @@ typedef struct {
 	uint64_t size_recv;
 	uint64_t wire_recv;
 	uint64_t rcodes_recv[RCODE_MAX];
+	latency_stats_t latency;
 	pthread_mutex_t mutex;
 } kxdpgun_stats_t;
 
 static kxdpgun_stats_t global_stats = { 0 };
 
+static latency_table_t global_latency = { 0 };
+
 typedef struct {
 	char		dev[IFNAMSIZ];
 	uint64_t	qps, duration;
@@ -99,6 +105,11 @@ typedef struct {
 	uint8_t		local_ip_range;
 	bool		ipv6;
 	bool		tcp;
+	bool		sock;
+	unsigned	tcp_conns;
+	double		speed; // timed replay if non-zero
+	struct pkt_payload *sched;
+	uint64_t	sched_offset;
 	uint16_t	target_port;
 	uint32_t	listen_port; // KNOT_XDP_LISTEN_PORT_*
 	unsigned	n_threads, thread_id;
@@ -110,6 +121,7 @@ const static xdp_gun_ctx_t ctx_defaults = {
 	.qps = 1000,
 	.duration = 5000000UL, // usecs
 	.at_once = 10,
+	.n_threads = 1,
 	.target_port = LOCAL_PORT_DEFAULT,
 	.listen_port = KNOT_XDP_LISTEN_PORT_PASS | LOCAL_PORT_MIN,
 };
@@ -141,6 +153,7 @@ static void clear_stats(kxdpgun_stats_t *st)
 	st->wire_recv   = 0;
 	st->collected   = 0;
 	memset(st->rcodes_recv, 0, sizeof(st->rcodes_recv));
+	memset(&st->latency, 0, sizeof(st->latency));
 	pthread_mutex_unlock(&st->mutex);
 }
 
@@ -158,6 +171,7 @@ static size_t collect_stats(kxdpgun_stats_t *into, const kxdpgun_stats_t *what)
 	for (int i = 0; i < RCODE_MAX; i++) {
 		into->rcodes_recv[i] += what->rcodes_recv[i];
 	}
+	latency_merge(&into->latency, &what->latency);
 	size_t res = ++into->collected;
 	pthread_mutex_unlock(&into->mutex);
 	return res;
@@ -199,6 +213,7 @@ static void print_stats(kxdpgun_stats_t *st, bool tcp, bool recv)
 				       rcname, space, "         ", st->rcodes_recv[i]);
 			}
 		}
+		latency_print(&st->latency);
 	}
 	printf("duration: %"PRIu64" s\n", (st->duration / (1000 * 1000)));
 
@@ -271,6 +286,42 @@ static void next_payload(struct pkt_payload **payload, int increment)
 	}
 }
 
+/*! \brief Move the replay schedule by the number of queries. */
+static void sched_advance(xdp_gun_ctx_t *ctx, unsigned count)
+{
+	for (unsigned i = 0; i < count; i++) {
+		if (ctx->sched == NULL) {
+			ctx->sched = global_payloads;
+		} else if (ctx->sched->next == NULL) {
+			ctx->sched = global_payloads;
+			ctx->sched_offset += global_payloads_span;
+		} else {
+			ctx->sched = ctx->sched->next;
+		}
+	}
+}
+
+/*! \brief Send time of the next query in the timed replay (usecs). */
+static uint64_t sched_time(xdp_gun_ctx_t *ctx)
+{
+	return (ctx->sched->time + ctx->sched_offset) / ctx->speed;
+}
+
+/*! \brief Number of queries to be sent in this tick, up to the batch size. */
+static unsigned sched_due(xdp_gun_ctx_t *ctx, uint64_t duration)
+{
+	if (ctx->speed == 0) {
+		return ctx->at_once;
+	}
+
+	unsigned due = 0;
+	while (due < ctx->at_once && sched_time(ctx) <= duration) {
+		sched_advance(ctx, ctx->n_threads);
+		due++;
+	}
+	return due;
+}
+
 static void put_dns_payload(struct iovec *put_into, bool zero_copy, xdp_gun_ctx_t *ctx, struct pkt_payload **payl)
 {
 	if (zero_copy) {
@@ -282,23 +333,40 @@ static void put_dns_payload(struct iovec *put_into, bool zero_copy, xdp_gun_ctx_
 	next_payload(payl, ctx->n_threads);
 }
 
+/*! \brief Sequence number of the first query sent in the tick. */
+static uint64_t tick_unique(xdp_gun_ctx_t *ctx, uint64_t tick)
+{
+	return (tick * ctx->n_threads + ctx->thread_id) * ctx->at_once;
+}
+
+/*!
+ * \brief Message ID of the query with the sequence number.
+ *
+ * The ID changes whenever the local ports are reused, so that late responses
+ * aren't matched with newer queries.
+ */
+static uint16_t unique_msgid(xdp_gun_ctx_t *ctx, uint64_t unique)
+{
+	return ctx->msgid + unique / LOCAL_PORT_COUNT;
+}
+
 static int alloc_pkts(knot_xdp_msg_t *pkts, struct knot_xdp_socket *xsk,
-                      xdp_gun_ctx_t *ctx, uint64_t tick)
+                      xdp_gun_ctx_t *ctx, uint64_t tick, unsigned count)
 {
-	uint64_t unique = (tick * ctx->n_threads + ctx->thread_id) * ctx->at_once;
+	uint64_t unique = tick_unique(ctx, tick);
 
 	knot_xdp_msg_flag_t flags = ctx->ipv6 ? KNOT_XDP_MSG_IPV6 : 0;
 	if (ctx->tcp) {
 		flags |= (KNOT_XDP_MSG_TCP | KNOT_XDP_MSG_SYN | KNOT_XDP_MSG_MSS);
 	}
 
-	for (int i = 0; i < ctx->at_once; i++) {
+	for (int i = 0; i < count; i++) {
 		int ret = knot_xdp_send_alloc(xsk, flags, &pkts[i]);
 		if (ret != KNOT_EOK) {
 			return i;
 		}
 
-		uint16_t local_port = LOCAL_PORT_MIN + unique % (LOCAL_PORT_MAX + 1 - LOCAL_PORT_MIN);
+		uint16_t local_port = LOCAL_PORT_MIN + unique % LOCAL_PORT_COUNT;
 		uint64_t ip_incr = unique % (1 << (addr_bits(ctx->ipv6) - ctx->local_ip_range));
 		shuffle_sockaddr(&pkts[i].ip_from, &ctx->local_ip,  local_port, ip_incr);
 		shuffle_sockaddr(&pkts[i].ip_to,   &ctx->target_ip, ctx->target_port, 0);
@@ -308,22 +376,131 @@ static int alloc_pkts(knot_xdp_msg_t *pkts, struct knot_xdp_socket *xsk,
 
 		unique++;
 	}
-	return ctx->at_once;
+	return count;
+}
+
+/*! \brief Map the original source of the replayed query into the local range. */
+static void replay_source(knot_xdp_msg_t *pkt, xdp_gun_ctx_t *ctx,
+                          const struct pkt_payload *payl)
+{
+	unsigned bits = addr_bits(ctx->ipv6) - ctx->local_ip_range;
+	if (global_payloads_span == 0 || bits == 0) {
+		return;
+	}
+	uint64_t ip_incr = payl->src % (UINT64_C(1) << MIN(bits, 32));
+	shuffle_sockaddr(&pkt->ip_from, &ctx->local_ip, be16toh(pkt->ip_from.sin6_port),
+	                 ip_incr);
 }
 
-inline static bool check_dns_payload(struct iovec *payl, xdp_gun_ctx_t *ctx,
-                                     kxdpgun_stats_t *st)
+/*! \brief Record the send time of the queries if responses are tracked. */
+static void track_pkts(knot_xdp_msg_t *pkts, int count, xdp_gun_ctx_t *ctx,
+                       uint64_t tick)
 {
-	if (payl->iov_len < KNOT_WIRE_HEADER_SIZE ||
-	    memcmp(payl->iov_base, &ctx->msgid, sizeof(ctx->msgid)) != 0) {
+	if (global_latency.slots == NULL) {
+		return;
+	}
+
+	uint64_t now = latency_now();
+	uint64_t unique = tick_unique(ctx, tick);
+	for (int i = 0; i < count; i++) {
+		uint16_t msgid = ctx->msgid;
+		if (!ctx->tcp) {
+			msgid = unique_msgid(ctx, unique + i);
+			memcpy(pkts[i].payload.iov_base, &msgid, sizeof(msgid));
+		}
+		latency_sent(&global_latency, be16toh(pkts[i].ip_from.sin6_port), msgid, now);
+	}
+}
+
+inline static bool check_dns_payload(struct iovec *payl, const knot_xdp_msg_t *msg,
+                                     xdp_gun_ctx_t *ctx, uint16_t ids,
+                                     uint64_t now, kxdpgun_stats_t *st)
+{
+	if (payl->iov_len < KNOT_WIRE_HEADER_SIZE) {
 		return false;
 	}
+
+	uint16_t msgid;
+	memcpy(&msgid, payl->iov_base, sizeof(msgid));
+
+	uint64_t rtt;
+	if (global_latency.slots != NULL &&
+	    latency_recv(&global_latency, be16toh(msg->ip_to.sin6_port), msgid, now, &rtt)) {
+		latency_add(&st->latency, rtt);
+	} else if ((uint16_t)(msgid - ctx->msgid) >= ids) {
+		return false; // Not a response to any query sent so far.
+	}
 	st->rcodes_recv[((uint8_t *)payl->iov_base)[3] & 0x0F]++;
 	st->size_recv += payl->iov_len;
 	st->ans_recv++;
 	return true;
 }
 
+#define PACE_SLEEP_MAX 100000
+
+/*!
+ * \brief Rate limiting and statistics dump, returns the elapsed time.
+ *
+ * If wait is set, the time to sleep is returned there instead of sleeping.
+ */
+static uint64_t pace(xdp_gun_ctx_t *ctx, kxdpgun_stats_t *local_stats,
+                     struct timespec *timer, unsigned *stats_triggered,
+                     uint64_t *wait)
+{
+	uint64_t dura_exp = (ctx->speed > 0) ? sched_time(ctx) :
+	                    (local_stats->qry_sent * 1000000) / ctx->qps;
+	uint64_t duration = timer_end(timer);
+	if (xdp_trigger == KXDPGUN_STOP && ctx->duration > duration) {
+		ctx->duration = duration;
+	}
+	if (stats_trigger > *stats_triggered) {
+		assert(stats_trigger == *stats_triggered + 1);
+		(*stats_triggered)++;
+
+		local_stats->duration = duration;
+		size_t collected = collect_stats(&global_stats, local_stats);
+		assert(collected <= ctx->n_threads);
+		if (collected == ctx->n_threads) {
+			print_stats(&global_stats, ctx->tcp,
+			            !(ctx->listen_port & KNOT_XDP_LISTEN_PORT_DROP));
+			clear_stats(&global_stats);
+		}
+	}
+	uint64_t sleep = 0;
+	if (dura_exp > duration) {
+		sleep += dura_exp - duration;
+	}
+	if (duration > ctx->duration) {
+		sleep += 1000;
+	}
+	sleep = MIN(sleep, PACE_SLEEP_MAX); // Long gaps in the replayed capture.
+	if (wait != NULL) {
+		*wait = sleep;
+	} else if (sleep > 0) {
+		usleep(sleep);
+	}
+	return duration;
+}
+
+static void thread_finish(xdp_gun_ctx_t *ctx, kxdpgun_stats_t *local_stats,
+                          uint64_t lost, uint64_t errors)
+{
+	char recv_str[40] = "", lost_str[40] = "", err_str[40] = "";
+	if (!(ctx->listen_port & KNOT_XDP_LISTEN_PORT_DROP)) {
+		(void)snprintf(recv_str, sizeof(recv_str), ", received %"PRIu64, local_stats->ans_recv);
+	}
+	if (lost > 0) {
+		(void)snprintf(lost_str, sizeof(lost_str), ", lost %"PRIu64, lost);
+	}
+	if (errors > 0) {
+		(void)snprintf(err_str, sizeof(err_str), ", errors %"PRIu64, errors);
+	}
+	printf("thread#%02u: sent %"PRIu64"%s%s%s\n",
+	       ctx->thread_id, local_stats->qry_sent, recv_str, lost_str, err_str);
+	local_stats->duration = ctx->duration;
+	collect_stats(&global_stats, local_stats);
+}
+
 void *xdp_gun_thread(void *_ctx)
 {
 	xdp_gun_ctx_t *ctx = _ctx;
@@ -362,17 +539,19 @@ void *xdp_gun_thread(void *_ctx)
 	uint64_t tick = 0;
 	struct pkt_payload *payload_ptr = NULL;
 	next_payload(&payload_ptr, ctx->thread_id);
+	sched_advance(ctx, ctx->thread_id + 1);
 
 	timer_start(&timer);
 
 	while (duration < ctx->duration + 1000000) {
 
 		// sending part
-		if (duration < ctx->duration) {
+		unsigned count = (duration < ctx->duration) ? sched_due(ctx, duration) : 0;
+		if (count > 0) {
 			while (1) {
 				knot_xdp_send_prepare(xsk);
-				int alloced = alloc_pkts(pkts, xsk, ctx, tick);
-				if (alloced < ctx->at_once) {
+				int alloced = alloc_pkts(pkts, xsk, ctx, tick, count);
+				if (alloced < count) {
 					lost++;
 					if (alloced == 0) {
 						break;
@@ -385,10 +564,12 @@ void *xdp_gun_thread(void *_ctx)
 					}
 				} else {
 					for (int i = 0; i < alloced; i++) {
+						replay_source(&pkts[i], ctx, payload_ptr);
 						put_dns_payload(&pkts[i].payload, false,
 						                ctx, &payload_ptr);
 					}
 				}
+				track_pkts(pkts, alloced, ctx, tick);
 
 				uint32_t really_sent = 0;
 				(void)knot_xdp_send(xsk, pkts, alloced, &really_sent);
@@ -418,6 +599,10 @@ void *xdp_gun_thread(void *_ctx)
 				if (recvd == 0) {
 					break;
 				}
+				uint64_t now = latency_now();
+				// Message IDs used so far with some reserve for faster threads.
+				uint16_t ids = MIN(tick_unique(ctx, tick) / LOCAL_PORT_COUNT + 2,
+				                   UINT16_MAX);
 				if (ctx->tcp) {
 					uint32_t ack_errors = 0;
 					knot_tcp_relay_dynarray_t relays = { 0 };
@@ -445,7 +630,8 @@ void *xdp_gun_thread(void *_ctx)
 							}
 							break;
 						case XDP_TCP_DATA:
-							if (check_dns_payload(&rl->data, ctx, &local_stats)) {
+							if (check_dns_payload(&rl->data, rl->msg, ctx, ids,
+							                      now, &local_stats)) {
 								rl->answer = XDP_TCP_ANSWER | XDP_TCP_CLOSE;
 							}
 							break;
@@ -470,8 +656,8 @@ void *xdp_gun_thread(void *_ctx)
 					knot_tcp_relay_free(&relays);
 				} else {
 					for (int i = 0; i < recvd; i++) {
-						(void)check_dns_payload(&pkts[i].payload, ctx,
-						                        &local_stats);
+						(void)check_dns_payload(&pkts[i].payload, &pkts[i],
+						                        ctx, ids, now, &local_stats);
 					}
 				}
 				local_stats.wire_recv += wire;
@@ -481,55 +667,428 @@ void *xdp_gun_thread(void *_ctx)
 		}
 
 		// speed and signal part
-		uint64_t dura_exp = (local_stats.qry_sent * 1000000) / ctx->qps;
-		duration = timer_end(&timer);
-		if (xdp_trigger == KXDPGUN_STOP && ctx->duration > duration) {
-			ctx->duration = duration;
-		}
-		if (stats_trigger > stats_triggered) {
-			assert(stats_trigger == stats_triggered + 1);
-			stats_triggered++;
-
-			local_stats.duration = duration;
-			size_t collected = collect_stats(&global_stats, &local_stats);
-			assert(collected <= ctx->n_threads);
-			if (collected == ctx->n_threads) {
-				print_stats(&global_stats, ctx->tcp,
-				            !(ctx->listen_port & KNOT_XDP_LISTEN_PORT_DROP));
-				clear_stats(&global_stats);
+		duration = pace(ctx, &local_stats, &timer, &stats_triggered, NULL);
+		tick++;
+	}
+
+	knot_xdp_deinit(xsk);
+
+	knot_tcp_table_free(tcp_table);
+
+	thread_finish(ctx, &local_stats, lost, errors);
+
+	return NULL;
+}
+
+#define SOCK_TCP_CONNS_MAX 4096
+#define SOCK_UDP_BUFSIZE   (4 * 1024 * 1024)
+
+/*! \brief Estimated size of the Ethernet, IP, and UDP/TCP headers. */
+static size_t wire_overhead(xdp_gun_ctx_t *ctx)
+{
+	return 14 + (ctx->ipv6 ? 40 : 20) + (ctx->tcp ? 20 : 8);
+}
+
+/*! \brief Copy the query into the buffer and set its message ID. */
+static size_t sock_put_query(uint8_t *buf, uint16_t msgid, xdp_gun_ctx_t *ctx,
+                             struct pkt_payload **payl)
+{
+	size_t len = (*payl)->len;
+	memcpy(buf, (*payl)->payload, len);
+	memcpy(buf, &msgid, sizeof(msgid));
+	next_payload(payl, ctx->n_threads);
+	return len;
+}
+
+static void sock_answer(const uint8_t *wire, size_t len, uint64_t rtt,
+                        kxdpgun_stats_t *st)
+{
+	st->rcodes_recv[wire[3] & 0x0F]++;
+	st->size_recv += len;
+	st->ans_recv++;
+	latency_add(&st->latency, rtt);
+}
+
+/*! \brief Wait for the socket events until the deadline, returns false on timeout. */
+static bool sock_wait(struct pollfd *pfds, size_t count, uint64_t deadline)
+{
+	uint64_t now = latency_now();
+	if (now >= deadline) {
+		return false;
+	}
+	struct timespec timeout = {
+		.tv_sec = (deadline - now) / 1000000000,
+		.tv_nsec = (deadline - now) % 1000000000
+	};
+	return ppoll(pfds, count, &timeout, NULL) > 0;
+}
+
+/*! \brief Receive responses until the deadline. */
+static void sock_udp_recv(int fd, struct mmsghdr *msgs, xdp_gun_ctx_t *ctx,
+                          latency_table_t *table, uint64_t deadline,
+                          kxdpgun_stats_t *st, uint64_t *errors)
+{
+	struct pollfd pfd = { fd, POLLIN, 0 };
+
+	while (true) {
+		for (unsigned i = 0; i < ctx->at_once; i++) {
+			msgs[i].msg_hdr.msg_iov->iov_len = KNOT_WIRE_MAX_PKTSIZE;
+		}
+		int ret = recvmmsg(fd, msgs, ctx->at_once, MSG_DONTWAIT, NULL);
+		if (ret <= 0) {
+			if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK &&
+			    errno != ECONNREFUSED) {
+				(*errors)++;
+			}
+			if (!sock_wait(&pfd, 1, deadline)) {
+				break;
 			}
+			continue;
 		}
-		if (dura_exp > duration) {
-			usleep(dura_exp - duration);
+
+		uint64_t now = latency_now();
+		for (int i = 0; i < ret; i++) {
+			const uint8_t *wire = msgs[i].msg_hdr.msg_iov->iov_base;
+			size_t len = msgs[i].msg_len;
+			if (len < KNOT_WIRE_HEADER_SIZE || !knot_wire_get_qr(wire)) {
+				continue;
+			}
+			uint16_t msgid;
+			memcpy(&msgid, wire, sizeof(msgid));
+			uint64_t rtt;
+			if (!latency_recv(table, msgid, msgid, now, &rtt)) {
+				continue; // Duplicate or unknown response.
+			}
+			sock_answer(wire, len, rtt, st);
+			st->wire_recv += len + wire_overhead(ctx);
 		}
-		if (duration > ctx->duration) {
-			usleep(1000);
+	}
+}
+
+static void *sock_udp_thread(xdp_gun_ctx_t *ctx, int fd)
+{
+	struct timespec timer;
+	uint64_t errors = 0, lost = 0, duration = 0, wait = 0;
+	kxdpgun_stats_t local_stats = { 0 };
+	unsigned stats_triggered = 0;
+	bool recv = !(ctx->listen_port & KNOT_XDP_LISTEN_PORT_DROP);
+
+	latency_table_t table = { 0 };
+	struct mmsghdr *msgs = calloc(ctx->at_once, sizeof(*msgs));
+	struct iovec *iovs = calloc(ctx->at_once, sizeof(*iovs));
+	uint8_t *bufs = malloc(ctx->at_once * KNOT_WIRE_MAX_PKTSIZE);
+	if (msgs == NULL || iovs == NULL || bufs == NULL ||
+	    (recv && !latency_table_init(&table))) {
+		printf("failed to allocate socket buffers\n");
+		goto finish;
+	}
+	for (unsigned i = 0; i < ctx->at_once; i++) {
+		iovs[i].iov_base = bufs + i * KNOT_WIRE_MAX_PKTSIZE;
+		msgs[i].msg_hdr.msg_iov = &iovs[i];
+		msgs[i].msg_hdr.msg_iovlen = 1;
+	}
+
+	while (xdp_trigger == KXDPGUN_WAIT) {
+		usleep(1000);
+	}
+
+	uint16_t msgid = ctx->msgid;
+	struct pkt_payload *payload_ptr = NULL;
+	next_payload(&payload_ptr, ctx->thread_id);
+	sched_advance(ctx, ctx->thread_id + 1);
+
+	timer_start(&timer);
+
+	while (duration < ctx->duration + 1000000) {
+
+		// sending part
+		unsigned count = (duration < ctx->duration) ? sched_due(ctx, duration) : 0;
+		if (count > 0) {
+			uint64_t now = latency_now();
+			for (unsigned i = 0; i < count; i++) {
+				uint16_t id = msgid + i;
+				iovs[i].iov_len = sock_put_query(iovs[i].iov_base, id,
+				                                 ctx, &payload_ptr);
+				if (recv) {
+					latency_sent(&table, id, id, now);
+				}
+			}
+			int sent = sendmmsg(fd, msgs, count, 0);
+			if (sent < 0) {
+				if (errno == EAGAIN || errno == EWOULDBLOCK || errno == ENOBUFS) {
+					lost++;
+				} else {
+					errors++;
+				}
+				sent = 0;
+			} else if (sent < count) {
+				lost++;
+			}
+			local_stats.qry_sent += sent;
+			msgid += sent;
 		}
-		tick++;
+
+		// receiving part, waits instead of sleeping for precise latency
+		if (recv) {
+			sock_udp_recv(fd, msgs, ctx, &table, latency_now() + wait * 1000,
+			              &local_stats, &errors);
+		} else if (wait > 0) {
+			usleep(wait);
+		}
+
+		// speed and signal part
+		duration = pace(ctx, &local_stats, &timer, &stats_triggered, &wait);
 	}
 
-	knot_xdp_deinit(xsk);
+finish:
+	latency_table_deinit(&table);
+	free(bufs);
+	free(iovs);
+	free(msgs);
 
-	knot_tcp_table_free(tcp_table);
+	thread_finish(ctx, &local_stats, lost, errors);
 
-	char recv_str[40] = "", lost_str[40] = "", err_str[40] = "";
-	if (!(ctx->listen_port & KNOT_XDP_LISTEN_PORT_DROP)) {
-		(void)snprintf(recv_str, sizeof(recv_str), ", received %"PRIu64, local_stats.ans_recv);
+	return NULL;
+}
+
+typedef struct {
+	int fd;
+	bool established;
+	uint64_t start;
+	size_t got;
+	uint8_t head[2 + KNOT_WIRE_HEADER_SIZE];
+} sock_conn_t;
+
+typedef struct {
+	sock_conn_t *conns;
+	struct pollfd *pfds;
+	size_t count;
+	size_t active;
+	size_t next;
+	uint8_t *buf;
+	size_t buf_size;
+	uint16_t msgid;
+	struct pkt_payload *payload;
+} sock_tcp_t;
+
+static void sock_tcp_close(sock_tcp_t *tcp, size_t i)
+{
+	close(tcp->conns[i].fd);
+	tcp->conns[i].fd = -1;
+	tcp->pfds[i].fd = -1;
+	tcp->active--;
+}
+
+static bool sock_tcp_open(sock_tcp_t *tcp, xdp_gun_ctx_t *ctx, uint64_t now)
+{
+	int fd = net_connected_socket(SOCK_STREAM, &ctx->target_ip,
+	                              &ctx->local_ip, false);
+	if (fd < 0) {
+		return false;
 	}
-	if (lost > 0) {
-		(void)snprintf(lost_str, sizeof(lost_str), ", lost %"PRIu64, lost);
+
+	while (tcp->conns[tcp->next].fd >= 0) {
+		tcp->next = (tcp->next + 1) % tcp->count;
 	}
-	if (errors > 0) {
-		(void)snprintf(err_str, sizeof(err_str), ", errors %"PRIu64, errors);
+	sock_conn_t *conn = &tcp->conns[tcp->next];
+	memset(conn, 0, sizeof(*conn));
+	conn->fd = fd;
+	conn->start = now;
+	tcp->pfds[tcp->next] = (struct pollfd){ fd, POLLOUT, 0 };
+	tcp->active++;
+
+	return true;
+}
+
+/*! \brief Send the query once connected, returns false if the connection failed. */
+static bool sock_tcp_established(sock_tcp_t *tcp, size_t i, xdp_gun_ctx_t *ctx)
+{
+	sock_conn_t *conn = &tcp->conns[i];
+
+	int err = 0;
+	socklen_t err_len = sizeof(err);
+	if (getsockopt(conn->fd, SOL_SOCKET, SO_ERROR, &err, &err_len) != 0 || err != 0) {
+		return false;
 	}
-	printf("thread#%02u: sent %"PRIu64"%s%s%s\n",
-	       ctx->thread_id, local_stats.qry_sent, recv_str, lost_str, err_str);
-	local_stats.duration = ctx->duration;
-	collect_stats(&global_stats, &local_stats);
+
+	size_t len = sock_put_query(tcp->buf + 2, tcp->msgid++, ctx, &tcp->payload);
+	knot_wire_write_u16(tcp->buf, len);
+	if (send(conn->fd, tcp->buf, len + 2, MSG_NOSIGNAL) != len + 2) {
+		return false;
+	}
+
+	conn->established = true;
+	tcp->pfds[i].events = POLLIN;
+
+	return true;
+}
+
+/*! \brief Read the response, returns true once it's complete. */
+static bool sock_tcp_read(sock_tcp_t *tcp, size_t i, xdp_gun_ctx_t *ctx,
+                          uint64_t now, kxdpgun_stats_t *st, bool *failed)
+{
+	sock_conn_t *conn = &tcp->conns[i];
+
+	while (true) {
+		ssize_t ret = recv(conn->fd, tcp->buf, tcp->buf_size, MSG_DONTWAIT);
+		if (ret <= 0) {
+			*failed = (ret == 0 || (errno != EAGAIN && errno != EWOULDBLOCK));
+			return false;
+		}
+		if (conn->got < sizeof(conn->head)) {
+			size_t cpy = MIN(sizeof(conn->head) - conn->got, ret);
+			memcpy(conn->head + conn->got, tcp->buf, cpy);
+		}
+		conn->got += ret;
+
+		size_t total = 2 + knot_wire_read_u16(conn->head);
+		if (conn->got >= sizeof(conn->head) && conn->got >= total) {
+			if (!knot_wire_get_qr(conn->head + 2)) {
+				*failed = true;
+				return false;
+			}
+			sock_answer(conn->head + 2, total - 2, now - conn->start, st);
+			st->wire_recv += conn->got + wire_overhead(ctx);
+			return true;
+		}
+	}
+}
+
+/*! \brief Process the connection events until the deadline. */
+static void sock_tcp_events(sock_tcp_t *tcp, xdp_gun_ctx_t *ctx, uint64_t deadline,
+                            kxdpgun_stats_t *st)
+{
+	while (tcp->active > 0 && sock_wait(tcp->pfds, tcp->count, deadline)) {
+		uint64_t now = latency_now();
+		for (size_t i = 0; i < tcp->count; i++) {
+			if (tcp->pfds[i].fd < 0 || tcp->pfds[i].revents == 0) {
+				continue;
+			}
+			tcp->pfds[i].revents = 0;
+
+			bool failed = false;
+			if (!tcp->conns[i].established) {
+				if (sock_tcp_established(tcp, i, ctx)) {
+					st->synack_recv++;
+				} else {
+					st->rst_recv++;
+					sock_tcp_close(tcp, i);
+				}
+			} else if (sock_tcp_read(tcp, i, ctx, now, st, &failed)) {
+				st->finack_recv++;
+				sock_tcp_close(tcp, i);
+			} else if (failed) {
+				st->rst_recv++;
+				sock_tcp_close(tcp, i);
+			}
+		}
+	}
+}
+
+static void *sock_tcp_thread(xdp_gun_ctx_t *ctx)
+{
+	struct timespec timer;
+	uint64_t errors = 0, lost = 0, duration = 0, wait = 0;
+	kxdpgun_stats_t local_stats = { 0 };
+	unsigned stats_triggered = 0;
+
+	sock_tcp_t tcp = {
+		.conns = calloc(ctx->tcp_conns, sizeof(*tcp.conns)),
+		.pfds = calloc(ctx->tcp_conns, sizeof(*tcp.pfds)),
+		.count = ctx->tcp_conns,
+		.buf_size = 2 + KNOT_WIRE_MAX_PKTSIZE,
+		.msgid = ctx->msgid,
+	};
+	tcp.buf = malloc(tcp.buf_size);
+	if (tcp.conns == NULL || tcp.pfds == NULL || tcp.buf == NULL) {
+		printf("failed to allocate TCP connection table\n");
+		goto finish;
+	}
+	for (size_t i = 0; i < tcp.count; i++) {
+		tcp.conns[i].fd = -1;
+		tcp.pfds[i].fd = -1;
+	}
+
+	while (xdp_trigger == KXDPGUN_WAIT) {
+		usleep(1000);
+	}
+
+	next_payload(&tcp.payload, ctx->thread_id);
+	sched_advance(ctx, ctx->thread_id + 1);
+
+	timer_start(&timer);
+
+	while (duration < ctx->duration + 1000000) {
+
+		// connecting part
+		unsigned count = (duration < ctx->duration) ? sched_due(ctx, duration) : 0;
+		if (count > 0) {
+			uint64_t now = latency_now();
+			for (unsigned i = 0; i < count; i++) {
+				if (tcp.active == tcp.count) {
+					lost++;
+					break;
+				}
+				if (!sock_tcp_open(&tcp, ctx, now)) {
+					errors++;
+					break;
+				}
+				local_stats.qry_sent++;
+			}
+		}
+
+		// sending and receiving part, waits instead of sleeping
+		uint64_t deadline = latency_now() + wait * 1000;
+		sock_tcp_events(&tcp, ctx, deadline, &local_stats);
+		uint64_t now = latency_now();
+		if (now < deadline) {
+			usleep((deadline - now) / 1000);
+		}
+
+		// speed and signal part
+		duration = pace(ctx, &local_stats, &timer, &stats_triggered, &wait);
+	}
+
+finish:
+	for (size_t i = 0; tcp.conns != NULL && i < tcp.count; i++) {
+		if (tcp.conns[i].fd >= 0) {
+			close(tcp.conns[i].fd);
+		}
+	}
+	free(tcp.buf);
+	free(tcp.pfds);
+	free(tcp.conns);
+
+	thread_finish(ctx, &local_stats, lost, errors);
 
 	return NULL;
 }
 
+void *sock_gun_thread(void *_ctx)
+{
+	xdp_gun_ctx_t *ctx = _ctx;
+
+	if (ctx->tcp) {
+		return sock_tcp_thread(ctx);
+	}
+
+	int fd = net_connected_socket(SOCK_DGRAM, &ctx->target_ip, &ctx->local_ip, false);
+	if (fd < 0) {
+		printf("failed to initialize socket#%u: %s\n",
+		       ctx->thread_id, knot_strerror(fd));
+		return NULL;
+	}
+
+	int bufsize = SOCK_UDP_BUFSIZE;
+	(void)setsockopt(fd, SOL_SOCKET, SO_SNDBUF, &bufsize, sizeof(bufsize));
+	(void)setsockopt(fd, SOL_SOCKET, SO_RCVBUF, &bufsize, sizeof(bufsize));
+
+	void *ret = sock_udp_thread(ctx, fd);
+	close(fd);
+
+	return ret;
+}
+
 static int dev2mac(const char *dev, uint8_t *mac)
 {
 	struct ifreq ifr;
@@ -571,6 +1130,16 @@ static bool configure_target(char *target_str, char *local_ip, xdp_gun_ctx_t *ct
 		ctx->target_ip.ss_family = AF_INET;
 	}
 
+	if (ctx->sock) {
+		sockaddr_port_set(&ctx->target_ip, ctx->target_port);
+		if (local_ip != NULL &&
+		    sockaddr_set(&ctx->local_ip, ctx->target_ip.ss_family, local_ip, 0) != KNOT_EOK) {
+			printf("invalid local IP\n");
+			return false;
+		}
+		return true;
+	}
+
 	struct sockaddr_storage via = { 0 };
 	int ret = ip_route_get(&ctx->target_ip, &via, &ctx->local_ip, ctx->dev);
 	if (ret < 0) {
@@ -643,9 +1212,13 @@ static void print_help(void)
 	       "                          "SPACE" (default is %d)\n"
 	       " -F, --affinity <spec>    "SPACE"CPU affinity in the format [<cpu_start>][s<cpu_step>].\n"
 	       "                          "SPACE" (default is %s)\n"
-	       " -i, --infile <file>      "SPACE"Path to a file with query templates.\n"
+	       " -i, --infile <file>      "SPACE"Path to a file with query templates or a capture.\n"
+	       " -R, --replay <speed>     "SPACE"Replay the capture with its timing sped up by the factor.\n"
 	       " -I, --interface <ifname> "SPACE"Override auto-detected interface for outgoing communication.\n"
 	       " -l, --local <ip[/prefix]>"SPACE"Override auto-detected source IP address or subnet.\n"
+	       " -S, --socket             "SPACE"Use ordinary sockets instead of XDP.\n"
+	       " -n, --threads <num>      "SPACE"Number of threads in the socket mode.\n"
+	       "                          "SPACE" (default is 1)\n"
 	       " -h, --help               "SPACE"Print the program help.\n"
 	       " -V, --version            "SPACE"Print the program version.\n"
 	       "\n"
@@ -670,6 +1243,9 @@ static bool get_opts(int argc, char *argv[], xdp_gun_ctx_t *ctx)
 		{ "interface", required_argument, NULL, 'I' },
 		{ "local",     required_argument, NULL, 'l' },
 		{ "infile",    required_argument, NULL, 'i' },
+		{ "socket",    no_argument,       NULL, 'S' },
+		{ "threads",   required_argument, NULL, 'n' },
+		{ "replay",    required_argument, NULL, 'R' },
 		{ NULL }
 	};
 
@@ -677,7 +1253,7 @@ static bool get_opts(int argc, char *argv[], xdp_gun_ctx_t *ctx)
 	bool default_at_once = true;
 	double argf;
 	char *argcp, *local_ip = NULL;
-	while ((opt = getopt_long(argc, argv, "hVt:Q:b:rp:TF:I:l:i:", opts, NULL)) != -1) {
+	while ((opt = getopt_long(argc, argv, "hVt:Q:b:rp:TF:I:l:i:Sn:R:", opts, NULL)) != -1) {
 		switch (opt) {
 		case 'h':
 			print_help();
@@ -751,6 +1327,25 @@ static bool get_opts(int argc, char *argv[], xdp_gun_ctx_t *ctx)
 				return false;
 			}
 			break;
+		case 'S':
+			ctx->sock = true;
+			break;
+		case 'n':
+			arg = atoi(optarg);
+			if (arg > 0) {
+				ctx->n_threads = arg;
+			} else {
+				return false;
+			}
+			break;
+		case 'R':
+			argf = atof(optarg);
+			if (argf > 0) {
+				ctx->speed = argf;
+			} else {
+				return false;
+			}
+			break;
 		default:
 			return false;
 		}
@@ -760,12 +1355,26 @@ static bool get_opts(int argc, char *argv[], xdp_gun_ctx_t *ctx)
 		return false;
 	}
 
+	if (ctx->speed > 0 && global_payloads_span == 0) {
+		printf("timed replay requires a capture file\n");
+		return false;
+	}
+
+	if (ctx->sock && ctx->tcp && (ctx->listen_port & KNOT_XDP_LISTEN_PORT_DROP)) {
+		printf("dropping responses isn't supported over TCP in the socket mode\n");
+		return false;
+	}
+
 	if (ctx->qps < ctx->n_threads) {
 		printf("QPS must be at least the number of threads (%u)\n", ctx->n_threads);
 		return false;
 	}
 	ctx->qps /= ctx->n_threads;
-	printf("using interface %s, XDP threads %u\n", ctx->dev, ctx->n_threads);
+	if (ctx->sock) {
+		printf("using sockets, threads %u\n", ctx->n_threads);
+	} else {
+		printf("using interface %s, XDP threads %u\n", ctx->dev, ctx->n_threads);
+	}
 
 	return true;
 }
@@ -790,12 +1399,20 @@ int main(int argc, char *argv[])
 		free_global_payloads();
 		return EXIT_FAILURE;
 	}
-	for (int i = 0; i < ctx.n_threads; i++) {
-		thread_ctxs[i] = ctx;
-		thread_ctxs[i].thread_id = i;
-	}
 
-	if (!linux_at_least(5, 11)) {
+	if (ctx.sock && ctx.tcp) {
+		// Each thread keeps up to tcp_conns connections open.
+		struct rlimit limit = { 0 };
+		if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+			limit.rlim_cur = limit.rlim_max;
+			(void)setrlimit(RLIMIT_NOFILE, &limit);
+		}
+		rlim_t per_thread = (limit.rlim_cur > 64) ? (limit.rlim_cur - 64) / ctx.n_threads : 0;
+		ctx.tcp_conns = MIN(SOCK_TCP_CONNS_MAX, per_thread);
+		if (ctx.tcp_conns == 0) {
+			ctx.tcp_conns = 1;
+		}
+	} else if (!ctx.sock && !linux_at_least(5, 11)) {
 		struct rlimit min_limit = { RLIM_INFINITY, RLIM_INFINITY }, cur_limit = { 0 };
 		if (getrlimit(RLIMIT_MEMLOCK, &cur_limit) != 0 ||
 		    cur_limit.rlim_cur != min_limit.rlim_cur ||
@@ -808,6 +1425,20 @@ int main(int argc, char *argv[])
 		}
 	}
 
+	for (int i = 0; i < ctx.n_threads; i++) {
+		thread_ctxs[i] = ctx;
+		thread_ctxs[i].thread_id = i;
+	}
+
+	if (!ctx.sock && !(ctx.listen_port & KNOT_XDP_LISTEN_PORT_DROP) &&
+	    !latency_table_init(&global_latency)) {
+		printf("out of memory\n");
+		free(thread_ctxs);
+		free(threads);
+		free_global_payloads();
+		return EXIT_FAILURE;
+	}
+
 	pthread_mutex_init(&global_stats.mutex, NULL);
 
 	struct sigaction stop_action = { .sa_handler = sigterm_handler };
@@ -821,7 +1452,9 @@ int main(int argc, char *argv[])
 		cpu_set_t set;
 		CPU_ZERO(&set);
 		CPU_SET(affinity, &set);
-		(void)pthread_create(&threads[i], NULL, xdp_gun_thread, &thread_ctxs[i]);
+		(void)pthread_create(&threads[i], NULL,
+		                     ctx.sock ? sock_gun_thread : xdp_gun_thread,
+		                     &thread_ctxs[i]);
 		int ret = pthread_setaffinity_np(threads[i], sizeof(cpu_set_t), &set);
 		if (ret != 0) {
 			printf("failed to set affinity of thread#%zu to CPU#%u\n", i, affinity);
@@ -840,6 +1473,7 @@ int main(int argc, char *argv[])
 		print_stats(&global_stats, ctx.tcp, !(ctx.listen_port & KNOT_XDP_LISTEN_PORT_DROP));
 	}
 	pthread_mutex_destroy(&global_stats.mutex);
+	latency_table_deinit(&global_latency);
 
 	free(thread_ctxs);
 	free(threads);
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+
+'''Ctl bulk zone editing with records not fitting into one data unit.'''
+
+import io
+import os
+
+import dns.rrset
+
+from dnstest.libknot import libknot
+from dnstest.test import Test
+from dnstest.utils import *
+
+t = Test()
+
+knot = t.server("knot")
+zone = t.zone("example.com.")
+t.link(zone, knot)
+
+ZONE_NAME = zone[0].name
+COUNT = 2000 # About two data units.
+TEXT = "x" * 50
+
+def records(prefix, count):
+    return ["%s%i.%s 3600 IN TXT \"%s\"" % (prefix, i, ZONE_NAME, TEXT) for i in range(count)]
+
+def wire(lines):
+    buf = io.BytesIO()
+    for line in lines:
+        owner, ttl, rclass, rtype, rdata = line.split(maxsplit=4)
+        rrset = dns.rrset.from_text(owner, int(ttl), rclass, rtype, rdata)
+        rrset.to_wire(buf)
+    return buf.getvalue()
+
+t.start()
+knot.zone_wait(zone)
+
+# knotc, all records from a file.
+bulk_file = os.path.join(knot.dir, "bulk.zone")
+with open(bulk_file, "w") as f:
+    f.write("\n".join(records("file", COUNT)) + "\n")
+
+knot.ctl("zone-begin %s" % ZONE_NAME)
+knot.ctl("zone-set %s +file %s" % (ZONE_NAME, bulk_file))
+knot.ctl("zone-commit %s" % ZONE_NAME)
+
+for i in [0, COUNT - 1]:
+    resp = knot.dig("file%i.%s" % (i, ZONE_NAME), "TXT")
+    resp.check(rcode="NOERROR", rdata=TEXT)
+
+# knotc, error in the last data unit.
+with open(bulk_file, "w") as f:
+    f.write("\n".join(records("bad", COUNT) + ["out.of.zone. 3600 IN A 1.2.3.4"]) + "\n")
+
+knot.ctl("zone-begin %s" % ZONE_NAME)
+try:
+    knot.ctl("zone-set %s +file %s" % (ZONE_NAME, bulk_file))
+    set_err("knotc error in the last data unit not reported")
+except Failed:
+    pass
+knot.ctl("zone-abort %s" % ZONE_NAME)
+
+# Python, records in wire format.
+ctl = libknot.control.KnotCtl()
+ctl.connect(os.path.join(knot.dir, "knot.sock"))
+
+ctl.send_block(cmd="zone-begin", zone=ZONE_NAME)
+resp = ctl.receive_block()
+
+ctl.send_wire_block(cmd="zone-set", zone=ZONE_NAME, wire=wire(records("py", COUNT)))
+resp = ctl.receive_block()
+
+ctl.send_block(cmd="zone-commit", zone=ZONE_NAME)
+resp = ctl.receive_block()
+
+ctl.send_block(cmd="zone-read", zone=ZONE_NAME)
+resp = ctl.receive_block()
+count = len([owner for owner in resp[ZONE_NAME] if owner.startswith("py")])
+compare(count, COUNT, "records added in bulk")
+
+# Python, error in the last data unit.
+ctl.send_block(cmd="zone-begin", zone=ZONE_NAME)
+resp = ctl.receive_block()
+
+bad = wire(records("bad", COUNT) + ["out.of.zone. 3600 IN A 1.2.3.4"])
+ctl.send_wire_block(cmd="zone-set", zone=ZONE_NAME, wire=bad)
+try:
+    resp = ctl.receive_block()
+    set_err("python error in the last data unit not reported")
+except libknot.control.KnotCtlError:
+    pass
+
+ctl.send_block(cmd="zone-abort", zone=ZONE_NAME)
+resp = ctl.receive_block()
+
+ctl.send(libknot.control.KnotCtlType.END)
+ctl.close()
+
+resp = knot.dig("bad0.%s" % ZONE_NAME, "TXT")
+resp.check(rcode="NXDOMAIN")
+
+t.end()
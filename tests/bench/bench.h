@@ -0,0 +1,132 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \file
+ *
+ * \brief Common helpers for benchmarks.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "contrib/mempattern.h"
+#include "contrib/ucw/mempool.h"
+#include "libknot/mm_ctx.h"
+
+/*! \brief Monotonic time in nanoseconds. */
+static inline uint64_t bench_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+#define BENCH_CYCLES_UNIT	"cycles"
+#else
+#define BENCH_CYCLES_UNIT	"ns"
+#endif
+
+/*! \brief CPU cycle counter, monotonic time in nanoseconds if not available. */
+static inline uint64_t bench_cycles(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+	return __builtin_ia32_rdtsc();
+#else
+	return bench_now_ns();
+#endif
+}
+
+/*!
+ * \brief Mempool memory context counting the allocations.
+ *
+ * \note The pool must be flushed via bench_mm_flush(), mp_flush() on mm.ctx
+ *       doesn't work.
+ */
+typedef struct {
+	struct mempool *pool;
+	uint64_t allocs;
+	uint64_t bytes;
+} bench_mm_t;
+
+static inline void *bench_mm_alloc(void *ctx, size_t len)
+{
+	bench_mm_t *bmm = ctx;
+	bmm->allocs++;
+	bmm->bytes += len;
+	return mp_alloc(bmm->pool, len);
+}
+
+static inline int bench_mm_init(bench_mm_t *bmm, knot_mm_t *mm)
+{
+	bmm->pool = mp_new(MM_DEFAULT_BLKSIZE);
+	if (bmm->pool == NULL) {
+		return -1;
+	}
+	bmm->allocs = 0;
+	bmm->bytes = 0;
+
+	mm->ctx = bmm;
+	mm->alloc = bench_mm_alloc;
+	mm->free = NULL;
+
+	return 0;
+}
+
+static inline void bench_mm_flush(bench_mm_t *bmm)
+{
+	mp_flush(bmm->pool);
+}
+
+static inline void bench_mm_deinit(bench_mm_t *bmm)
+{
+	mp_delete(bmm->pool);
+	bmm->pool = NULL;
+}
+
+static int bench_u64_cmp(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+	return (x > y) - (x < y);
+}
+
+/*! \brief Sort the samples in ascending order. */
+static inline void bench_sort(uint64_t *samples, size_t count)
+{
+	qsort(samples, count, sizeof(*samples), bench_u64_cmp);
+}
+
+/*!
+ * \brief Get a percentile of sorted samples.
+ *
+ * \param samples  Samples sorted by bench_sort().
+ * \param count    Number of samples.
+ * \param pct      Percentile in the range 0 to 100.
+ */
+static inline uint64_t bench_percentile(const uint64_t *samples, size_t count, double pct)
+{
+	if (count == 0) {
+		return 0;
+	}
+
+	size_t idx = (size_t)(pct / 100.0 * (count - 1) + 0.5);
+	return samples[idx < count ? idx : count - 1];
+}
@@ -0,0 +1,900 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \brief Query processing benchmark.
+ *
+ * Loads zones into a fake server and replays a query corpus through
+ * the query processing layer the same way the UDP handler does.
+ */
+
+#include <getopt.h>
+#include <inttypes.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <urcu.h>
+
+#include <tap/files.h>
+
+#include "bench/bench.h"
+#include "contrib/macros.h"
+#include "contrib/sockaddr.h"
+#include "contrib/string.h"
+#include "contrib/wire_ctx.h"
+#include "knot/conf/conf.h"
+#include "knot/nameserver/process_query.h"
+#include "knot/server/server.h"
+#include "knot/zone/zone-load.h"
+#include "libknot/libknot.h"
+
+#define PROGRAM_NAME	"knot_query"
+#define DEFAULT_QUERIES	1000000
+#define DEFAULT_WARMUP	10000
+#define DEFAULT_EDNS	1232
+#define SYNTH_ORIGIN	"example."
+#define SYNTH_HOSTS	10000
+
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define HEAP_COUNTING
+
+/* Count heap allocations by overriding the glibc allocator entry points. */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t nmemb, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static __thread uint64_t heap_allocs;
+
+void *malloc(size_t size)
+{
+	heap_allocs++;
+	return __libc_malloc(size);
+}
+
+void *calloc(size_t nmemb, size_t size)
+{
+	heap_allocs++;
+	return __libc_calloc(nmemb, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+	heap_allocs++;
+	return __libc_realloc(ptr, size);
+}
+#else
+static __thread uint64_t heap_allocs;
+#endif
+
+typedef struct {
+	uint8_t **wire;
+	uint16_t *len;
+	size_t count;
+	size_t alloc;
+} corpus_t;
+
+typedef struct {
+	const char *origin;
+	const char *file;
+} zone_arg_t;
+
+typedef struct {
+	pthread_t thread;
+	unsigned id;
+	server_t *server;
+	const corpus_t *corpus;
+	size_t offset;
+	size_t queries;
+	size_t warmup;
+	uint64_t *latency;
+	uint64_t elapsed;
+	uint64_t heap_allocs;
+	uint64_t pool_allocs;
+	uint64_t pool_bytes;
+	uint64_t dropped;
+	uint64_t rcodes[16];
+	bool started;
+	int ret;
+} worker_t;
+
+static int corpus_add(corpus_t *corpus, const uint8_t *wire, size_t len)
+{
+	if (len < KNOT_WIRE_HEADER_SIZE || len > KNOT_WIRE_MAX_PKTSIZE ||
+	    knot_wire_get_qr(wire)) {
+		return KNOT_EOK; // Skip responses and garbage.
+	}
+
+	if (corpus->count == corpus->alloc) {
+		size_t new_alloc = (corpus->alloc == 0) ? 1024 : 2 * corpus->alloc;
+		uint8_t **new_wire = realloc(corpus->wire, new_alloc * sizeof(*new_wire));
+		if (new_wire == NULL) {
+			return KNOT_ENOMEM;
+		}
+		corpus->wire = new_wire;
+		uint16_t *new_len = realloc(corpus->len, new_alloc * sizeof(*new_len));
+		if (new_len == NULL) {
+			return KNOT_ENOMEM;
+		}
+		corpus->len = new_len;
+		corpus->alloc = new_alloc;
+	}
+
+	uint8_t *copy = malloc(len);
+	if (copy == NULL) {
+		return KNOT_ENOMEM;
+	}
+	memcpy(copy, wire, len);
+
+	corpus->wire[corpus->count] = copy;
+	corpus->len[corpus->count] = len;
+	corpus->count++;
+
+	return KNOT_EOK;
+}
+
+static void corpus_deinit(corpus_t *corpus)
+{
+	for (size_t i = 0; i < corpus->count; i++) {
+		free(corpus->wire[i]);
+	}
+	free(corpus->wire);
+	free(corpus->len);
+	memset(corpus, 0, sizeof(*corpus));
+}
+
+static int corpus_add_question(corpus_t *corpus, const char *owner, uint16_t type,
+                               uint16_t edns, bool dnssec)
+{
+	knot_dname_storage_t qname;
+	if (knot_dname_from_str(qname, owner, sizeof(qname)) == NULL) {
+		return KNOT_EINVAL;
+	}
+	knot_dname_to_lower(qname);
+
+	uint8_t wire[KNOT_WIRE_MAX_PKTSIZE];
+	knot_pkt_t *pkt = knot_pkt_new(wire, sizeof(wire), NULL);
+	if (pkt == NULL) {
+		return KNOT_ENOMEM;
+	}
+	knot_pkt_clear(pkt);
+	knot_wire_set_id(pkt->wire, corpus->count);
+	int ret = knot_pkt_put_question(pkt, qname, KNOT_CLASS_IN, type);
+	if (ret == KNOT_EOK && edns > 0) {
+		knot_rrset_t opt;
+		ret = knot_edns_init(&opt, edns, 0, 0, NULL);
+		if (ret == KNOT_EOK) {
+			if (dnssec) {
+				knot_edns_set_do(&opt);
+			}
+			knot_pkt_begin(pkt, KNOT_ADDITIONAL);
+			ret = knot_pkt_put(pkt, KNOT_COMPR_HINT_NONE, &opt, 0);
+			knot_rrset_clear(&opt, NULL);
+		}
+	}
+	if (ret == KNOT_EOK) {
+		ret = corpus_add(corpus, pkt->wire, pkt->size);
+	}
+	knot_pkt_free(pkt);
+
+	return ret;
+}
+
+/*! \brief Load queries in the "name type" format, one per line. */
+static int corpus_load_text(corpus_t *corpus, const char *path, uint16_t edns,
+                            bool dnssec)
+{
+	FILE *fp = fopen(path, "r");
+	if (fp == NULL) {
+		return knot_map_errno();
+	}
+
+	int ret = KNOT_EOK;
+	char line[KNOT_DNAME_TXT_MAXLEN + 64];
+	size_t lineno = 0;
+	while (ret == KNOT_EOK && fgets(line, sizeof(line), fp) != NULL) {
+		lineno++;
+		char owner[1024], type_str[32];
+		if (line[0] == '#' || sscanf(line, "%1023s %31s", owner, type_str) != 2) {
+			continue;
+		}
+
+		uint16_t type;
+		if (knot_rrtype_from_string(type_str, &type) != 0) {
+			fprintf(stderr, "%s:%zu: invalid type '%s'\n", path, lineno, type_str);
+			continue;
+		}
+
+		ret = corpus_add_question(corpus, owner, type, edns, dnssec);
+		if (ret == KNOT_EINVAL) {
+			fprintf(stderr, "%s:%zu: invalid name '%s'\n", path, lineno, owner);
+			ret = KNOT_EOK;
+		}
+	}
+	fclose(fp);
+
+	return ret;
+}
+
+#define PCAP_MAGIC	0xa1b2c3d4
+#define PCAP_MAGIC_NS	0xa1b23c4d
+#define LINKTYPE_NULL	0
+#define LINKTYPE_ETHER	1
+#define LINKTYPE_RAW	101
+#define LINKTYPE_SLL	113
+
+static uint32_t pcap_u32(const uint8_t *data, bool swap)
+{
+	uint32_t val;
+	memcpy(&val, data, sizeof(val));
+	return swap ? __builtin_bswap32(val) : val;
+}
+
+/*! \brief Add UDP payload of a captured frame, other frames are ignored. */
+static int pcap_frame(corpus_t *corpus, uint32_t linktype, const uint8_t *data,
+                       size_t len)
+{
+	wire_ctx_t ctx = wire_ctx_init_const(data, len);
+
+	uint16_t proto = 0;
+	switch (linktype) {
+	case LINKTYPE_NULL:
+		wire_ctx_skip(&ctx, 4);
+		break;
+	case LINKTYPE_ETHER:
+		wire_ctx_skip(&ctx, 12);
+		proto = wire_ctx_read_u16(&ctx);
+		while (proto == 0x8100 || proto == 0x88a8) { // VLAN tags
+			wire_ctx_skip(&ctx, 2);
+			proto = wire_ctx_read_u16(&ctx);
+		}
+		break;
+	case LINKTYPE_SLL:
+		wire_ctx_skip(&ctx, 14);
+		proto = wire_ctx_read_u16(&ctx);
+		break;
+	case LINKTYPE_RAW:
+		break;
+	default:
+		return KNOT_EOK;
+	}
+	if (ctx.error != KNOT_EOK || wire_ctx_available(&ctx) < 1) {
+		return KNOT_EOK;
+	}
+
+	uint8_t version = *ctx.position >> 4;
+	if (proto != 0 && proto != 0x0800 && proto != 0x86dd) {
+		return KNOT_EOK;
+	} else if (version == 4) {
+		uint8_t ihl = (wire_ctx_read_u8(&ctx) & 0x0f) * 4;
+		wire_ctx_skip(&ctx, 5);
+		uint16_t frag = wire_ctx_read_u16(&ctx);
+		wire_ctx_skip(&ctx, 1);
+		uint8_t next = wire_ctx_read_u8(&ctx);
+		if (next != IPPROTO_UDP || (frag & 0x3fff) != 0 || ihl < 20) {
+			return KNOT_EOK;
+		}
+		wire_ctx_skip(&ctx, ihl - 10);
+	} else if (version == 6) {
+		wire_ctx_skip(&ctx, 6);
+		uint8_t next = wire_ctx_read_u8(&ctx);
+		if (next != IPPROTO_UDP) {
+			return KNOT_EOK; // Extension headers not supported.
+		}
+		wire_ctx_skip(&ctx, 33);
+	} else {
+		return KNOT_EOK;
+	}
+
+	wire_ctx_skip(&ctx, 4);
+	uint16_t udp_len = wire_ctx_read_u16(&ctx);
+	wire_ctx_skip(&ctx, 2);
+	if (ctx.error != KNOT_EOK || udp_len < 8) {
+		return KNOT_EOK;
+	}
+
+	size_t payload = MIN(udp_len - 8, wire_ctx_available(&ctx));
+	return corpus_add(corpus, ctx.position, payload);
+}
+
+/*! \brief Load DNS queries from a classic pcap file. */
+static int corpus_load_pcap(corpus_t *corpus, const char *path)
+{
+	FILE *fp = fopen(path, "rb");
+	if (fp == NULL) {
+		return knot_map_errno();
+	}
+
+	uint8_t hdr[24];
+	if (fread(hdr, sizeof(hdr), 1, fp) != 1) {
+		fclose(fp);
+		return KNOT_EMALF;
+	}
+
+	bool swap;
+	uint32_t magic = pcap_u32(hdr, false);
+	if (magic == PCAP_MAGIC || magic == PCAP_MAGIC_NS) {
+		swap = false;
+	} else if (__builtin_bswap32(magic) == PCAP_MAGIC ||
+	           __builtin_bswap32(magic) == PCAP_MAGIC_NS) {
+		swap = true;
+	} else {
+		fclose(fp);
+		return KNOT_EMALF;
+	}
+	uint32_t linktype = pcap_u32(hdr + 20, swap) & 0x0fffffff;
+
+	int ret = KNOT_EOK;
+	uint8_t frame[65536];
+	uint8_t rec[16];
+	while (ret == KNOT_EOK && fread(rec, sizeof(rec), 1, fp) == 1) {
+		uint32_t caplen = pcap_u32(rec + 8, swap);
+		if (caplen > sizeof(frame) || fread(frame, caplen, 1, fp) != 1) {
+			ret = KNOT_EMALF;
+			break;
+		}
+		ret = pcap_frame(corpus, linktype, frame, caplen);
+	}
+	fclose(fp);
+
+	return ret;
+}
+
+/*! \brief Write a zone with various answer types into the directory. */
+static char *synth_zone(const char *dir)
+{
+	char *path = sprintf_alloc("%s/%szone", dir, SYNTH_ORIGIN);
+	FILE *fp = (path != NULL) ? fopen(path, "w") : NULL;
+	if (fp == NULL) {
+		free(path);
+		return NULL;
+	}
+
+	fprintf(fp, "$ORIGIN %s\n$TTL 3600\n"
+	            "@ SOA ns hostmaster 1 3600 900 604800 300\n"
+	            "@ NS ns\n"
+	            "ns A 192.0.2.1\n"
+	            "ns AAAA 2001:db8::1\n"
+	            "sub NS ns.sub\n"
+	            "ns.sub A 192.0.2.2\n"
+	            "*.wild A 192.0.2.3\n"
+	            "alias CNAME host0\n", SYNTH_ORIGIN);
+	for (unsigned i = 0; i < SYNTH_HOSTS; i++) {
+		fprintf(fp, "host%u A 198.51.%u.%u\n", i, (i >> 8) & 0xff, i & 0xff);
+	}
+	fclose(fp);
+
+	return path;
+}
+
+/*! \brief Generate a mix of positive, negative, wildcard and referral queries. */
+static int synth_corpus(corpus_t *corpus, uint16_t edns, bool dnssec)
+{
+	int ret = KNOT_EOK;
+	for (unsigned i = 0; ret == KNOT_EOK && i < SYNTH_HOSTS; i++) {
+		char owner[64];
+		uint16_t type = KNOT_RRTYPE_A;
+		switch (i % 8) {
+		case 0:
+		case 1:
+		case 2:
+			(void)snprintf(owner, sizeof(owner), "host%u.%s", i, SYNTH_ORIGIN);
+			break;
+		case 3:
+			(void)snprintf(owner, sizeof(owner), "host%u.%s", i, SYNTH_ORIGIN);
+			type = KNOT_RRTYPE_AAAA;
+			break;
+		case 4:
+			(void)snprintf(owner, sizeof(owner), "none%u.%s", i, SYNTH_ORIGIN);
+			break;
+		case 5:
+			(void)snprintf(owner, sizeof(owner), "w%u.wild.%s", i, SYNTH_ORIGIN);
+			break;
+		case 6:
+			(void)snprintf(owner, sizeof(owner), "h%u.sub.%s", i, SYNTH_ORIGIN);
+			break;
+		default:
+			(void)snprintf(owner, sizeof(owner), "alias.%s", SYNTH_ORIGIN);
+			break;
+		}
+		ret = corpus_add_question(corpus, owner, type, edns, dnssec);
+	}
+
+	return ret;
+}
+
+static int setup_conf(const char *dir, const zone_arg_t *zones, size_t count)
+{
+	char *conf_str = sprintf_alloc("server:\n"
+	                               "    identity: bench\n"
+	                               "database:\n"
+	                               "    storage: \"%s\"\n"
+	                               "template:\n"
+	                               "  - id: default\n"
+	                               "    zonefile-sync: -1\n"
+	                               "    journal-content: none\n"
+	                               "zone:\n", dir);
+	for (size_t i = 0; conf_str != NULL && i < count; i++) {
+		char *zone_str = sprintf_alloc("  - domain: \"%s\"\n"
+		                               "    file: \"%s\"\n",
+		                               zones[i].origin, zones[i].file);
+		char *joined = strcdup(conf_str, zone_str);
+		free(zone_str);
+		free(conf_str);
+		conf_str = joined;
+	}
+	if (conf_str == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	conf_t *new_conf = NULL;
+	int ret = conf_new(&new_conf, conf_schema, NULL, 2 * 1024 * 1024, CONF_FNONE);
+	if (ret == KNOT_EOK) {
+		ret = conf_import(new_conf, conf_str, false, false);
+		if (ret == KNOT_EOK) {
+			conf_update(new_conf, CONF_UPD_FNONE);
+		} else {
+			conf_free(new_conf);
+		}
+	}
+	free(conf_str);
+
+	return ret;
+}
+
+static int load_zones(server_t *server, const zone_arg_t *zones, size_t count)
+{
+	knot_zonedb_t *db = knot_zonedb_new();
+	if (db == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	int ret = KNOT_EOK;
+	for (size_t i = 0; ret == KNOT_EOK && i < count; i++) {
+		knot_dname_t *name = knot_dname_from_str_alloc(zones[i].origin);
+		if (name == NULL) {
+			ret = KNOT_EINVAL;
+			break;
+		}
+		knot_dname_to_lower(name);
+
+		zone_t *zone = zone_new(name);
+		knot_dname_free(name, NULL);
+		if (zone == NULL) {
+			ret = KNOT_ENOMEM;
+			break;
+		}
+		zone->server = server;
+		zone->settings = zone_settings_new(conf(), zone->name);
+
+		ret = zone_load_contents(conf(), zone->name, &zone->contents, false);
+		if (ret == KNOT_EOK) {
+			ret = knot_zonedb_insert(db, zone);
+		}
+		if (ret != KNOT_EOK) {
+			fprintf(stderr, "failed to load zone %s from %s (%s)\n",
+			        zones[i].origin, zones[i].file, knot_strerror(ret));
+			zone_free(&zone);
+		}
+	}
+
+	if (ret != KNOT_EOK) {
+		knot_zonedb_deep_free(&db, false);
+		return ret;
+	}
+
+	knot_zonedb_deep_free(&server->zone_db, false);
+	server->zone_db = db;
+
+	return KNOT_EOK;
+}
+
+/*! \brief Process one query like udp_handle() does, return response size. */
+static size_t handle_query(knot_layer_t *layer, knotd_qdata_params_t *params,
+                           uint8_t *rx, size_t rx_len, uint8_t *tx, size_t tx_len)
+{
+	knot_layer_begin(layer, params);
+
+	knot_pkt_t *query = knot_pkt_new(rx, rx_len, layer->mm);
+	knot_pkt_t *ans = knot_pkt_new(tx, tx_len, layer->mm);
+
+	int ret = knot_pkt_parse(query, 0);
+	if (ret != KNOT_EOK && query->parsed > 0) {
+		query->parsed--;
+	}
+	knot_layer_consume(layer, query);
+
+	while (layer->state == KNOT_STATE_PRODUCE || layer->state == KNOT_STATE_FAIL) {
+		knot_layer_produce(layer, ans);
+	}
+
+	size_t ans_len = (layer->state == KNOT_STATE_DONE) ? ans->size : 0;
+
+	knot_layer_finish(layer);
+
+	return ans_len;
+}
+
+static void *worker_run(void *arg)
+{
+	worker_t *w = arg;
+	const corpus_t *corpus = w->corpus;
+
+	rcu_register_thread();
+
+	bench_mm_t bmm;
+	knot_mm_t mm;
+	if (bench_mm_init(&bmm, &mm) != 0) {
+		w->ret = KNOT_ENOMEM;
+		rcu_unregister_thread();
+		return NULL;
+	}
+
+	knot_layer_t layer = { 0 };
+	knot_layer_init(&layer, &mm, process_query_layer());
+
+	struct sockaddr_storage remote;
+	sockaddr_set(&remote, AF_INET, "127.0.0.1", 53);
+	knotd_qdata_params_t params = {
+		.remote = &remote,
+		.flags = KNOTD_QUERY_FLAG_NO_AXFR | KNOTD_QUERY_FLAG_NO_IXFR |
+		         KNOTD_QUERY_FLAG_LIMIT_SIZE,
+		.socket = -1,
+		.server = w->server,
+		.thread_id = w->id
+	};
+
+	uint8_t rx[KNOT_WIRE_MAX_PKTSIZE];
+	uint8_t tx[KNOT_WIRE_MAX_PKTSIZE];
+
+	size_t pos = w->offset;
+	for (size_t i = 0; i < w->warmup + w->queries; i++) {
+		if (i == w->warmup) {
+			heap_allocs = 0;
+			bmm.allocs = 0;
+			bmm.bytes = 0;
+			w->elapsed = bench_now_ns();
+		}
+
+		size_t len = corpus->len[pos];
+		memcpy(rx, corpus->wire[pos], len);
+		if (++pos == corpus->count) {
+			pos = 0;
+		}
+
+		uint64_t start = bench_now_ns();
+		size_t ans_len = handle_query(&layer, &params, rx, len, tx, sizeof(tx));
+		bench_mm_flush(&bmm);
+		uint64_t end = bench_now_ns();
+
+		if (i >= w->warmup) {
+			w->latency[i - w->warmup] = end - start;
+			if (ans_len >= KNOT_WIRE_HEADER_SIZE) {
+				w->rcodes[knot_wire_get_rcode(tx)]++;
+			} else {
+				w->dropped++;
+			}
+		}
+	}
+	w->elapsed = bench_now_ns() - w->elapsed;
+	w->heap_allocs = heap_allocs;
+	w->pool_allocs = bmm.allocs;
+	w->pool_bytes = bmm.bytes;
+
+	bench_mm_deinit(&bmm);
+	rcu_unregister_thread();
+
+	return NULL;
+}
+
+static void report(worker_t *workers, unsigned threads)
+{
+	size_t total = 0;
+	double qps_sum = 0;
+	uint64_t heap = 0, pool = 0, pool_bytes = 0, dropped = 0;
+	uint64_t rcodes[16] = { 0 };
+
+	for (unsigned i = 0; i < threads; i++) {
+		worker_t *w = &workers[i];
+		double qps = w->queries * 1e9 / (w->elapsed > 0 ? w->elapsed : 1);
+		printf("thread %2u: %10.0f qps\n", i, qps);
+
+		total += w->queries;
+		qps_sum += qps;
+		heap += w->heap_allocs;
+		pool += w->pool_allocs;
+		pool_bytes += w->pool_bytes;
+		dropped += w->dropped;
+		for (int rc = 0; rc < 16; rc++) {
+			rcodes[rc] += w->rcodes[rc];
+		}
+	}
+
+	printf("total:     %10.0f qps, %.0f qps per thread\n", qps_sum, qps_sum / threads);
+
+	/* Merge latency samples of all threads. */
+	uint64_t *samples = malloc(total * sizeof(*samples));
+	if (samples != NULL) {
+		size_t pos = 0;
+		for (unsigned i = 0; i < threads; i++) {
+			memcpy(samples + pos, workers[i].latency,
+			       workers[i].queries * sizeof(*samples));
+			pos += workers[i].queries;
+		}
+		bench_sort(samples, total);
+		printf("latency:   p50 %"PRIu64" ns, p90 %"PRIu64" ns, p99 %"PRIu64" ns, "
+		       "p99.9 %"PRIu64" ns, max %"PRIu64" ns\n",
+		       bench_percentile(samples, total, 50),
+		       bench_percentile(samples, total, 90),
+		       bench_percentile(samples, total, 99),
+		       bench_percentile(samples, total, 99.9),
+		       bench_percentile(samples, total, 100));
+		free(samples);
+	}
+
+#ifdef HEAP_COUNTING
+	printf("allocs:    %.2f heap, %.2f mempool (%.0f B) per query\n",
+	       (double)heap / total, (double)pool / total, (double)pool_bytes / total);
+#else
+	printf("allocs:    %.2f mempool (%.0f B) per query\n",
+	       (double)pool / total, (double)pool_bytes / total);
+#endif
+
+	printf("responses:");
+	for (int rc = 0; rc < 16; rc++) {
+		if (rcodes[rc] > 0) {
+			const knot_lookup_t *item = knot_lookup_by_id(knot_rcode_names, rc);
+			if (item != NULL) {
+				printf(" %s %"PRIu64",", item->name, rcodes[rc]);
+			} else {
+				printf(" RCODE%d %"PRIu64",", rc, rcodes[rc]);
+			}
+		}
+	}
+	printf(" dropped %"PRIu64"\n", dropped);
+}
+
+static void print_help(void)
+{
+	printf("Usage: %s [options]\n"
+	       "\n"
+	       "Replays queries through the query processing layer.\n"
+	       "\n"
+	       "Options:\n"
+	       " -t, --threads <num>       Number of threads (default 1).\n"
+	       " -n, --queries <num>       Measured queries per thread (default %u).\n"
+	       " -w, --warmup <num>        Warm-up queries per thread (default %u).\n"
+	       " -z, --zone <origin:file>  Zone to be loaded (may be repeated).\n"
+	       " -q, --query-file <file>   Text query corpus, \"name type\" per line.\n"
+	       " -p, --pcap <file>         Query corpus in the pcap format.\n"
+	       " -e, --edns <size>         EDNS payload of text queries, 0 disables (default %u).\n"
+	       " -D, --dnssec              Set the DO bit in text queries.\n"
+	       " -h, --help                Print the program help.\n"
+	       "\n"
+	       "Without zones and queries, a synthetic zone and query mix is used.\n",
+	       PROGRAM_NAME, DEFAULT_QUERIES, DEFAULT_WARMUP, DEFAULT_EDNS);
+}
+
+int main(int argc, char *argv[])
+{
+	struct option opts[] = {
+		{ "threads",    required_argument, NULL, 't' },
+		{ "queries",    required_argument, NULL, 'n' },
+		{ "warmup",     required_argument, NULL, 'w' },
+		{ "zone",       required_argument, NULL, 'z' },
+		{ "query-file", required_argument, NULL, 'q' },
+		{ "pcap",       required_argument, NULL, 'p' },
+		{ "edns",       required_argument, NULL, 'e' },
+		{ "dnssec",     no_argument,       NULL, 'D' },
+		{ "help",       no_argument,       NULL, 'h' },
+		{ NULL }
+	};
+
+	unsigned threads = 1;
+	size_t queries = DEFAULT_QUERIES;
+	size_t warmup = DEFAULT_WARMUP;
+	zone_arg_t *zones = NULL;
+	size_t zone_count = 0;
+	const char *query_file = NULL;
+	const char *pcap_file = NULL;
+	unsigned edns = DEFAULT_EDNS;
+	bool dnssec = false;
+
+	int opt;
+	while ((opt = getopt_long(argc, argv, "t:n:w:z:q:p:e:Dh", opts, NULL)) != -1) {
+		switch (opt) {
+		case 't':
+			threads = strtoul(optarg, NULL, 10);
+			break;
+		case 'n':
+			queries = strtoull(optarg, NULL, 10);
+			break;
+		case 'w':
+			warmup = strtoull(optarg, NULL, 10);
+			break;
+		case 'z': {
+			char *sep = strchr(optarg, ':');
+			zone_arg_t *new_zones = realloc(zones, (zone_count + 1) * sizeof(*zones));
+			if (sep == NULL || new_zones == NULL) {
+				print_help();
+				free(zones);
+				return EXIT_FAILURE;
+			}
+			*sep = '\0';
+			zones = new_zones;
+			zones[zone_count].origin = optarg;
+			zones[zone_count].file = sep + 1;
+			zone_count++;
+			break;
+		}
+		case 'q':
+			query_file = optarg;
+			break;
+		case 'p':
+			pcap_file = optarg;
+			break;
+		case 'e':
+			edns = strtoul(optarg, NULL, 10);
+			break;
+		case 'D':
+			dnssec = true;
+			break;
+		case 'h':
+			print_help();
+			free(zones);
+			return EXIT_SUCCESS;
+		default:
+			print_help();
+			free(zones);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (threads == 0 || queries == 0 || edns > UINT16_MAX) {
+		print_help();
+		free(zones);
+		return EXIT_FAILURE;
+	}
+	if ((zone_count == 0) != (query_file == NULL && pcap_file == NULL)) {
+		fprintf(stderr, "zones and queries must be specified together\n");
+		free(zones);
+		return EXIT_FAILURE;
+	}
+
+	int exit_code = EXIT_FAILURE;
+	char *synth_path = NULL;
+	corpus_t corpus = { 0 };
+	worker_t *workers = NULL;
+	server_t server = { 0 };
+	bool conf_ready = false;
+	bool server_ready = false;
+
+	char *dir = test_mkdtemp();
+	if (dir == NULL) {
+		fprintf(stderr, "failed to create temporary directory\n");
+		goto finish;
+	}
+
+	/* Prepare the query corpus. */
+	int ret = KNOT_EOK;
+	if (zone_count == 0) {
+		synth_path = synth_zone(dir);
+		zones = malloc(sizeof(*zones));
+		if (synth_path == NULL || zones == NULL) {
+			fprintf(stderr, "failed to create synthetic zone\n");
+			goto finish;
+		}
+		zones[0].origin = SYNTH_ORIGIN;
+		zones[0].file = synth_path;
+		zone_count = 1;
+		ret = synth_corpus(&corpus, edns, dnssec);
+	} else {
+		if (query_file != NULL) {
+			ret = corpus_load_text(&corpus, query_file, edns, dnssec);
+		}
+		if (ret == KNOT_EOK && pcap_file != NULL) {
+			ret = corpus_load_pcap(&corpus, pcap_file);
+		}
+	}
+	if (ret != KNOT_EOK || corpus.count == 0) {
+		fprintf(stderr, "failed to load queries (%s)\n",
+		        ret != KNOT_EOK ? knot_strerror(ret) : "no queries");
+		goto finish;
+	}
+
+	/* Prepare the server. */
+	ret = setup_conf(dir, zones, zone_count);
+	if (ret != KNOT_EOK) {
+		fprintf(stderr, "failed to prepare configuration (%s)\n", knot_strerror(ret));
+		goto finish;
+	}
+	conf_ready = true;
+	ret = server_init(&server, 1);
+	if (ret != KNOT_EOK) {
+		fprintf(stderr, "failed to initialize server (%s)\n", knot_strerror(ret));
+		goto finish;
+	}
+	server_ready = true;
+	ret = load_zones(&server, zones, zone_count);
+	if (ret != KNOT_EOK) {
+		goto finish;
+	}
+
+	printf("zones: %zu, queries: %zu, threads: %u, queries per thread: %zu\n",
+	       zone_count, corpus.count, threads, queries);
+
+	/* Run the workers. */
+	workers = calloc(threads, sizeof(*workers));
+	if (workers == NULL) {
+		goto finish;
+	}
+	for (unsigned i = 0; i < threads; i++) {
+		worker_t *w = &workers[i];
+		w->id = i;
+		w->server = &server;
+		w->corpus = &corpus;
+		w->offset = (corpus.count / threads) * i;
+		w->queries = queries;
+		w->warmup = warmup;
+		w->latency = malloc(queries * sizeof(*w->latency));
+		if (w->latency == NULL) {
+			fprintf(stderr, "failed to allocate latency samples\n");
+			goto finish;
+		}
+	}
+	for (unsigned i = 0; i < threads; i++) {
+		workers[i].started = (pthread_create(&workers[i].thread, NULL,
+		                                     worker_run, &workers[i]) == 0);
+	}
+	bool failed = false;
+	for (unsigned i = 0; i < threads; i++) {
+		if (workers[i].started) {
+			pthread_join(workers[i].thread, NULL);
+		}
+		failed |= (!workers[i].started || workers[i].ret != KNOT_EOK);
+	}
+
+	if (!failed) {
+		report(workers, threads);
+		exit_code = EXIT_SUCCESS;
+	}
+
+finish:
+	if (workers != NULL) {
+		for (unsigned i = 0; i < threads; i++) {
+			free(workers[i].latency);
+		}
+		free(workers);
+	}
+	if (server_ready) {
+		server_deinit(&server);
+	}
+	if (conf_ready) {
+		conf_free(conf());
+	}
+	corpus_deinit(&corpus);
+	free(synth_path);
+	free(zones);
+	if (dir != NULL) {
+		test_rm_rf(dir);
+		free(dir);
+	}
+
+	return exit_code;
+}
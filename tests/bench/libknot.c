@@ -0,0 +1,768 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+/*!
+ * \brief Microbenchmarks of libknot primitives.
+ *
+ * Each case is run in several rounds over a synthetic TLD-like name set
+ * or packets derived from it, the median cost per operation is reported.
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench/bench.h"
+#include "contrib/macros.h"
+#include "contrib/qp-trie/trie.h"
+#include "contrib/string.h"
+#include "libknot/libknot.h"
+#include "libknot/yparser/yparser.h"
+
+#define PROGRAM_NAME	"libknot"
+#define DEFAULT_NAMES	100000
+#define DEFAULT_ROUNDS	7
+#define TSIG_OPS	10000
+#define RDATASET_SIZE	16
+#define A_RDATA_SIZE	6  // knot_rdata_size(4)
+
+typedef struct {
+	size_t count;
+	char **names_str;
+	knot_dname_t **names;
+	uint8_t **queries;
+	uint16_t *query_len;
+	uint8_t response[KNOT_WIRE_MAX_PKTSIZE];
+	size_t response_len;
+	knot_rrset_t ns_rrset;
+	uint8_t ns_wire[512];
+	size_t ns_wire_len;
+	uint8_t a_rdata[RDATASET_SIZE][A_RDATA_SIZE];
+	trie_t *trie;
+	char *conf;
+	knot_tsig_key_t tsig_key;
+	uint8_t tsig_query[TSIG_OPS][256];
+	size_t tsig_query_len[TSIG_OPS];
+} bench_data_t;
+
+typedef struct {
+	const char *name;
+	size_t (*run)(bench_data_t *data);
+} bench_case_t;
+
+/* Prevents optimizing out the benchmarked calls. */
+static volatile uint64_t sink;
+
+static uint64_t rand_state = 0x2545f4914f6cdd1dULL;
+
+static uint32_t rand_next(void)
+{
+	rand_state ^= rand_state << 13;
+	rand_state ^= rand_state >> 7;
+	rand_state ^= rand_state << 17;
+	return rand_state >> 32;
+}
+
+/*! \brief Random second-level name under a TLD with a skewed popularity. */
+static char *random_name(void)
+{
+	static const struct {
+		const char *tld;
+		unsigned weight;
+	} tlds[] = {
+		{ "com", 50 }, { "net", 10 }, { "org", 8 }, { "de", 8 },
+		{ "cz", 6 }, { "co.uk", 6 }, { "info", 4 }, { "eu", 4 },
+		{ "io", 2 }, { "xn--p1ai", 2 }
+	};
+
+	unsigned pick = rand_next() % 100;
+	const char *tld = tlds[0].tld;
+	for (size_t i = 0; i < sizeof(tlds) / sizeof(tlds[0]); i++) {
+		if (pick < tlds[i].weight) {
+			tld = tlds[i].tld;
+			break;
+		}
+		pick -= tlds[i].weight;
+	}
+
+	static const char alphabet[] = "abcdefghijklmnopqrstuvwxyz0123456789-";
+	char label[64];
+	size_t len = 3 + rand_next() % 6 + rand_next() % 6 + rand_next() % 4;
+	for (size_t i = 0; i < len; i++) {
+		size_t max = (i == 0 || i == len - 1) ? 36 : 37; // No leading/trailing hyphen.
+		label[i] = alphabet[rand_next() % max];
+	}
+	label[len] = '\0';
+
+	/* Some names with a www or mail prefix. */
+	switch (rand_next() % 8) {
+	case 0:  return sprintf_alloc("www.%s.%s.", label, tld);
+	case 1:  return sprintf_alloc("mail.%s.%s.", label, tld);
+	default: return sprintf_alloc("%s.%s.", label, tld);
+	}
+}
+
+static int put_opt(knot_pkt_t *pkt, bool dnssec, bool ecs)
+{
+	knot_rrset_t opt;
+	int ret = knot_edns_init(&opt, 1232, 0, 0, NULL);
+	if (ret != KNOT_EOK) {
+		return ret;
+	}
+	if (dnssec) {
+		knot_edns_set_do(&opt);
+	}
+	if (ecs) {
+		knot_edns_client_subnet_t subnet = {
+			.family = 1, .source_len = 24, .address = { 198, 51, 100 }
+		};
+		uint16_t size = knot_edns_client_subnet_size(&subnet);
+		uint8_t *wire = NULL;
+		ret = knot_edns_reserve_option(&opt, KNOT_EDNS_OPTION_CLIENT_SUBNET,
+		                               size, &wire, NULL);
+		if (ret == KNOT_EOK) {
+			ret = knot_edns_client_subnet_write(wire, size, &subnet);
+		}
+	}
+	if (ret == KNOT_EOK) {
+		knot_pkt_begin(pkt, KNOT_ADDITIONAL);
+		ret = knot_pkt_put(pkt, KNOT_COMPR_HINT_NONE, &opt, 0);
+	}
+	knot_rrset_clear(&opt, NULL);
+
+	return ret;
+}
+
+static int put_rrset(knot_pkt_t *pkt, uint16_t compr_hint, const knot_dname_t *owner,
+                     uint16_t type, const uint8_t *rdata, const uint16_t *lens,
+                     size_t count)
+{
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, (knot_dname_t *)owner, type, KNOT_CLASS_IN, 3600);
+	for (size_t i = 0; i < count; i++) {
+		int ret = knot_rrset_add_rdata(&rr, rdata, lens[i], NULL);
+		if (ret != KNOT_EOK) {
+			knot_rdataset_clear(&rr.rrs, NULL);
+			return ret;
+		}
+		rdata += lens[i];
+	}
+	int ret = knot_pkt_put(pkt, compr_hint, &rr, 0);
+	knot_rdataset_clear(&rr.rrs, NULL);
+
+	return ret;
+}
+
+/*! \brief Build a typical referral-like response with glue. */
+static int build_response(bench_data_t *data)
+{
+	knot_pkt_t *pkt = knot_pkt_new(data->response, sizeof(data->response), NULL);
+	if (pkt == NULL) {
+		return KNOT_ENOMEM;
+	}
+	knot_pkt_clear(pkt);
+
+	const knot_dname_t *qname = (const knot_dname_t *)"\x03""www""\x07""example""\x03""com";
+	const knot_dname_t *zone = qname + 4;
+	static const uint8_t a_rdata[] = { 192, 0, 2, 1, 192, 0, 2, 2 };
+	static const uint16_t a_lens[] = { 4, 4 };
+	static const uint8_t ns_rdata[] = { 3, 'n', 's', '1', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0,
+	                                    3, 'n', 's', '2', 7, 'e', 'x', 'a', 'm', 'p', 'l', 'e', 3, 'c', 'o', 'm', 0 };
+	static const uint16_t ns_lens[] = { 17, 17 };
+
+	knot_wire_set_qr(pkt->wire);
+	knot_wire_set_aa(pkt->wire);
+	int ret = knot_pkt_put_question(pkt, qname, KNOT_CLASS_IN, KNOT_RRTYPE_A);
+	if (ret == KNOT_EOK) {
+		knot_pkt_begin(pkt, KNOT_ANSWER);
+		ret = put_rrset(pkt, KNOT_COMPR_HINT_QNAME, qname, KNOT_RRTYPE_A,
+		                a_rdata, a_lens, 2);
+	}
+	if (ret == KNOT_EOK) {
+		knot_pkt_begin(pkt, KNOT_AUTHORITY);
+		ret = put_rrset(pkt, KNOT_COMPR_HINT_NONE, zone, KNOT_RRTYPE_NS,
+		                ns_rdata, ns_lens, 2);
+	}
+	if (ret == KNOT_EOK) {
+		knot_pkt_begin(pkt, KNOT_ADDITIONAL);
+		ret = put_rrset(pkt, KNOT_COMPR_HINT_NONE, ns_rdata, KNOT_RRTYPE_A,
+		                a_rdata, a_lens, 1);
+	}
+	if (ret == KNOT_EOK) {
+		ret = put_rrset(pkt, KNOT_COMPR_HINT_NONE, ns_rdata + 17, KNOT_RRTYPE_A,
+		                a_rdata + 4, a_lens, 1);
+	}
+	if (ret == KNOT_EOK) {
+		ret = put_opt(pkt, true, false);
+	}
+	data->response_len = pkt->size;
+	knot_pkt_free(pkt);
+
+	/* Standalone NS RRSet for the wire conversions. */
+	if (ret == KNOT_EOK) {
+		knot_rrset_init(&data->ns_rrset, (knot_dname_t *)zone, KNOT_RRTYPE_NS,
+		                KNOT_CLASS_IN, 3600);
+		ret = knot_rrset_add_rdata(&data->ns_rrset, ns_rdata, ns_lens[0], NULL);
+	}
+	if (ret == KNOT_EOK) {
+		ret = knot_rrset_add_rdata(&data->ns_rrset, ns_rdata + 17, ns_lens[1], NULL);
+	}
+	if (ret == KNOT_EOK) {
+		ret = knot_rrset_to_wire(&data->ns_rrset, data->ns_wire,
+		                         sizeof(data->ns_wire), NULL);
+		if (ret > 0) {
+			data->ns_wire_len = ret;
+			ret = KNOT_EOK;
+		}
+	}
+
+	return ret;
+}
+
+static int build_queries(bench_data_t *data)
+{
+	data->queries = calloc(data->count, sizeof(*data->queries));
+	data->query_len = calloc(data->count, sizeof(*data->query_len));
+	if (data->queries == NULL || data->query_len == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	uint8_t wire[512];
+	for (size_t i = 0; i < data->count; i++) {
+		knot_pkt_t *pkt = knot_pkt_new(wire, sizeof(wire), NULL);
+		if (pkt == NULL) {
+			return KNOT_ENOMEM;
+		}
+		knot_pkt_clear(pkt);
+		knot_wire_set_id(pkt->wire, i);
+		knot_wire_set_rd(pkt->wire);
+		uint16_t type = (i % 4 == 3) ? KNOT_RRTYPE_AAAA : KNOT_RRTYPE_A;
+		int ret = knot_pkt_put_question(pkt, data->names[i], KNOT_CLASS_IN, type);
+		if (ret == KNOT_EOK && i % 10 != 0) { // Most queries have EDNS.
+			ret = put_opt(pkt, i % 2 == 0, i % 16 == 1);
+		}
+		if (ret == KNOT_EOK) {
+			data->queries[i] = malloc(pkt->size);
+			if (data->queries[i] == NULL) {
+				ret = KNOT_ENOMEM;
+			} else {
+				memcpy(data->queries[i], pkt->wire, pkt->size);
+				data->query_len[i] = pkt->size;
+			}
+		}
+		knot_pkt_free(pkt);
+		if (ret != KNOT_EOK) {
+			return ret;
+		}
+	}
+
+	return KNOT_EOK;
+}
+
+static int build_conf(bench_data_t *data)
+{
+	size_t max = 64 + data->count * (KNOT_DNAME_TXT_MAXLEN + 64);
+	data->conf = malloc(max);
+	if (data->conf == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	size_t len = snprintf(data->conf, max, "zone:\n");
+	for (size_t i = 0; i < data->count; i++) {
+		len += snprintf(data->conf + len, max - len,
+		                "  - domain: %s\n"
+		                "    master: primary\n"
+		                "    acl: [ notify, transfer ]\n",
+		                data->names_str[i]);
+	}
+
+	return KNOT_EOK;
+}
+
+static int build_tsig(bench_data_t *data)
+{
+	int ret = knot_tsig_key_init(&data->tsig_key, "hmac-sha256", "key.example.",
+	                             "Wg6WATxhjlbbIzHDB3O6RzmSj1YgyjOGBd/2+2SQNw8=");
+	for (size_t i = 0; ret == KNOT_EOK && i < TSIG_OPS; i++) {
+		size_t idx = i % data->count;
+		size_t len = MIN(data->query_len[idx], sizeof(data->tsig_query[i]) - 128);
+		memcpy(data->tsig_query[i], data->queries[idx], len);
+		data->tsig_query_len[i] = len;
+	}
+
+	return ret;
+}
+
+static int data_init(bench_data_t *data, size_t count)
+{
+	memset(data, 0, sizeof(*data));
+	data->count = count;
+
+	data->names_str = calloc(count, sizeof(*data->names_str));
+	data->names = calloc(count, sizeof(*data->names));
+	data->trie = trie_create(NULL);
+	if (data->names_str == NULL || data->names == NULL || data->trie == NULL) {
+		return KNOT_ENOMEM;
+	}
+
+	for (size_t i = 0; i < count; i++) {
+		data->names_str[i] = random_name();
+		if (data->names_str[i] == NULL) {
+			return KNOT_ENOMEM;
+		}
+		data->names[i] = knot_dname_from_str_alloc(data->names_str[i]);
+		if (data->names[i] == NULL) {
+			return KNOT_EINVAL;
+		}
+
+		knot_dname_storage_t lf_storage;
+		uint8_t *lf = knot_dname_lf(data->names[i], lf_storage);
+		if (trie_get_ins(data->trie, lf + 1, *lf) == NULL) {
+			return KNOT_ENOMEM;
+		}
+	}
+
+	for (unsigned i = 0; i < RDATASET_SIZE; i++) {
+		uint8_t addr[4] = { 192, 0, 2, rand_next() };
+		knot_rdata_init((knot_rdata_t *)data->a_rdata[i], sizeof(addr), addr);
+	}
+
+	int ret = build_queries(data);
+	if (ret == KNOT_EOK) {
+		ret = build_response(data);
+	}
+	if (ret == KNOT_EOK) {
+		ret = build_conf(data);
+	}
+	if (ret == KNOT_EOK) {
+		ret = build_tsig(data);
+	}
+
+	return ret;
+}
+
+static void data_deinit(bench_data_t *data)
+{
+	for (size_t i = 0; i < data->count; i++) {
+		if (data->names_str != NULL) {
+			free(data->names_str[i]);
+		}
+		if (data->names != NULL) {
+			knot_dname_free(data->names[i], NULL);
+		}
+		if (data->queries != NULL) {
+			free(data->queries[i]);
+		}
+	}
+	free(data->names_str);
+	free(data->names);
+	free(data->queries);
+	free(data->query_len);
+	knot_rdataset_clear(&data->ns_rrset.rrs, NULL);
+	trie_free(data->trie);
+	free(data->conf);
+	knot_tsig_key_deinit(&data->tsig_key);
+}
+
+static size_t bench_dname_from_str(bench_data_t *data)
+{
+	knot_dname_storage_t name;
+	for (size_t i = 0; i < data->count; i++) {
+		sink += (knot_dname_from_str(name, data->names_str[i], sizeof(name)) != NULL);
+	}
+	return data->count;
+}
+
+static size_t bench_dname_to_str(bench_data_t *data)
+{
+	knot_dname_txt_storage_t str;
+	for (size_t i = 0; i < data->count; i++) {
+		sink += (knot_dname_to_str(str, data->names[i], sizeof(str)) != NULL);
+	}
+	return data->count;
+}
+
+static size_t bench_dname_to_lower(bench_data_t *data)
+{
+	for (size_t i = 0; i < data->count; i++) {
+		knot_dname_to_lower(data->names[i]);
+	}
+	return data->count;
+}
+
+static size_t bench_dname_cmp(bench_data_t *data)
+{
+	for (size_t i = 1; i < data->count; i++) {
+		sink += knot_dname_cmp(data->names[i - 1], data->names[i]);
+	}
+	return data->count - 1;
+}
+
+static size_t bench_dname_lf(bench_data_t *data)
+{
+	knot_dname_storage_t storage;
+	for (size_t i = 0; i < data->count; i++) {
+		sink += *knot_dname_lf(data->names[i], storage);
+	}
+	return data->count;
+}
+
+static size_t bench_pkt_parse_query(bench_data_t *data)
+{
+	uint8_t wire[512];
+	for (size_t i = 0; i < data->count; i++) {
+		memcpy(wire, data->queries[i], data->query_len[i]);
+		knot_pkt_t *pkt = knot_pkt_new(wire, data->query_len[i], NULL);
+		sink += knot_pkt_parse(pkt, 0);
+		knot_pkt_free(pkt);
+	}
+	return data->count;
+}
+
+static size_t bench_pkt_parse_response(bench_data_t *data)
+{
+	uint8_t wire[KNOT_WIRE_MAX_PKTSIZE];
+	for (size_t i = 0; i < data->count; i++) {
+		memcpy(wire, data->response, data->response_len);
+		knot_pkt_t *pkt = knot_pkt_new(wire, data->response_len, NULL);
+		sink += knot_pkt_parse(pkt, 0);
+		knot_pkt_free(pkt);
+	}
+	return data->count;
+}
+
+static size_t bench_pkt_put_response(bench_data_t *data)
+{
+	uint8_t wire[KNOT_WIRE_MAX_PKTSIZE];
+	knot_pkt_t *pkt = knot_pkt_new(wire, sizeof(wire), NULL);
+	for (size_t i = 0; i < data->count; i++) {
+		knot_pkt_clear(pkt);
+		(void)knot_pkt_put_question(pkt, data->names[i], KNOT_CLASS_IN,
+		                            KNOT_RRTYPE_A);
+		knot_pkt_begin(pkt, KNOT_AUTHORITY);
+		sink += knot_pkt_put(pkt, KNOT_COMPR_HINT_NONE, &data->ns_rrset, 0);
+	}
+	knot_pkt_free(pkt);
+	return data->count;
+}
+
+static size_t bench_rrset_to_wire(bench_data_t *data)
+{
+	uint8_t wire[512];
+	for (size_t i = 0; i < data->count; i++) {
+		sink += knot_rrset_to_wire(&data->ns_rrset, wire, sizeof(wire), NULL);
+	}
+	return data->count;
+}
+
+static size_t bench_rrset_rr_from_wire(bench_data_t *data)
+{
+	for (size_t i = 0; i < data->count; i++) {
+		size_t pos = 0;
+		knot_rrset_t rr;
+		sink += knot_rrset_rr_from_wire(data->ns_wire, &pos, data->ns_wire_len,
+		                                &rr, NULL, true);
+		knot_rrset_clear(&rr, NULL);
+	}
+	return data->count;
+}
+
+static size_t bench_rdataset_add(bench_data_t *data)
+{
+	size_t sets = data->count / RDATASET_SIZE;
+	for (size_t i = 0; i < sets; i++) {
+		knot_rdataset_t rrs;
+		knot_rdataset_init(&rrs);
+		for (unsigned j = 0; j < RDATASET_SIZE; j++) {
+			sink += knot_rdataset_add(&rrs, (knot_rdata_t *)data->a_rdata[j], NULL);
+		}
+		knot_rdataset_clear(&rrs, NULL);
+	}
+	return sets * RDATASET_SIZE;
+}
+
+static size_t bench_rdataset_member(bench_data_t *data)
+{
+	knot_rdataset_t rrs;
+	knot_rdataset_init(&rrs);
+	for (unsigned j = 0; j < RDATASET_SIZE; j++) {
+		(void)knot_rdataset_add(&rrs, (knot_rdata_t *)data->a_rdata[j], NULL);
+	}
+	for (size_t i = 0; i < data->count; i++) {
+		sink += knot_rdataset_member(&rrs, (knot_rdata_t *)data->a_rdata[i % RDATASET_SIZE]);
+	}
+	knot_rdataset_clear(&rrs, NULL);
+	return data->count;
+}
+
+static size_t bench_trie_insert(bench_data_t *data)
+{
+	trie_t *trie = trie_create(NULL);
+	knot_dname_storage_t storage;
+	for (size_t i = 0; i < data->count; i++) {
+		uint8_t *lf = knot_dname_lf(data->names[i], storage);
+		sink += (trie_get_ins(trie, lf + 1, *lf) != NULL);
+	}
+	trie_free(trie);
+	return data->count;
+}
+
+static size_t bench_trie_get_try(bench_data_t *data)
+{
+	knot_dname_storage_t storage;
+	for (size_t i = 0; i < data->count; i++) {
+		uint8_t *lf = knot_dname_lf(data->names[i], storage);
+		sink += (trie_get_try(data->trie, lf + 1, *lf) != NULL);
+	}
+	return data->count;
+}
+
+static size_t bench_trie_get_leq(bench_data_t *data)
+{
+	knot_dname_storage_t storage;
+	uint8_t key[KNOT_DNAME_MAXLEN + 1];
+	for (size_t i = 0; i < data->count; i++) {
+		/* Look up non-existent names below the existing ones. */
+		uint8_t *lf = knot_dname_lf(data->names[i], storage);
+		memcpy(key, lf + 1, *lf);
+		key[*lf] = '\0';
+		trie_val_t *val = NULL;
+		sink += trie_get_leq(data->trie, key, *lf + 1, &val);
+	}
+	return data->count;
+}
+
+static size_t bench_yp_parse(bench_data_t *data)
+{
+	yp_parser_t parser;
+	yp_init(&parser);
+	size_t items = 0;
+	if (yp_set_input_string(&parser, data->conf, strlen(data->conf)) == KNOT_EOK) {
+		while (yp_parse(&parser) == KNOT_EOK) {
+			items++;
+		}
+	}
+	yp_deinit(&parser);
+	return items;
+}
+
+static size_t bench_edns_put(bench_data_t *data)
+{
+	uint8_t wire[512];
+	knot_pkt_t *pkt = knot_pkt_new(wire, sizeof(wire), NULL);
+	for (size_t i = 0; i < data->count; i++) {
+		knot_pkt_clear(pkt);
+		sink += put_opt(pkt, true, true);
+	}
+	knot_pkt_free(pkt);
+	return data->count;
+}
+
+static size_t bench_ecs_parse(bench_data_t *data)
+{
+	knot_edns_client_subnet_t ecs = {
+		.family = 2, .source_len = 56,
+		.address = { 0x20, 0x01, 0x0d, 0xb8, 0x12, 0x34, 0x56 }
+	};
+	uint8_t wire[32];
+	uint16_t size = knot_edns_client_subnet_size(&ecs);
+	(void)knot_edns_client_subnet_write(wire, sizeof(wire), &ecs);
+
+	for (size_t i = 0; i < data->count; i++) {
+		knot_edns_client_subnet_t out;
+		sink += knot_edns_client_subnet_parse(&out, wire, size);
+	}
+	return data->count;
+}
+
+static size_t bench_tsig_sign(bench_data_t *data)
+{
+	uint8_t wire[256];
+	uint8_t digest[64];
+	for (size_t i = 0; i < TSIG_OPS; i++) {
+		size_t len = data->tsig_query_len[i];
+		size_t digest_len = sizeof(digest);
+		memcpy(wire, data->tsig_query[i], len);
+		sink += knot_tsig_sign(wire, &len, sizeof(wire), NULL, 0, digest,
+		                       &digest_len, &data->tsig_key, 0, 0);
+	}
+	return TSIG_OPS;
+}
+
+static size_t bench_tsig_verify(bench_data_t *data)
+{
+	static uint8_t signed_wire[TSIG_OPS][256];
+	static size_t signed_len[TSIG_OPS];
+	static bool ready = false;
+
+	if (!ready) {
+		for (size_t i = 0; i < TSIG_OPS; i++) {
+			uint8_t digest[64];
+			size_t digest_len = sizeof(digest);
+			signed_len[i] = data->tsig_query_len[i];
+			memcpy(signed_wire[i], data->tsig_query[i], signed_len[i]);
+			(void)knot_tsig_sign(signed_wire[i], &signed_len[i], sizeof(signed_wire[i]),
+			                     NULL, 0, digest, &digest_len, &data->tsig_key, 0, 0);
+		}
+		ready = true;
+	}
+
+	for (size_t i = 0; i < TSIG_OPS; i++) {
+		knot_pkt_t *pkt = knot_pkt_new(signed_wire[i], signed_len[i], NULL);
+		if (knot_pkt_parse(pkt, 0) == KNOT_EOK && pkt->tsig_rr != NULL) {
+			sink += knot_tsig_server_check(pkt->tsig_rr, pkt->wire, pkt->size,
+			                               &data->tsig_key);
+		}
+		knot_pkt_free(pkt);
+	}
+	return TSIG_OPS;
+}
+
+static const bench_case_t cases[] = {
+	{ "dname_from_str",      bench_dname_from_str },
+	{ "dname_to_str",        bench_dname_to_str },
+	{ "dname_to_lower",      bench_dname_to_lower },
+	{ "dname_cmp",           bench_dname_cmp },
+	{ "dname_lf",            bench_dname_lf },
+	{ "pkt_parse_query",     bench_pkt_parse_query },
+	{ "pkt_parse_response",  bench_pkt_parse_response },
+	{ "pkt_put_response",    bench_pkt_put_response },
+	{ "rrset_to_wire",       bench_rrset_to_wire },
+	{ "rrset_rr_from_wire",  bench_rrset_rr_from_wire },
+	{ "rdataset_add",        bench_rdataset_add },
+	{ "rdataset_member",     bench_rdataset_member },
+	{ "trie_insert",         bench_trie_insert },
+	{ "trie_get_try",        bench_trie_get_try },
+	{ "trie_get_leq",        bench_trie_get_leq },
+	{ "yp_parse",            bench_yp_parse },
+	{ "edns_put",            bench_edns_put },
+	{ "ecs_parse",           bench_ecs_parse },
+	{ "tsig_sign",           bench_tsig_sign },
+	{ "tsig_verify",         bench_tsig_verify },
+	{ NULL }
+};
+
+static void run_case(const bench_case_t *bench, bench_data_t *data, unsigned rounds)
+{
+	uint64_t *costs = calloc(rounds, sizeof(*costs));
+	if (costs == NULL) {
+		return;
+	}
+
+	(void)bench->run(data); // Warm-up.
+
+	size_t ops = 0;
+	for (unsigned i = 0; i < rounds; i++) {
+		uint64_t start = bench_cycles();
+		ops = bench->run(data);
+		uint64_t end = bench_cycles();
+		/* Store in hundredths to keep the precision. */
+		costs[i] = (end - start) * 100 / (ops > 0 ? ops : 1);
+	}
+
+	bench_sort(costs, rounds);
+	printf("%-20s %10.2f %-6s  (min %.2f, %zu ops)\n", bench->name,
+	       bench_percentile(costs, rounds, 50) / 100.0, BENCH_CYCLES_UNIT,
+	       costs[0] / 100.0, ops);
+
+	free(costs);
+}
+
+static void print_help(void)
+{
+	printf("Usage: %s [options] [case...]\n"
+	       "\n"
+	       "Runs microbenchmarks of libknot primitives, all cases by default.\n"
+	       "\n"
+	       "Options:\n"
+	       " -n, --names <num>   Size of the name set (default %u).\n"
+	       " -r, --rounds <num>  Number of measured rounds (default %u).\n"
+	       " -l, --list          List the benchmark cases.\n"
+	       " -h, --help          Print the program help.\n",
+	       PROGRAM_NAME, DEFAULT_NAMES, DEFAULT_ROUNDS);
+}
+
+int main(int argc, char *argv[])
+{
+	struct option opts[] = {
+		{ "names",  required_argument, NULL, 'n' },
+		{ "rounds", required_argument, NULL, 'r' },
+		{ "list",   no_argument,       NULL, 'l' },
+		{ "help",   no_argument,       NULL, 'h' },
+		{ NULL }
+	};
+
+	size_t names = DEFAULT_NAMES;
+	unsigned rounds = DEFAULT_ROUNDS;
+
+	int opt;
+	while ((opt = getopt_long(argc, argv, "n:r:lh", opts, NULL)) != -1) {
+		switch (opt) {
+		case 'n':
+			names = strtoull(optarg, NULL, 10);
+			break;
+		case 'r':
+			rounds = strtoul(optarg, NULL, 10);
+			break;
+		case 'l':
+			for (const bench_case_t *bench = cases; bench->name != NULL; bench++) {
+				printf("%s\n", bench->name);
+			}
+			return EXIT_SUCCESS;
+		case 'h':
+			print_help();
+			return EXIT_SUCCESS;
+		default:
+			print_help();
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (names < 2 || rounds == 0) {
+		print_help();
+		return EXIT_FAILURE;
+	}
+
+	bench_data_t *data = malloc(sizeof(*data));
+	int ret = (data != NULL) ? data_init(data, names) : KNOT_ENOMEM;
+	if (ret != KNOT_EOK) {
+		fprintf(stderr, "failed to prepare data (%s)\n", knot_strerror(ret));
+		if (data != NULL) {
+			data_deinit(data);
+			free(data);
+		}
+		return EXIT_FAILURE;
+	}
+
+	printf("names: %zu, rounds: %u, median cost per operation:\n", names, rounds);
+
+	for (const bench_case_t *bench = cases; bench->name != NULL; bench++) {
+		bool selected = (optind == argc);
+		for (int i = optind; i < argc && !selected; i++) {
+			selected = (strcmp(argv[i], bench->name) == 0);
+		}
+		if (selected) {
+			run_case(bench, data, rounds);
+		}
+	}
+
+	data_deinit(data);
+	free(data);
+
+	return EXIT_SUCCESS;
+}
@@ -46,6 +46,24 @@ static char *str_key_rand(size_t len)
 	return s;
 }
 
+/* Check ordering of values visited across split trie parts. */
+typedef struct {
+	const char *prev;
+	size_t count;
+	bool sorted;
+} split_ctx_t;
+
+static int split_apply_cb(trie_val_t *val, void *d)
+{
+	split_ctx_t *ctx = d;
+	if (ctx->prev != NULL && strcmp(ctx->prev, *val) > 0) {
+		ctx->sorted = false;
+	}
+	ctx->prev = *val;
+	ctx->count++;
+	return KNOT_EOK;
+}
+
 /* Check lesser or equal result. */
 static bool str_key_get_leq(trie_t *trie, char **keys, size_t i, size_t size)
 {
@@ -270,6 +288,16 @@ int main(int argc, char *argv[])
 	is_int(inserted, iterated, "trie: sorted iteration");
 	trie_it_free(it);
 
+	/* Split iteration. */
+	trie_part_t parts[64];
+	size_t part_count = trie_split(trie, parts, sizeof(parts) / sizeof(*parts));
+	split_ctx_t split = { .sorted = true };
+	for (size_t i = 0; i < part_count; ++i) {
+		(void)trie_part_apply(parts[i], split_apply_cb, &split);
+	}
+	ok(part_count > 1 && part_count <= 64 && split.sorted && split.count == inserted,
+	   "trie: split iteration");
+
 	/* Cleanup */
 	for (unsigned i = 0; i < key_count; ++i) {
 		free(keys[i]);
@@ -15,6 +15,7 @@
  */
 
 #include <assert.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/socket.h>
 #include <tap/basic.h>
@@ -163,6 +164,10 @@ static void test_acl_allowed(void)
 	check_sockaddr_set(&addr, AF_INET6, "2001::1", 0);
 	ret = acl_allowed(conf(), &acl, ACL_ACTION_NONE, &addr, &key1, zone_name, NULL);
 	ok(ret == true, "Address, key, empty action");
+	ok(key1.secret.size == 3 && memcmp(key1.secret.data, "foo", 3) == 0,
+	   "Key secret filled");
+	acl_compiled_t *compiled = conf()->acl;
+	ok(compiled != NULL, "ACL compiled on first use");
 
 	acl = conf_zone_get(conf(), C_ACL, zone_name);
 	ok(acl.code == KNOT_EOK, "Get zone ACL");
@@ -295,6 +300,8 @@ static void test_acl_allowed(void)
 	knot_dname_free(aa_key2_name, NULL);
 	knot_rdataset_clear(&aaA.rrs, NULL);
 
+	ok(conf()->acl == compiled, "Compiled ACL reused");
+
 	conf_free(conf());
 	knot_dname_free(zone_name, NULL);
 	knot_dname_free(zone2_name, NULL);
@@ -0,0 +1,143 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <fcntl.h>
+#include <signal.h>
+#include <tap/basic.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "contrib/sockaddr.h"
+#include "knot/query/conn_pool.h"
+#include "libknot/errcode.h"
+
+static void interrupt_handle(int s)
+{
+}
+
+static bool fd_open(int fd)
+{
+	return fcntl(fd, F_GETFD) != -1;
+}
+
+/*! \brief Create a connected socket, the peer is stored into the second item. */
+static int conn(int peer[2])
+{
+	if (socketpair(AF_UNIX, SOCK_STREAM, 0, peer) != 0) {
+		return -1;
+	}
+	int fd = peer[0];
+	peer[0] = peer[1];
+	return fd;
+}
+
+static size_t usage(conn_pool_t *pool)
+{
+	pthread_mutex_lock(&pool->lock);
+	size_t res = pool->usage;
+	pthread_mutex_unlock(&pool->lock);
+	return res;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	/* Register signal handler interrupting the closing thread. */
+	struct sigaction sa;
+	sa.sa_handler = interrupt_handle;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGALRM, &sa, NULL);
+
+	struct sockaddr_storage src = { 0 }, dst1 = { 0 }, dst2 = { 0 };
+	sockaddr_set(&src, AF_INET, "127.0.0.1", 0);
+	sockaddr_set(&dst1, AF_INET, "127.0.0.2", 53);
+	sockaddr_set(&dst2, AF_INET, "127.0.0.3", 53);
+	struct sockaddr_storage any = { .ss_family = AF_UNSPEC };
+
+	conn_pool_t pool;
+	int ret = conn_pool_init(&pool);
+	is_int(KNOT_EOK, ret, "conn_pool: init");
+
+	int peer[2];
+	int fd = conn(peer);
+
+	/* Disabled pool. */
+	conn_pool_put(&pool, &src, &dst1, fd);
+	ok(!fd_open(fd) && conn_pool_get(&pool, &src, &dst1) < 0,
+	   "conn_pool: disabled by default");
+	close(peer[0]);
+
+	ret = conn_pool_set_limits(&pool, 2, 60);
+	is_int(KNOT_EOK, ret, "conn_pool: set limits");
+
+	/* Reuse by source and remote. */
+	fd = conn(peer);
+	conn_pool_put(&pool, &src, &dst1, fd);
+	ok(conn_pool_get(&pool, &src, &dst2) < 0, "conn_pool: other remote");
+	ok(conn_pool_get(&pool, &any, &dst1) < 0, "conn_pool: other source");
+	is_int(fd, conn_pool_get(&pool, &src, &dst1), "conn_pool: reuse");
+	ok(conn_pool_get(&pool, &src, &dst1) < 0, "conn_pool: taken");
+	close(fd);
+	close(peer[0]);
+
+	/* Connection closed by the remote. */
+	fd = conn(peer);
+	conn_pool_put(&pool, &src, &dst1, fd);
+	close(peer[0]);
+	ok(conn_pool_get(&pool, &src, &dst1) < 0 && !fd_open(fd) && pool.usage == 0,
+	   "conn_pool: closed by remote");
+
+	/* Least recently used connection closed if full. */
+	int peers[3], fds[3];
+	for (int i = 0; i < 3; i++) {
+		fds[i] = conn(peer);
+		peers[i] = peer[0];
+		conn_pool_put(&pool, &src, &dst1, fds[i]);
+		if (i < 2) {
+			pool.conns[i].last_active -= 2 - i;
+		}
+	}
+	ok(!fd_open(fds[0]) && fd_open(fds[1]) && fd_open(fds[2]) && pool.usage == 2,
+	   "conn_pool: evict least recently used");
+
+	/* Shrinking closes the rest. */
+	ret = conn_pool_set_limits(&pool, 1, 1);
+	ok(ret == KNOT_EOK && !fd_open(fds[1]) && fd_open(fds[2]) && pool.usage == 1,
+	   "conn_pool: shrink");
+
+	/* Idle timeout. */
+	conn_pool_start(&pool);
+	for (int i = 0; i < 30 && usage(&pool) > 0; i++) {
+		usleep(100 * 1000);
+	}
+	ok(usage(&pool) == 0 && !fd_open(fds[2]), "conn_pool: idle timeout");
+	for (int i = 0; i < 3; i++) {
+		close(peers[i]);
+	}
+
+	/* Pending connections closed upon deinit. */
+	fd = conn(peer);
+	conn_pool_put(&pool, &src, &dst2, fd);
+	conn_pool_stop(&pool);
+	conn_pool_join(&pool);
+	conn_pool_deinit(&pool);
+	ok(!fd_open(fd), "conn_pool: deinit");
+	close(peer[0]);
+
+	return 0;
+}
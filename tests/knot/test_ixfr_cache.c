@@ -0,0 +1,147 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <tap/basic.h>
+
+#include "knot/nameserver/ixfr_cache.h"
+#include "knot/server/server.h"
+#include "knot/zone/zone.h"
+#include "libknot/libknot.h"
+
+#define ROOM	KNOT_WIRE_MAX_PKTSIZE
+
+static ixfr_cache_entry_t *capture(ixfr_cache_t *cache, zone_t *zone,
+                                   uint32_t serial_from, unsigned msgs)
+{
+	static const uint8_t wire[] = { 0xc0, 0x0c, 0x00, 0x06, 0x00, 0x01 };
+
+	ixfr_cache_entry_t *entry = ixfr_cache_entry_new(cache, zone->name,
+	                                                 serial_from, zone->contents);
+	for (unsigned i = 0; entry != NULL && i < msgs; i++) {
+		if (ixfr_cache_entry_append(entry, wire, sizeof(wire), i + 1) != KNOT_EOK) {
+			ixfr_cache_entry_free(entry);
+			return NULL;
+		}
+	}
+
+	return entry;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	ixfr_cache_t cache;
+	int ret = ixfr_cache_init(&cache);
+	is_int(KNOT_EOK, ret, "ixfr_cache: init");
+
+	knot_dname_t *name = knot_dname_from_str_alloc("example.com.");
+	zone_t *zone = zone_new(name);
+	zone->contents = zone_contents_new(name, false);
+	ok(zone->contents != NULL, "ixfr_cache: create zone");
+
+	/* Disabled cache. */
+	ok(capture(&cache, zone, 1, 1) == NULL, "ixfr_cache: disabled by default");
+
+	ixfr_cache_set_max_size(&cache, 1024 * 1024);
+
+	/* Insert and lookup. */
+	ixfr_cache_entry_t *entry = capture(&cache, zone, 1, 3);
+	ok(entry != NULL && entry->msg_count == 3, "ixfr_cache: capture");
+	ret = ixfr_cache_insert(&cache, entry, zone);
+	is_int(KNOT_EOK, ret, "ixfr_cache: insert");
+
+	ixfr_cache_entry_t *found = ixfr_cache_get(&cache, zone->name, 1, zone->contents, ROOM);
+	ok(found == entry && found->msgs[2].ancount == 3, "ixfr_cache: get");
+	ok(ixfr_cache_get(&cache, zone->name, 2, zone->contents, ROOM) == NULL,
+	   "ixfr_cache: get other serial");
+	ok(ixfr_cache_get(&cache, zone->name, 1, NULL, ROOM) == NULL,
+	   "ixfr_cache: get other contents");
+	ok(ixfr_cache_get(&cache, zone->name, 1, zone->contents, 5) == NULL,
+	   "ixfr_cache: get with less room");
+
+	ixfr_cache_entry_t *dup = capture(&cache, zone, 1, 1);
+	ret = ixfr_cache_insert(&cache, dup, zone);
+	is_int(KNOT_EEXIST, ret, "ixfr_cache: insert duplicate");
+	ixfr_cache_entry_free(dup);
+
+	/* Invalidation while in use. */
+	ixfr_cache_invalidate(&cache, zone->name);
+	ok(ixfr_cache_get(&cache, zone->name, 1, zone->contents, ROOM) == NULL,
+	   "ixfr_cache: invalidate");
+	ok(found->unlinked && found->msgs[0].size == 6, "ixfr_cache: used entry kept");
+	ixfr_cache_release(&cache, found);
+	is_int(0, cache.size, "ixfr_cache: empty after invalidate");
+
+	/* Contents changed during the transfer. */
+	entry = capture(&cache, zone, 1, 1);
+	zone_contents_t *contents = zone->contents;
+	zone->contents = NULL;
+	ret = ixfr_cache_insert(&cache, entry, zone);
+	is_int(KNOT_EAGAIN, ret, "ixfr_cache: insert stale");
+	ixfr_cache_entry_free(entry);
+	zone->contents = contents;
+
+	/* Size limits. */
+	for (uint32_t serial = 10; serial < 20; serial++) {
+		entry = capture(&cache, zone, serial, 4);
+		ret = ixfr_cache_insert(&cache, entry, zone);
+		if (ret != KNOT_EOK) {
+			ixfr_cache_entry_free(entry);
+			break;
+		}
+	}
+	is_int(KNOT_EOK, ret, "ixfr_cache: insert more");
+	size_t entry_size = cache.size / 10;
+	ixfr_cache_set_max_size(&cache, 3 * entry_size);
+	ok(ixfr_cache_get(&cache, zone->name, 16, zone->contents, ROOM) == NULL &&
+	   cache.size <= 3 * entry_size, "ixfr_cache: evict least recently used");
+	found = ixfr_cache_get(&cache, zone->name, 19, zone->contents, ROOM);
+	ok(found != NULL, "ixfr_cache: keep recently used");
+	ixfr_cache_release(&cache, found);
+
+	entry = capture(&cache, zone, 30, 40);
+	ok(entry == NULL, "ixfr_cache: too large capture");
+
+	/* Full-size TCP message. */
+	ixfr_cache_set_max_size(&cache, 1024 * 1024);
+	entry = ixfr_cache_entry_new(&cache, zone->name, 40, zone->contents);
+	uint8_t *large = calloc(1, IXFR_CACHE_MSG_MAX);
+	ret = ixfr_cache_entry_append(entry, large, IXFR_CACHE_MSG_MAX - 100, 1);
+	is_int(KNOT_EOK, ret, "ixfr_cache: full-size message");
+	free(large);
+	ixfr_cache_entry_free(entry);
+
+	ixfr_cache_deinit(&cache);
+	ok(1, "ixfr_cache: deinit");
+
+	/* Zone removed together with its contents. */
+	server_t server = { 0 };
+	ixfr_cache_init(&server.ixfr_cache);
+	ixfr_cache_set_max_size(&server.ixfr_cache, 1024 * 1024);
+	zone->server = &server;
+	entry = capture(&server.ixfr_cache, zone, 1, 1);
+	ret = ixfr_cache_insert(&server.ixfr_cache, entry, zone);
+	is_int(KNOT_EOK, ret, "ixfr_cache: insert before zone removal");
+	zone_free(&zone);
+	is_int(0, server.ixfr_cache.size, "ixfr_cache: empty after zone removal");
+	ixfr_cache_deinit(&server.ixfr_cache);
+
+	knot_dname_free(name, NULL);
+
+	return 0;
+}
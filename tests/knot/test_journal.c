@@ -19,6 +19,7 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <limits.h>
+#include <pthread.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include <tap/basic.h>
@@ -850,6 +851,133 @@ static void test_stress(const knot_dname_t *apex)
 	test_stress_base(apex, 4000, 10 * 1024 * 1024);
 }
 
+#ifdef HAVE_LZ4
+/*! \brief Test storing and loading compressed zone-in-journal. */
+static void test_compression(const knot_dname_t *apex)
+{
+	_unused_ int ret = test_conf("database:\n"
+	                             "  journal-db-compression: lz4\n"
+	                             "template:\n"
+	                             " - id: default\n"
+	                             "   journal-max-usage: 4194304\n", NULL);
+	assert(ret == KNOT_EOK);
+
+	char path[strlen(test_dir_name) + 16];
+	(void)snprintf(path, sizeof(path), "%s/compress", test_dir_name);
+	knot_lmdb_db_t cdb;
+	knot_lmdb_init(&cdb, path, 8 * 1024 * 1024, env_flag, NULL);
+	ret = knot_lmdb_open(&cdb);
+	is_int(KNOT_EOK, ret, "journal: open compressed db (%s)", knot_strerror(ret));
+	zone_journal_t cj = { &cdb, apex, conf() };
+
+	zone_contents_t *z = tm2_zone(apex);
+	ret = journal_insert_zone(cj, z);
+	is_int(KNOT_EOK, ret, "journal: insert compressed zone (%s)", knot_strerror(ret));
+
+	size_t compressed = 0, raw_total = 0;
+	knot_lmdb_txn_t txn = { 0 };
+	knot_lmdb_begin(&cdb, &txn, false);
+	MDB_val prefix = journal_changeset_id_to_key(true, 0, apex);
+	knot_lmdb_foreach(&txn, &prefix) {
+		uint32_t raw_size = 0;
+		if (journal_chunk_flags(&txn.cur_val, &raw_size) & JOURNAL_CHUNK_LZ4) {
+			compressed += txn.cur_val.mv_size - JOURNAL_HEADER_SIZE;
+			raw_total += raw_size;
+		}
+	}
+	free(prefix.mv_data);
+	knot_lmdb_abort(&txn);
+	ok(compressed > 0 && compressed < raw_total,
+	   "journal: zone chunks compressed (%zu -> %zu)", raw_total, compressed);
+
+	list_t l;
+	journal_read_t *read = NULL;
+	ret = load_j_list(&cj, true, 0, &read, &l);
+	changeset_t fake = { .add = z };
+	ok(ret == KNOT_EOK && list_size(&l) == 1 &&
+	   tm_rrcnt(HEAD(l), 1) == tm_rrcnt(&fake, 1),
+	   "journal: read compressed zone (%s)", knot_strerror(ret));
+	changesets_free(&l);
+	journal_read_end(read);
+
+	zone_contents_deep_free(z);
+	tm_rrs_int(NULL, 0);
+	knot_lmdb_deinit(&cdb);
+	unset_conf();
+}
+#endif
+
+#define GROUP_ZONES 8
+#define GROUP_CHANGES 5
+
+typedef struct {
+	zone_journal_t j;
+	changeset_t ch;
+	int ret;
+} group_insert_t;
+
+static void *group_insert(void *arg)
+{
+	group_insert_t *gi = arg;
+	for (uint32_t serial = 0; serial < GROUP_CHANGES && gi->ret == KNOT_EOK; serial++) {
+		changeset_set_soa_serials(&gi->ch, serial, serial + 1, gi->j.zone);
+		gi->ret = journal_insert(gi->j, &gi->ch, NULL);
+	}
+	return NULL;
+}
+
+/*! \brief Test concurrent inserts with grouped commits. */
+static void test_group_commit(void)
+{
+	_unused_ int ret = test_conf("database:\n"
+	                             "  journal-db-mode: grouped\n"
+	                             "  journal-db-group-window: 1\n"
+	                             "template:\n"
+	                             " - id: default\n"
+	                             "   journal-max-usage: 1048576\n", NULL);
+	assert(ret == KNOT_EOK);
+
+	char path[strlen(test_dir_name) + 8];
+	(void)snprintf(path, sizeof(path), "%s/group", test_dir_name);
+	knot_lmdb_db_t gdb;
+	knot_lmdb_init(&gdb, path, 8 * 1024 * 1024, journal_env_flags(JOURNAL_MODE_GROUP, false), NULL);
+	ret = knot_lmdb_open(&gdb);
+	is_int(KNOT_EOK, ret, "journal: open grouped db (%s)", knot_strerror(ret));
+
+	uint8_t apexes[GROUP_ZONES][8];
+	group_insert_t gi[GROUP_ZONES];
+	pthread_t threads[GROUP_ZONES];
+	for (int i = 0; i < GROUP_ZONES; i++) {
+		memcpy(apexes[i], "\5zone0", 7);
+		apexes[i][5] += i;
+		gi[i].j = (zone_journal_t){ &gdb, apexes[i], conf() };
+		gi[i].ret = changeset_init(&gi[i].ch, apexes[i]);
+		init_random_changeset(&gi[i].ch, 0, 1, 40, apexes[i], false);
+	}
+	for (int i = 0; i < GROUP_ZONES; i++) {
+		pthread_create(&threads[i], NULL, group_insert, &gi[i]);
+	}
+	for (int i = 0; i < GROUP_ZONES; i++) {
+		pthread_join(threads[i], NULL);
+	}
+
+	for (int i = 0; i < GROUP_ZONES; i++) {
+		uint32_t first = 1, last = 0;
+		bool exists = false;
+		ret = journal_info(gi[i].j, &exists, &first, NULL, &last, NULL, NULL, NULL, NULL);
+		if (ret == KNOT_EOK) {
+			ret = journal_sem_check(gi[i].j);
+		}
+		ok(gi[i].ret == KNOT_EOK && ret == KNOT_EOK && exists &&
+		   first == 0 && last == GROUP_CHANGES,
+		   "journal: grouped inserts of zone %d (%s)", i, knot_strerror(gi[i].ret));
+		changeset_clear(&gi[i].ch);
+	}
+
+	knot_lmdb_deinit(&gdb);
+	unset_conf();
+}
+
 int main(int argc, char *argv[])
 {
 	plan_lazy();
@@ -871,6 +999,12 @@ int main(int argc, char *argv[])
 
 	test_stress(apex);
 
+#ifdef HAVE_LZ4
+	test_compression(apex);
+#endif
+
+	test_group_commit();
+
 	knot_lmdb_deinit(&jdb);
 
 	test_rm_rf(test_dir_name);
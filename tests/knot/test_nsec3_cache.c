@@ -0,0 +1,91 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <tap/basic.h>
+#include <string.h>
+
+#include "knot/dnssec/zone-nsec.h"
+#include "knot/nameserver/nsec3_cache.h"
+#include "libknot/libknot.h"
+
+static bool owner_ok(nsec3_cache_t *cache, const knot_dname_t *name,
+                     const knot_dname_t *apex, const dnssec_nsec3_params_t *params)
+{
+	knot_dname_storage_t expected, cached;
+	int ret1 = knot_create_nsec3_owner(expected, sizeof(expected), name, apex, params);
+	int ret2 = nsec3_cache_owner(cache, cached, sizeof(cached), name, apex, params);
+
+	return ret1 == KNOT_EOK && ret2 == KNOT_EOK && knot_dname_is_equal(expected, cached);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	const knot_dname_t *apex = (const knot_dname_t *)"\x07""example""\x03""com";
+	const knot_dname_t *name = (const knot_dname_t *)"\x01""x""\x07""example""\x03""com";
+
+	uint8_t salt[] = { 0xab, 0xcd };
+	dnssec_nsec3_params_t params = {
+		.algorithm = DNSSEC_NSEC3_ALGORITHM_SHA1,
+		.iterations = 10,
+		.salt = { .data = salt, .size = sizeof(salt) }
+	};
+
+	nsec3_cache_t cache = { 0 };
+
+	/* Disabled cache. */
+	ok(owner_ok(&cache, name, apex, &params) && cache.misses == 0,
+	   "nsec3_cache: disabled by default");
+	ok(owner_ok(NULL, name, apex, &params), "nsec3_cache: no cache");
+
+	nsec3_cache_set_size(&cache, 100);
+
+	/* Insert and lookup. */
+	ok(owner_ok(&cache, name, apex, &params) && cache.size == 64 &&
+	   cache.misses == 1 && cache.hits == 0, "nsec3_cache: miss");
+	ok(owner_ok(&cache, name, apex, &params) && cache.hits == 1,
+	   "nsec3_cache: hit");
+
+	/* Other parameters. */
+	params.iterations = 0;
+	ok(owner_ok(&cache, name, apex, &params) && cache.misses == 2,
+	   "nsec3_cache: other parameters");
+	salt[0] = 0;
+	ok(owner_ok(&cache, name, apex, &params) && cache.misses == 3,
+	   "nsec3_cache: other salt");
+
+	/* Too long name. */
+	knot_dname_t *long_name = knot_dname_from_str_alloc(
+		"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa."
+		"aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa."
+		"example.com.");
+	ok(owner_ok(&cache, long_name, apex, &params) &&
+	   owner_ok(&cache, long_name, apex, &params) && cache.misses == 3,
+	   "nsec3_cache: long name not cached");
+	knot_dname_free(long_name, NULL);
+
+	/* Disable. */
+	nsec3_cache_set_size(&cache, 0);
+	ok(owner_ok(&cache, name, apex, &params) && cache.size == 0 &&
+	   cache.entries == NULL, "nsec3_cache: disable");
+
+	nsec3_cache_deinit(&cache);
+	ok(1, "nsec3_cache: deinit");
+
+	return 0;
+}
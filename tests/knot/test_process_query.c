@@ -23,6 +23,7 @@
 #include "libknot/descriptor.h"
 #include "libknot/packet/wire.h"
 #include "knot/nameserver/process_query.h"
+#include "knot/server/query_arena.h"
 #include "test_server.h"
 #include "contrib/sockaddr.h"
 #include "contrib/ucw/mempool.h"
@@ -186,6 +187,35 @@ int main(int argc, char *argv[])
 	knot_layer_finish(&proc);
 	ok(proc.state == KNOT_STATE_NOOP, "ns: processing end" );
 
+	/* Query processor with the preallocated query arena. */
+	uint64_t allocs = 0;
+	query_arena_t arena;
+	ret = query_arena_init(&arena, &allocs);
+	is_int(KNOT_EOK, ret, "ns: query arena initialization");
+	knot_layer_t arena_proc;
+	knot_layer_init(&arena_proc, &arena.mm, process_query_layer());
+
+	knot_pkt_clear(query);
+	knot_pkt_put_question(query, ROOT_DNAME, KNOT_CLASS_IN, KNOT_RRTYPE_SOA);
+	uint8_t query_wire[KNOT_WIRE_MAX_PKTSIZE], answer_wire[KNOT_WIRE_MAX_PKTSIZE];
+	memcpy(query_wire, query->wire, query->size);
+	for (int i = 0; i < 2; i++) {
+		query_arena_begin(&arena, &arena_proc, &params);
+		knot_pkt_t *arena_query = query_arena_query(&arena, query_wire, query->size);
+		knot_pkt_t *arena_answer = query_arena_answer(&arena, answer_wire,
+		                                              sizeof(answer_wire));
+		knot_pkt_parse(arena_query, 0);
+		knot_layer_consume(&arena_proc, arena_query);
+		knot_layer_produce(&arena_proc, arena_answer);
+		ok(arena_proc.state == KNOT_STATE_DONE, "ns: answer arena query %i", i);
+		answer_sanity_check(query_wire, arena_answer->wire, arena_answer->size,
+		                    KNOT_RCODE_NOERROR, "IN/arena");
+		knot_layer_finish(&arena_proc);
+		query_arena_flush(&arena);
+	}
+	is_int(0, allocs, "ns: plain query without allocation");
+	query_arena_deinit(&arena);
+
 fatal:
 	/* Cleanup. */
 	mp_delete((struct mempool *)mm.ctx);
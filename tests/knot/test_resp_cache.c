@@ -0,0 +1,87 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <tap/basic.h>
+#include <string.h>
+
+#include "knot/nameserver/resp_cache.h"
+#include "libknot/libknot.h"
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	const knot_dname_t *name = (const knot_dname_t *)"\x07""example""\x03""com";
+	uint8_t wire[100];
+	for (size_t i = 0; i < sizeof(wire); i++) {
+		wire[i] = i;
+	}
+
+	resp_cache_key_t key, key_do;
+	resp_cache_key_init(&key, name, KNOT_RRTYPE_A, RESP_CACHE_FLAG_EDNS, 1232, 1232);
+	resp_cache_key_init(&key_do, name, KNOT_RRTYPE_A,
+	                    RESP_CACHE_FLAG_EDNS | RESP_CACHE_FLAG_DO, 1232, 1232);
+	ok(key.size == key_do.size && key.hash != key_do.hash, "resp_cache: key");
+
+	resp_cache_t cache = { 0 };
+
+	/* Disabled cache. */
+	resp_cache_put(&cache, &key, 1, wire, sizeof(wire));
+	ok(resp_cache_get(&cache, &key, 1) == NULL && cache.size == 0,
+	   "resp_cache: disabled by default");
+
+	resp_cache_set_size(&cache, 4096);
+
+	/* Insert and lookup. */
+	ok(resp_cache_get(&cache, &key, 1) == NULL && cache.misses == 1,
+	   "resp_cache: miss");
+	resp_cache_put(&cache, &key, 1, wire, sizeof(wire));
+	const resp_cache_entry_t *entry = resp_cache_get(&cache, &key, 1);
+	ok(entry != NULL && entry->wire_size == sizeof(wire) &&
+	   memcmp(resp_cache_entry_wire(entry), wire, sizeof(wire)) == 0 &&
+	   cache.hits == 1, "resp_cache: hit");
+	ok(resp_cache_get(&cache, &key_do, 1) == NULL, "resp_cache: other key");
+	ok(resp_cache_get(&cache, &key, 2) == NULL, "resp_cache: other generation");
+
+	/* Replacement. */
+	wire[0] = 0xff;
+	resp_cache_put(&cache, &key, 2, wire, 50);
+	entry = resp_cache_get(&cache, &key, 2);
+	ok(entry != NULL && entry->wire_size == 50 && resp_cache_entry_wire(entry)[0] == 0xff &&
+	   resp_cache_get(&cache, &key, 1) == NULL, "resp_cache: replace");
+
+	/* Memory limit. */
+	uint8_t big[8192] = { 0 };
+	resp_cache_put(&cache, &key_do, 1, big, sizeof(big));
+	ok(resp_cache_get(&cache, &key_do, 1) == NULL && cache.size < 4096,
+	   "resp_cache: too large response");
+
+	/* Resize flushes the cache. */
+	resp_cache_set_size(&cache, 8192);
+	ok(resp_cache_get(&cache, &key, 2) == NULL && cache.size == 0 &&
+	   cache.slot_count == 16, "resp_cache: resize");
+
+	resp_cache_set_size(&cache, 0);
+	resp_cache_put(&cache, &key, 1, wire, sizeof(wire));
+	ok(resp_cache_get(&cache, &key, 1) == NULL && cache.slots == NULL,
+	   "resp_cache: disable");
+
+	resp_cache_deinit(&cache);
+	ok(1, "resp_cache: deinit");
+
+	return 0;
+}
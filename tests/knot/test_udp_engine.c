@@ -0,0 +1,408 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <assert.h>
+#include <tap/basic.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "contrib/net.h"
+#include "contrib/sockaddr.h"
+#include "knot/query/notify-send.h"
+#include "knot/query/soa-check.h"
+#include "libknot/libknot.h"
+
+#define SERIAL	2021
+#define TIMEOUT	100
+
+typedef struct {
+	pthread_mutex_t lock;
+	pthread_cond_t cond;
+	unsigned calls;
+	int ret;
+	uint32_t serial;
+	uint16_t rcode;
+	struct sockaddr_storage remote;
+} result_t;
+
+static pthread_mutex_t ports_lock = PTHREAD_MUTEX_INITIALIZER;
+static unsigned ports_seen; // Number of source port changes seen by the responder.
+
+static void interrupt_handle(int s)
+{
+}
+
+static void set_blocking_mode(int sock)
+{
+	int flags = fcntl(sock, F_GETFL);
+	flags &= ~O_NONBLOCK;
+	fcntl(sock, F_SETFL, flags);
+}
+
+static void put_soa(knot_pkt_t *pkt, const knot_dname_t *owner)
+{
+	uint8_t soa[22] = { 0 };
+	knot_wire_write_u32(soa + 2, SERIAL);
+
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, (knot_dname_t *)owner, KNOT_RRTYPE_SOA, KNOT_CLASS_IN, 3600);
+	knot_rrset_add_rdata(&rr, soa, sizeof(soa), NULL);
+	knot_pkt_put(pkt, 0, &rr, 0);
+	knot_rdataset_clear(&rr.rrs, NULL);
+}
+
+/*!
+ * \brief Answer SOA queries and acknowledge NOTIFYs.
+ *
+ * Truncate "trunc.", refuse "refused.", ignore "drop.", stop on "stop.".
+ */
+static void *responder_thread(void *arg)
+{
+	int fd = *(int *)arg;
+
+	set_blocking_mode(fd);
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	int last_port = -1;
+
+	while (true) {
+		struct sockaddr_storage from;
+		socklen_t from_len = sizeof(from);
+		ssize_t len = recvfrom(fd, buf, sizeof(buf), 0,
+		                       (struct sockaddr *)&from, &from_len);
+		if (len < 0) {
+			break;
+		}
+
+		int port = sockaddr_port(&from);
+		if (port != last_port) {
+			pthread_mutex_lock(&ports_lock);
+			ports_seen++;
+			pthread_mutex_unlock(&ports_lock);
+			last_port = port;
+		}
+
+		knot_pkt_t *query = knot_pkt_new(buf, len, NULL);
+		if (knot_pkt_parse(query, 0) != KNOT_EOK) {
+			knot_pkt_free(query);
+			continue;
+		}
+		knot_dname_txt_storage_t qname;
+		knot_dname_to_str(qname, knot_pkt_qname(query), sizeof(qname));
+
+		uint8_t resp_buf[KNOT_WIRE_MAX_PKTSIZE];
+		knot_pkt_t *resp = knot_pkt_new(resp_buf, sizeof(resp_buf), NULL);
+		knot_pkt_init_response(resp, query);
+		if (strcmp(qname, "refused.") == 0) {
+			knot_wire_set_rcode(resp->wire, KNOT_RCODE_REFUSED);
+		} else if (knot_wire_get_opcode(query->wire) == KNOT_OPCODE_NOTIFY) {
+			if (knot_pkt_section(query, KNOT_ANSWER)->count != 1) {
+				knot_wire_set_rcode(resp->wire, KNOT_RCODE_FORMERR);
+			}
+		} else if (strcmp(qname, "trunc.") == 0) {
+			knot_wire_set_tc(resp->wire);
+		} else {
+			put_soa(resp, knot_pkt_qname(query));
+		}
+
+		if (strcmp(qname, "stop.") == 0) {
+			knot_pkt_free(resp);
+			knot_pkt_free(query);
+			break;
+		} else if (strcmp(qname, "drop.") != 0) {
+			(void)sendto(fd, resp->wire, resp->size, 0,
+			             (struct sockaddr *)&from, from_len);
+		}
+		knot_pkt_free(resp);
+		knot_pkt_free(query);
+	}
+
+	return NULL;
+}
+
+static void result_set(result_t *res, int ret, const struct sockaddr_storage *remote,
+                       uint32_t serial, uint16_t rcode)
+{
+	pthread_mutex_lock(&res->lock);
+	res->calls++;
+	res->ret = ret;
+	res->serial = serial;
+	res->rcode = rcode;
+	res->remote = *remote;
+	pthread_cond_signal(&res->cond);
+	pthread_mutex_unlock(&res->lock);
+}
+
+static void soa_cb(void *ctx, int ret, const struct sockaddr_storage *remote,
+                   uint32_t serial)
+{
+	result_set(ctx, ret, remote, serial, 0);
+}
+
+static void notify_cb(void *ctx, int ret, const struct sockaddr_storage *remote,
+                      uint32_t serial, uint16_t rcode)
+{
+	result_set(ctx, ret, remote, serial, rcode);
+}
+
+static void result_wait(result_t *res)
+{
+	pthread_mutex_lock(&res->lock);
+	while (res->calls == 0) {
+		pthread_cond_wait(&res->cond, &res->lock);
+	}
+	pthread_mutex_unlock(&res->lock);
+}
+
+static void result_init(result_t *res)
+{
+	memset(res, 0, sizeof(*res));
+	pthread_mutex_init(&res->lock, NULL);
+	pthread_cond_init(&res->cond, NULL);
+}
+
+static int submit_soa(udp_engine_t *engine, const char *zone, const udp_target_t *targets,
+                      size_t count, result_t *res)
+{
+	knot_dname_t *name = knot_dname_from_str_alloc(zone);
+	int ret = soa_check_submit(engine, name, targets, count, soa_cb, res);
+	knot_dname_free(name, NULL);
+	return ret;
+}
+
+static int submit_notify(udp_engine_t *engine, const char *zone, uint32_t serial,
+                         const udp_target_t *targets, size_t count, result_t *res)
+{
+	uint8_t soa[22] = { 0 };
+	knot_wire_write_u32(soa + 2, serial);
+
+	knot_dname_t *name = knot_dname_from_str_alloc(zone);
+	knot_rrset_t rr;
+	knot_rrset_init(&rr, name, KNOT_RRTYPE_SOA, KNOT_CLASS_IN, 3600);
+	knot_rrset_add_rdata(&rr, soa, sizeof(soa), NULL);
+
+	int ret = notify_send_submit(engine, name, &rr, targets, count, notify_cb, res);
+
+	knot_rdataset_clear(&rr.rrs, NULL);
+	knot_dname_free(name, NULL);
+	return ret;
+}
+
+static unsigned drain_count(int fd)
+{
+	uint8_t buf[KNOT_WIRE_MAX_PKTSIZE];
+	unsigned count = 0;
+	while (recv(fd, buf, sizeof(buf), MSG_DONTWAIT) > 0) {
+		count++;
+	}
+	return count;
+}
+
+static void test_soa_check(udp_engine_t *engine, const udp_target_t *targets,
+                           const struct sockaddr_storage *server)
+{
+	result_t res;
+
+	/* Successful query. */
+	result_init(&res);
+	int ret = submit_soa(engine, "example.com.", &targets[1], 1, &res);
+	is_int(KNOT_EOK, ret, "soa_check: submit");
+	result_wait(&res);
+	ok(res.ret == KNOT_EOK && res.serial == SERIAL, "soa_check: serial received");
+
+	/* Fallback to the next remote after timeout. */
+	result_init(&res);
+	ret = submit_soa(engine, "example.com.", targets, 2, &res);
+	result_wait(&res);
+	ok(ret == KNOT_EOK && res.ret == KNOT_EOK &&
+	   sockaddr_cmp(&res.remote, server, false) == 0, "soa_check: fallback");
+
+	/* Timeout of the last remote. */
+	result_init(&res);
+	ret = submit_soa(engine, "example.com.", targets, 1, &res);
+	is_int(KNOT_EOK, ret, "soa_check: submit to silent remote");
+	ret = submit_soa(engine, "example.com.", targets, 1, &res);
+	is_int(KNOT_EEXIST, ret, "soa_check: submit duplicate");
+	result_wait(&res);
+	is_int(KNOT_ETIMEOUT, res.ret, "soa_check: timeout");
+
+	/* Truncated answer. */
+	result_init(&res);
+	ret = submit_soa(engine, "trunc.", &targets[1], 1, &res);
+	result_wait(&res);
+	ok(ret == KNOT_EOK && res.ret == KNOT_ENOTSUP, "soa_check: truncated");
+
+	/* Error response. */
+	result_init(&res);
+	ret = submit_soa(engine, "refused.", &targets[1], 1, &res);
+	result_wait(&res);
+	ok(ret == KNOT_EOK && res.ret == KNOT_EDENIED, "soa_check: error response");
+}
+
+static void test_notify_send(udp_engine_t *engine, const udp_target_t *targets,
+                             const struct sockaddr_storage *server, int silent_fd)
+{
+	result_t res;
+
+	/* Acknowledged NOTIFY. */
+	result_init(&res);
+	int ret = submit_notify(engine, "example.com.", 1, &targets[1], 1, &res);
+	is_int(KNOT_EOK, ret, "notify_send: submit");
+	result_wait(&res);
+	ok(res.ret == KNOT_EOK && res.serial == 1, "notify_send: acknowledged");
+
+	/* Error response, no fallback. */
+	result_init(&res);
+	ret = submit_notify(engine, "refused.", 1, &targets[1], 1, &res);
+	result_wait(&res);
+	ok(ret == KNOT_EOK && res.ret == KNOT_EDENIED && res.rcode == KNOT_RCODE_REFUSED,
+	   "notify_send: error response");
+
+	/* Fallback to the next address after retransmissions. */
+	(void)drain_count(silent_fd);
+	result_init(&res);
+	ret = submit_notify(engine, "example.com.", 2, targets, 2, &res);
+	result_wait(&res);
+	ok(ret == KNOT_EOK && res.ret == KNOT_EOK && res.serial == 2 &&
+	   sockaddr_cmp(&res.remote, server, false) == 0, "notify_send: fallback");
+	is_int(3, drain_count(silent_fd), "notify_send: retransmissions");
+
+	/* Newer serial replaces the pending one. */
+	result_init(&res);
+	ret = submit_notify(engine, "example.com.", 3, targets, 1, &res);
+	is_int(KNOT_EOK, ret, "notify_send: submit to silent remote");
+	ret = submit_notify(engine, "example.com.", 4, targets, 1, &res);
+	is_int(KNOT_EOK, ret, "notify_send: submit newer serial");
+	result_wait(&res);
+	usleep(2 * TIMEOUT * 1000);
+	ok(res.calls == 1 && res.ret == KNOT_ETIMEOUT && res.serial == 4,
+	   "notify_send: replaced");
+}
+
+static void test_engine(udp_engine_t *engine, const udp_target_t *targets)
+{
+	result_t res;
+
+	/* Source port changes over time. */
+	pthread_mutex_lock(&ports_lock);
+	unsigned ports_before = ports_seen;
+	pthread_mutex_unlock(&ports_lock);
+	bool all_ok = true;
+	for (int i = 0; i < 100; i++) {
+		result_init(&res);
+		int ret = submit_soa(engine, "example.com.", &targets[1], 1, &res);
+		result_wait(&res);
+		all_ok = all_ok && ret == KNOT_EOK && res.ret == KNOT_EOK;
+	}
+	pthread_mutex_lock(&ports_lock);
+	ok(all_ok && ports_seen > ports_before, "udp_engine: source port rotated");
+	pthread_mutex_unlock(&ports_lock);
+
+	/* Cancelled queries. */
+	result_t res_notify;
+	result_init(&res);
+	result_init(&res_notify);
+	int ret = submit_soa(engine, "drop.", &targets[1], 1, &res);
+	int ret_notify = submit_notify(engine, "drop.", 1, &targets[1], 1, &res_notify);
+	udp_engine_cancel(engine, &res);
+	udp_engine_cancel(engine, &res_notify);
+	usleep(4 * TIMEOUT * 1000);
+	ok(ret == KNOT_EOK && ret_notify == KNOT_EOK &&
+	   res.calls == 0 && res_notify.calls == 0, "udp_engine: cancel");
+
+	/* Pending queries dropped upon deinit. */
+	ret = submit_soa(engine, "drop.", &targets[1], 1, &res);
+	ret_notify = submit_notify(engine, "drop.", 1, &targets[1], 1, &res_notify);
+	ok(ret == KNOT_EOK && ret_notify == KNOT_EOK, "udp_engine: submit pending");
+
+	udp_engine_stop(engine);
+	udp_engine_join(engine);
+	udp_engine_deinit(engine);
+	ok(res.calls == 0 && res_notify.calls == 0, "udp_engine: deinit");
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	/* Register signal handler interrupting the engine thread. */
+	struct sigaction sa;
+	sa.sa_handler = interrupt_handle;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGALRM, &sa, NULL);
+
+	/* Bind responder to random port. */
+	struct sockaddr_storage server = { 0 };
+	sockaddr_set(&server, AF_INET, "127.0.0.1", 0);
+	int responder_fd = net_bound_socket(SOCK_DGRAM, &server, 0);
+	assert(responder_fd >= 0);
+	socklen_t addr_len = sockaddr_len(&server);
+	int ret = getsockname(responder_fd, (struct sockaddr *)&server, &addr_len);
+	ok(ret == 0, "udp_engine: responder bound");
+
+	/* Address where nobody answers. */
+	struct sockaddr_storage silent = { 0 };
+	sockaddr_set(&silent, AF_INET, "127.0.0.1", 0);
+	int silent_fd = net_bound_socket(SOCK_DGRAM, &silent, 0);
+	assert(silent_fd >= 0);
+	addr_len = sockaddr_len(&silent);
+	(void)getsockname(silent_fd, (struct sockaddr *)&silent, &addr_len);
+
+	pthread_t thread;
+	pthread_create(&thread, NULL, responder_thread, &responder_fd);
+
+	udp_engine_t engine;
+	ret = udp_engine_init(&engine);
+	is_int(KNOT_EOK, ret, "udp_engine: init");
+	udp_engine_start(&engine);
+
+	udp_target_t targets[2] = { 0 };
+	targets[0].remote.addr = silent;
+	targets[1].remote.addr = server;
+
+	/* Disabled by default. */
+	result_t res;
+	result_init(&res);
+	ret = submit_soa(&engine, "example.com.", &targets[1], 1, &res);
+	is_int(KNOT_ENOTSUP, ret, "udp_engine: disabled");
+
+	udp_engine_set_limits(&engine, 2, TIMEOUT);
+
+	test_soa_check(&engine, targets, &server);
+	test_notify_send(&engine, targets, &server, silent_fd);
+	test_engine(&engine, targets);
+
+	/* Terminate responder. */
+	int conn = net_unbound_socket(SOCK_DGRAM, &server);
+	uint8_t wire[KNOT_WIRE_MAX_PKTSIZE];
+	knot_pkt_t *pkt = knot_pkt_new(wire, sizeof(wire), NULL);
+	knot_pkt_clear(pkt);
+	knot_pkt_put_question(pkt, (const knot_dname_t *)"\x04""stop", KNOT_CLASS_IN,
+	                      KNOT_RRTYPE_SOA);
+	(void)sendto(conn, pkt->wire, pkt->size, 0, (struct sockaddr *)&server,
+	             sockaddr_len(&server));
+	knot_pkt_free(pkt);
+	pthread_join(thread, NULL);
+	close(conn);
+	close(silent_fd);
+	close(responder_fd);
+
+	return 0;
+}
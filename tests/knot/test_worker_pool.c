@@ -21,6 +21,7 @@
 #include <sched.h>
 #include <signal.h>
 #include <time.h>
+#include <unistd.h>
 
 #include "knot/worker/pool.h"
 #include "knot/worker/queue.h"
@@ -61,6 +62,114 @@ static void task_counting(worker_task_t *task)
 	pthread_mutex_unlock(&log->mx);
 }
 
+/*!
+ * Priority test log.
+ */
+typedef struct prio_log {
+	pthread_mutex_t mx;
+	worker_prio_t order[TASKS_BATCH];
+	unsigned executed;
+	unsigned running;
+	unsigned max_running;
+} prio_log_t;
+
+/*!
+ * Task recording its priority class and the number of concurrent tasks.
+ */
+static void task_prio(worker_task_t *task)
+{
+	prio_log_t *log = task->ctx;
+
+	pthread_mutex_lock(&log->mx);
+	if (log->executed < TASKS_BATCH) {
+		log->order[log->executed] = task->prio;
+	}
+	log->executed += 1;
+	log->running += 1;
+	if (log->running > log->max_running) {
+		log->max_running = log->running;
+	}
+	pthread_mutex_unlock(&log->mx);
+
+	usleep(1000);
+
+	pthread_mutex_lock(&log->mx);
+	log->running -= 1;
+	pthread_mutex_unlock(&log->mx);
+}
+
+static void test_priorities(void)
+{
+	worker_pool_t *pool = worker_pool_create(1);
+	prio_log_t log = { .mx = PTHREAD_MUTEX_INITIALIZER };
+
+	worker_task_t maint = { .run = task_prio, .ctx = &log,
+	                        .prio = WORKER_PRIO_MAINTENANCE };
+	worker_task_t ctl = { .run = task_prio, .ctx = &log,
+	                      .prio = WORKER_PRIO_CONTROL };
+
+	// maintenance tasks enqueued first, control tasks take over
+
+	for (int i = 0; i < 4; i++) {
+		worker_pool_assign(pool, &maint);
+	}
+	for (int i = 0; i < 4; i++) {
+		worker_pool_assign(pool, &ctl);
+	}
+
+	worker_pool_start(pool);
+	worker_pool_wait(pool);
+
+	ok(log.executed == 8 && log.order[0] == WORKER_PRIO_CONTROL &&
+	   log.order[3] == WORKER_PRIO_CONTROL &&
+	   log.order[4] == WORKER_PRIO_MAINTENANCE, "priority order");
+
+	// lower class not starved
+
+	log.executed = 0;
+	worker_pool_suspend(pool);
+	for (int i = 0; i < 20; i++) {
+		worker_pool_assign(pool, &ctl);
+	}
+	worker_pool_assign(pool, &maint);
+	worker_pool_resume(pool);
+	worker_pool_wait(pool);
+
+	bool served = false;
+	for (int i = 0; i < 20; i++) {
+		served |= (log.order[i] == WORKER_PRIO_MAINTENANCE);
+	}
+	ok(served, "lower priority not starved");
+
+	worker_pool_stop(pool);
+	worker_pool_join(pool);
+	worker_pool_destroy(pool);
+	pthread_mutex_destroy(&log.mx);
+}
+
+static void test_limits(void)
+{
+	worker_pool_t *pool = worker_pool_create(THREADS);
+	prio_log_t log = { .mx = PTHREAD_MUTEX_INITIALIZER };
+
+	worker_task_t maint = { .run = task_prio, .ctx = &log,
+	                        .prio = WORKER_PRIO_MAINTENANCE };
+
+	worker_pool_set_limit(pool, WORKER_PRIO_MAINTENANCE, 1);
+	for (int i = 0; i < TASKS_BATCH; i++) {
+		worker_pool_assign(pool, &maint);
+	}
+	worker_pool_start(pool);
+	worker_pool_wait(pool);
+
+	ok(log.executed == TASKS_BATCH && log.max_running == 1, "class limit");
+
+	worker_pool_stop(pool);
+	worker_pool_join(pool);
+	worker_pool_destroy(pool);
+	pthread_mutex_destroy(&log.mx);
+}
+
 static void interrupt_handle(int s)
 {
 }
@@ -148,5 +257,8 @@ int main(void)
 
 	pthread_mutex_destroy(&log.mx);
 
+	test_priorities();
+	test_limits();
+
 	return 0;
 }
@@ -18,6 +18,7 @@
 #include <tap/basic.h>
 
 #include "libknot/errcode.h"
+#include "knot/worker/compute.h"
 #include "knot/zone/zone-tree.h"
 
 #define NCOUNT 4
@@ -129,6 +130,14 @@ int main(int argc, char *argv[])
 	ret = zone_tree_sub_apply(t, (const knot_dname_t *)"\x02""ac", true, ztree_node_counter, &counter);
 	ok(ret == KNOT_EOK && counter == 1, "ztree: subtree iteration excluding root");
 
+	/* 7. parallel apply */
+	int counters[3] = { 0 };
+	void *data[3] = { &counters[0], &counters[1], &counters[2] };
+	ret = zone_tree_apply_parallel(t, ztree_node_counter, data, 3);
+	ok(ret == KNOT_EOK && counters[0] + counters[1] + counters[2] == NCOUNT,
+	   "ztree: parallel iteration");
+	compute_pool_deinit();
+
 	zone_tree_free(&t);
 	ztree_free_data();
 	return 0;
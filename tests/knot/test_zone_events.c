@@ -15,10 +15,17 @@
  */
 
 #include <tap/basic.h>
+#include <signal.h>
+#include <unistd.h>
 
+#include "contrib/net.h"
+#include "contrib/sockaddr.h"
 #include "knot/common/evsched.h"
 #include "knot/worker/pool.h"
 #include "knot/events/events.h"
+#include "knot/events/replan.h"
+#include "knot/query/notify-send.h"
+#include "knot/server/server.h"
 #include "knot/zone/zone.h"
 
 static void test_scheduling(zone_t *zone)
@@ -67,6 +74,80 @@ static void test_scheduling(zone_t *zone)
 	// zone_events_start
 }
 
+static void interrupt_handle(int s)
+{
+}
+
+static void notify_cb(void *ctx, int ret, const struct sockaddr_storage *remote,
+                      uint32_t serial, uint16_t rcode)
+{
+	unsigned *calls = ctx;
+	(*calls)++;
+}
+
+static void test_replan_notify(worker_pool_t *pool, evsched_t *sched)
+{
+	server_t server = { 0 };
+	zone_t old_zone = { 0 };
+	zone_t new_zone = { 0 };
+	knot_dname_t *name = knot_dname_from_str_alloc("example.com.");
+
+	int r = udp_engine_init(&server.notify_send);
+	ok(r == KNOT_EOK, "NOTIFY engine init");
+	udp_engine_set_limits(&server.notify_send, 1, 1000);
+	udp_engine_start(&server.notify_send);
+
+	// secondary which never answers
+	udp_target_t target = { 0 };
+	sockaddr_set(&target.remote.addr, AF_INET, "127.0.0.1", 0);
+	int fd = net_bound_socket(SOCK_DGRAM, &target.remote.addr, 0);
+	socklen_t addr_len = sockaddr_len(&target.remote.addr);
+	(void)getsockname(fd, (struct sockaddr *)&target.remote.addr, &addr_len);
+
+	old_zone.name = name;
+	old_zone.server = &server;
+	new_zone.name = name;
+	new_zone.server = &server;
+	zone_events_init(&old_zone);
+	zone_events_init(&new_zone);
+	zone_events_setup(&old_zone, pool, sched);
+	zone_events_setup(&new_zone, pool, sched);
+	zone_events_freeze(&new_zone);
+
+	uint8_t soa_rdata[22] = { 0 };
+	knot_rrset_t soa;
+	knot_rrset_init(&soa, name, KNOT_RRTYPE_SOA, KNOT_CLASS_IN, 3600);
+	knot_rrset_add_rdata(&soa, soa_rdata, sizeof(soa_rdata), NULL);
+
+	unsigned calls = 0;
+	r = notify_send_submit(&server.notify_send, name, &soa, &target, 1,
+	                       notify_cb, &old_zone);
+	ok(r == KNOT_EOK, "NOTIFY pending");
+
+	// reload while the NOTIFY is waiting for acknowledgement
+	replan_load_updated(&new_zone, &old_zone);
+	ok(zone_events_get_time(&new_zone, ZONE_EVENT_NOTIFY) > 0,
+	   "NOTIFY replanned for the reloaded zone");
+	is_int(0, udp_engine_cancel(&server.notify_send, &old_zone),
+	       "NOTIFY of the old zone cancelled");
+
+	// reload without any pending NOTIFY
+	zone_events_schedule_at(&new_zone, ZONE_EVENT_NOTIFY, 0);
+	replan_load_updated(&new_zone, &old_zone);
+	ok(zone_events_get_time(&new_zone, ZONE_EVENT_NOTIFY) <= 0,
+	   "nothing to replan");
+	ok(calls == 0, "no NOTIFY result reported");
+
+	udp_engine_stop(&server.notify_send);
+	udp_engine_join(&server.notify_send);
+	udp_engine_deinit(&server.notify_send);
+	zone_events_deinit(&new_zone);
+	zone_events_deinit(&old_zone);
+	knot_rdataset_clear(&soa.rrs, NULL);
+	knot_dname_free(name, NULL);
+	close(fd);
+}
+
 int main(void)
 {
 	plan_lazy();
@@ -91,6 +172,15 @@ int main(void)
 
 	test_scheduling(&zone);
 
+	/* Register signal handler interrupting the NOTIFY engine thread. */
+	struct sigaction sa;
+	sa.sa_handler = interrupt_handle;
+	sigemptyset(&sa.sa_mask);
+	sa.sa_flags = 0;
+	sigaction(SIGALRM, &sa, NULL);
+
+	test_replan_notify(pool, &sched);
+
 	zone_events_deinit(&zone);
 	worker_pool_destroy(pool);
 	evsched_deinit(&sched);
@@ -0,0 +1,116 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <tap/basic.h>
+
+#include "test_conf.h"
+#include "knot/conf/confio.h"
+#include "knot/zone/settings.h"
+#include "knot/zone/zone.h"
+#include "libknot/libknot.h"
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	const char *conf_str =
+		"remote:\n"
+		"  - id: master\n"
+		"    address: 192.0.2.1\n"
+		"template:\n"
+		"  - id: signed\n"
+		"    dnssec-signing: on\n"
+		"    serial-policy: unixtime\n"
+		"    zonefile-sync: -1\n"
+		"    refresh-min-interval: 10\n"
+		"zone:\n"
+		"  - domain: example.com.\n"
+		"  - domain: example.net.\n"
+		"    template: signed\n"
+		"    master: master\n"
+		"    zone-max-size: 1000\n"
+		"    journal-content: all\n";
+
+	int ret = test_conf(conf_str, NULL);
+	is_int(KNOT_EOK, ret, "load configuration");
+
+	knot_dname_t *name = knot_dname_from_str_alloc("example.com.");
+	zone_settings_t *settings = zone_settings_new(conf(), name);
+	ok(settings != NULL, "zone_settings: new");
+	ok(!settings->is_slave && !settings->dnssec_signing &&
+	   settings->serial_policy == SERIAL_POLICY_INCREMENT &&
+	   settings->journal_content == JOURNAL_CONTENT_CHANGES &&
+	   settings->zonefile_sync == 0 &&
+	   settings->refresh_min_interval == 2,
+	   "zone_settings: default values");
+	zone_settings_free(settings);
+	knot_dname_free(name, NULL);
+
+	name = knot_dname_from_str_alloc("example.net.");
+	settings = zone_settings_new(conf(), name);
+	ok(settings != NULL, "zone_settings: new from template");
+	ok(settings->is_slave && settings->dnssec_signing &&
+	   settings->serial_policy == SERIAL_POLICY_UNIXTIME &&
+	   settings->zonefile_sync == -1 &&
+	   settings->refresh_min_interval == 10,
+	   "zone_settings: template values");
+	ok(settings->max_zone_size == 1000 &&
+	   settings->journal_content == JOURNAL_CONTENT_ALL,
+	   "zone_settings: explicit values");
+
+	/* Resolved from configuration if not cached. */
+	zone_t *zone = zone_new(name);
+	zone_settings_t local;
+	const zone_settings_t *resolved = zone_get_settings(conf(), zone, &local);
+	ok(resolved == &local && local.is_slave && local.max_zone_size == 1000,
+	   "zone_settings: resolve uncached");
+	ok(zone_is_slave(conf(), zone), "zone_settings: slave uncached");
+
+	/* Cached settings take precedence. */
+	settings->is_slave = false;
+	zone->settings = settings;
+	resolved = zone_get_settings(conf(), zone, &local);
+	ok(resolved == &local && !local.is_slave && local.max_zone_size == 1000,
+	   "zone_settings: get cached");
+	ok(!zone_is_slave(conf(), zone), "zone_settings: slave cached");
+
+	/* Committed configuration change is reflected. */
+	ok(conf_io_begin(false) == KNOT_EOK &&
+	   conf_io_set("zone", "serial-policy", "example.net.", "dateserial") == KNOT_EOK &&
+	   conf_io_set("zone", "journal-max-depth", "example.net.", "5") == KNOT_EOK &&
+	   conf_io_commit(false) == KNOT_EOK &&
+	   conf_refresh_txn(conf()) == KNOT_EOK,
+	   "zone_settings: commit configuration change");
+	resolved = zone_get_settings(conf(), zone, &local);
+	ok(local.serial_policy == SERIAL_POLICY_UNIXTIME,
+	   "zone_settings: unchanged before reload");
+	zone_settings_t *old = zone_reload_settings(conf(), zone);
+	ok(old == settings, "zone_settings: reload");
+	zone_settings_free(old);
+	resolved = zone_get_settings(conf(), zone, &local);
+	ok(resolved == &local && local.is_slave &&
+	   local.serial_policy == SERIAL_POLICY_DATESERIAL &&
+	   local.journal_max_depth == 5 && local.max_zone_size == 1000,
+	   "zone_settings: get reloaded");
+
+	zone_free(&zone);
+	knot_dname_free(name, NULL);
+
+	test_conf_free();
+
+	return 0;
+}
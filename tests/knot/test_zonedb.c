@@ -95,6 +95,32 @@ int main(int argc, char *argv[])
 	}
 	ok(nr_passed == ZONE_COUNT, "zonedb: find zones for subnames");
 
+	/* Incremental update. */
+	knot_zonedb_t *db_new = knot_zonedb_cow(db);
+	ok(db_new != NULL, "zonedb: start incremental update");
+	dname = knot_dname_from_str_alloc("cow.net");
+	zone_t *added = zone_new(dname);
+	int ret_ins = knot_zonedb_insert(db_new, added);
+	int ret_del = knot_zonedb_del(db_new, zones[1]->name);
+	ok(ret_ins == KNOT_EOK && ret_del == KNOT_EOK, "zonedb: update copy");
+	ok(knot_zonedb_find(db, dname) == NULL &&
+	   knot_zonedb_find(db, zones[1]->name) == zones[1] &&
+	   knot_zonedb_size(db) == ZONE_COUNT, "zonedb: original unchanged");
+	ok(knot_zonedb_find(db_new, dname) == added &&
+	   knot_zonedb_find(db_new, zones[1]->name) == NULL &&
+	   knot_zonedb_find(db_new, zones[2]->name) == zones[2] &&
+	   knot_zonedb_size(db_new) == ZONE_COUNT, "zonedb: copy updated");
+	knot_zonedb_cow_commit(&db, db_new);
+	ok(db == NULL && knot_zonedb_find_suffix(db_new, dname) == added,
+	   "zonedb: commit incremental update");
+	db = db_new;
+
+	/* Revert the update. */
+	(void)knot_zonedb_del(db, dname);
+	(void)knot_zonedb_insert(db, zones[1]);
+	zone_free(&added);
+	knot_dname_free(dname, NULL);
+
 	/* Remove all zones. */
 	nr_passed = 0;
 	for (unsigned i = 0; i < ZONE_COUNT; ++i) {
@@ -104,17 +104,28 @@ static void ctl_client(const char *socket, size_t argc, knot_ctl_data_t *argv)
 	knot_ctl_free(ctl);
 }
 
-static void ctl_server(const char *socket, size_t argc, knot_ctl_data_t *argv)
+static void ctl_server(const char *socket, size_t argc, knot_ctl_data_t *argv,
+                       bool move)
 {
-	knot_ctl_t *ctl = knot_ctl_alloc();
-	ok(ctl != NULL, "Allocate control");
+	knot_ctl_t *listener = knot_ctl_alloc();
+	ok(listener != NULL, "Allocate control");
 
-	int ret = knot_ctl_bind(ctl, socket);
+	int ret = knot_ctl_bind(listener, socket);
 	is_int(KNOT_EOK, ret, "Bind control socket");
 
-	ret = knot_ctl_accept(ctl);
+	ret = knot_ctl_accept(listener);
 	is_int(KNOT_EOK, ret, "Accept a connection");
 
+	knot_ctl_t *ctl = listener;
+	if (move) {
+		ctl = knot_ctl_alloc();
+		ok(ctl != NULL, "Allocate session control");
+
+		ret = knot_ctl_move(listener, ctl);
+		is_int(KNOT_EOK, ret, "Move the connection");
+		ok(listener->sock < 0, "Connection moved away");
+	}
+
 	diag("BEGIN: Server <- Client");
 
 	size_t count = 0;
@@ -169,11 +180,14 @@ static void ctl_server(const char *socket, size_t argc, knot_ctl_data_t *argv)
 	diag("END: Server -> Client");
 
 	knot_ctl_close(ctl);
-	knot_ctl_unbind(ctl);
-	knot_ctl_free(ctl);
+	if (move) {
+		knot_ctl_free(ctl);
+	}
+	knot_ctl_unbind(listener);
+	knot_ctl_free(listener);
 }
 
-static void test_client_server_client(void)
+static void test_client_server_client(bool move)
 {
 	char *socket = test_mktemp();
 	ok(socket != NULL, "Make a temporary socket file '%s'", socket);
@@ -197,9 +211,9 @@ static void test_client_server_client(void)
 	if (child_pid == 0) {
 		ctl_client(socket, data_len, data);
 		free(socket);
-		return;
+		exit(0);
 	} else {
-		ctl_server(socket, data_len, data);
+		ctl_server(socket, data_len, data, move);
 	}
 
 	int status = 0;
@@ -210,12 +224,47 @@ static void test_client_server_client(void)
 	free(socket);
 }
 
+static void test_wakeup(void)
+{
+	char *socket = test_mktemp();
+	ok(socket != NULL, "Make a temporary socket file '%s'", socket);
+
+	knot_ctl_t *ctl = knot_ctl_alloc();
+	int ret = knot_ctl_bind(ctl, socket);
+	is_int(KNOT_EOK, ret, "Bind control socket");
+
+	int fds[2];
+	ret = pipe(fds);
+	ok(ret == 0, "Create wakeup pipe");
+	knot_ctl_set_wakeup(ctl, fds[0]);
+
+	uint8_t byte = 0;
+	ret = write(fds[1], &byte, sizeof(byte));
+	ok(ret == sizeof(byte), "Write wakeup");
+
+	ret = knot_ctl_accept(ctl);
+	is_int(KNOT_EAGAIN, ret, "Accept interrupted by wakeup");
+
+	close(fds[0]);
+	close(fds[1]);
+	knot_ctl_unbind(ctl);
+	knot_ctl_free(ctl);
+	test_rm_rf(socket);
+	free(socket);
+}
+
 int main(int argc, char *argv[])
 {
 	plan_lazy();
 
 	diag("Client -> Server -> Client");
-	test_client_server_client();
+	test_client_server_client(false);
+
+	diag("Client -> Server -> Client, moved connection");
+	test_client_server_client(true);
+
+	diag("Accept interrupted by wakeup");
+	test_wakeup();
 
 	return 0;
 }
@@ -183,6 +183,21 @@ int main(int argc, char *argv[])
 	/* Compare copied packet to original. */
 	packet_match(in, copy);
 
+	/*
+	 * Caller-provided packet tests.
+	 */
+	knot_pkt_t ext;
+	knot_rrinfo_t ext_info[2];
+	knot_rrset_t ext_rr[2];
+	knot_pkt_init(&ext, out->wire, out->size, &out->mm, ext_info, ext_rr, 2);
+	ok(ext.rr == ext_rr && (ext.flags & KNOT_PF_EXTRR), "pkt: init with RR arrays");
+
+	/* Read packet exceeding the provided RR arrays. */
+	ret = knot_pkt_parse(&ext, 0);
+	is_int(KNOT_EOK, ret, "pkt: parse into provided packet");
+	ok(ext.rr != ext_rr && !(ext.flags & KNOT_PF_EXTRR), "pkt: RR arrays reallocated");
+	packet_match(&ext, out);
+
 	/* Free packets. */
 	knot_pkt_free(copy);
 	knot_pkt_free(out);
@@ -0,0 +1,98 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <tap/basic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "contrib/sockaddr.h"
+#include "knot/modules/queryacl/addr_set.c"
+
+static bool match(const addr_set_t *set, int family, const char *str)
+{
+	struct sockaddr_storage addr;
+	sockaddr_set(&addr, family, str, 0);
+	return addr_set_match(set, &addr);
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	addr_set_t *set = addr_set_new();
+	ok(set != NULL, "addr_set: create");
+
+	struct sockaddr_storage min, max;
+	sockaddr_set(&min, AF_INET, "192.0.2.10", 0);
+	sockaddr_set(&max, AF_INET, "192.0.2.20", 0);
+	int ret = addr_set_add_range(set, &min, &max);
+	is_int(KNOT_EOK, ret, "addr_set: add range");
+	ret = addr_set_add_range(set, &max, &min);
+	is_int(KNOT_EINVAL, ret, "addr_set: add inverted range");
+
+	sockaddr_set(&min, AF_INET, "192.0.2.21", 0);
+	ret = addr_set_add_net(set, &min, 32);
+	is_int(KNOT_EOK, ret, "addr_set: add adjacent address");
+	sockaddr_set(&min, AF_INET, "198.51.100.77", 0);
+	ret = addr_set_add_net(set, &min, 24);
+	is_int(KNOT_EOK, ret, "addr_set: add IPv4 network");
+	sockaddr_set(&min, AF_INET6, "2001:db8::1", 0);
+	ret = addr_set_add_net(set, &min, 32);
+	is_int(KNOT_EOK, ret, "addr_set: add IPv6 network");
+	ret = addr_set_add_net(set, &min, 129);
+	is_int(KNOT_EINVAL, ret, "addr_set: add too long prefix");
+
+	/* Address file. */
+	char path[] = "/tmp/knot_test_queryacl_XXXXXX";
+	int fd = mkstemp(path);
+	FILE *file = fdopen(fd, "w");
+	fprintf(file, "# comment\n\n  203.0.113.1-203.0.113.5  # range\n192.0.2.15/30\n");
+	fclose(file);
+	size_t line = 0;
+	ret = addr_set_add_file(set, path, &line);
+	is_int(KNOT_EOK, ret, "addr_set: add file");
+
+	file = fopen(path, "a");
+	fprintf(file, "203.0.113.300\n");
+	fclose(file);
+	addr_set_t *bad = addr_set_new();
+	ret = addr_set_add_file(bad, path, &line);
+	ok(ret == KNOT_EMALF && line == 5, "addr_set: malformed file");
+	addr_set_free(bad);
+	unlink(path);
+
+	ret = addr_set_build(set);
+	is_int(KNOT_EOK, ret, "addr_set: build");
+	is_int(4, addr_set_size(set), "addr_set: merged intervals");
+
+	ok(match(set, AF_INET, "192.0.2.10") && match(set, AF_INET, "192.0.2.21") &&
+	   match(set, AF_INET, "198.51.100.0") && match(set, AF_INET, "198.51.100.255") &&
+	   match(set, AF_INET, "203.0.113.3") && match(set, AF_INET6, "2001:db8:ffff::"),
+	   "addr_set: match");
+	ok(!match(set, AF_INET, "192.0.2.9") && !match(set, AF_INET, "192.0.2.22") &&
+	   !match(set, AF_INET, "203.0.113.6") && !match(set, AF_INET, "0.0.0.0") &&
+	   !match(set, AF_INET6, "2001:db9::") && !match(set, AF_INET6, "::c000:20a"),
+	   "addr_set: no match");
+
+	ret = addr_set_add_net(set, &min, 64);
+	is_int(KNOT_EINVAL, ret, "addr_set: add after build");
+
+	addr_set_free(set);
+
+	return 0;
+}
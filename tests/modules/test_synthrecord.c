@@ -0,0 +1,157 @@
+/*  Copyright (C) 2021 CZ.NIC, z.s.p.o. <knot-dns@labs.nic.cz>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include <tap/basic.h>
+#include <arpa/inet.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "knot/modules/synthrecord/synth_addr.c"
+
+static bool label_parse(const char *text, int family, const char *expected)
+{
+	synth_addr_t addr;
+	if (synth_addr_from_label((const uint8_t *)text, strlen(text), &addr) != KNOT_EOK) {
+		return expected == NULL;
+	}
+
+	uint8_t bytes[16] = { 0 };
+	return expected != NULL && addr.family == family &&
+	       inet_pton(family, expected, bytes) == 1 &&
+	       memcmp(bytes, addr.bytes, (family == AF_INET) ? 4 : 16) == 0;
+}
+
+static bool reverse_parse(const char *name, const char *expected, bool exp_parent)
+{
+	knot_dname_t *dname = knot_dname_from_str_alloc(name);
+	synth_addr_t addr;
+	bool parent = false;
+	int ret = synth_addr_from_reverse(dname, &addr, &parent);
+	knot_dname_free(dname, NULL);
+	if (ret != KNOT_EOK) {
+		return expected == NULL;
+	}
+
+	uint8_t bytes[16] = { 0 };
+	return expected != NULL && parent == exp_parent &&
+	       inet_pton(addr.family, expected, bytes) == 1 &&
+	       memcmp(bytes, addr.bytes, sizeof(bytes)) == 0;
+}
+
+static bool label_write(const char *address, bool shorten, const char *expected)
+{
+	synth_addr_t addr = { .family = strchr(address, ':') ? AF_INET6 : AF_INET };
+	(void)inet_pton(addr.family, address, addr.bytes);
+
+	uint8_t out[SYNTH_ADDR_LABEL_MAXLEN];
+	size_t len = synth_addr_to_label(&addr, shorten, out);
+	return len == strlen(expected) && memcmp(out, expected, len) == 0;
+}
+
+/*! \brief Compare parsing of random addresses with inet_pton. */
+static bool random_roundtrip(int family, bool shorten)
+{
+	for (int i = 0; i < 10000; i++) {
+		synth_addr_t addr = { .family = family };
+		for (int j = 0; j < sizeof(addr.bytes); j++) {
+			addr.bytes[j] = (rand() % 3 == 0) ? rand() : 0;
+		}
+		if (family == AF_INET) {
+			memset(addr.bytes + 4, 0, sizeof(addr.bytes) - 4);
+		}
+
+		// Forward label produced by inet_ntop.
+		char text[INET6_ADDRSTRLEN];
+		inet_ntop(family, addr.bytes, text, sizeof(text));
+		for (char *ch = text; *ch != '\0'; ch++) {
+			if (*ch == ':' || (family == AF_INET && *ch == '.')) {
+				*ch = '-';
+			}
+		}
+		synth_addr_t parsed;
+		if (synth_addr_from_label((uint8_t *)text, strlen(text), &parsed) != KNOT_EOK ||
+		    parsed.family != family ||
+		    memcmp(parsed.bytes, addr.bytes, sizeof(addr.bytes)) != 0) {
+			diag("forward mismatch %s", text);
+			return false;
+		}
+
+		// Label written by the module.
+		uint8_t out[SYNTH_ADDR_LABEL_MAXLEN];
+		size_t len = synth_addr_to_label(&addr, shorten, out);
+		if (synth_addr_from_label(out, len, &parsed) != KNOT_EOK ||
+		    memcmp(parsed.bytes, addr.bytes, sizeof(addr.bytes)) != 0 ||
+		    out[0] == '-' || out[len - 1] == '-') {
+			diag("label mismatch %.*s", (int)len, out);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	plan_lazy();
+
+	/* Forward labels. */
+	ok(label_parse("192-0-2-1", AF_INET, "192.0.2.1"), "forward: IPv4");
+	ok(label_parse("192-0-2-01", AF_INET, NULL), "forward: IPv4 leading zero");
+	ok(label_parse("192-0-2-256", AF_INET, NULL), "forward: IPv4 octet overflow");
+	ok(label_parse("192-0-2", AF_INET, NULL), "forward: IPv4 too short");
+	ok(label_parse("2620-0-b61-100--1", AF_INET6, "2620:0:b61:100::1"), "forward: IPv6");
+	ok(label_parse("2620:0:b61:100::1", AF_INET6, "2620:0:b61:100::1"), "forward: IPv6 with colons");
+	ok(label_parse("--1", AF_INET6, "::1"), "forward: IPv6 leading compression");
+	ok(label_parse("1--", AF_INET6, "1::"), "forward: IPv6 trailing compression");
+	ok(label_parse("--ffff-192.0.2.1", AF_INET6, "::ffff:192.0.2.1"), "forward: IPv6 with IPv4 suffix");
+	ok(label_parse("1-2-3-4-5-6-7-8", AF_INET6, "1:2:3:4:5:6:7:8"), "forward: IPv6 full");
+	ok(label_parse("1-2-3-4-5-6-7-8-9", AF_INET6, NULL), "forward: IPv6 too long");
+	ok(label_parse("1--2--3", AF_INET6, NULL), "forward: IPv6 double compression");
+	ok(label_parse("12345--1", AF_INET6, NULL), "forward: IPv6 block overflow");
+	ok(label_parse("1-2-3-", AF_INET6, NULL), "forward: IPv6 trailing separator");
+	ok(label_parse("g--1", AF_INET6, NULL), "forward: invalid character");
+
+	/* Reverse names. */
+	ok(reverse_parse("1.2.0.192.in-addr.arpa.", "192.0.2.1", false), "reverse: IPv4");
+	ok(reverse_parse("2.0.192.in-addr.arpa.", "192.0.2.0", true), "reverse: IPv4 parent");
+	ok(reverse_parse("in-addr.arpa.", "0.0.0.0", true), "reverse: IPv4 zone");
+	ok(reverse_parse("01.2.0.192.in-addr.arpa.", NULL, false), "reverse: IPv4 leading zero");
+	ok(reverse_parse("1.2.0.192.in-addr.arpa.com.", NULL, false), "reverse: IPv4 other zone");
+	ok(reverse_parse("1.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.0.1.0.1.6.b.0.0.0.0.0.0.2.6.2.ip6.arpa.",
+	                 "2620:0:b61:100::1", false), "reverse: IPv6");
+	ok(reverse_parse("0.1.0.1.6.b.0.0.0.0.0.0.2.6.2.ip6.arpa.", "2620:0:b61:100::", true),
+	   "reverse: IPv6 parent");
+	ok(reverse_parse("x.0.0.0.1.6.b.0.0.0.0.2.6.2.ip6.arpa.", NULL, false),
+	   "reverse: IPv6 invalid nibble");
+	ok(reverse_parse("10.0.0.0.1.6.b.0.0.0.0.2.6.2.ip6.arpa.", NULL, false),
+	   "reverse: IPv6 long label");
+
+	/* Labels written for PTR records. */
+	ok(label_write("192.0.2.1", false, "192-0-2-1"), "label: IPv4");
+	ok(label_write("2620:0:b61:100::1", false, "2620-0000-0b61-0100-0000-0000-0000-0001"),
+	   "label: IPv6");
+	ok(label_write("2620:0:b61:100::1", true, "2620-0-b61-100--1"), "label: IPv6 short");
+	ok(label_write("2620:0:b61::", true, "2620-0-b61--0"), "label: IPv6 short trailing zeros");
+	ok(label_write("::1", true, "0-0--1"), "label: IPv6 short leading zeros");
+	ok(label_write("1:2:0:4:0:6:0:8", true, "1-2-0-4-0-6-0-8"), "label: IPv6 single zero blocks");
+
+	ok(random_roundtrip(AF_INET, false), "random IPv4 addresses");
+	ok(random_roundtrip(AF_INET6, false), "random IPv6 addresses");
+	ok(random_roundtrip(AF_INET6, true), "random IPv6 addresses, short");
+
+	return 0;
+}